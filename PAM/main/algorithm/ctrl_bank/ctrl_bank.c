@@ -0,0 +1,108 @@
+//ESP32-S3 的 PIE 向量指令只支持整数 (int8/16/32) 运算，没有浮点 SIMD，
+//因此浮点控制器组在所有芯片上都使用同一份标量实现：SoA 布局 + 无分支循环
+//让编译器可以流水化/展开，同时保证与单结构体版本的结果逐位一致。
+
+#include "ctrl_bank.h"
+#include <string.h>
+#include <math.h>
+
+void pid_bank_init(pid_bank_t *b, int n) {
+    memset(b, 0, sizeof(*b));
+    b->n = n > CTRL_BANK_MAX ? CTRL_BANK_MAX : n;
+}
+
+void pid_bank_config(pid_bank_t *b, int i, float kp, float ki, float kd, float min, float max) {
+    if (i < 0 || i >= b->n) return;
+    b->kp[i] = kp;
+    b->ki[i] = ki;
+    b->kd[i] = kd;
+    b->out_min[i] = min;
+    b->out_max[i] = max;
+    b->int_limit[i] = (max - min) * 0.5f; // 默认积分限幅为量程的一半
+    b->dead_zone[i] = 0.0f;               // 默认无死区
+
+    b->setpoint[i] = 0.0f;
+    b->integral[i] = 0.0f;
+    b->prev_error[i] = 0.0f;
+}
+
+void pid_bank_reset(pid_bank_t *b, int i) {
+    if (i < 0 || i >= b->n) return;
+    b->integral[i] = 0.0f;
+    b->prev_error[i] = 0.0f;
+}
+
+/**
+ * @brief 批量计算 PID 输出 (与 pid_compute 逐位一致)
+ * * @param b 控制器组
+ * @param measured 各控制器的测量值
+ * @param out 各控制器的输出
+ */
+void pid_bank_compute(pid_bank_t *b, const float *measured, float *out) {
+    const int n = b->n;
+    float *restrict integral = b->integral;
+    float *restrict prev_error = b->prev_error;
+
+    for (int i = 0; i < n; i++) {
+        float error = b->setpoint[i] - measured[i];
+
+        // 1. 死区处理
+        error = (fabsf(error) < b->dead_zone[i]) ? 0.0f : error;
+
+        // 2. 积分计算 (带抗饱和限幅)
+        float integ = integral[i] + error;
+        float lim = b->int_limit[i];
+        integ = integ > lim ? lim : (integ < -lim ? -lim : integ);
+        integral[i] = integ;
+
+        // 3. 微分计算
+        float derivative = error - prev_error[i];
+
+        // 4. PID 公式
+        float output = (b->kp[i] * error) + (b->ki[i] * integ) + (b->kd[i] * derivative);
+
+        // 5. 输出限幅
+        output = output > b->out_max[i] ? b->out_max[i] : (output < b->out_min[i] ? b->out_min[i] : output);
+
+        prev_error[i] = error;
+        out[i] = output;
+    }
+}
+
+void kf_bank_init(kf_bank_t *b, int n) {
+    memset(b, 0, sizeof(*b));
+    b->n = n > CTRL_BANK_MAX ? CTRL_BANK_MAX : n;
+}
+
+void kf_bank_config(kf_bank_t *b, int i, float initial_value, float P, float Q, float R) {
+    if (i < 0 || i >= b->n) return;
+    b->x[i] = initial_value;
+    b->P[i] = P;
+    b->Q[i] = Q;
+    b->R[i] = R;
+}
+
+/**
+ * @brief 批量更新卡尔曼滤波 (与 kf_update 逐位一致)
+ * * @param b 滤波器组
+ * @param z 各滤波器的测量值
+ * @param out 各滤波器的估计值，可为 NULL
+ */
+void kf_bank_update(kf_bank_t *b, const float *z, float *out) {
+    const int n = b->n;
+    float *restrict x = b->x;
+    float *restrict P = b->P;
+
+    for (int i = 0; i < n; i++) {
+        // 1. 预测更新
+        float p = P[i] + b->Q[i];
+        // 2. 计算卡尔曼增益
+        float K = p / (p + b->R[i]);
+        // 3. 测量更新
+        x[i] = x[i] + K * (z[i] - x[i]);
+        // 4. 更新误差协方差
+        P[i] = (1.0f - K) * p;
+    }
+
+    if (out) memcpy(out, x, n * sizeof(float));
+}
@@ -0,0 +1,50 @@
+//多关节控制器组 (结构体数组 -> 数组结构体 SoA 布局)
+//一次调用更新 N 个 PID / N 个一维卡尔曼滤波，各字段连续存放，循环体无分支，
+//运算顺序与 pid_compute / kf_update 完全相同，结果逐位一致。
+
+#ifndef CTRL_BANK_H
+#define CTRL_BANK_H
+
+#define CTRL_BANK_MAX 24    // 8 个 MUX 通道 × 3 个回路
+
+typedef struct {
+    int   n;                            ///< 当前使用的控制器数量
+    float kp[CTRL_BANK_MAX];
+    float ki[CTRL_BANK_MAX];
+    float kd[CTRL_BANK_MAX];
+    float setpoint[CTRL_BANK_MAX];
+    float integral[CTRL_BANK_MAX];
+    float prev_error[CTRL_BANK_MAX];
+    float out_min[CTRL_BANK_MAX];
+    float out_max[CTRL_BANK_MAX];
+    float int_limit[CTRL_BANK_MAX];     ///< 积分限幅 (抗饱和)
+    float dead_zone[CTRL_BANK_MAX];     ///< 死区
+} pid_bank_t;
+
+typedef struct {
+    int   n;
+    float x[CTRL_BANK_MAX];             ///< 状态估计值
+    float P[CTRL_BANK_MAX];             ///< 估计协方差
+    float Q[CTRL_BANK_MAX];             ///< 过程噪声
+    float R[CTRL_BANK_MAX];             ///< 测量噪声
+} kf_bank_t;
+
+// n 个控制器全部清零
+void pid_bank_init(pid_bank_t *b, int n);
+
+// 配置第 i 个控制器，默认值与 pid_init 相同
+void pid_bank_config(pid_bank_t *b, int i, float kp, float ki, float kd, float min, float max);
+
+// 清除第 i 个控制器的积分和历史误差
+void pid_bank_reset(pid_bank_t *b, int i);
+
+// 同时计算 n 个 PID，measured/out 各 n 个元素
+void pid_bank_compute(pid_bank_t *b, const float *measured, float *out);
+
+void kf_bank_init(kf_bank_t *b, int n);
+void kf_bank_config(kf_bank_t *b, int i, float initial_value, float P, float Q, float R);
+
+// 同时更新 n 个滤波器，out 可以为 NULL
+void kf_bank_update(kf_bank_t *b, const float *z, float *out);
+
+#endif // CTRL_BANK_H
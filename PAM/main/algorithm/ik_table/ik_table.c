@@ -0,0 +1,120 @@
+#include "ik_table.h"
+#include <math.h>
+#include <string.h>
+
+#define IK_PI       3.14159265f
+
+bool ik_solve_exact(const ik_arm_t *arm, float elbow, float x, float y, float q[2]) {
+    float c2 = (x * x + y * y - arm->l1 * arm->l1 - arm->l2 * arm->l2) / (2.0f * arm->l1 * arm->l2);
+    if (c2 > 1.0f || c2 < -1.0f) return false;
+
+    float q2 = elbow * acosf(c2);
+    float q1 = atan2f(y, x) - atan2f(arm->l2 * sinf(q2), arm->l1 + arm->l2 * cosf(q2));
+    if (elbow * q2 < arm->q2_margin) return false;
+    if (q1 < arm->q_min[0] || q1 > arm->q_max[0]) return false;
+    if (q2 < arm->q_min[1] || q2 > arm->q_max[1]) return false;
+
+    q[0] = q1;
+    q[1] = q2;
+    return true;
+}
+
+void ik_forward(const ik_arm_t *arm, const float q[2], float *x, float *y) {
+    *x = arm->l1 * cosf(q[0]) + arm->l2 * cosf(q[0] + q[1]);
+    *y = arm->l1 * sinf(q[0]) + arm->l2 * sinf(q[0] + q[1]);
+}
+
+bool ik_table_build(ik_table_t *t, const ik_arm_t *arm) {
+    memset(t, 0, sizeof(*t));
+    t->arm = *arm;
+    t->elbow = (arm->q_max[1] >= -arm->q_min[1]) ? 1.0f : -1.0f;
+
+    // 该构型下肘角绝对值的范围 -> ρ 区间 (|q2| 越大 ρ 越小)
+    float a_lo = arm->q2_margin;
+    float a_hi = t->elbow > 0.0f ? arm->q_max[1] : -arm->q_min[1];
+    if (a_hi > IK_PI) a_hi = IK_PI;
+    if (a_hi <= a_lo) return false;
+
+    float k = 2.0f * arm->l1 * arm->l2;
+    float base = arm->l1 * arm->l1 + arm->l2 * arm->l2;
+    float rho_lo = base + k * cosf(a_hi);
+    float rho_hi = base + k * cosf(a_lo);
+    t->rho0 = rho_lo;
+    t->inv_drho = (IK_RHO_POINTS - 1) / (rho_hi - rho_lo);
+
+    for (int i = 0; i < IK_RHO_POINTS; i++) {
+        float c2 = (rho_lo + i / t->inv_drho - base) / k;
+        if (c2 > 1.0f) c2 = 1.0f;
+        else if (c2 < -1.0f) c2 = -1.0f;
+        float q2 = t->elbow * acosf(c2);
+        t->q2[i] = q2;
+        t->beta[i] = atan2f(arm->l2 * sinf(q2), arm->l1 + arm->l2 * cosf(q2));
+    }
+    for (int i = 0; i < IK_ATAN_POINTS; i++) {
+        t->atan_tab[i] = atanf((float)i / (IK_ATAN_POINTS - 1));
+    }
+    return true;
+}
+
+// 查表 atan2: 按八分圆折算到 t ∈ [0, 1]
+static inline float ik_atan2(const ik_table_t *t, float y, float x) {
+    float ax = fabsf(x), ay = fabsf(y);
+    bool swap = ay > ax;
+    float r = swap ? ax / ay : ay / ax;
+
+    float f = r * (IK_ATAN_POINTS - 1);
+    int i = (int)f;
+    if (i > IK_ATAN_POINTS - 2) i = IK_ATAN_POINTS - 2;
+    float a = t->atan_tab[i] + (f - (float)i) * (t->atan_tab[i + 1] - t->atan_tab[i]);
+
+    if (swap) a = 0.5f * IK_PI - a;
+    if (x < 0.0f) a = IK_PI - a;
+    return y < 0.0f ? -a : a;
+}
+
+ik_status_t ik_table_lookup(const ik_table_t *t, float x, float y, ik_sol_t *out) {
+    ik_status_t st = IK_OK;
+    float rho = x * x + y * y;
+
+    // ρ 超出可达区间时钳位到边界 (同一方位角)
+    float f = (rho - t->rho0) * t->inv_drho;
+    if (f < 0.0f) {
+        f = 0.0f;
+        st = IK_CLAMPED;
+    } else if (f > (float)(IK_RHO_POINTS - 1)) {
+        f = (float)(IK_RHO_POINTS - 1);
+        st = IK_CLAMPED;
+    }
+    int i = (int)f;
+    if (i > IK_RHO_POINTS - 2) i = IK_RHO_POINTS - 2;
+    float a = f - (float)i;
+    float s_q2 = t->q2[i + 1] - t->q2[i];
+    float s_b = t->beta[i + 1] - t->beta[i];
+    float q2 = t->q2[i] + a * s_q2;
+    float q1 = (rho > 0.0f ? ik_atan2(t, y, x) : 0.0f) - (t->beta[i] + a * s_b);
+
+    if (q1 < t->arm.q_min[0]) {
+        q1 = t->arm.q_min[0];
+        st = IK_CLAMPED;
+    } else if (q1 > t->arm.q_max[0]) {
+        q1 = t->arm.q_max[0];
+        st = IK_CLAMPED;
+    }
+    out->q[0] = q1;
+    out->q[1] = q2;
+
+    if (st != IK_OK) {
+        memset(out->dq, 0, sizeof(out->dq));
+        return st;
+    }
+
+    // ∂ρ/∂(x,y) = 2(x,y)，∂φ/∂(x,y) = (-y, x) / ρ
+    s_q2 *= t->inv_drho;
+    s_b *= t->inv_drho;
+    float inv_rho = 1.0f / rho;
+    out->dq[0][0] = -y * inv_rho - 2.0f * x * s_b;
+    out->dq[0][1] = x * inv_rho - 2.0f * y * s_b;
+    out->dq[1][0] = 2.0f * x * s_q2;
+    out->dq[1][1] = 2.0f * y * s_q2;
+    return IK_OK;
+}
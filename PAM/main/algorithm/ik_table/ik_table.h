@@ -0,0 +1,55 @@
+//平面两连杆 (肩 + 肘) 逆运动学查找表
+//两连杆的逆解可分离: 肘角只取决于 ρ = x² + y²，肩角 q1 = φ - β(ρ)，φ 为末端方位角。
+//建表时在可达的 ρ 区间上等间隔求出 q2(ρ) 与 β(ρ) (闭式解，固定肘部构型)，φ 由 atan 表求得；
+//运行时两次线性插值，没有迭代求解和三角函数。插值斜率即逆雅可比 ∂q/∂(x,y)，用于把末端参考
+//速度换算为关节参考速度。
+//不可达目标 (超出臂长、肘部接近伸直的奇异位形、肩关节限位外) 将 ρ 与 q1 钳位到可达边界。
+
+#ifndef IK_TABLE_H
+#define IK_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IK_RHO_POINTS       129         // ρ 断点数 (等间隔，覆盖肘角限位)
+#define IK_ATAN_POINTS      65          // atan(t), t ∈ [0, 1] 断点数
+
+typedef enum {
+    IK_OK = 0,                          ///< 插值结果
+    IK_CLAMPED,                         ///< 目标不可达，输出可达边界上的位形 (逆雅可比为 0)
+} ik_status_t;
+
+// 连杆与关节限位
+typedef struct {
+    float l1, l2;                       ///< 肩->肘、肘->末端长度 (mm)
+    float q_min[2], q_max[2];           ///< 关节限位 (rad)，q[1] 为相对上臂的肘角
+    float q2_margin;                    ///< 肘角距伸直位形的最小值 (rad)
+} ik_arm_t;
+
+typedef struct {
+    float q[2];                         ///< 关节角 (rad)
+    float dq[2][2];                     ///< 逆雅可比: dq[i][0] = ∂q_i/∂x, dq[i][1] = ∂q_i/∂y (rad/mm)
+} ik_sol_t;
+
+typedef struct {
+    ik_arm_t arm;
+    float    elbow;                     ///< 肘部构型: +1 (q2 > 0) 或 -1
+    float    rho0, inv_drho;            ///< ρ 网格起点与间距倒数 (mm²)
+    float    q2[IK_RHO_POINTS];         ///< 肘角
+    float    beta[IK_RHO_POINTS];       ///< 肩角偏置: q1 = φ - β
+    float    atan_tab[IK_ATAN_POINTS];
+} ik_table_t;
+
+// 闭式解 (建表与精度检查用)；不可达或超出限位时返回 false
+bool ik_solve_exact(const ik_arm_t *arm, float elbow, float x, float y, float q[2]);
+
+// 正运动学
+void ik_forward(const ik_arm_t *arm, const float q[2], float *x, float *y);
+
+// 建表 (只在初始化时调用)，肘部构型取限位范围较大的一侧；该构型下没有可达区间时返回 false
+bool ik_table_build(ik_table_t *t, const ik_arm_t *arm);
+
+// 查表
+ik_status_t ik_table_lookup(const ik_table_t *t, float x, float y, ik_sol_t *out);
+
+#endif // IK_TABLE_H
@@ -18,4 +18,44 @@ float kf_update(KalmanFilter *kf, float z) {
     kf->P = (1.0f - K) * kf->P;
 
     return kf->x;
-}
\ No newline at end of file
+}
+
+void kf_cv_init(kf_cv_t *kf, float initial_value, float q, float r) {
+    kf->x = initial_value;
+    kf->v = 0.0f;
+    kf->P[0][0] = r;
+    kf->P[0][1] = 0.0f;
+    kf->P[1][0] = 0.0f;
+    kf->P[1][1] = 1.0e4f * r;   // 初始速度未知
+    kf->q = q;
+    kf->r = r;
+}
+
+float kf_cv_update(kf_cv_t *kf, float z, float dt) {
+    // 1. 预测: x = x + v*dt, P = F P F' + Q
+    float dt2 = dt * dt;
+    kf->x += kf->v * dt;
+
+    float p00 = kf->P[0][0] + dt * (kf->P[1][0] + kf->P[0][1]) + dt2 * kf->P[1][1] + kf->q * dt2 * dt * (1.0f / 3.0f);
+    float p01 = kf->P[0][1] + dt * kf->P[1][1] + kf->q * dt2 * 0.5f;
+    float p10 = kf->P[1][0] + dt * kf->P[1][1] + kf->q * dt2 * 0.5f;
+    float p11 = kf->P[1][1] + kf->q * dt;
+
+    // 2. 计算卡尔曼增益 (只观测位置)
+    float S = p00 + kf->r;
+    float K0 = p00 / S;
+    float K1 = p10 / S;
+
+    // 3. 测量更新
+    float y = z - kf->x;
+    kf->x += K0 * y;
+    kf->v += K1 * y;
+
+    // 4. 更新误差协方差
+    kf->P[0][0] = (1.0f - K0) * p00;
+    kf->P[0][1] = (1.0f - K0) * p01;
+    kf->P[1][0] = p10 - K1 * p00;
+    kf->P[1][1] = p11 - K1 * p01;
+
+    return kf->x;
+}
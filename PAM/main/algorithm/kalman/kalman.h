@@ -11,4 +11,19 @@ typedef struct {
 void kf_init(KalmanFilter *kf, float initial_value, float P, float Q, float R);
 float kf_update(KalmanFilter *kf, float z);
 
-#endif
\ No newline at end of file
+// 2 状态 (位置 + 速度) 匀速模型卡尔曼滤波
+// 过程噪声按白噪声加速度建模，q 为加速度谱密度 (单位²/s³)，r 为测量噪声方差
+typedef struct {
+    float x;        // 位置估计
+    float v;        // 速度估计 (单位/秒)
+    float P[2][2];  // 估计协方差
+    float q;        // 过程噪声 (加速度谱密度)
+    float r;        // 测量噪声方差
+} kf_cv_t;
+
+void kf_cv_init(kf_cv_t *kf, float initial_value, float q, float r);
+
+// 以测量值 z 更新，dt 为距上次更新的时间 (秒)，返回位置估计
+float kf_cv_update(kf_cv_t *kf, float z, float dt);
+
+#endif
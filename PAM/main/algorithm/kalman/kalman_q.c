@@ -0,0 +1,61 @@
+#include "kalman_q.h"
+
+void kf_q_init(kf_q_t *kf, q16_t initial_value, float P, float Q, float R) {
+    kf->x = initial_value;
+    kf->P = q16_from_float(P);
+    kf->Q = q16_from_float(Q);
+    kf->R = q16_from_float(R);
+}
+
+q16_t kf_q_update(kf_q_t *kf, q16_t z) {
+    kf->P = q16_add(kf->P, kf->Q);
+    q15_t K = q15_from_q16(q16_div(kf->P, q16_add(kf->P, kf->R)));
+    kf->x = q16_add(kf->x, q16_mul_q15(q16_sub(z, kf->x), K));
+    kf->P = q16_sub(kf->P, q16_mul_q15(kf->P, K));
+
+    return kf->x;
+}
+
+void kf_cv_q_init(kf_cv_q_t *kf, q16_t initial_value, float q, float r) {
+    kf->x = initial_value;
+    kf->v = 0;
+    kf->P[0][0] = q16_from_float(r);
+    kf->P[0][1] = 0;
+    kf->P[1][0] = 0;
+    kf->P[1][1] = q16_from_float(1.0e4f * r * 1e-6f);  // 初始速度未知 (同 kf_cv_init，换算到 /ms²)
+    kf->q = (int32_t)(q * 1e-9f * (float)(1 << 24) + 0.5f);
+    kf->r = q16_from_float(r);
+}
+
+q16_t kf_cv_q_update(kf_cv_q_t *kf, q16_t z, int32_t dt_us) {
+    // 1. 预测: x = x + v*dt, P = F P F' + Q
+    q16_t dt = q16_ratio(dt_us, 1000);
+    q16_t qdt = q16_sat64(((int64_t)kf->q * dt) >> 24);
+    q16_t qdt2 = q16_mul(qdt, dt);
+    kf->x = q16_add(kf->x, q16_mul(kf->v, dt));
+
+    q16_t pdt = q16_mul(dt, kf->P[1][1]);
+    q16_t p00 = q16_add(q16_add(kf->P[0][0], q16_mul(dt, q16_add(kf->P[1][0], kf->P[0][1]))),
+                        q16_add(q16_mul(dt, pdt), q16_mul(qdt2, dt) / 3));
+    q16_t p01 = q16_add(q16_add(kf->P[0][1], pdt), qdt2 / 2);
+    q16_t p10 = q16_add(q16_add(kf->P[1][0], pdt), qdt2 / 2);
+    q16_t p11 = q16_add(kf->P[1][1], qdt);
+
+    // 2. 计算卡尔曼增益 (只观测位置)
+    q16_t S = q16_add(p00, kf->r);
+    q15_t K0 = q15_from_q16(q16_div(p00, S));
+    q16_t K1 = q16_div(p10, S);
+
+    // 3. 测量更新
+    q16_t y = q16_sub(z, kf->x);
+    kf->x = q16_add(kf->x, q16_mul_q15(y, K0));
+    kf->v = q16_add(kf->v, q16_mul(K1, y));
+
+    // 4. 更新误差协方差
+    kf->P[0][0] = q16_sub(p00, q16_mul_q15(p00, K0));
+    kf->P[0][1] = q16_sub(p01, q16_mul_q15(p01, K0));
+    kf->P[1][0] = q16_sub(p10, q16_mul(K1, p00));
+    kf->P[1][1] = q16_sub(p11, q16_mul(K1, p01));
+
+    return kf->x;
+}
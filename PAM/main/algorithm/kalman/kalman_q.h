@@ -0,0 +1,42 @@
+//定点匀速模型卡尔曼滤波 (Q16.16)，与 kf_cv_t 相同的模型，用于 PAM_FIXED_POINT
+//内部时间单位为 ms: 速度为 单位/ms，协方差为 单位²、单位²/ms、单位²/ms²。以秒为单位时
+//速度方差 (约 1e4 计数²/s²) 与过程噪声 (约 1e6 计数²/s³) 都超出 Q16.16 的范围，而以 ms 为
+//单位时二者都落在 1e-3 ~ 1e2 之间，32 位即可表示。位置增益 K0 在 [0, 1) 内，以 Q1.15 相乘。
+
+#ifndef KALMAN_Q_H
+#define KALMAN_Q_H
+
+#include <stdint.h>
+#include "fixq.h"
+
+// 一维滤波 (与 KalmanFilter 相同)，增益 K 在 [0, 1) 内以 Q1.15 表示
+typedef struct {
+    q16_t x;    // 状态估计值
+    q16_t P;    // 估计协方差
+    q16_t Q;    // 过程噪声
+    q16_t R;    // 测量噪声
+} kf_q_t;
+
+void kf_q_init(kf_q_t *kf, q16_t initial_value, float P, float Q, float R);
+q16_t kf_q_update(kf_q_t *kf, q16_t z);
+
+typedef struct {
+    q16_t x;        // 位置估计
+    q16_t v;        // 速度估计 (单位/ms)
+    q16_t P[2][2];  // 估计协方差
+    int32_t q;      // 过程噪声 (单位²/ms³)，Q8.24: 典型值约 1e-3，Q16.16 下只有 66 个 LSB
+    q16_t r;        // 测量噪声方差
+} kf_cv_q_t;
+
+// q、r 与 kf_cv_init 同义 (q: 单位²/s³)，只在初始化时换算
+void kf_cv_q_init(kf_cv_q_t *kf, q16_t initial_value, float q, float r);
+
+// 以测量值 z 更新，dt_us 为距上次更新的时间 (µs)，返回位置估计
+q16_t kf_cv_q_update(kf_cv_q_t *kf, q16_t z, int32_t dt_us);
+
+// 速度估计 (单位/秒)
+static inline q16_t kf_cv_q_velocity(const kf_cv_q_t *kf) {
+    return q16_sat64((int64_t)kf->v * 1000);
+}
+
+#endif
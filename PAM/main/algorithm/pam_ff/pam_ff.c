@@ -0,0 +1,71 @@
+#include "pam_ff.h"
+#include <math.h>
+
+/**
+ * @brief 单点平衡压力差
+ * * 肌肉力 F = p·g(L) 对压力线性，令 pA = base + dp, pB = base - dp:
+ * * r·[(base + dp)·gA - (base - dp)·gB] = τ_load·sin θ + c·ω
+ * * => dp = (τ / r - base·(gA - gB)) / (gA + gB)
+ */
+static float equilibrium_dp(const pam_model_params_t *mp, float base, float theta, float omega) {
+    float la, lb;
+    pam_muscle_lengths(mp, theta, &la, &lb);
+
+    // 单位压力 (1 kPa) 下的肌肉力
+    float ga = pam_muscle_force(mp, 1.0f, la);
+    float gb = pam_muscle_force(mp, 1.0f, lb);
+    if (ga + gb <= 0.0f) return 0.0f;
+
+    float torque = mp->load_torque * sinf(theta) + mp->damping * omega;
+    float dp = (torque / mp->pulley_r - base * (ga - gb)) / (ga + gb);
+
+    // 两肌肉压力都不能为负
+    if (dp > base) dp = base;
+    else if (dp < -base) dp = -base;
+    return dp;
+}
+
+void pam_ff_build(pam_ff_t *ff, const pam_model_params_t *mp, float base_kpa, float counts_per_rad) {
+    float a_max = mp->angle_limit * counts_per_rad;
+
+    ff->angle0 = -a_max;
+    ff->inv_da = (PAM_FF_ANGLE_POINTS - 1) / (2.0f * a_max);
+    ff->vel0 = -PAM_FF_VEL_MAX;
+    ff->inv_dv = (PAM_FF_VEL_POINTS - 1) / (2.0f * PAM_FF_VEL_MAX);
+    ff->base = base_kpa;
+
+    for (int j = 0; j < PAM_FF_VEL_POINTS; j++) {
+        float omega = (ff->vel0 + j / ff->inv_dv) / counts_per_rad;
+        for (int i = 0; i < PAM_FF_ANGLE_POINTS; i++) {
+            float theta = (ff->angle0 + i / ff->inv_da) / counts_per_rad;
+            ff->dp[j][i] = equilibrium_dp(mp, base_kpa, theta, omega);
+        }
+    }
+}
+
+// 连续坐标 -> 单元索引与单元内比例 (网格外钳位到边界)
+static inline int grid_index(float x, int n, float *frac) {
+    if (x <= 0.0f) {
+        *frac = 0.0f;
+        return 0;
+    }
+    if (x >= (float)(n - 1)) {
+        *frac = 1.0f;
+        return n - 2;
+    }
+    int i = (int)x;
+    *frac = x - (float)i;
+    return i;
+}
+
+float pam_ff_lookup(const pam_ff_t *ff, float angle, float vel) {
+    float fa, fv;
+    int i = grid_index((angle - ff->angle0) * ff->inv_da, PAM_FF_ANGLE_POINTS, &fa);
+    int j = grid_index((vel - ff->vel0) * ff->inv_dv, PAM_FF_VEL_POINTS, &fv);
+
+    const float *r0 = &ff->dp[j][i];
+    const float *r1 = &ff->dp[j + 1][i];
+    float lo = r0[0] + fa * (r0[1] - r0[0]);
+    float hi = r1[0] + fa * (r1[1] - r1[0]);
+    return lo + fv * (hi - lo);
+}
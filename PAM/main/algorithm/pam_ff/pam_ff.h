@@ -0,0 +1,30 @@
+//拮抗关节的静态模型前馈
+//对 (参考角度, 参考角速度) 网格预先求出平衡所需的压力差: 两肌肉取 基础气压 ± dp 时，
+//McKibben 肌肉力产生的力矩恰好抵消重力负载与粘性阻尼。运行时双线性插值查表，
+//结果叠加在角度环 PID 输出之上，积分器只需补偿模型误差。
+
+#ifndef PAM_FF_H
+#define PAM_FF_H
+
+#include <stdint.h>
+#include "pam_model.h"
+
+#define PAM_FF_ANGLE_POINTS 33          // 角度断点数 (等间隔，覆盖机械限位)
+#define PAM_FF_VEL_POINTS   9           // 角速度断点数 (等间隔，±PAM_FF_VEL_MAX)
+#define PAM_FF_VEL_MAX      1500.0f     // 速度网格范围 (计数/秒)
+
+typedef struct {
+    float dp[PAM_FF_VEL_POINTS][PAM_FF_ANGLE_POINTS];  ///< 压力差 (kPa): A = base + dp, B = base - dp
+    float angle0, inv_da;               ///< 角度网格起点与间距倒数 (计数)
+    float vel0, inv_dv;                 ///< 速度网格起点与间距倒数 (计数/秒)
+    float base;                         ///< 建表时的基础气压
+} pam_ff_t;
+
+// 由肌肉/关节模型建表 (只在初始化或基础气压改变时调用)
+// counts_per_rad: 角度计数与弧度的换算 (AS5600: 4096 / 2π)
+void pam_ff_build(pam_ff_t *ff, const pam_model_params_t *mp, float base_kpa, float counts_per_rad);
+
+// 双线性插值查表，网格外按边界值
+float pam_ff_lookup(const pam_ff_t *ff, float angle, float vel);
+
+#endif // PAM_FF_H
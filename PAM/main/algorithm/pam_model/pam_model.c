@@ -0,0 +1,179 @@
+#include "pam_model.h"
+#include <math.h>
+
+#define R_AIR       287.0f      // 空气气体常数 J/(kg·K)
+#define T_AIR       293.15f     // 气温 K
+#define RHO_ANR     1.185f      // 标准状态空气密度 kg/m³
+#define POLY_N      1.2f        // 腔内多变指数
+#define SUBSTEP_S   1.0e-4f     // 积分细分步长
+#define PI_F        3.14159265f
+
+void pam_model_default_params(pam_model_params_t *p) {
+    p->valve_c = 3.0e-9f;           // ≈0.3 dm³/(s·bar)，小型两位三通电磁阀
+    p->valve_b = 0.3f;
+    p->valve_dead = 0.15f;
+    p->valve_sat = 0.85f;
+    p->leak_c = 1.5e-10f;
+
+    p->muscle_d0 = 0.020f;
+    p->muscle_l0 = 0.200f;
+    p->muscle_theta0 = 25.0f * PI_F / 180.0f;
+    p->muscle_eps0 = 0.15f;
+    p->dead_volume = 5.0e-6f;
+
+    p->pulley_r = 0.020f;
+    p->inertia = 0.01f;
+    p->damping = 0.5f;
+    p->load_torque = 0.5f;
+    p->angle_limit = 60.0f * PI_F / 180.0f;
+
+    p->tank_volume = 2.0e-3f;
+    p->pump_flow = 3.9e-4f;         // ≈20 L/min 自由空气
+    p->switch_on_kpa = 400.0f;
+    p->switch_off_kpa = 600.0f;
+}
+
+void pam_model_init(pam_model_state_t *s, const pam_model_params_t *p, float init_kpa) {
+    s->p_kpa[0] = init_kpa;
+    s->p_kpa[1] = init_kpa;
+    s->theta = 0.0f;
+    s->omega = 0.0f;
+    s->tank_kpa = p->switch_off_kpa;
+    s->switch_low = false;
+    s->pump_on = false;
+    for (int i = 0; i < PAM_VALVE_NUM; i++) s->duty[i] = 0.0f;
+    s->air_used_kg = 0.0;
+    s->air_pumped_kg = 0.0;
+    s->pump_on_s = 0.0;
+    s->time_s = 0.0;
+}
+
+// 编织几何: 编织线长 b 与圈数 n 由静止状态决定
+static inline void braid_geometry(const pam_model_params_t *p, float *b2, float *k) {
+    float b = p->muscle_l0 / cosf(p->muscle_theta0);
+    float n = b * sinf(p->muscle_theta0) / (PI_F * p->muscle_d0);
+    *b2 = b * b;
+    *k = 1.0f / (4.0f * PI_F * n * n);
+}
+
+float pam_muscle_force(const pam_model_params_t *p, float p_gauge_kpa, float length) {
+    float b2, k;
+    braid_geometry(p, &b2, &k);
+    if (p_gauge_kpa <= 0.0f) return 0.0f;
+    float f = p_gauge_kpa * 1000.0f * (3.0f * length * length - b2) * k;
+    return f > 0.0f ? f : 0.0f;     // 肌肉只能拉不能推
+}
+
+float pam_muscle_volume(const pam_model_params_t *p, float length) {
+    float b2, k;
+    braid_geometry(p, &b2, &k);
+    return length * (b2 - length * length) * k + p->dead_volume;
+}
+
+// dV/dL
+static float muscle_dvdl(const pam_model_params_t *p, float length) {
+    float b2, k;
+    braid_geometry(p, &b2, &k);
+    return (b2 - 3.0f * length * length) * k;
+}
+
+void pam_muscle_lengths(const pam_model_params_t *p, float theta, float *len_a, float *len_b) {
+    float l_rest = p->muscle_l0 * (1.0f - p->muscle_eps0);
+    *len_a = l_rest - p->pulley_r * theta;
+    *len_b = l_rest + p->pulley_r * theta;
+}
+
+float pam_valve_mass_flow(const pam_model_params_t *p, float duty, float p_up_abs, float p_dn_abs) {
+    // 1. PWM 占空比 -> 等效开度 (死区 + 饱和)
+    float open = (duty - p->valve_dead) / (p->valve_sat - p->valve_dead);
+    if (open <= 0.0f) return 0.0f;
+    if (open > 1.0f) open = 1.0f;
+
+    // 2. 方向: 从高压流向低压
+    float sign = 1.0f;
+    if (p_dn_abs > p_up_abs) {
+        float t = p_up_abs; p_up_abs = p_dn_abs; p_dn_abs = t;
+        sign = -1.0f;
+    }
+
+    // 3. ISO 6358: 临界 (壅塞) / 亚声速
+    float r = p_dn_abs / p_up_abs;
+    float phi = 1.0f;
+    if (r > p->valve_b) {
+        float x = (r - p->valve_b) / (1.0f - p->valve_b);
+        phi = sqrtf(fmaxf(0.0f, 1.0f - x * x));
+    }
+    return sign * open * p->valve_c * RHO_ANR * p_up_abs * 1000.0f * phi;
+}
+
+// 泄漏通道: 全开流导为 leak_c 的常开小孔
+static float leak_mass_flow(const pam_model_params_t *p, float p_abs) {
+    pam_model_params_t lp = *p;
+    lp.valve_c = p->leak_c;
+    lp.valve_dead = 0.0f;
+    lp.valve_sat = 1.0f;
+    return pam_valve_mass_flow(&lp, 1.0f, p_abs, PAM_P_ATM_KPA);
+}
+
+float pam_chamber_dpdt(const pam_model_params_t *p, float p_kpa, float duty_in, float duty_out,
+                       float supply_kpa, float length, float dldt, float *q_in) {
+    float p_abs = p_kpa + PAM_P_ATM_KPA;
+    float qi = pam_valve_mass_flow(p, duty_in, supply_kpa + PAM_P_ATM_KPA, p_abs);
+    float qo = pam_valve_mass_flow(p, duty_out, p_abs, PAM_P_ATM_KPA) + leak_mass_flow(p, p_abs);
+    if (q_in) *q_in = qi;
+
+    float V = pam_muscle_volume(p, length);
+    float dVdt = muscle_dvdl(p, length) * dldt;
+    return (POLY_N * R_AIR * T_AIR * (qi - qo) - POLY_N * p_abs * 1000.0f * dVdt) / V;
+}
+
+static void substep(pam_model_state_t *s, const pam_model_params_t *p, float dt) {
+    float len[2], dldt[2];
+    pam_muscle_lengths(p, s->theta, &len[0], &len[1]);
+    dldt[0] = -p->pulley_r * s->omega;
+    dldt[1] =  p->pulley_r * s->omega;
+
+    float tank_out = 0.0f;
+
+    // 1. 肌肉腔压力
+    for (int m = 0; m < 2; m++) {
+        float q_in;
+        float dpdt = pam_chamber_dpdt(p, s->p_kpa[m], s->duty[m * 2], s->duty[m * 2 + 1], s->tank_kpa,
+                                      len[m], dldt[m], &q_in);
+        tank_out += q_in;
+        s->p_kpa[m] += dpdt * dt * 0.001f;
+        if (s->p_kpa[m] < 0.0f) s->p_kpa[m] = 0.0f;
+    }
+
+    // 2. 关节力矩平衡 (半隐式欧拉)
+    float f_a = pam_muscle_force(p, s->p_kpa[0], len[0]);
+    float f_b = pam_muscle_force(p, s->p_kpa[1], len[1]);
+    float torque = p->pulley_r * (f_a - f_b) - p->damping * s->omega - p->load_torque * sinf(s->theta);
+    s->omega += torque / p->inertia * dt;
+    s->theta += s->omega * dt;
+    if (s->theta > p->angle_limit) { s->theta = p->angle_limit; if (s->omega > 0) s->omega = 0; }
+    if (s->theta < -p->angle_limit) { s->theta = -p->angle_limit; if (s->omega < 0) s->omega = 0; }
+
+    // 3. 储气罐 + 气泵 (等温)
+    float pump_in = s->pump_on ? p->pump_flow : 0.0f;
+    s->tank_kpa += R_AIR * T_AIR * (pump_in - tank_out) / p->tank_volume * dt * 0.001f;
+    if (s->tank_kpa < 0.0f) s->tank_kpa = 0.0f;
+
+    // 4. QPM11 压力开关 (自带回差)
+    if (s->tank_kpa < p->switch_on_kpa) s->switch_low = true;
+    else if (s->tank_kpa > p->switch_off_kpa) s->switch_low = false;
+
+    s->air_used_kg += tank_out * dt;
+    s->air_pumped_kg += pump_in * dt;
+    if (s->pump_on) s->pump_on_s += dt;
+    s->time_s += dt;
+}
+
+void pam_model_step(pam_model_state_t *s, const pam_model_params_t *p, float dt) {
+    int n = (int)ceilf(dt / SUBSTEP_S);
+    if (n < 1) n = 1;
+    float h = dt / (float)n;
+    for (int i = 0; i < n; i++) {
+        substep(s, p, h);
+    }
+}
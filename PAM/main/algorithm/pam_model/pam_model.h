@@ -0,0 +1,86 @@
+//气动人工肌肉 (PAM) 关节被控对象模型
+//包含: 阀门流量-占空比特性 (ISO 6358)、肌肉腔压力动态、McKibben 肌肉力 (Chou-Hannaford)、
+//拮抗关节力矩平衡、储气罐 + 气泵 + QPM11 压力开关。纯 C，无平台依赖，
+//供软件在环仿真、观测器和标定等使用。
+
+#ifndef PAM_MODEL_H
+#define PAM_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PAM_P_ATM_KPA   101.325f  // 大气压 (绝对, kPa)
+
+// 阀门编号，与 hal_valves 通道一致
+enum { PAM_VALVE_A_IN = 0, PAM_VALVE_A_OUT, PAM_VALVE_B_IN, PAM_VALVE_B_OUT, PAM_VALVE_NUM };
+
+typedef struct {
+    // 阀门 (PWM 平均后的等效开度)
+    float valve_c;          ///< 全开声速流导 C (m³/(s·Pa))
+    float valve_b;          ///< 临界压比 b
+    float valve_dead;       ///< 死区占空比 (0-1)，低于此值阀门打不开
+    float valve_sat;        ///< 饱和占空比 (0-1)，高于此值等效全开
+    float leak_c;           ///< 肌肉被动泄漏流导 (m³/(s·Pa))
+
+    // 肌肉 (McKibben)
+    float muscle_d0;        ///< 静止直径 (m)
+    float muscle_l0;        ///< 静止长度 (m)
+    float muscle_theta0;    ///< 静止编织角 (rad)
+    float muscle_eps0;      ///< 关节零位时的预收缩率
+    float dead_volume;      ///< 管路死体积 (m³)
+
+    // 关节
+    float pulley_r;         ///< 滑轮半径 (m)
+    float inertia;          ///< 转动惯量 (kg·m²)
+    float damping;          ///< 粘性阻尼 (N·m·s/rad)
+    float load_torque;      ///< 重力负载力矩幅值 (N·m)，按 sin(θ) 作用
+    float angle_limit;      ///< 机械限位 (rad)
+
+    // 气源
+    float tank_volume;      ///< 储气罐容积 (m³)
+    float pump_flow;        ///< 气泵质量流量 (kg/s)
+    float switch_on_kpa;    ///< 压力开关闭合 (低压) 阈值，表压 kPa
+    float switch_off_kpa;   ///< 压力开关断开 (高压) 阈值，表压 kPa
+} pam_model_params_t;
+
+typedef struct {
+    float  p_kpa[2];        ///< 肌肉 A/B 腔内表压 (kPa)
+    float  theta;           ///< 关节角 (rad)
+    float  omega;           ///< 关节角速度 (rad/s)
+    float  tank_kpa;        ///< 储气罐表压 (kPa)
+    bool   switch_low;      ///< 压力开关状态: true = 低压闭合
+    bool   pump_on;         ///< 气泵继电器 (输入)
+    float  duty[PAM_VALVE_NUM]; ///< 阀门占空比 0-1 (输入)
+
+    double air_used_kg;     ///< 从储气罐流出的累计空气质量
+    double air_pumped_kg;   ///< 气泵累计泵入质量
+    double pump_on_s;       ///< 气泵累计运行时间
+    double time_s;          ///< 仿真时间
+} pam_model_state_t;
+
+// 默认参数: 20mm × 200mm 肌肉，2L 储气罐
+void pam_model_default_params(pam_model_params_t *p);
+
+// 初始化状态: 两肌肉为 init_kpa，储气罐为开关断开压力
+void pam_model_init(pam_model_state_t *s, const pam_model_params_t *p, float init_kpa);
+
+// 前进 dt 秒 (内部按 ≤100us 细分积分)
+void pam_model_step(pam_model_state_t *s, const pam_model_params_t *p, float dt);
+
+// 阀门质量流量 (kg/s)，p_up/p_dn 为绝对压力 (kPa)，duty 为 0-1
+float pam_valve_mass_flow(const pam_model_params_t *p, float duty, float p_up_abs, float p_dn_abs);
+
+// 肌肉长度 (m) 对应的收缩力 (N) 与腔体积 (m³)，p_gauge 为表压 kPa
+float pam_muscle_force(const pam_model_params_t *p, float p_gauge_kpa, float length);
+float pam_muscle_volume(const pam_model_params_t *p, float length);
+
+// 关节角 (rad) 对应的 A/B 肌肉长度 (A 随角度增大而收缩)
+void pam_muscle_lengths(const pam_model_params_t *p, float theta, float *len_a, float *len_b);
+
+// 单块肌肉腔的压力变化率 (Pa/s): 进/排气阀与泄漏的质量流量 + 体积变化 (多变过程)
+// p_kpa / supply_kpa 为表压，duty 为 0-1，length (m) 与 dldt (m/s) 为肌肉长度及其变化率；
+// q_in 非 NULL 时输出从气源流入的质量流量 (kg/s)。被控对象与压力观测器共用
+float pam_chamber_dpdt(const pam_model_params_t *p, float p_kpa, float duty_in, float duty_out,
+                       float supply_kpa, float length, float dldt, float *q_in);
+
+#endif // PAM_MODEL_H
@@ -66,4 +66,136 @@ float pid_compute(pid_ctrl_t *pid, float measured) {
     pid->prev_error = error;
 
     return output;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 计算 PID 输出，微分项使用外部提供的测量变化率 (微分作用于测量值)
+ * * 用于已有干净速度估计 (如卡尔曼滤波) 的场合，避免对含噪误差做差分，
+ * * 且设定值阶跃不会引起微分冲击
+ * @param pid 指向 PID 结构体的指针
+ * @param measured 当前测量值 (反馈值)
+ * @param measured_delta 测量值在一个控制周期内的变化量 (速度 × 周期)，与 pid_compute 的微分同量纲
+ * @return float PID 计算出的控制量
+ */
+float pid_compute_rate(pid_ctrl_t *pid, float measured, float measured_delta) {
+    float output;
+    float error = pid->setpoint - measured;
+
+    // 1. 死区处理
+    if (error > -pid->dead_zone && error < pid->dead_zone) {
+        error = 0.0f;
+    }
+
+    // 2. 积分计算 (带抗饱和限幅)
+    pid->integral += error;
+    if (pid->integral > pid->int_limit) pid->integral = pid->int_limit;
+    else if (pid->integral < -pid->int_limit) pid->integral = -pid->int_limit;
+
+    // 3. PID 公式 (误差的变化 = -测量值的变化)
+    output = (pid->kp * error) + (pid->ki * pid->integral) - (pid->kd * measured_delta);
+
+    // 4. 输出限幅
+    if (output > pid->out_max) output = pid->out_max;
+    else if (output < pid->out_min) output = pid->out_min;
+
+    pid->prev_error = error;
+
+    return output;
+}
+
+/**
+ * @brief 初始化按实际间隔计算的 PID
+ * * @param kp 比例增益
+ * @param ki 积分增益 (1/s)
+ * @param kd 微分增益 (s)
+ * @param min 输出最小值
+ * @param max 输出最大值
+ */
+void pid_timed_init(pid_timed_t *pid, float kp, float ki, float kd, float min, float max) {
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->beta = 1.0f;
+    pid->d_tau = 0.0f;
+    pid->kb = (kp > 0.0f) ? ki / kp : 0.0f;  // 跟踪时间常数取积分时间 Ti
+    pid->dt_max = 0.1f;
+    pid->out_min = min;
+    pid->out_max = max;
+    pid->int_limit = (max - min) * 0.5f;
+    pid->dead_zone = 0.0f;
+    pid->setpoint = 0.0f;
+    pid_timed_reset(pid);
+}
+
+void pid_timed_reset(pid_timed_t *pid) {
+    pid->integral = 0.0f;
+    pid->d_state = 0.0f;
+    pid->prev_meas = 0.0f;
+    pid->prev_error = 0.0f;
+    pid->started = 0;
+}
+
+/**
+ * @brief 计算输出，微分项使用外部提供的测量值变化率
+ * * 积分在饱和判断之后更新: 本次输出先按旧积分计算，再用 (限幅后 - 限幅前) 的差反算积分，
+ * * 与先积分后限幅相比只多一次乘加，计算量与 pid_compute_rate 相当
+ * @param pid 指向 PID 结构体的指针
+ * @param measured 当前测量值
+ * @param measured_rate 测量值变化率 (单位/秒)
+ * @param dt 距上次调用的实际间隔 (s)，<= 0 时不积分
+ * @return float 控制量
+ */
+float pid_timed_compute_rate(pid_timed_t *pid, float measured, float measured_rate, float dt) {
+    if (dt > pid->dt_max) dt = pid->dt_max;
+    else if (dt < 0.0f) dt = 0.0f;
+
+    float error = pid->setpoint - measured;
+
+    // 1. 死区处理
+    if (error > -pid->dead_zone && error < pid->dead_zone) {
+        error = 0.0f;
+    }
+
+    // 2. 微分作用于测量值，一阶低通: d += dt / (tau + dt) · (rate - d)
+    // 测量值长时间不变时滤波状态按指数衰减，接近 0 时直接清零，避免落入非规格化数使运算变慢
+    if (pid->d_tau > 0.0f) {
+        if (dt > 0.0f) pid->d_state += dt / (pid->d_tau + dt) * (measured_rate - pid->d_state);
+        if (pid->d_state > -1e-20f && pid->d_state < 1e-20f) pid->d_state = 0.0f;
+    } else {
+        pid->d_state = measured_rate;
+    }
+
+    // 3. PID 公式 (比例项: beta·sp - y，死区内为 0)
+    float p_error = error - (1.0f - pid->beta) * pid->setpoint;
+    if (error == 0.0f) p_error = 0.0f;
+    float v = (pid->kp * p_error) + pid->integral - (pid->kd * pid->d_state);
+
+    // 4. 输出限幅
+    float output = v;
+    if (output > pid->out_max) output = pid->out_max;
+    else if (output < pid->out_min) output = pid->out_min;
+
+    // 5. 积分与抗饱和
+    if (pid->kb > 0.0f) {
+        pid->integral += (pid->ki * error + pid->kb * (output - v)) * dt;
+    } else if (output == v || (output > v) == (error > 0.0f)) {
+        pid->integral += pid->ki * error * dt;      // 条件积分: 饱和时只向退出饱和的方向积分
+    }
+    if (pid->integral > pid->int_limit) pid->integral = pid->int_limit;
+    else if (pid->integral < -pid->int_limit) pid->integral = -pid->int_limit;
+
+    pid->prev_meas = measured;
+    pid->prev_error = p_error;
+    pid->started = 1;
+
+    return output;
+}
+
+/**
+ * @brief 计算输出，微分由相邻两次测量值按实际间隔差分
+ * * 首次调用没有上一次测量值，微分取 0
+ */
+float pid_timed_compute(pid_timed_t *pid, float measured, float dt) {
+    float rate = (pid->started && dt > 0.0f) ? (measured - pid->prev_meas) / dt : 0.0f;
+    return pid_timed_compute_rate(pid, measured, rate, dt);
+}
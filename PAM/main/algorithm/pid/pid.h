@@ -25,4 +25,42 @@ void pid_reset(pid_ctrl_t *pid);
 
 float pid_compute(pid_ctrl_t *pid, float measured);
 
+// 微分作用于测量值，measured_delta 为测量值在一个周期内的变化量 (速度 × 周期)
+float pid_compute_rate(pid_ctrl_t *pid, float measured, float measured_delta);
+
+// 按实际采样间隔计算的 PID (增益为连续时间形式，周期变化或抖动时含义不变)
+// 微分作用于测量值并经一阶滤波；比例项带设定值权重；
+// 抗饱和: kb > 0 时按执行器饱和量反算积分，kb = 0 时只在不加深饱和的方向上积分
+typedef struct {
+    float kp;           ///< 比例增益
+    float ki;           ///< 积分增益 (1/s)
+    float kd;           ///< 微分增益 (s)
+    float beta;         ///< 比例项设定值权重 (1 = 普通 PID，< 1 减小设定值阶跃的冲击)
+    float d_tau;        ///< 微分一阶滤波时间常数 (s)，0 = 不滤波
+    float kb;           ///< 反算抗饱和增益 (1/s)，0 = 条件积分
+    float dt_max;       ///< 单步间隔上限 (s)，调度超时后不让积分/微分跳变
+
+    float setpoint;
+    float integral;     ///< 积分项 (输出单位，已乘 ki)
+    float d_state;      ///< 滤波后的测量值变化率
+    float prev_meas;
+    float prev_error;   ///< 最近一次比例项的误差 (含设定值权重与死区)
+    uint8_t started;
+
+    float out_min;
+    float out_max;
+    float int_limit;    ///< 积分项限幅 (输出单位)
+    float dead_zone;    ///< 死区 (误差在此范围内比例/积分不动作)
+} pid_timed_t;
+
+void pid_timed_init(pid_timed_t *pid, float kp, float ki, float kd, float min, float max);
+
+void pid_timed_reset(pid_timed_t *pid);
+
+// dt: 距上次调用的实际间隔 (s)；微分由相邻测量值差分得到
+float pid_timed_compute(pid_timed_t *pid, float measured, float dt);
+
+// 微分使用外部提供的测量值变化率 (单位/秒，如卡尔曼速度估计)
+float pid_timed_compute_rate(pid_timed_t *pid, float measured, float measured_rate, float dt);
+
 #endif 
\ No newline at end of file
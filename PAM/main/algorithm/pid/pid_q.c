@@ -0,0 +1,77 @@
+#include "pid_q.h"
+
+void pid_q_config(pid_q_t *q, const pid_timed_t *f) {
+    q->kp = q16_from_float(f->kp);
+    q->ki = q16_from_float(f->ki);
+    q->kd = q16_from_float(f->kd);
+    q->beta_c = q16_from_float(1.0f - f->beta);
+    q->d_tau = q16_from_float(f->d_tau);
+    q->kb = q16_from_float(f->kb);
+    q->dt_max = q16_from_float(f->dt_max);
+    q->out_min = q16_from_float(f->out_min);
+    q->out_max = q16_from_float(f->out_max);
+    q->int_limit = q16_from_float(f->int_limit);
+    q->dead_zone = q16_from_float(f->dead_zone);
+}
+
+void pid_q_reset(pid_q_t *q) {
+    q->integral = 0;
+    q->d_state = 0;
+    q->prev_meas = 0;
+    q->prev_error = 0;
+    q->started = 0;
+}
+
+/**
+ * @brief 计算输出，步骤与 pid_timed_compute_rate 相同
+ * * 积分增量按 (e·dt)·ki 的顺序相乘: 误差与增益各自可达数百，先乘 dt 使中间量保持在 Q16.16 范围内
+ * * 比例项超出范围时饱和，输出限幅 (远小于 32768) 之后结果与浮点一致
+ */
+q16_t pid_q_compute_rate(pid_q_t *q, q16_t measured, q16_t measured_rate, q16_t dt) {
+    dt = q16_clamp(dt, 0, q->dt_max);
+
+    q16_t error = q16_sub(q->setpoint, measured);
+
+    // 1. 死区处理
+    if (error > -q->dead_zone && error < q->dead_zone) {
+        error = 0;
+    }
+
+    // 2. 微分作用于测量值，一阶低通系数 dt / (tau + dt) 在 [0, 1) 内，以 Q1.15 相乘
+    if (q->d_tau > 0) {
+        if (dt > 0) {
+            q15_t alpha = q15_from_q16(q16_div(dt, q16_add(q->d_tau, dt)));
+            q->d_state = q16_add(q->d_state, q16_mul_q15(q16_sub(measured_rate, q->d_state), alpha));
+        }
+    } else {
+        q->d_state = measured_rate;
+    }
+
+    // 3. PID 公式
+    q16_t p_error = error == 0 ? 0 : q16_sub(error, q16_mul(q->beta_c, q->setpoint));
+    q16_t v = q16_sub(q16_add(q16_mul(q->kp, p_error), q->integral), q16_mul(q->kd, q->d_state));
+
+    // 4. 输出限幅
+    q16_t output = q16_clamp(v, q->out_min, q->out_max);
+
+    // 5. 积分与抗饱和
+    if (q->kb > 0) {
+        q16_t di = q16_add(q16_mul(q16_mul(error, dt), q->ki),
+                           q16_mul(q16_mul(q16_sub(output, v), dt), q->kb));
+        q->integral = q16_add(q->integral, di);
+    } else if (output == v || (output > v) == (error > 0)) {
+        q->integral = q16_add(q->integral, q16_mul(q16_mul(error, dt), q->ki));
+    }
+    q->integral = q16_clamp(q->integral, -q->int_limit, q->int_limit);
+
+    q->prev_meas = measured;
+    q->prev_error = p_error;
+    q->started = 1;
+
+    return output;
+}
+
+q16_t pid_q_compute(pid_q_t *q, q16_t measured, q16_t dt) {
+    q16_t rate = (q->started && dt > 0) ? q16_div(q16_sub(measured, q->prev_meas), dt) : 0;
+    return pid_q_compute_rate(q, measured, rate, dt);
+}
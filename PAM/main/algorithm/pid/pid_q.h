@@ -0,0 +1,47 @@
+//定点 PID (Q16.16)，算法与 pid_timed_compute_rate 一致
+//用于无硬件 FPU 的芯片 (PAM_FIXED_POINT)。增益等参数仍在 pid_timed_t 中以浮点配置，
+//参数更新时由 pid_q_config 换算一次，控制回路内只有整数运算。
+//量纲: 测量值/设定值/输出/积分与 pid_timed_t 相同 (Q16.16)，dt 为 Q16.16 秒；
+//乘法顺序保证中间量不超过 ±32768 (误差先乘 dt 再乘积分增益)，超出时饱和。
+
+#ifndef PID_Q_H
+#define PID_Q_H
+
+#include <stdint.h>
+#include "fixq.h"
+#include "pid.h"
+
+typedef struct {
+    q16_t kp;
+    q16_t ki;           ///< 1/s
+    q16_t kd;           ///< s
+    q16_t beta_c;       ///< 1 - beta (设定值权重的补)
+    q16_t d_tau;        ///< s，0 = 不滤波
+    q16_t kb;           ///< 1/s，0 = 条件积分
+    q16_t dt_max;
+
+    q16_t setpoint;
+    q16_t integral;
+    q16_t d_state;
+    q16_t prev_meas;
+    q16_t prev_error;
+    uint8_t started;
+
+    q16_t out_min;
+    q16_t out_max;
+    q16_t int_limit;
+    q16_t dead_zone;
+} pid_q_t;
+
+// 从浮点配置换算增益与限幅 (不改变运行状态)
+void pid_q_config(pid_q_t *q, const pid_timed_t *f);
+
+void pid_q_reset(pid_q_t *q);
+
+// dt: Q16.16 秒；measured_rate: 测量值变化率 (单位/秒)
+q16_t pid_q_compute_rate(pid_q_t *q, q16_t measured, q16_t measured_rate, q16_t dt);
+
+// 微分由相邻两次测量值按实际间隔差分
+q16_t pid_q_compute(pid_q_t *q, q16_t measured, q16_t dt);
+
+#endif // PID_Q_H
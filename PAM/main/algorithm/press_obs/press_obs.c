@@ -0,0 +1,115 @@
+#include "press_obs.h"
+#include <string.h>
+#include <math.h>
+
+void press_obs_init(press_obs_t *o, const pam_model_params_t *mp, int muscle, const press_obs_cfg_t *cfg) {
+    memset(o, 0, sizeof(*o));
+    o->mp = mp;
+    o->cfg = *cfg;
+    o->muscle = muscle;
+    o->t_us = -1;
+    o->meas_t_us = -1;
+    o->state = PRESS_OBS_INIT;
+    for (int i = 0; i < PRESS_OBS_HIST_LEN; i++) o->hist_t[i] = INT64_MIN;
+}
+
+static void hist_push(press_obs_t *o) {
+    o->hist_head = (o->hist_head + 1) % PRESS_OBS_HIST_LEN;
+    o->hist_t[o->hist_head] = o->t_us;
+    o->hist_p[o->hist_head] = o->p_hat;
+}
+
+void press_obs_predict(press_obs_t *o, int64_t now_us, float duty_in, float duty_out,
+                       float supply_kpa, float theta, float omega) {
+    if (o->state == PRESS_OBS_INIT) {
+        o->t_us = now_us;
+        return;
+    }
+    if (now_us <= o->t_us) return;
+
+    // 区间内关节角与阀门输出视为不变
+    float len[2];
+    pam_muscle_lengths(o->mp, theta, &len[0], &len[1]);
+    float dldt = (o->muscle == 0 ? -1.0f : 1.0f) * o->mp->pulley_r * omega;
+
+    uint32_t span = (uint32_t)(now_us - o->t_us);
+    uint32_t n = (span + o->cfg.substep_us - 1) / o->cfg.substep_us;
+    float h = (float)span * 1e-6f / (float)n;
+    for (uint32_t i = 0; i < n; i++) {
+        float dpdt = pam_chamber_dpdt(o->mp, o->p_hat, duty_in, duty_out, supply_kpa,
+                                      len[o->muscle], dldt, NULL);
+        o->p_hat += dpdt * h * 0.001f;
+        if (o->p_hat < 0.0f) o->p_hat = 0.0f;
+    }
+    o->t_us = now_us;
+    hist_push(o);
+
+    // 采样过期: 先只靠模型外推，超时判为故障
+    int64_t age = now_us - o->meas_t_us;
+    if (o->state == PRESS_OBS_OK && age > o->cfg.stale_us) {
+        o->state = PRESS_OBS_COAST;
+        o->coast_events++;
+    } else if (o->state == PRESS_OBS_COAST && age > o->cfg.coast_us) {
+        o->state = PRESS_OBS_FAULT;
+        o->faults++;
+    }
+}
+
+void press_obs_correct(press_obs_t *o, float meas_kpa, int64_t t_us) {
+    if (t_us <= o->meas_t_us) return;
+    o->meas_t_us = t_us;
+    o->samples++;
+
+    // 首个采样或采样中断的故障之后: 以读数重新开始
+    if (o->state == PRESS_OBS_INIT || (o->state == PRESS_OBS_FAULT && !o->latched)) {
+        o->p_hat = meas_kpa;
+        o->resid_avg = 0.0f;
+        if (o->t_us < t_us) o->t_us = t_us;
+        hist_push(o);
+        o->state = PRESS_OBS_OK;
+        return;
+    }
+
+    // 采样时刻的预测值: 历史中不晚于采样时刻的最新一项 (早于全部历史时取最旧一项)
+    int k = o->hist_head;
+    float pred = o->p_hat;
+    for (int i = 0; i < PRESS_OBS_HIST_LEN; i++) {
+        int j = (o->hist_head + PRESS_OBS_HIST_LEN - i) % PRESS_OBS_HIST_LEN;
+        if (o->hist_t[j] == INT64_MIN) break;
+        k = j;
+        pred = o->hist_p[j];
+        if (o->hist_t[j] <= t_us) break;
+    }
+
+    // 校正当前估计，以及采样时刻之后的历史 (下一个采样与校正后的预测比较)
+    float r = meas_kpa - pred;
+    float dp = o->cfg.gain * r;
+    o->p_hat += dp;
+    if (o->p_hat < 0.0f) o->p_hat = 0.0f;
+    for (int j = k; ; j = (j + 1) % PRESS_OBS_HIST_LEN) {
+        o->hist_p[j] += dp;
+        if (j == o->hist_head) break;
+    }
+
+    float ar = fabsf(r);
+    o->resid = r;
+    o->resid_avg += o->cfg.resid_alpha * (ar - o->resid_avg);
+    if (ar > o->resid_max) o->resid_max = ar;
+
+    if (o->state == PRESS_OBS_FAULT) return;
+    if (o->resid_avg > o->cfg.resid_limit_kpa) {
+        o->state = PRESS_OBS_FAULT;
+        o->latched = true;
+        o->faults++;
+    } else {
+        o->state = PRESS_OBS_OK;
+    }
+}
+
+void press_obs_clear(press_obs_t *o) {
+    o->state = PRESS_OBS_INIT;
+    o->latched = false;
+    o->resid_avg = 0.0f;
+    o->meas_t_us = -1;
+    for (int i = 0; i < PRESS_OBS_HIST_LEN; i++) o->hist_t[i] = INT64_MIN;
+}
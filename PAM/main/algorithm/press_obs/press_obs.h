@@ -0,0 +1,76 @@
+//肌肉腔压力观测器
+//两次气压采样之间用腔体模型 (pam_chamber_dpdt: 阀门流量 + 体积变化) 按实际输出的阀门占空比、
+//气源压力与关节角/角速度外推腔压；新采样到达时按采样时刻的预测值计算残差并校正
+//(采样有传输延迟，预测值保存在一个短历史中)。压力环因此可以每周期使用新的估计值，
+//回路频率不受串口采样率限制，单次读取失败或延迟也不会被当作真实读数。
+//健康监测: 残差 |r| 的指数平均超限 (传感器卡死/漂移) 或超过 coast_us 没有新采样时判为故障，
+//由控制器进入降级安全模式。采样中断的故障在采样恢复后以新读数重新开始；残差故障锁存
+//(安全模式下阀门关闭，残差不再能说明传感器是否恢复)，由 press_obs_clear 解除。
+
+#ifndef PRESS_OBS_H
+#define PRESS_OBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pam_model.h"
+
+#define PRESS_OBS_HIST_LEN  16          // 预测历史长度 (覆盖最大采样延迟)
+
+typedef enum {
+    PRESS_OBS_INIT = 0,                 ///< 尚无采样 (估计无效)
+    PRESS_OBS_OK,                       ///< 采样正常
+    PRESS_OBS_COAST,                    ///< 超过 stale_us 没有新采样，只靠模型外推
+    PRESS_OBS_FAULT,                    ///< 残差超限或外推超时
+} press_obs_state_t;
+
+typedef struct {
+    float    gain;                      ///< 新采样的校正增益 (0~1)
+    float    resid_alpha;               ///< 残差指数平均系数 (每个采样)
+    float    resid_limit_kpa;           ///< 残差平均上限，超过判为故障
+    uint32_t stale_us;                  ///< 超过此时间没有新采样进入 COAST
+    uint32_t coast_us;                  ///< 超过此时间没有新采样判为故障
+    uint32_t substep_us;                ///< 外推积分步长上限
+} press_obs_cfg_t;
+
+typedef struct {
+    const pam_model_params_t *mp;
+    press_obs_cfg_t cfg;
+    int      muscle;                    ///< 0: A (关节角增大时收缩), 1: B
+    float    p_hat;                     ///< 腔压估计 (kPa 表压)
+    int64_t  t_us;                      ///< 估计对应的时刻
+    int64_t  meas_t_us;                 ///< 最近一次采用的采样时刻
+    float    resid;                     ///< 最近一次残差
+    float    resid_avg;                 ///< 残差绝对值的指数平均
+    press_obs_state_t state;
+    bool     latched;                   ///< 残差故障 (只由 press_obs_clear 解除)
+
+    // 预测历史 (环形): 采样到达时取采样时刻之前最近的预测值
+    int64_t  hist_t[PRESS_OBS_HIST_LEN];
+    float    hist_p[PRESS_OBS_HIST_LEN];
+    uint8_t  hist_head;
+
+    uint32_t samples;                   ///< 采用的采样数
+    uint32_t coast_events;              ///< 进入 COAST 的次数
+    uint32_t faults;                    ///< 进入 FAULT 的次数
+    float    resid_max;                 ///< 最大残差绝对值
+} press_obs_t;
+
+void press_obs_init(press_obs_t *o, const pam_model_params_t *mp, int muscle, const press_obs_cfg_t *cfg);
+
+// 外推到 now_us: duty_in/out 为上一周期起实际输出的占空比 (0~1)，supply_kpa 为气源表压估计，
+// theta/omega 为关节角 (rad) 与角速度 (rad/s)；同时检查采样是否过期
+void press_obs_predict(press_obs_t *o, int64_t now_us, float duty_in, float duty_out,
+                       float supply_kpa, float theta, float omega);
+
+// 一次采样 (t_us 为采样时刻，与上次相同即没有新采样，直接忽略)
+void press_obs_correct(press_obs_t *o, float meas_kpa, int64_t t_us);
+
+// 解除故障并以下一个采样重新开始 (统计保留)
+void press_obs_clear(press_obs_t *o);
+
+// 估计可用于控制 (OK 或 COAST)
+static inline bool press_obs_usable(const press_obs_t *o) {
+    return o->state == PRESS_OBS_OK || o->state == PRESS_OBS_COAST;
+}
+
+#endif // PRESS_OBS_H
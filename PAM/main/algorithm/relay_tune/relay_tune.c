@@ -0,0 +1,83 @@
+#include "relay_tune.h"
+#include <math.h>
+
+#define PI_F 3.14159265f
+
+void relay_tune_init(relay_tune_t *rt, float setpoint, float bias, float amp, float hyst,
+                     int skip, int cycles, float timeout_s) {
+    rt->setpoint = setpoint;
+    rt->bias = bias;
+    rt->amp = amp;
+    rt->hyst = hyst;
+    rt->skip = skip;
+    rt->cycles = cycles;
+    rt->timeout_s = timeout_s;
+
+    rt->high = true;
+    rt->t = 0.0f;
+    rt->t_rise = -1.0f;
+    rt->y_max = -INFINITY;
+    rt->y_min = INFINITY;
+    rt->n = 0;
+    rt->sum_period = 0.0f;
+    rt->sum_amp = 0.0f;
+}
+
+/**
+ * @brief 继电器一步
+ * * 误差超出回差才切换；每次切到高输出结束一个完整周期，记录周期与本周期峰峰值
+ */
+relay_status_t relay_tune_update(relay_tune_t *rt, float y, float dt, float *u) {
+    float e = rt->setpoint - y;
+    rt->t += dt;
+    if (y > rt->y_max) rt->y_max = y;
+    if (y < rt->y_min) rt->y_min = y;
+
+    if (rt->high && e < -rt->hyst) {
+        rt->high = false;
+    } else if (!rt->high && e > rt->hyst) {
+        rt->high = true;
+        if (rt->t_rise >= 0.0f) {
+            if (rt->n >= rt->skip) {
+                rt->sum_period += rt->t - rt->t_rise;
+                rt->sum_amp += 0.5f * (rt->y_max - rt->y_min);
+            }
+            rt->n++;
+        }
+        rt->t_rise = rt->t;
+        rt->y_max = y;
+        rt->y_min = y;
+    }
+
+    *u = rt->bias + (rt->high ? rt->amp : -rt->amp);
+    if (rt->n >= rt->skip + rt->cycles) return RELAY_DONE;
+    if (rt->t > rt->timeout_s) return RELAY_TIMEOUT;
+    return RELAY_RUNNING;
+}
+
+bool relay_tune_result(const relay_tune_t *rt, float *ku, float *tu, float *a) {
+    int n = rt->n - rt->skip;
+    if (n <= 0) return false;
+
+    *a = rt->sum_amp / (float)n;
+    *tu = rt->sum_period / (float)n;
+    if (*a <= rt->hyst) return false;
+    *ku = 4.0f * rt->amp / (PI_F * sqrtf(*a * *a - rt->hyst * rt->hyst));
+    return true;
+}
+
+tune_gains_t tune_rule_gains(tune_rule_t rule, float ku, float tu) {
+    switch (rule) {
+    case TUNE_RULE_ZN_PI:        return (tune_gains_t){ 0.45f * ku, tu / 1.2f, 0.0f };
+    case TUNE_RULE_ZN_PID:       return (tune_gains_t){ 0.6f * ku,  tu / 2.0f, tu / 8.0f };
+    case TUNE_RULE_TL_PI:        return (tune_gains_t){ ku / 3.2f,  2.2f * tu, 0.0f };
+    case TUNE_RULE_TL_PID:       return (tune_gains_t){ ku / 2.2f,  2.2f * tu, tu / 6.3f };
+    case TUNE_RULE_NO_OVERSHOOT: return (tune_gains_t){ 0.2f * ku,  tu / 2.0f, tu / 3.0f };
+    default:                     return (tune_gains_t){ 0.0f, 0.0f, 0.0f };
+    }
+}
+
+const char *tune_rule_name(tune_rule_t rule) {
+    static const char *names[TUNE_RULE_NUM] = { "ZN-PI", "ZN-PID", "TL-PI", "TL-PID", "no-overshoot" };
+    return rule < TUNE_RULE_NUM ? names[rule] : "?";
+}
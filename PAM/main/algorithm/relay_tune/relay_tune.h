@@ -0,0 +1,68 @@
+//继电反馈整定 (Åström–Hägglund)
+//用带回差的继电器代替控制器闭环，输出在 bias ± amp 之间切换，被控量进入极限环振荡。
+//由振荡幅值 a 与周期 Tu 按描述函数估计临界增益 Ku = 4·amp / (π·√(a² − ε²))，
+//再按所选整定规则换算成 PID 增益。只做计算，不涉及硬件，由调用者按回路周期驱动。
+
+#ifndef RELAY_TUNE_H
+#define RELAY_TUNE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    RELAY_RUNNING = 0,
+    RELAY_DONE,                         ///< 已测满所需周期数
+    RELAY_TIMEOUT,                      ///< 超时仍未形成稳定振荡
+} relay_status_t;
+
+// 整定规则 (由 Ku、Tu 计算 Kp、Ti、Td)
+typedef enum {
+    TUNE_RULE_ZN_PI = 0,                ///< Ziegler–Nichols PI
+    TUNE_RULE_ZN_PID,                   ///< Ziegler–Nichols PID
+    TUNE_RULE_TL_PI,                    ///< Tyreus–Luyben PI (更保守，适合有积分特性的对象)
+    TUNE_RULE_TL_PID,                   ///< Tyreus–Luyben PID
+    TUNE_RULE_NO_OVERSHOOT,             ///< 无超调 PID
+    TUNE_RULE_NUM,
+} tune_rule_t;
+
+typedef struct {
+    // 配置
+    float setpoint;
+    float bias;                         ///< 继电器中心输出
+    float amp;                          ///< 继电器幅值 d
+    float hyst;                         ///< 回差 ε (与被控量同单位)
+    int   skip;                         ///< 丢弃的起始周期数 (过渡过程)
+    int   cycles;                       ///< 参与平均的周期数
+    float timeout_s;
+
+    // 运行状态
+    bool  high;                         ///< 当前输出 bias + amp
+    float t;                            ///< 已运行时间 (s)
+    float t_rise;                       ///< 上一次切到高输出的时刻，< 0 表示尚未切换
+    float y_max, y_min;                 ///< 本周期的极值
+    int   n;                            ///< 已完成的周期数 (含丢弃)
+    float sum_period, sum_amp;
+} relay_tune_t;
+
+// 连续形式的 PID 增益 (Ti = 0 表示无积分)
+typedef struct {
+    float kp;
+    float ti;
+    float td;
+} tune_gains_t;
+
+void relay_tune_init(relay_tune_t *rt, float setpoint, float bias, float amp, float hyst,
+                     int skip, int cycles, float timeout_s);
+
+// 每个回路周期调用一次: 输入测量值与周期 dt，输出继电器指令
+relay_status_t relay_tune_update(relay_tune_t *rt, float y, float dt, float *u);
+
+// 平均振荡幅值 a (半峰峰值) 与临界增益 Ku、临界周期 Tu；振荡幅值不大于回差时返回 false
+bool relay_tune_result(const relay_tune_t *rt, float *ku, float *tu, float *a);
+
+// 按整定规则计算连续形式增益
+tune_gains_t tune_rule_gains(tune_rule_t rule, float ku, float tu);
+
+const char *tune_rule_name(tune_rule_t rule);
+
+#endif // RELAY_TUNE_H
@@ -0,0 +1,132 @@
+#include "traj.h"
+#include <string.h>
+
+#define PHASE_END   ((uint32_t)(TRAJ_TABLE_POINTS - 1) << 16)
+
+// 归一化曲线: τ = i/(N-1) ∈ [0,1] 处的位置 s(τ)、速度 ds/dτ、加速度 d²s/dτ²
+typedef struct {
+    float s[TRAJ_TABLE_POINTS];
+    float v[TRAJ_TABLE_POINTS];
+    float a[TRAJ_TABLE_POINTS];
+} traj_table_t;
+
+static traj_table_t tables[TRAJ_PROFILE_NUM];
+static bool tables_ready;
+
+/**
+ * @brief 生成归一化查找表 (只在初始化时运行一次)
+ * * 最小加加速度: s = 10τ³ - 15τ⁴ + 6τ⁵
+ * * 梯形速度: 加速/匀速/减速各 1/3，峰值速度 1.5，加速度 ±4.5
+ */
+static void build_tables(void) {
+    for (int i = 0; i < TRAJ_TABLE_POINTS; i++) {
+        float t = (float)i / (TRAJ_TABLE_POINTS - 1);
+        float t2 = t * t, t3 = t2 * t;
+
+        traj_table_t *mj = &tables[TRAJ_MIN_JERK];
+        mj->s[i] = t3 * (10.0f - 15.0f * t + 6.0f * t2);
+        mj->v[i] = t2 * (30.0f - 60.0f * t + 30.0f * t2);
+        mj->a[i] = t * (60.0f - 180.0f * t + 120.0f * t2);
+
+        traj_table_t *tr = &tables[TRAJ_TRAPEZOID];
+        if (t < 1.0f / 3.0f) {
+            tr->s[i] = 2.25f * t2;
+            tr->v[i] = 4.5f * t;
+            tr->a[i] = 4.5f;
+        } else if (t <= 2.0f / 3.0f) {
+            tr->s[i] = 1.5f * t - 0.25f;
+            tr->v[i] = 1.5f;
+            tr->a[i] = 0.0f;
+        } else {
+            float r = 1.0f - t;
+            tr->s[i] = 1.0f - 2.25f * r * r;
+            tr->v[i] = 4.5f * r;
+            tr->a[i] = -4.5f;
+        }
+    }
+    tables_ready = true;
+}
+
+void traj_init(traj_t *tj, float pos) {
+    if (!tables_ready) build_tables();
+    memset(tj, 0, sizeof(*tj));
+    spsc_ring_init(&tj->queue, tj->queue_buf, TRAJ_QUEUE_LEN, sizeof(traj_waypoint_t));
+    tj->pos = pos;
+}
+
+bool traj_push(traj_t *tj, const traj_waypoint_t *wp) {
+    return spsc_ring_push(&tj->queue, wp);
+}
+
+void traj_reset(traj_t *tj, float pos) {
+    traj_waypoint_t wp;
+    while (spsc_ring_pop(&tj->queue, &wp)) {
+    }
+    tj->s = NULL;
+    tj->pos = pos;
+}
+
+void traj_hold(traj_t *tj, float pos) {
+    tj->s = NULL;
+    tj->pos = pos;
+}
+
+bool traj_busy(traj_t *tj) {
+    return tj->s != NULL || spsc_ring_depth(&tj->queue) > 0;
+}
+
+// 从当前终点开始新的一段 (时长不足一个周期的按阶跃处理)
+static void start_segment(traj_t *tj, const traj_waypoint_t *wp, float dt) {
+    if (wp->profile == TRAJ_STEP || wp->profile >= TRAJ_PROFILE_NUM || !(wp->duration_s > dt)) {
+        tj->s = NULL;
+        tj->pos = wp->target;
+        return;
+    }
+
+    const traj_table_t *tb = &tables[wp->profile];
+    float inv_t = 1.0f / wp->duration_s;
+    tj->s = tb->s;
+    tj->v = tb->v;
+    tj->a = tb->a;
+    tj->p0 = tj->pos;
+    tj->delta = wp->target - tj->pos;
+    tj->vel_scale = tj->delta * inv_t;
+    tj->acc_scale = tj->vel_scale * inv_t;
+    tj->phase = 0;
+    tj->phase_rate = (float)PHASE_END * inv_t;
+    tj->pos = wp->target;
+}
+
+/**
+ * @brief 前进一个周期并输出参考
+ * * 相位为 16.16 定点表索引: 整数部分选断点，小数部分在相邻断点间线性插值
+ * @param tj 轨迹
+ * @param dt 周期 (s)
+ * @param out 参考位置/速度/加速度
+ */
+void traj_step(traj_t *tj, float dt, traj_ref_t *out) {
+    if (tj->s == NULL) {
+        traj_waypoint_t wp;
+        if (spsc_ring_pop(&tj->queue, &wp)) start_segment(tj, &wp, dt);
+    }
+
+    if (tj->s != NULL) {
+        float inc = tj->phase_rate * dt;
+        uint32_t left = PHASE_END - tj->phase;
+        tj->phase = inc >= (float)left ? PHASE_END : tj->phase + (uint32_t)inc;
+
+        if (tj->phase < PHASE_END) {
+            uint32_t i = tj->phase >> 16;
+            float f = (float)(tj->phase & 0xFFFF) * (1.0f / 65536.0f);
+            out->pos = tj->p0 + tj->delta * (tj->s[i] + f * (tj->s[i + 1] - tj->s[i]));
+            out->vel = tj->vel_scale * (tj->v[i] + f * (tj->v[i + 1] - tj->v[i]));
+            out->acc = tj->acc_scale * (tj->a[i] + f * (tj->a[i + 1] - tj->a[i]));
+            return;
+        }
+        tj->s = NULL;   // 本段结束，下一周期取下一路点
+    }
+
+    out->pos = tj->pos;
+    out->vel = 0.0f;
+    out->acc = 0.0f;
+}
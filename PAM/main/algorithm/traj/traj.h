@@ -0,0 +1,68 @@
+//轨迹生成器
+//外部以带时长的路点下发运动指令 (无锁 SPSC 命令队列)，角度环每周期取一次参考
+//位置/速度/加速度。最小加加速度与梯形速度曲线预先归一化成固定长度的查找表，
+//运行时只做一次定点相位累加与线性插值，回路中没有 pow/sin。
+
+#ifndef TRAJ_H
+#define TRAJ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spsc_ring.h"
+
+#define TRAJ_TABLE_POINTS   65          // 归一化曲线断点数 (等间隔时间)
+#define TRAJ_QUEUE_LEN      8           // 路点队列长度 (2 的幂)
+
+typedef enum {
+    TRAJ_STEP = 0,                      ///< 阶跃: 立即跳到目标 (时长忽略)
+    TRAJ_MIN_JERK,                      ///< 最小加加速度 (五次多项式)
+    TRAJ_TRAPEZOID,                     ///< 梯形速度 (加速/匀速/减速各占 1/3)
+    TRAJ_PROFILE_NUM,
+} traj_profile_t;
+
+// 路点: 在 duration_s 内从上一段终点运动到 target
+typedef struct {
+    float   target;
+    float   duration_s;
+    uint8_t profile;                    ///< traj_profile_t
+} traj_waypoint_t;
+
+// 每周期的参考量 (与 target 同单位，速度/加速度按秒)
+typedef struct {
+    float pos;
+    float vel;
+    float acc;
+} traj_ref_t;
+
+typedef struct {
+    spsc_ring_t     queue;
+    traj_waypoint_t queue_buf[TRAJ_QUEUE_LEN];
+
+    // 当前段 (仅消费者访问)
+    const float *s, *v, *a;             ///< 当前曲线的归一化表，NULL 表示静止
+    float    p0, delta;                 ///< 起点与位移
+    float    vel_scale, acc_scale;      ///< delta / T, delta / T²
+    uint32_t phase;                     ///< 16.16 定点表索引
+    float    phase_rate;                ///< 每秒相位增量 ((N-1) << 16) / T
+    float    pos;                       ///< 静止时的位置 / 当前段终点
+} traj_t;
+
+// 初始化 (静止于 pos)；首次调用时生成查找表
+void traj_init(traj_t *tj, float pos);
+
+// 生产者: 追加一个路点，队列满时返回 false
+bool traj_push(traj_t *tj, const traj_waypoint_t *wp);
+
+// 消费者: 前进一个周期 dt 并输出参考；当前段结束后自动取下一路点
+void traj_step(traj_t *tj, float dt, traj_ref_t *out);
+
+// 消费者: 丢弃队列与当前段，静止于 pos
+void traj_reset(traj_t *tj, float pos);
+
+// 消费者: 结束当前段，静止于 pos；队列中的路点保留，下一周期从 pos 开始执行
+void traj_hold(traj_t *tj, float pos);
+
+// 正在运动或队列中还有路点
+bool traj_busy(traj_t *tj);
+
+#endif // TRAJ_H
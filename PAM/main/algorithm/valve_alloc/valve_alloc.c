@@ -0,0 +1,27 @@
+#include "valve_alloc.h"
+
+/**
+ * @brief 有符号控制量 -> 进气/排气阀占空比
+ * * 死区以外的区间 (dead_band, max_duty] 线性映射到 [min_pulse, max_duty]
+ * @param cfg 分配参数
+ * @param u 压力环输出，正值充气，负值放气
+ * @return valve_pair_t 进气/排气阀占空比 (至少一个为 0)
+ */
+valve_pair_t valve_alloc(const valve_alloc_cfg_t *cfg, float u) {
+    valve_pair_t v = { 0, 0 };
+
+    float mag = u >= 0.0f ? u : -u;
+    if (mag <= cfg->dead_band) return v;
+    if (u < 0.0f && !cfg->exhaust) return v;
+
+    float span = cfg->max_duty - cfg->dead_band;
+    float duty = cfg->max_duty;
+    if (span > 0.0f && mag < cfg->max_duty) {
+        duty = cfg->min_pulse + (mag - cfg->dead_band) * (cfg->max_duty - cfg->min_pulse) / span;
+    }
+
+    uint32_t d = (uint32_t)(duty + 0.5f);
+    if (u > 0.0f) v.in = d;
+    else v.out = d;
+    return v;
+}
@@ -0,0 +1,28 @@
+//阀门分配：把压力环的有符号输出映射到一块肌肉的进气/排气阀对
+//u > 0 开进气阀充气，u < 0 开排气阀放气，两者永不同时打开。
+//|u| 在死区内两阀均关；死区以外按最小有效脉宽做偏置补偿，
+//使 PID 输出刚越过死区时阀门就能真正打开，而不是落在阀的机械死区里。
+
+#ifndef VALVE_ALLOC_H
+#define VALVE_ALLOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    float    dead_band;     ///< |u| 小于此值时两阀均关 (占空比计数)
+    float    min_pulse;     ///< 阀门能开启的最小占空比 (占空比计数)
+    float    max_duty;      ///< 满量程占空比
+    bool     exhaust;       ///< false: 只用进气阀 (u < 0 时两阀均关)
+} valve_alloc_cfg_t;
+
+// 一块肌肉的阀门占空比
+typedef struct {
+    uint32_t in;
+    uint32_t out;
+} valve_pair_t;
+
+// u: 压力环输出 (-max_duty ~ max_duty)
+valve_pair_t valve_alloc(const valve_alloc_cfg_t *cfg, float u);
+
+#endif // VALVE_ALLOC_H
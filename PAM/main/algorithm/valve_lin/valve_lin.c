@@ -0,0 +1,69 @@
+#include "valve_lin.h"
+
+void valve_lin_identity(valve_lin_t *lin, uint16_t max_duty) {
+    for (int i = 0; i < VALVE_LIN_POINTS; i++) {
+        lin->duty[i] = (uint16_t)((uint32_t)max_duty * i / (VALVE_LIN_POINTS - 1));
+    }
+}
+
+/**
+ * @brief 由正向曲线求逆向查找表
+ * * 流量为 0 的断点取死区边缘 (最后一个零流量占空比)，使小指令刚好越过死区
+ * @param lin 输出查找表
+ * @param flow 等间隔占空比上的归一化流量
+ * @param max_duty 满量程占空比
+ * @return true 建表成功
+ */
+bool valve_lin_build(valve_lin_t *lin, const float flow[VALVE_LIN_POINTS], uint16_t max_duty) {
+    const int n = VALVE_LIN_POINTS;
+    float f[VALVE_LIN_POINTS];
+
+    // 1. 单调化 (测量噪声可能造成局部回落) 并归一化到满占空比流量
+    float run = 0.0f;
+    for (int i = 0; i < n; i++) {
+        if (flow[i] > run) run = flow[i];
+        f[i] = run;
+    }
+    if (f[n - 1] <= 0.0f) {
+        valve_lin_identity(lin, max_duty);
+        return false;
+    }
+    for (int i = 0; i < n; i++) f[i] /= f[n - 1];
+
+    // 2. 对每个等间隔流量断点，在正向曲线上找到所在区间并插值出占空比
+    const float step = (float)max_duty / (float)(n - 1);
+    int seg = 0;
+    for (int j = 0; j < n; j++) {
+        float q = (float)j / (float)(n - 1);
+        // 区间只前移: 开头的零流量区间 (死区) 与平台段都会被跳过
+        while (seg < n - 2 && f[seg + 1] <= q) seg++;
+        float lo = f[seg], hi = f[seg + 1];
+        float frac = hi > lo ? (q - lo) / (hi - lo) : 1.0f;
+        if (frac < 0.0f) frac = 0.0f;
+        if (frac > 1.0f) frac = 1.0f;
+        lin->duty[j] = (uint16_t)((seg + frac) * step + 0.5f);
+    }
+    lin->duty[n - 1] = max_duty;
+    return true;
+}
+
+/**
+ * @brief 执行路径上的逆映射: 定点索引 + 线性插值
+ * * @param lin 查找表
+ * @param cmd 指令占空比 (0 ~ max_duty)
+ * @param max_duty 满量程占空比
+ * @return uint32_t 实际输出占空比
+ */
+uint32_t valve_lin_apply(const valve_lin_t *lin, uint32_t cmd, uint16_t max_duty) {
+    // 16.16 定点位置: cmd / max_duty * (N-1)，cmd 先饱和到 max_duty
+    uint32_t c = cmd < max_duty ? cmd : max_duty;
+    uint32_t pos = (uint32_t)(((uint64_t)c * (VALVE_LIN_POINTS - 1) << 16) / max_duty);
+    uint32_t i = pos >> 16;
+    i -= (i == VALVE_LIN_POINTS - 1);               // 末端断点并入最后一个区间
+    uint32_t frac = pos - (i << 16);
+
+    int32_t d0 = lin->duty[i];
+    int32_t d1 = lin->duty[i + 1];
+    uint32_t out = (uint32_t)(d0 + (int32_t)(((int64_t)(d1 - d0) * frac) >> 16));
+    return out & -(uint32_t)(cmd != 0);             // 指令 0 -> 阀门关闭
+}
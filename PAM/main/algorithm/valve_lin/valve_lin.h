@@ -0,0 +1,27 @@
+//阀门线性化查找表
+//标定得到“占空比 -> 流量”的单调正向曲线后，预先求出等间隔流量断点上的逆映射
+//(流量 -> 占空比)。执行路径上只需一次定点查表与线性插值，无比较分支。
+
+#ifndef VALVE_LIN_H
+#define VALVE_LIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VALVE_LIN_POINTS    17          // 断点数 (正向: 等间隔占空比; 逆向: 等间隔流量)
+
+typedef struct {
+    uint16_t duty[VALVE_LIN_POINTS];    ///< 流量 = i/(N-1) 满流量时所需的占空比
+} valve_lin_t;
+
+// 恒等映射 (未标定)
+void valve_lin_identity(valve_lin_t *lin, uint16_t max_duty);
+
+// 由正向测量建表: flow[i] 为占空比 i*max_duty/(N-1) 时的归一化流量 (0~1)
+// 测量值先做单调化处理；返回 false 表示曲线无效 (满占空比无流量)，此时建为恒等映射
+bool valve_lin_build(valve_lin_t *lin, const float flow[VALVE_LIN_POINTS], uint16_t max_duty);
+
+// 指令占空比 (视为满流量的比例) -> 实际占空比；0 保持为 0 (阀门关闭)
+uint32_t valve_lin_apply(const valve_lin_t *lin, uint32_t cmd, uint16_t max_duty);
+
+#endif // VALVE_LIN_H
@@ -1,108 +1,739 @@
 #include "arm_control.h"
 #include "pid.h"
+#include "pid_q.h"
 #include "hardware_config.h"
 #include "as5600.h"
 #include "press.h"
 #include "hal_valves.h"
+#include "hal_pump.h"
+#include "valve_alloc.h"
+#include "valve_cal.h"
+#include "traj.h"
+#include "pam_ff.h"
+#include "press_obs.h"
+#include "autotune.h"
+#include "ctrl_sched.h"
+#include "mailbox.h"
+#include "sensor_pipeline.h"
+#include "loop_prof.h"
+#include "telemetry.h"
+#include "param_store.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <math.h>
+#include <string.h>
+#include <stdatomic.h>
 
 static const char *TAG = "ARM_CTRL";
 
+// 时间戳时钟 (采样时刻、观测器、PWM 同步与调度节拍)，仿真中换成仿真时钟
+static int64_t (*clock_fn)(void) = esp_timer_get_time;
+
+#define COUNTS_PER_RAD  (4096.0f / 6.28318531f)   // AS5600 计数 / 弧度
+
+// 回路 PID: 浮点结构保存由参数表换算的配置；PAM_FIXED_POINT 时由定点 PID 按同一配置运行
+typedef struct {
+    pid_timed_t f;
+#if PAM_FIXED_POINT
+    pid_q_t     q;
+#endif
+} loop_pid_t;
+
 // 定义三个 PID 控制器
-static pid_ctrl_t pid_angle;    ///< 角度环 PID
-static pid_ctrl_t pid_press_A;  ///< 肌肉A 压力环 PID
-static pid_ctrl_t pid_press_B;  ///< 肌肉B 压力环 PID
+static loop_pid_t pid_angle;    ///< 角度环 PID
+static loop_pid_t pid_press_A;  ///< 肌肉A 压力环 PID
+static loop_pid_t pid_press_B;  ///< 肌肉B 压力环 PID
+
+// 运行时参数 (增益、限幅、基础气压、回路周期)，在回路边界从 param_store 整体更新
+static pam_params_t params;
+static uint32_t     params_version;
+static int          loop_angle, loop_press;   ///< 调度器中的回路索引
+
+// 外环 -> 内环的压力设定值
+typedef struct {
+    float press_A;
+    float press_B;
+#if PAM_FIXED_POINT
+    q16_t q_A, q_B;     ///< 同上 (Q16.16)，由角度环换算，压力环不再转换
+#endif
+} press_setpoint_t;
+
+// 外部命令经轨迹生成器的无锁路点队列进入角度环；回路之间通过最新值邮箱交换数据，不加锁
+static traj_t    traj;              ///< 外部命令 -> 角度环参考
+static mailbox_t mb_press_sp;       ///< 角度环 -> 压力环
+static press_setpoint_t press_sp_buf;
+static mailbox_t mb_state;          ///< 角度环 -> 外部观察 (参考量与压力差)
+static arm_ctrl_state_t state_buf;
+static mailbox_t mb_health;         ///< 压力环 -> 外部观察 (观测器状态)
+static arm_press_health_t health_buf;
+
+static ctrl_sched_t sched;
+
+// 计时插桩: 每个回路一份，区段首尾相接
+static loop_prof_t *prof_angle;
+static loop_prof_t *prof_press;
+static int span_angle_sensor, span_angle_pid, span_angle_alloc;
+static int span_press_sensor, span_press_pid, span_press_valve;
+
+#if PAM_TELEMETRY_ENABLE
+// 遥测记录: 角度环填入外环信号，压力环补齐内环信号后整条写出
+// (两个回路在同一任务中执行，无需同步)
+static telem_record_t telem;
+static int span_press_telem;
+#endif
+
+static float angle_period_s;        ///< 角度环周期 (s)，随参数更新
+static float press_period_s;        ///< 压力环周期 (s)，随参数更新
+#if PAM_FIXED_POINT
+static q16_t press_period_q;        ///< 同上 (Q16.16)
+#endif
+static int64_t angle_last_us = -1;  ///< 上一次角度采样时刻，PID 按实际间隔计算
+static int64_t press_last_us[2] = { -1, -1 };
+static int64_t tune_last_us[2] = { -1, -1 };    ///< 自整定压力实验的原始采样时刻
+// 静态模型前馈表双缓冲: 后台任务在备用表中按新的基础气压重建 (约 300 次模型计算，不放在回路中)，
+// 完成后置 ff_ready；角度环在周期开头切换到备用表并清除 ff_ready，此后后台才会再写原来的表
+static pam_ff_t ff_tabs[2];
+static atomic_int  ff_active;       ///< 角度环正在使用的表 (只由角度环修改)
+static atomic_bool ff_ready;        ///< 备用表已建好，等待角度环切换
+static atomic_bool ff_pending;      ///< 有重建请求
+static TaskHandle_t ff_task_handle;
+static valve_alloc_cfg_t alloc_cfg; ///< 压力环输出 -> 进/排气阀，随参数更新
+
+#if PAM_PIPELINE_MODE
+static sensor_frame_t frame;        ///< 控制核上最近收到的传感器帧
+#endif
+
+// 压力观测器: 两块肌肉各一个，按上一周期实际输出的占空比与角度环最近的角度外推
+static pam_model_params_t obs_model;
+static press_obs_t obs[2];
+static float    obs_duty[VALVE_NUM];    ///< 当前生效的占空比 (0~1)
+static float    obs_duty_next[VALVE_NUM];   ///< 已提交、在 PWM 周期起点 obs_duty_at 生效的占空比
+static int64_t  obs_duty_at = -1;
+static float    obs_theta, obs_omega;   ///< 角度环最近一次的关节角 (rad) 与角速度 (rad/s)
+static int64_t  obs_now_us;             ///< 本周期估计对应的时刻
+static bool     obs_running;            ///< 参数 press_obs 打开: 观测器每周期更新
+static bool     fault_mode;             ///< 安全模式由观测器故障引起 (等待首个采样不算)
+static uint32_t safe_entries;
+static uint32_t safe_reported;
+static atomic_bool obs_clear_req;
+static bool     pwm_synced;             ///< 阀门 PWM 周期起点已与压力环节拍对齐
+
+// 参数表增益 -> 连续时间增益 (定点 PID 同步换算)
+static void pid_apply(loop_pid_t *lp, const param_pid_t *p, float t_nom) {
+    param_pid_apply(p, t_nom, &lp->f);
+#if PAM_FIXED_POINT
+    pid_q_config(&lp->q, &lp->f);
+#endif
+}
+
+static void loop_pid_reset(loop_pid_t *lp) {
+    pid_timed_reset(&lp->f);
+#if PAM_FIXED_POINT
+    pid_q_reset(&lp->q);
+#endif
+}
+
+static void periods_apply(void) {
+    angle_period_s = (float)(params.angle_period_ticks * CTRL_BASE_TICK_US) * 1e-6f;
+    press_period_s = (float)(params.press_period_ticks * CTRL_BASE_TICK_US) * 1e-6f;
+#if PAM_FIXED_POINT
+    press_period_q = q16_ratio(params.press_period_ticks * CTRL_BASE_TICK_US, 1000000);
+#endif
+}
+
+static void alloc_apply(const pam_params_t *p) {
+    alloc_cfg.dead_band = p->valve_dead_band;
+    alloc_cfg.min_pulse = valve_cal_valid() ? 0.0f : p->valve_min_pulse;   // 标定表已包含阀门死区
+    alloc_cfg.max_duty = (float)VALVE_MAX_DUTY;
+    alloc_cfg.exhaust = p->valve_exhaust != 0;
+    pump_set_mode(alloc_cfg.exhaust ? PUMP_MODE_EXHAUST : PUMP_MODE_INLET_ONLY);   // 耗气量按阀门分配模式分别统计
+}
+
+// 由肌肉/关节模型建立前馈表 (平衡点取决于基础气压)
+static void ff_build(pam_ff_t *ff, float base_kpa) {
+    pam_model_params_t mp;
+    pam_model_default_params(&mp);
+    pam_ff_build(ff, &mp, base_kpa, COUNTS_PER_RAD);
+}
+
+static const pam_ff_t *ff_table(void) {
+    return &ff_tabs[atomic_load_explicit(&ff_active, memory_order_relaxed)];
+}
+
+// 请求后台重建 (目标上唤醒前馈任务，仿真中由仿真循环调用 arm_control_ff_service)
+static void ff_request(void) {
+    atomic_store(&ff_pending, true);
+    if (ff_task_handle) xTaskNotifyGive(ff_task_handle);
+}
+
+// 角度环周期开头: 备用表已建好则切换
+static void ff_swap(void) {
+    if (!atomic_load_explicit(&ff_ready, memory_order_acquire)) return;
+    atomic_store_explicit(&ff_active, 1 - atomic_load_explicit(&ff_active, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&ff_ready, false, memory_order_release);
+}
+
+void arm_control_ff_service(void) {
+    // 上一张备用表尚未被角度环取走时不能覆盖，保留请求稍后再试
+    if (atomic_load_explicit(&ff_ready, memory_order_acquire)) return;
+    if (!atomic_exchange(&ff_pending, false)) return;
 
-// 基础气压 (Base Pressure)，单位 kPa，保持肌肉的初始张力
-#define BASE_PRESSURE 300.0f 
+    pam_params_t p;
+    param_store_get(&p);
+    int active = atomic_load_explicit(&ff_active, memory_order_relaxed);
+    if (p.base_pressure == ff_tabs[active].base) return;
+
+    ff_build(&ff_tabs[1 - active], p.base_pressure);
+    atomic_store_explicit(&ff_ready, true, memory_order_release);
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+static void ff_task(void *arg) {
+    while (1) {
+        // 等待请求；备用表未被取走时隔一个角度环周期左右再试
+        ulTaskNotifyTake(pdTRUE, atomic_load(&ff_pending) ? pdMS_TO_TICKS(20) : portMAX_DELAY);
+        arm_control_ff_service();
+    }
+}
+#endif
+
+/**
+ * @brief 参数有新版本时整体取走并生效 (保留积分等运行状态)
+ * * 两个回路都在调度任务中执行，在任一回路开头调用即保证同一周期内参数一致
+ */
+static void refresh_params(void) {
+    if (param_store_version() == params_version) return;
+
+    params_version = param_store_get(&params);
+    pid_apply(&pid_angle, &params.angle, ANGLE_LOOP_NOMINAL_S);
+    pid_apply(&pid_press_A, &params.press_a, PRESS_LOOP_NOMINAL_S);
+    pid_apply(&pid_press_B, &params.press_b, PRESS_LOOP_NOMINAL_S);
+    ctrl_sched_set_period(&sched, loop_angle, params.angle_period_ticks);
+    ctrl_sched_set_period(&sched, loop_press, params.press_period_ticks);
+    periods_apply();
+    alloc_apply(&params);
+    if (params.base_pressure != ff_table()->base) ff_request();
+}
+
+// 传感器读取：流水线模式下取采集核送来的最新帧，否则直接调用驱动
+static void refresh_sensors(void) {
+#if PAM_PIPELINE_MODE
+    sensor_pipeline_latest(&frame);
+#endif
+}
+
+static float read_angle(void) {
+#if PAM_PIPELINE_MODE
+    return frame.angle;
+#else
+    return (float)as5600_get_angle(0); // 通道0
+#endif
+}
+
+// 角速度估计 (计数/秒)，来自 AS5600 的匀速模型卡尔曼滤波
+static float read_angle_vel(void) {
+#if PAM_PIPELINE_MODE
+    return frame.angle_vel;
+#else
+    return as5600_get_velocity(0);
+#endif
+}
+
+#if PAM_FIXED_POINT
+static q16_t read_pressure_q16(int channel) {
+#if PAM_PIPELINE_MODE
+    return frame.press_q16[channel];
+#else
+    return pressure_read_q16(channel);
+#endif
+}
+#else
+static float read_pressure(int channel) {
+#if PAM_PIPELINE_MODE
+    return frame.press_kpa[channel];
+#else
+    return (float)pressure_read_kpa(channel);
+#endif
+}
+#endif
+
+// 测量值的采样时刻: 流水线模式下为采集时刻，否则为本次读取的时刻
+static int64_t read_angle_time(void) {
+#if PAM_PIPELINE_MODE
+    return frame.t_us;
+#else
+    return clock_fn();
+#endif
+}
+
+static int64_t read_pressure_time(int channel) {
+#if PAM_PIPELINE_MODE
+    return frame.press_t_us[channel];
+#else
+    return clock_fn();
+#endif
+}
+
+// 带采样时刻的原始气压 (kPa，Pa 分辨率)，尚无有效数据时返回 false
+static bool read_pressure_sample(int channel, float *kpa, int64_t *t_us) {
+#if PAM_PIPELINE_MODE
+    if (frame.press_t_us[channel] == 0) return false;
+    *kpa = q16_to_float(frame.press_q16[channel]);
+    *t_us = frame.press_t_us[channel];
+    return true;
+#else
+    press_sample_t s;
+    if (!pressure_get_sample(channel, &s)) return false;
+    *kpa = (float)s.pa * 1e-3f;
+    *t_us = s.timestamp_us;
+    return true;
+#endif
+}
+
+static void obs_init(void) {
+    press_obs_cfg_t cfg = {
+        .gain = PRESS_OBS_GAIN,
+        .resid_alpha = PRESS_OBS_RESID_ALPHA,
+        .resid_limit_kpa = PRESS_OBS_RESID_KPA,
+        .stale_us = PRESS_OBS_STALE_MS * 1000,
+        .coast_us = PRESS_OBS_COAST_MS * 1000,
+        .substep_us = PRESS_OBS_SUBSTEP_US,
+    };
+    pam_model_default_params(&obs_model);
+    press_obs_init(&obs[0], &obs_model, 0, &cfg);
+    press_obs_init(&obs[1], &obs_model, 1, &cfg);
+}
+
+/**
+ * @brief 观测器外推到当前时刻，有新采样时校正
+ * * 气源压力按储气余量在压力开关两个阈值之间估计
+ * @return bool 两个估计都可用；否则 (无数据、残差超限或采样长时间中断) 应进入安全模式
+ */
+static bool obs_update(void) {
+    // 刚打开时估计已过期 (关闭期间不外推): 与解除故障相同，以下一个采样重新开始
+    if (atomic_exchange(&obs_clear_req, false) || !obs_running) {
+        press_obs_clear(&obs[0]);
+        press_obs_clear(&obs[1]);
+        obs_running = true;
+    }
+    obs_now_us = clock_fn();
+    float supply = PUMP_SWITCH_LOW_KPA + pump_supply_margin() * (PUMP_SWITCH_HIGH_KPA - PUMP_SWITCH_LOW_KPA);
+    // 上次提交在本区间内的 PWM 周期起点生效: 分两段外推
+    if (obs_duty_at >= 0 && obs_duty_at <= obs_now_us) {
+        for (int ch = 0; ch < 2; ch++) {
+            press_obs_predict(&obs[ch], obs_duty_at, obs_duty[ch * 2], obs_duty[ch * 2 + 1], supply, obs_theta, obs_omega);
+        }
+        memcpy(obs_duty, obs_duty_next, sizeof(obs_duty));
+        obs_duty_at = -1;
+    }
+    for (int ch = 0; ch < 2; ch++) {
+        press_obs_predict(&obs[ch], obs_now_us, obs_duty[ch * 2], obs_duty[ch * 2 + 1], supply, obs_theta, obs_omega);
+        float kpa;
+        int64_t t_us;
+        if (read_pressure_sample(ch, &kpa, &t_us)) press_obs_correct(&obs[ch], kpa, t_us);
+    }
+    return press_obs_usable(&obs[0]) && press_obs_usable(&obs[1]);
+}
+
+// 距上一次采样的间隔 (s)；同一采样重复读取时为 0 (PID 不积分)，首次取回路周期
+static float sample_dt(int64_t *last_us, int64_t t_us, float period_s) {
+    float dt = (*last_us >= 0) ? (float)(t_us - *last_us) * 1e-6f : period_s;
+    *last_us = t_us;
+    return dt;
+}
+
+#if PAM_FIXED_POINT
+static q16_t sample_dt_q16(int64_t *last_us, int64_t t_us, q16_t period) {
+    q16_t dt = (*last_us >= 0) ? q16_ratio(t_us - *last_us, 1000000) : period;
+    *last_us = t_us;
+    return dt;
+}
+#endif
+
+// 角度环 PID (定点路径在此换算: 角度环本身的轨迹与前馈仍为浮点)
+static float angle_pid_compute(float setpoint, float angle, float rate, float dt) {
+    pid_angle.f.setpoint = setpoint;
+#if PAM_FIXED_POINT
+    pid_angle.q.setpoint = q16_from_float(setpoint);
+    return q16_to_float(pid_q_compute_rate(&pid_angle.q, q16_from_float(angle),
+                                           q16_from_float(rate), q16_from_float(dt)));
+#else
+    return pid_timed_compute_rate(&pid_angle.f, angle, rate, dt);
+#endif
+}
+
+/**
+ * @brief 自整定的压力实验: 继电器按原始采样切换与计时 (观测器估计含模型外推，会改变辨识出的
+ * 振荡周期与幅值)
+ * @return bool 本周期由继电器接管，u 为其输出
+ */
+static bool press_tune(int ch, float *u) {
+    if (!autotune_running()) {
+        tune_last_us[ch] = -1;
+        return false;
+    }
+    int64_t t_us = read_pressure_time(ch);
+#if PAM_FIXED_POINT
+    float kpa = q16_to_float(read_pressure_q16(ch));
+#else
+    float kpa = read_pressure(ch);
+#endif
+    float dt = sample_dt(&tune_last_us[ch], t_us, press_period_s);
+    return autotune_press_hook(ch, kpa, dt, u);
+}
+
+/**
+ * @brief 一块肌肉的压力环: 自整定的压力实验期间由继电器接管，否则运行 PID
+ * * 定点路径下气压、采样间隔与 PID 均为 Q16.16，只有输出与 (遥测用的) 气压换算为浮点
+ * @param ch 气压通道 (0: 肌肉A, 1: 肌肉B)
+ * @param press 输出: 本次读到的气压 (kPa)
+ * @return float 有符号阀门指令
+ */
+static float press_control(int ch, loop_pid_t *pid, const press_setpoint_t *sp, float *press) {
+    float u;
+    bool use_obs = params.press_obs != 0;
+    int64_t t_us = use_obs ? obs_now_us : read_pressure_time(ch);
+#if PAM_FIXED_POINT
+    q16_t p = use_obs ? q16_from_float(obs[ch].p_hat) : read_pressure_q16(ch);
+    q16_t dt = sample_dt_q16(&press_last_us[ch], t_us, press_period_q);
+    *press = q16_to_float(p);
+    if (press_tune(ch, &u)) {
+        loop_pid_reset(pid);
+        return u;
+    }
+    pid->q.setpoint = ch == 0 ? sp->q_A : sp->q_B;
+    return q16_to_float(pid_q_compute(&pid->q, p, dt));
+#else
+    *press = use_obs ? obs[ch].p_hat : read_pressure(ch);
+    float dt = sample_dt(&press_last_us[ch], t_us, press_period_s);
+    if (press_tune(ch, &u)) {
+        loop_pid_reset(pid);
+        return u;
+    }
+    pid->f.setpoint = ch == 0 ? sp->press_A : sp->press_B;
+    return pid_timed_compute(&pid->f, *press, dt);
+#endif
+}
+
+/**
+ * @brief 角度外环 (ANGLE_LOOP_PERIOD_TICKS)
+ * * 读取角度，计算压力差并分配给两块拮抗肌肉
+ * @param arg 未使用
+ */
+static void angle_loop(void *arg) {
+    PROF_PERIOD(prof_angle);
+    PROF_MARK(t);
+
+    refresh_params();
+    ff_swap();
+
+    refresh_sensors();
+    float current_angle = read_angle();
+    float angle_vel = read_angle_vel();
+    float dt = sample_dt(&angle_last_us, read_angle_time(), angle_period_s);
+    obs_theta = current_angle / COUNTS_PER_RAD;
+    obs_omega = angle_vel / COUNTS_PER_RAD;
+    PROF_LAP(prof_angle, span_angle_sensor, t);
+
+    // 自整定期间压力差由继电实验给出，轨迹与角度 PID 暂停；结束时从当前位置重新开始
+    traj_ref_t ref = { current_angle, 0.0f, 0.0f };
+    float total, ff = 0.0f, rate_error = 0.0f;
+    int at = autotune_angle_hook(current_angle, dt, ff_table(), &total);
+    if (at == AUTOTUNE_HOOK_END) {
+        loop_pid_reset(&pid_angle);
+        loop_pid_reset(&pid_press_A);
+        loop_pid_reset(&pid_press_B);
+        traj_reset(&traj, current_angle);
+    }
+
+    if (at != AUTOTUNE_HOOK_ACTIVE) {
+        // 轨迹参考: 位置作为设定值，速度/加速度用于微分与前馈
+        // 气源预计即将不足时放慢轨迹时间基准，降低大幅动作的速度与加速度需求，以免储气罐在补气前被抽空
+        float rate = pump_supply_low() ? PUMP_LOW_SUPPLY_SCALE : 1.0f;
+        traj_step(&traj, dt * rate, &ref);
+        ref.vel *= rate;
+        ref.acc *= rate * rate;
+
+        // 目标：计算需要多大的“压力差”才能修正角度误差
+        // 微分项直接使用滤波器的速度估计 (减去参考速度，即作用于速度误差)，不再对含噪误差做差分
+        rate_error = angle_vel - ref.vel;
+        float delta_pressure = angle_pid_compute(ref.pos, current_angle, rate_error, dt);
+
+        // 参考速度/加速度前馈，合计仍受角度环输出限幅约束
+        delta_pressure += params.traj_kv * ref.vel + params.traj_ka * ref.acc;
+        if (delta_pressure > pid_angle.f.out_max) delta_pressure = pid_angle.f.out_max;
+        else if (delta_pressure < pid_angle.f.out_min) delta_pressure = pid_angle.f.out_min;
+
+        // 静态模型前馈: 参考点的平衡压力差，PID 只需修正模型误差；合计不使任一肌肉压力为负
+        ff = params.ff_enable ? pam_ff_lookup(ff_table(), ref.pos, ref.vel) : 0.0f;
+        total = delta_pressure + ff;
+        if (total > params.base_pressure) total = params.base_pressure;
+        else if (total < -params.base_pressure) total = -params.base_pressure;
+    }
+    PROF_LAP(prof_angle, span_angle_pid, t);
+
+    // 压力分配 (拮抗控制)
+    // 肌肉A 目标压力 = 基础压力 + (delta + 前馈)
+    // 肌肉B 目标压力 = 基础压力 - (delta + 前馈)
+    press_setpoint_t sp = {
+        .press_A = params.base_pressure + total,
+        .press_B = params.base_pressure - total,
+    };
+#if PAM_FIXED_POINT
+    sp.q_A = q16_from_float(sp.press_A);
+    sp.q_B = q16_from_float(sp.press_B);
+#endif
+    mailbox_post(&mb_press_sp, &sp);
+    arm_ctrl_state_t st = { ref.pos, ref.vel, ref.acc, total, ff };
+    mailbox_post(&mb_state, &st);
+    PROF_LAP(prof_angle, span_angle_alloc, t);
+
+#if PAM_TELEMETRY_ENABLE
+    telem.v[TELEM_ANGLE]     = current_angle;
+    telem.v[TELEM_ANGLE_SP]  = pid_angle.f.setpoint;
+    telem.v[TELEM_ANGLE_VEL] = angle_vel;
+#if PAM_FIXED_POINT
+    telem.v[TELEM_PID_P]     = q16_to_float(q16_mul(pid_angle.q.kp, pid_angle.q.prev_error));
+    telem.v[TELEM_PID_I]     = q16_to_float(pid_angle.q.integral);
+    telem.v[TELEM_PID_D]     = -q16_to_float(q16_mul(pid_angle.q.kd, pid_angle.q.d_state));
+#else
+    telem.v[TELEM_PID_P]     = pid_angle.f.kp * pid_angle.f.prev_error;
+    telem.v[TELEM_PID_I]     = pid_angle.f.integral;
+    telem.v[TELEM_PID_D]     = -pid_angle.f.kd * pid_angle.f.d_state;
+#endif
+#endif
+
+    // 调试日志 (建议每 500ms 打印一次，不要太快)
+    // ESP_LOGI(TAG, "Ang:%.1f Tgt:%.1f | T_A:%.0f T_B:%.0f",
+    //          current_angle, pid_angle.f.setpoint, sp.press_A, sp.press_B);
+}
+
+/**
+ * @brief 压力内环 (PRESS_LOOP_PERIOD_TICKS)
+ * * 读取最新气压快照 (不阻塞)，计算并输出阀门 PWM
+ * @param arg 未使用
+ */
+static void press_loop(void *arg) {
+#if VALVE_PWM_SYNC
+    // 第一个节拍: PWM 周期起点对齐到 本节拍 + VALVE_PWM_LEAD_US，此后每个周期起点之前都有一次提交
+    if (!pwm_synced) {
+        valves_pwm_sync(clock_fn() + VALVE_PWM_LEAD_US);
+        pwm_synced = true;
+    }
+#endif
+    PROF_PERIOD(prof_press);
+    PROF_MARK(t);
+
+    refresh_params();
+
+    press_setpoint_t sp;
+    mailbox_peek(&mb_press_sp, &sp);
+
+    refresh_sensors();
+    bool use_obs = params.press_obs != 0;
+    bool usable = use_obs ? obs_update() : true;
+    obs_running = use_obs;
+    PROF_LAP(prof_press, span_press_sensor, t);
+
+    // 安全模式: 观测器启用且任一腔压估计不可用时关闭全部阀门保压，PID 复位，恢复后重新开始。
+    // 上电或解除故障后等待首个采样 (INIT) 同样保压，但不计为故障
+    bool safe = use_obs && !usable;
+    bool fault = use_obs && (obs[0].state == PRESS_OBS_FAULT || obs[1].state == PRESS_OBS_FAULT);
+    if (fault && !fault_mode) safe_entries++;
+    fault_mode = fault;
+
+    // 读取气压 (kPa) 并计算有符号阀门指令: 正值充气，负值放气
+    float current_press_A = obs[0].p_hat, current_press_B = obs[1].p_hat;
+    float u_A = 0.0f, u_B = 0.0f;
+    if (safe) {
+        loop_pid_reset(&pid_press_A);
+        loop_pid_reset(&pid_press_B);
+    } else {
+        u_A = press_control(0, &pid_press_A, &sp, &current_press_A); // 假设通道0是肌肉A
+        u_B = press_control(1, &pid_press_B, &sp, &current_press_B); // 假设通道1是肌肉B
+    }
+    PROF_LAP(prof_press, span_press_pid, t);
+
+    // 分配到进/排气阀对 (同一肌肉的两个阀不会同时打开)，经标定表线性化后四路一次提交
+    valve_pair_t vA = valve_alloc(&alloc_cfg, u_A);
+    valve_pair_t vB = valve_alloc(&alloc_cfg, u_B);
+    uint32_t duty[VALVE_NUM] = { vA.in, vA.out, vB.in, vB.out };
+    for (int i = 0; i < VALVE_NUM; i++) {
+        duty[i] = valve_lin_apply(valve_cal_table(i), duty[i], VALVE_MAX_DUTY);
+        obs_duty_next[i] = (float)duty[i] / (float)VALVE_MAX_DUTY;
+    }
+    valve_set_duty_all(duty);
+    obs_duty_at = valves_commit_edge();
+    PROF_LAP(prof_press, span_press_valve, t);
+
+    arm_press_health_t h = {
+        .press_kpa = { current_press_A, current_press_B },
+        .obs_state = { obs[0].state, obs[1].state },
+        .resid_avg = { obs[0].resid_avg, obs[1].resid_avg },
+        .safe_mode = safe,
+        .safe_entries = safe_entries,
+    };
+    mailbox_post(&mb_health, &h);
+
+#if PAM_TELEMETRY_ENABLE
+    telem.v[TELEM_PRESS_SP_A] = sp.press_A;
+    telem.v[TELEM_PRESS_SP_B] = sp.press_B;
+    telem.v[TELEM_PRESS_A]    = current_press_A;
+    telem.v[TELEM_PRESS_B]    = current_press_B;
+    telem.v[TELEM_DUTY_A_IN]  = (float)duty[0];
+    telem.v[TELEM_DUTY_A_OUT] = (float)duty[1];
+    telem.v[TELEM_DUTY_B_IN]  = (float)duty[2];
+    telem.v[TELEM_DUTY_B_OUT] = (float)duty[3];
+    telemetry_push(&telem);
+    PROF_LAP(prof_press, span_press_telem, t);
+#endif
+
+#if PAM_PIPELINE_MODE
+    sensor_pipeline_mark_actuated(&frame);
+#endif
+}
+
+void arm_control_set_clock(int64_t (*clock)(void)) {
+    clock_fn = clock;
+}
 
 /**
  * @brief 初始化控制系统
  */
 void arm_control_init(void) {
-    // 1. 初始化角度环 PID
-    // 输出: 压力差 (kPa)，假设最大允许差值为 150kPa
-    pid_init(&pid_angle, 
-             2.0f,  0.1f, 0.5f,   // Kp, Ki, Kd (需要根据实际调试)
-             -150.0f, 150.0f);    // Output Min, Max
-    pid_angle.dead_zone = 1.0f;   // 1度以内的误差忽略
-
-    // 2. 初始化压力环 PID (肌肉A)
-    // 输出: PWM 占空比 (0 ~ VALVE_MAX_DUTY)
-    pid_init(&pid_press_A,
-             15.0f, 0.5f, 0.0f,             // 压力环通常只需 PI 控制
-             0.0f, (float)VALVE_MAX_DUTY);  // Output 0 ~ 8191
-
-    // 3. 初始化压力环 PID (肌肉B)
-    pid_init(&pid_press_B,
-             15.0f, 0.5f, 0.0f,
-             0.0f, (float)VALVE_MAX_DUTY);
-             
+    // 增益与限幅来自参数表 (param_store_init 须已调用)，默认值见 param_store.c
+    // 参数表的增益按默认周期下“每次调用”的量纲保存 (默认值等效于原 50Hz 下的参数)，
+    // pid_apply 换算为连续时间增益，PID 按实际采样间隔积分/微分
+    params_version = param_store_get(&params);
+    periods_apply();
+    alloc_apply(&params);
+    ff_build(&ff_tabs[0], params.base_pressure);
+    autotune_init();
+
+    // 1. 角度环 PID (默认 100Hz)，输出: 压力差 (kPa)
+    pid_timed_init(&pid_angle.f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f);
+    pid_apply(&pid_angle, &params.angle, ANGLE_LOOP_NOMINAL_S);
+
+    // 2. 压力环 PID (默认 500Hz)，输出: 有符号占空比 (±VALVE_MAX_DUTY)，经 valve_alloc 分配到阀对
+    pid_timed_init(&pid_press_A.f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f);
+    pid_apply(&pid_press_A, &params.press_a, PRESS_LOOP_NOMINAL_S);
+    pid_timed_init(&pid_press_B.f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f);
+    pid_apply(&pid_press_B, &params.press_b, PRESS_LOOP_NOMINAL_S);
+
+    // 4. 轨迹与回路间邮箱，初值为零角度 / 基础气压
+    traj_init(&traj, 0.0f);
+    mailbox_init(&mb_press_sp, &press_sp_buf, sizeof(press_sp_buf));
+    mailbox_init(&mb_state, &state_buf, sizeof(state_buf));
+    press_setpoint_t sp0 = { params.base_pressure, params.base_pressure };
+    arm_ctrl_state_t st0 = { 0 };
+    mailbox_post(&mb_press_sp, &sp0);
+    mailbox_post(&mb_state, &st0);
+    mailbox_init(&mb_health, &health_buf, sizeof(health_buf));
+    arm_press_health_t h0 = { 0 };
+    mailbox_post(&mb_health, &h0);
+    obs_init();
+
+    // 5. 计时插桩
+    prof_angle = loop_prof_register("angle", params.angle_period_ticks * CTRL_BASE_TICK_US);
+    span_angle_sensor = loop_prof_add_span(prof_angle, "sensor");
+    span_angle_pid    = loop_prof_add_span(prof_angle, "outer_pid");
+    span_angle_alloc  = loop_prof_add_span(prof_angle, "alloc");
+    prof_press = loop_prof_register("press", params.press_period_ticks * CTRL_BASE_TICK_US);
+    span_press_sensor = loop_prof_add_span(prof_press, "sensor");
+    span_press_pid    = loop_prof_add_span(prof_press, "inner_pid");
+    span_press_valve  = loop_prof_add_span(prof_press, "valves");
+#if PAM_TELEMETRY_ENABLE
+    span_press_telem  = loop_prof_add_span(prof_press, "telemetry");
+#endif
+
+    // 6. 注册回路：同一节拍内先外环后内环
+    ctrl_sched_init(&sched, CTRL_BASE_TICK_US);
+    ctrl_sched_set_clock(&sched, clock_fn);
+    loop_angle = ctrl_sched_add(&sched, "angle", angle_loop, NULL, params.angle_period_ticks, ANGLE_LOOP_PHASE_TICKS);
+    loop_press = ctrl_sched_add(&sched, "press", press_loop, NULL, params.press_period_ticks, PRESS_LOOP_PHASE_TICKS);
+
+#if !CONFIG_IDF_TARGET_LINUX
+    xTaskCreate(ff_task, "FF_Task", 3072, NULL, PAM_FF_TASK_PRIO, &ff_task_handle);
+#endif
+
     ESP_LOGI(TAG, "PID Controllers Initialized");
 }
 
 /**
- * @brief 设置目标角度
+ * @brief 设置目标角度 (阶跃，排在已有路点之后)
  * * @param angle 目标角度
  */
 void arm_set_target_angle(float angle) {
-    pid_angle.setpoint = angle;
+    arm_move_to(angle, 0.0f, TRAJ_STEP);
 }
 
 /**
- * @brief 机械臂主控制循环任务
- * * @param pvParameters 参数
+ * @brief 追加一个轨迹路点
+ * * @param angle 目标角度
+ * @param duration_s 运动时长
+ * @param profile 速度曲线 (traj_profile_t)
+ * @return bool 路点队列满时返回 false
  */
-void arm_control_task(void *pvParameters) {
-    TickType_t xLastWakeTime;
-    const TickType_t xFrequency = pdMS_TO_TICKS(20); // 50Hz 控制频率
+bool arm_move_to(float angle, float duration_s, int profile) {
+    traj_waypoint_t wp = { angle, duration_s, (uint8_t)profile };
+    if (traj_push(&traj, &wp)) return true;
+    ESP_LOGW(TAG, "Trajectory queue full, waypoint dropped");
+    return false;
+}
 
-    xLastWakeTime = xTaskGetTickCount();
+void arm_control_get_state(arm_ctrl_state_t *out) {
+    mailbox_peek(&mb_state, out);
+}
 
-    while (1) {
-        // --- 1. 读取传感器数据 ---
-        float current_angle = (float)as5600_get_angle(0); // 通道0
-        
-        // 读取气压 (kPa)
-        float current_press_A = (float)pressure_read_kpa(0); // 假设通道0是肌肉A
-        float current_press_B = (float)pressure_read_kpa(1); // 假设通道1是肌肉B
-
-        // --- 2. 外环：位置环计算 ---
-        // 目标：计算需要多大的“压力差”才能修正角度误差
-        float delta_pressure = pid_compute(&pid_angle, current_angle);
-
-        // --- 3. 压力分配 (拮抗控制) ---
-        // 肌肉A 目标压力 = 基础压力 + delta
-        // 肌肉B 目标压力 = 基础压力 - delta
-        float target_press_A = BASE_PRESSURE + delta_pressure;
-        float target_press_B = BASE_PRESSURE - delta_pressure;
-
-        // 设置压力环的目标值
-        pid_press_A.setpoint = target_press_A;
-        pid_press_B.setpoint = target_press_B;
-
-        // --- 4. 内环：压力环计算 ---
-        // 计算阀门 PWM 占空比
-        float duty_A = pid_compute(&pid_press_A, current_press_A);
-        float duty_B = pid_compute(&pid_press_B, current_press_B);
-
-        // --- 5. 执行控制 ---
-        // 更新电磁阀 PWM
-        // 这里假设肌肉只有进气阀控制压力，排气阀常开或由其他逻辑控制
-        // 如果是标准的两位三通充放气控制，PID输出正值充气，负值放气，逻辑会更复杂
-        // 这里简化为：单阀控制充气量，假设有微量排气或被动排气
-        valve_set_duty(0, (uint32_t)duty_A); // 肌肉A 进气
-        valve_set_duty(2, (uint32_t)duty_B); // 肌肉B 进气
-
-        // 调试日志 (建议每 500ms 打印一次，不要太快)
-        // ESP_LOGI(TAG, "Ang:%.1f Tgt:%.1f | P_A:%.0f T_A:%.0f | PWM_A:%d", 
-        //          current_angle, pid_angle.setpoint, 
-        //          current_press_A, target_press_A, (int)duty_A);
-
-        // 保持 50Hz 循环频率
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+void arm_control_get_press_health(arm_press_health_t *out) {
+    mailbox_peek(&mb_health, out);
+}
+
+void arm_control_clear_fault(void) {
+    atomic_store(&obs_clear_req, true);
+}
+
+/**
+ * @brief 打印各回路的截止期错过情况 (仅在有新错过时输出)
+ */
+void arm_control_report(void) {
+    ctrl_sched_report(&sched);
+
+    arm_press_health_t h;
+    arm_control_get_press_health(&h);
+    if (h.safe_entries != safe_reported) {
+        ESP_LOGW(TAG, "Pressure sensor fault: safe mode entered %lu times (now %s), obs state %u/%u, residual %.1f/%.1f kPa",
+                 (unsigned long)h.safe_entries, h.safe_mode ? "on" : "off", h.obs_state[0], h.obs_state[1],
+                 h.resid_avg[0], h.resid_avg[1]);
+        safe_reported = h.safe_entries;
     }
-}
\ No newline at end of file
+
+#if PAM_PIPELINE_MODE
+    sensor_pipeline_stats_t st;
+    sensor_pipeline_get_stats(&st);
+    ESP_LOGD(TAG, "Pipeline: %lu frames, %lu drops, depth %lu/%lu, latency %lu/%lu us (mean/max)",
+             (unsigned long)st.frames, (unsigned long)st.drops, (unsigned long)st.depth,
+             (unsigned long)st.max_depth, (unsigned long)st.mean_latency_us, (unsigned long)st.max_latency_us);
+#endif
+}
+
+/**
+ * @brief 机械臂主控制循环任务
+ * * 运行多速率调度器：角度外环与压力内环各自按周期执行
+ * @param pvParameters 参数
+ */
+void arm_control_task(void *pvParameters) {
+    ctrl_sched_run(&sched);
+}
+
+/**
+ * @brief 同步执行一个调度节拍 (不经过定时器，供仿真按仿真时钟驱动)
+ * * 释放时刻取 arm_control_set_clock 设置的时钟
+ * @param tick 节拍序号
+ */
+void arm_control_step(uint32_t tick) {
+    ctrl_sched_step(&sched, tick, clock_fn());
+}
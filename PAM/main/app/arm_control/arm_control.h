@@ -2,9 +2,57 @@
 #define ARM_CONTROL_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// 角度环最近一个周期的参考量与输出
+typedef struct {
+    float ref_pos;          ///< 参考角度 (计数)
+    float ref_vel;          ///< 参考角速度 (计数/秒)
+    float ref_acc;          ///< 参考角加速度 (计数/秒²)
+    float delta_pressure;   ///< 角度环输出的压力差 (kPa，含前馈)
+    float ff_pressure;      ///< 其中的静态模型前馈 (kPa)
+} arm_ctrl_state_t;
+
+// 压力环最近一个周期的观测器状态
+typedef struct {
+    float    press_kpa[2];      ///< 压力环使用的腔压 (观测器估计或原始读数)
+    uint8_t  obs_state[2];      ///< press_obs_state_t
+    float    resid_avg[2];      ///< 残差平均 (kPa)
+    bool     safe_mode;         ///< 传感器故障: 全部阀门关闭保压
+    uint32_t safe_entries;      ///< 因观测器故障进入安全模式的次数 (等待首个采样不计)
+} arm_press_health_t;
 
 void arm_control_init(void);
+
+// 替换时间戳时钟 (默认 esp_timer_get_time)，在 arm_control_init 之前调用；仿真中设为仿真时钟，
+// 使 PID/轨迹的采样间隔与被控对象的时间一致
+void arm_control_set_clock(int64_t (*clock)(void));
+
+// 目标角度阶跃 (排在已有路点之后)
 void arm_set_target_angle(float angle);
+
+// 追加路点: 在 duration_s 内按 profile (traj_profile_t) 运动到 angle
+// 路点队列为单生产者，只应由一个任务调用；队列满时返回 false
+bool arm_move_to(float angle, float duration_s, int profile);
+
+// 读取角度环的参考量与输出 (无锁快照)
+void arm_control_get_state(arm_ctrl_state_t *out);
+
+// 读取压力环的观测器状态 (无锁快照)
+void arm_control_get_press_health(arm_press_health_t *out);
+
+// 解除锁存的传感器故障 (残差超限)，压力环下一个周期以新读数重新开始；可在任意任务中调用
+void arm_control_clear_fault(void);
+
 void arm_control_task(void *pvParameters);
 
+// 打印控制回路的截止期错过统计 (仅在有新错过时输出)
+void arm_control_report(void);
+
+// 基础气压改变后重建前馈表 (目标上由后台任务调用，仿真中由仿真循环每个节拍调用；无请求时立即返回)
+void arm_control_ff_service(void);
+
+// 同步执行一个调度节拍 (仿真用，正常运行由 arm_control_task 驱动)
+void arm_control_step(uint32_t tick);
+
 #endif // ARM_CONTROL_H
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "autotune.h"
+#include "hardware_config.h"
+#include "param_store.h"
+#include "mailbox.h"
+#include "esp_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+static const char *TAG = "AUTOTUNE";
+
+// 外部请求 (任意任务写，角度环钩子取走)
+#define REQ_NONE    0
+#define REQ_START   1
+#define REQ_ABORT   2
+
+static atomic_int  request;
+static atomic_int  phase_pub;       ///< 当前阶段 (供 autotune_running 无锁查询)
+static atomic_bool save_pending;
+static autotune_cfg_t cfg;          ///< 由 autotune_start 在请求前写入
+
+// 以下只由控制任务访问
+static autotune_status_t status;
+static pam_params_t      saved;     ///< 整定前的参数 (失败时恢复增益)
+static relay_tune_t      relay;
+static autotune_phase_t  next_phase;///< 稳定阶段结束后进入的实验
+static float settle_t;
+static float angle0;                ///< 起始角度: 角度实验的设定值与越限检查的基准
+static bool  end_pending;
+
+static mailbox_t         mb_status;
+static autotune_status_t status_buf;
+
+static const char *loop_grp[AUTOTUNE_LOOP_NUM] = { "press_a", "press_b", "angle" };
+
+static bool active(void) {
+    return status.phase >= AUTOTUNE_SETTLE && status.phase <= AUTOTUNE_ANGLE;
+}
+
+static void publish(void) {
+    mailbox_post(&mb_status, &status);
+    atomic_store(&phase_pub, (int)status.phase);
+}
+
+static float param_max(const char *name) {
+    for (int i = 0; i < param_count(); i++) {
+        if (strcmp(param_desc(i)->name, name) == 0) return param_desc(i)->max;
+    }
+    return 0.0f;
+}
+
+// 写入一组 PID 的增益与积分限幅 (输出限幅与死区不变)
+static bool set_gains(const char *grp, float kp, float ki, float kd, float int_limit) {
+    static const char *fields[] = { "kp", "ki", "kd", "int_limit" };
+    float v[] = { kp, ki, kd, int_limit };
+    char name[24];
+    bool ok = true;
+
+    for (int i = 0; i < 4; i++) {
+        snprintf(name, sizeof(name), "%s.%s", grp, fields[i]);
+        if (i == 3 && v[i] > param_max(name)) v[i] = param_max(name);
+        ok &= param_set(name, v[i]) == ESP_OK;
+    }
+    return ok;
+}
+
+static const param_pid_t *saved_pid(int loop) {
+    return loop == AUTOTUNE_LOOP_PRESS_A ? &saved.press_a
+         : loop == AUTOTUNE_LOOP_PRESS_B ? &saved.press_b : &saved.angle;
+}
+
+static void fail(const char *reason) {
+    for (int i = 0; i < AUTOTUNE_LOOP_NUM; i++) {
+        const param_pid_t *p = saved_pid(i);
+        set_gains(loop_grp[i], p->kp, p->ki, p->kd, p->int_limit);
+    }
+    status.phase = AUTOTUNE_FAILED;
+    status.error = reason;
+    end_pending = true;
+    publish();
+    ESP_LOGW(TAG, "Autotune failed: %s, gains restored", reason);
+}
+
+static void enter_settle(autotune_phase_t next) {
+    status.phase = AUTOTUNE_SETTLE;
+    next_phase = next;
+    settle_t = 0.0f;
+    publish();
+}
+
+/**
+ * @brief 一个继电实验结束: 估计 Ku/Tu，按规则换算为参数表的离散增益并立即生效
+ * * ki = Kp·T / Ti，kd = Kp·Td / T (T 为回路默认周期，与参数表的量纲一致)；
+ * * 积分限幅取使积分项恰好能达到输出上限的值
+ */
+static bool finish_loop(int loop, tune_rule_t rule) {
+    autotune_loop_t *r = &status.loop[loop];
+    float dt = loop == AUTOTUNE_LOOP_ANGLE ? ANGLE_LOOP_NOMINAL_S : PRESS_LOOP_NOMINAL_S;
+    if (!relay_tune_result(&relay, &r->ku, &r->tu, &r->amp)) {
+        fail("no oscillation above hysteresis");
+        return false;
+    }
+
+    tune_gains_t g = tune_rule_gains(rule, r->ku, r->tu);
+    r->kp = g.kp;
+    r->ki = g.ti > 0.0f ? g.kp * dt / g.ti : 0.0f;
+    r->kd = g.kp * g.td / dt;
+    float int_limit = r->ki > 0.0f ? saved_pid(loop)->out_max / r->ki : saved_pid(loop)->int_limit;
+
+    ESP_LOGI(TAG, "%s: Ku %.3g, Tu %.3f s, a %.2f -> %s kp %.4g ki %.4g kd %.4g", loop_grp[loop],
+             r->ku, r->tu, r->amp, tune_rule_name(rule), r->kp, r->ki, r->kd);
+    if (!set_gains(loop_grp[loop], r->kp, r->ki, r->kd, int_limit)) {
+        fail("tuned gains out of parameter range");
+        return false;
+    }
+    r->valid = true;
+    return true;
+}
+
+void autotune_init(void) {
+    memset(&status, 0, sizeof(status));
+    mailbox_init(&mb_status, &status_buf, sizeof(status_buf));
+    publish();
+}
+
+esp_err_t autotune_start(const autotune_cfg_t *c) {
+    float exhaust = 0.0f;
+    if (autotune_running()) return ESP_ERR_INVALID_STATE;
+    if (c->rule_press >= TUNE_RULE_NUM || c->rule_angle >= TUNE_RULE_NUM) return ESP_ERR_INVALID_ARG;
+    param_get("valve_exhaust", &exhaust);
+    if (exhaust == 0.0f) {
+        ESP_LOGW(TAG, "Autotune needs exhaust valves (valve_exhaust = 1)");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    cfg = *c;
+    atomic_store_explicit(&request, REQ_START, memory_order_release);
+    return ESP_OK;
+}
+
+void autotune_abort(void) {
+    atomic_store_explicit(&request, REQ_ABORT, memory_order_release);
+}
+
+bool autotune_running(void) {
+    int ph = atomic_load(&phase_pub);
+    return atomic_load(&request) == REQ_START || (ph >= AUTOTUNE_SETTLE && ph <= AUTOTUNE_ANGLE);
+}
+
+void autotune_get_status(autotune_status_t *out) {
+    mailbox_peek(&mb_status, out);
+}
+
+void autotune_poll(void) {
+    if (!atomic_exchange(&save_pending, false)) return;
+    esp_err_t err = param_store_save();
+    if (err == ESP_OK) ESP_LOGI(TAG, "Tuned gains saved to NVS");
+    else ESP_LOGW(TAG, "Saving tuned gains failed: %s", esp_err_to_name(err));
+}
+
+int autotune_angle_hook(float angle, float dt, const pam_ff_t *ff, float *dp) {
+    int req = atomic_exchange_explicit(&request, REQ_NONE, memory_order_acquire);
+    if (req == REQ_START && !active()) {
+        param_store_get(&saved);
+        memset(status.loop, 0, sizeof(status.loop));
+        status.error = NULL;
+        angle0 = angle;
+        end_pending = false;
+        ESP_LOGI(TAG, "Autotune started at angle %.0f (%s / %s)", angle,
+                 tune_rule_name(cfg.rule_press), tune_rule_name(cfg.rule_angle));
+        enter_settle(AUTOTUNE_PRESS_A);
+    } else if (req == REQ_ABORT && active()) {
+        fail("aborted");
+    }
+
+    if (active() && fabsf(angle - angle0) > cfg.angle_span) fail("angle limit");
+
+    *dp = 0.0f;     // 稳定阶段与压力实验期间两肌肉保持基础气压
+    switch (status.phase) {
+    case AUTOTUNE_SETTLE:
+        settle_t += dt;
+        if (settle_t < AUTOTUNE_SETTLE_S) break;
+        status.phase = next_phase;
+        if (next_phase == AUTOTUNE_ANGLE) {
+            relay_tune_init(&relay, angle0, pam_ff_lookup(ff, angle0, 0.0f), AUTOTUNE_ANGLE_RELAY_KPA,
+                            AUTOTUNE_ANGLE_HYST, AUTOTUNE_SKIP_CYCLES, AUTOTUNE_CYCLES, AUTOTUNE_ANGLE_TIMEOUT_S);
+        } else {
+            relay_tune_init(&relay, saved.base_pressure, 0.0f, AUTOTUNE_PRESS_RELAY_DUTY,
+                            AUTOTUNE_PRESS_HYST_KPA, AUTOTUNE_SKIP_CYCLES, AUTOTUNE_CYCLES, AUTOTUNE_PRESS_TIMEOUT_S);
+        }
+        publish();
+        break;
+
+    case AUTOTUNE_ANGLE: {
+        relay_status_t st = relay_tune_update(&relay, angle, dt, dp);
+        if (*dp > saved.base_pressure) *dp = saved.base_pressure;
+        else if (*dp < -saved.base_pressure) *dp = -saved.base_pressure;
+
+        if (st == RELAY_TIMEOUT) {
+            fail("angle relay timeout");
+        } else if (st == RELAY_DONE && finish_loop(AUTOTUNE_LOOP_ANGLE, cfg.rule_angle)) {
+            status.phase = AUTOTUNE_DONE;
+            end_pending = true;
+            if (cfg.save) atomic_store(&save_pending, true);
+            publish();
+            ESP_LOGI(TAG, "Autotune done");
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    if (end_pending) {
+        end_pending = false;
+        return AUTOTUNE_HOOK_END;
+    }
+    return active() ? AUTOTUNE_HOOK_ACTIVE : AUTOTUNE_HOOK_OFF;
+}
+
+bool autotune_press_hook(int muscle, float press, float dt, float *u) {
+    if (!active()) return false;
+    if (press > cfg.press_max_kpa) {
+        fail("pressure limit");     // 本周期起由 PID 接管，设定值仍为基础气压
+        return false;
+    }
+
+    autotune_phase_t ph = muscle == 0 ? AUTOTUNE_PRESS_A : AUTOTUNE_PRESS_B;
+    if (status.phase != ph) return false;
+
+    relay_status_t st = relay_tune_update(&relay, press, dt, u);
+    if (st == RELAY_TIMEOUT) {
+        fail("pressure relay timeout");
+        return false;
+    }
+    if (st == RELAY_DONE) {
+        int loop = muscle == 0 ? AUTOTUNE_LOOP_PRESS_A : AUTOTUNE_LOOP_PRESS_B;
+        if (finish_loop(loop, cfg.rule_press)) {
+            enter_settle(muscle == 0 ? AUTOTUNE_PRESS_B : AUTOTUNE_ANGLE);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+//继电反馈自整定
+//在控制任务内以状态机运行: 两肌肉保持基础气压稳定 -> 肌肉A 压力环继电实验 -> 肌肉B 压力环
+//继电实验 -> 以新的内环增益做角度环继电实验 (中心输出为模型前馈)。每个实验由 relay_tune
+//估计 Ku/Tu，按所选规则换算增益后经 param_store 生效；全程监视肌肉压力与关节偏移，
+//越限或超时立即中止并恢复整定前的增益。成功后可由低优先级任务写入 NVS。
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "hardware_config.h"
+#include "relay_tune.h"
+#include "pam_ff.h"
+
+typedef enum {
+    AUTOTUNE_IDLE = 0,
+    AUTOTUNE_SETTLE,                    ///< 两肌肉保持基础气压，等待稳定
+    AUTOTUNE_PRESS_A,                   ///< 肌肉A 压力环继电实验
+    AUTOTUNE_PRESS_B,                   ///< 肌肉B 压力环继电实验
+    AUTOTUNE_ANGLE,                     ///< 角度环继电实验
+    AUTOTUNE_DONE,
+    AUTOTUNE_FAILED,
+} autotune_phase_t;
+
+// 被整定的回路
+enum {
+    AUTOTUNE_LOOP_PRESS_A = 0,
+    AUTOTUNE_LOOP_PRESS_B,
+    AUTOTUNE_LOOP_ANGLE,
+    AUTOTUNE_LOOP_NUM,
+};
+
+// 角度环钩子的返回值
+enum {
+    AUTOTUNE_HOOK_OFF = 0,              ///< 未在整定，正常控制
+    AUTOTUNE_HOOK_ACTIVE,               ///< 整定中，压力差由整定给出
+    AUTOTUNE_HOOK_END,                  ///< 整定刚结束 (一次)，调用者应复位控制器并保持当前位置
+};
+
+typedef struct {
+    uint8_t rule_press;                 ///< 压力环整定规则 (tune_rule_t)
+    uint8_t rule_angle;                 ///< 角度环整定规则
+    float   press_max_kpa;              ///< 任一肌肉压力超过即中止
+    float   angle_span;                 ///< 关节偏离起始角度超过即中止 (计数)
+    bool    save;                       ///< 成功后写入 NVS (由 autotune_poll 执行)
+} autotune_cfg_t;
+
+#define AUTOTUNE_CFG_DEFAULT { TUNE_RULE_TL_PI, TUNE_RULE_NO_OVERSHOOT, \
+                               AUTOTUNE_PRESS_MAX_KPA, AUTOTUNE_ANGLE_SPAN, true }
+
+typedef struct {
+    bool  valid;
+    float ku, tu;                       ///< 临界增益与周期 (s)
+    float amp;                          ///< 振荡幅值 (半峰峰值)
+    float kp, ki, kd;                   ///< 换算后的增益 (与 param_pid_t 同义)
+} autotune_loop_t;
+
+typedef struct {
+    autotune_phase_t phase;
+    const char      *error;             ///< 失败原因 (FAILED 时有效)
+    autotune_loop_t  loop[AUTOTUNE_LOOP_NUM];
+} autotune_status_t;
+
+// 控制任务初始化时调用
+void autotune_init(void);
+
+// 请求开始整定 (任意任务)，在下一个角度环周期生效
+// 返回 ESP_ERR_INVALID_STATE: 正在整定或未开启排气阀 (压力环继电实验需要双向输出)
+esp_err_t autotune_start(const autotune_cfg_t *cfg);
+
+// 请求中止，恢复整定前的增益
+void autotune_abort(void);
+
+bool autotune_running(void);
+
+// 读取状态 (无锁快照)
+void autotune_get_status(autotune_status_t *out);
+
+// 低优先级任务中周期调用: 整定成功且要求保存时写入 NVS
+void autotune_poll(void);
+
+// ---- 以下只由控制任务调用 ----
+
+// 角度环: 返回 AUTOTUNE_HOOK_*；ACTIVE 时 *dp 为压力差 (A = base + dp, B = base - dp)
+// ff: 模型前馈表，角度实验以起始角度处的平衡压力差为继电器中心
+int autotune_angle_hook(float angle, float dt, const pam_ff_t *ff, float *dp);
+
+// 压力环: 返回 true 时 *u 为该肌肉的阀门指令 (有符号占空比)，调用者不运行该肌肉的 PID
+bool autotune_press_hook(int muscle, float press, float dt, float *u);
+
+#endif // AUTOTUNE_H
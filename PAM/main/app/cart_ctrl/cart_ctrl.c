@@ -0,0 +1,93 @@
+#include "cart_ctrl.h"
+#include <string.h>
+
+void cart_ctrl_arm(ik_arm_t *arm, const joint_desc_t *shoulder, const joint_desc_t *elbow,
+                   float l1_mm, float l2_mm, float elbow_margin_rad) {
+    arm->l1 = l1_mm;
+    arm->l2 = l2_mm;
+    arm->q_min[0] = shoulder->angle_min / CART_COUNTS_PER_RAD;
+    arm->q_max[0] = shoulder->angle_max / CART_COUNTS_PER_RAD;
+    arm->q_min[1] = elbow->angle_min / CART_COUNTS_PER_RAD;
+    arm->q_max[1] = elbow->angle_max / CART_COUNTS_PER_RAD;
+    arm->q2_margin = elbow_margin_rad;
+}
+
+void cart_ctrl_init(cart_ctrl_t *c, const ik_table_t *ik, int j_shoulder, int j_elbow) {
+    memset(c, 0, sizeof(*c));
+    c->ik = ik;
+    c->joint[0] = j_shoulder;
+    c->joint[1] = j_elbow;
+    spsc_ring_init(&c->queue, c->queue_buf, CART_QUEUE_LEN, sizeof(cart_waypoint_t));
+    traj_init(&c->axis[0], 0.0f);
+    traj_init(&c->axis[1], 0.0f);
+    c->status = IK_OK;
+    atomic_init(&c->release, false);
+}
+
+bool cart_ctrl_move_to(cart_ctrl_t *c, float x, float y, float duration_s, int profile) {
+    cart_waypoint_t wp = { x, y, duration_s, (uint8_t)profile };
+    return spsc_ring_push(&c->queue, &wp);
+}
+
+// 从两关节的最近一次实测角度起步 (只在接管时算一次正运动学)
+static void cart_ctrl_activate(cart_ctrl_t *c, joint_rt_t *rt) {
+    float q[2] = {
+        rt->joints[c->joint[0]].angle.angle / CART_COUNTS_PER_RAD,
+        rt->joints[c->joint[1]].angle.angle / CART_COUNTS_PER_RAD,
+    };
+    ik_forward(&c->ik->arm, q, &c->x_ref, &c->y_ref);
+    traj_reset(&c->axis[0], c->x_ref);
+    traj_reset(&c->axis[1], c->y_ref);
+    c->active = true;
+}
+
+void cart_ctrl_release(cart_ctrl_t *c) {
+    atomic_store(&c->release, true);
+}
+
+// 交还两关节 (队列在这里由消费者清空，请求之后追加的路点会被一并丢弃)
+static void cart_ctrl_deactivate(cart_ctrl_t *c, joint_rt_t *rt) {
+    cart_waypoint_t wp;
+    while (spsc_ring_pop(&c->queue, &wp)) {
+    }
+    traj_reset(&c->axis[0], c->x_ref);
+    traj_reset(&c->axis[1], c->y_ref);
+    if (c->active) {
+        joint_rt_clear_ref(rt, c->joint[0]);
+        joint_rt_clear_ref(rt, c->joint[1]);
+    }
+    c->active = false;
+}
+
+void cart_ctrl_step(cart_ctrl_t *c, joint_rt_t *rt, float dt) {
+    if (atomic_load_explicit(&c->release, memory_order_relaxed) && atomic_exchange(&c->release, false)) {
+        cart_ctrl_deactivate(c, rt);
+    }
+
+    // 当前段结束后两轴同时取下一路点，保持同步
+    if (!traj_busy(&c->axis[0]) && spsc_ring_depth(&c->queue) > 0) {
+        cart_waypoint_t wp;
+        spsc_ring_pop(&c->queue, &wp);
+        if (!c->active) cart_ctrl_activate(c, rt);
+        traj_waypoint_t wx = { wp.x, wp.duration_s, wp.profile };
+        traj_waypoint_t wy = { wp.y, wp.duration_s, wp.profile };
+        traj_push(&c->axis[0], &wx);
+        traj_push(&c->axis[1], &wy);
+    }
+    if (!c->active) return;
+
+    traj_ref_t rx, ry;
+    traj_step(&c->axis[0], dt, &rx);
+    traj_step(&c->axis[1], dt, &ry);
+    c->x_ref = rx.pos;
+    c->y_ref = ry.pos;
+
+    ik_sol_t sol;
+    c->status = ik_table_lookup(c->ik, rx.pos, ry.pos, &sol);
+    if (c->status != IK_OK) c->clamped++;
+
+    for (int i = 0; i < 2; i++) {
+        float vel = sol.dq[i][0] * rx.vel + sol.dq[i][1] * ry.vel;
+        joint_rt_set_ref(rt, c->joint[i], sol.q[i] * CART_COUNTS_PER_RAD, vel * CART_COUNTS_PER_RAD);
+    }
+}
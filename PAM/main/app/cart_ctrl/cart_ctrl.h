@@ -0,0 +1,61 @@
+//任务空间 (笛卡尔) 控制: 平面两连杆末端的位置命令与直线路径
+//末端路点 (x, y, 时长, 速度曲线) 经无锁队列下发；调度任务每个基础节拍生成 x/y 两轴的同步
+//轨迹参考 (同一归一化曲线，末端走直线)，查 ik_table 得到肩/肘两关节的参考角与参考角速度
+//(逆雅可比 × 末端速度)，作为 joint_rt 中这两个关节的外部参考。
+//第一个路点到达时从两关节的实测角度 (正运动学) 起步；目标不可达时钳位到最近可达节点并计数。
+//cart_ctrl_release 交还两关节，之后由各自的关节路点控制。
+//关节计数 0 对应 q = 0 (两连杆共线)，正方向相同。
+
+#ifndef CART_CTRL_H
+#define CART_CTRL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "ik_table.h"
+#include "joint_rt.h"
+#include "traj.h"
+#include "spsc_ring.h"
+
+#define CART_QUEUE_LEN      8                       // 末端路点队列长度 (2 的幂)
+#define CART_COUNTS_PER_RAD (4096.0f / 6.28318531f) // AS5600 计数 / 弧度
+
+// 末端路点: 在 duration_s 内直线运动到 (x, y) (mm)
+typedef struct {
+    float   x, y;
+    float   duration_s;
+    uint8_t profile;                    ///< traj_profile_t
+} cart_waypoint_t;
+
+typedef struct {
+    const ik_table_t *ik;
+    int         joint[2];               ///< joint_rt 中的肩/肘关节
+    spsc_ring_t queue;
+    cart_waypoint_t queue_buf[CART_QUEUE_LEN];
+    atomic_bool release;                ///< cart_ctrl_release 的请求，由调度任务执行
+
+    // 以下仅调度任务访问
+    traj_t      axis[2];                ///< x/y 轨迹 (mm)
+    bool        active;                 ///< 已接管两关节的参考
+    float       x_ref, y_ref;           ///< 最近一次末端参考
+    ik_status_t status;                 ///< 最近一次查表结果
+    uint32_t    clamped;                ///< 参考不可达的节拍数
+} cart_ctrl_t;
+
+// 由两个关节的描述表限位 (计数) 与连杆长度组成 ik_arm_t
+void cart_ctrl_arm(ik_arm_t *arm, const joint_desc_t *shoulder, const joint_desc_t *elbow,
+                   float l1_mm, float l2_mm, float elbow_margin_rad);
+
+void cart_ctrl_init(cart_ctrl_t *c, const ik_table_t *ik, int j_shoulder, int j_elbow);
+
+// 生产者: 追加末端路点，队列满时返回 false
+bool cart_ctrl_move_to(cart_ctrl_t *c, float x, float y, float duration_s, int profile);
+
+// 生产者: 请求结束任务空间控制。调度任务在下一次 cart_ctrl_step 中丢弃未执行的末端路点，
+// 两关节静止于最后一次参考并回到各自的关节轨迹；之后的 cart_ctrl_move_to 重新从实测角度接管
+void cart_ctrl_release(cart_ctrl_t *c);
+
+// 调度任务: 前进 dt 并设置两关节的外部参考 (在 joint_rt_tick 之前调用)；收到第一个路点前不做任何事
+void cart_ctrl_step(cart_ctrl_t *c, joint_rt_t *rt, float dt);
+
+#endif // CART_CTRL_H
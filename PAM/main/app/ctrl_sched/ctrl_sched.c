@@ -0,0 +1,131 @@
+//多速率控制调度器
+//esp_timer 以基础节拍唤醒调度任务，每个回路有独立的周期与相位，
+//回路完成时间超过 (释放时刻 + 周期) 或因调度落后被跳过时记为一次截止期错过。
+
+#include "ctrl_sched.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "CTRL_SCHED";
+
+static void ctrl_sched_tick_cb(void *arg) {
+    ctrl_sched_t *s = (ctrl_sched_t *)arg;
+    atomic_fetch_add_explicit(&s->ticks, 1, memory_order_relaxed);
+    xTaskNotifyGive(s->task);
+}
+
+static inline int loop_due(const ctrl_loop_t *l, uint32_t tick) {
+    return tick >= l->phase_ticks && ((tick - l->phase_ticks) % l->period_ticks) == 0;
+}
+
+void ctrl_sched_init(ctrl_sched_t *s, uint32_t tick_us) {
+    memset(s, 0, sizeof(*s));
+    s->tick_us = tick_us;
+    atomic_init(&s->ticks, 0);
+    s->clock = esp_timer_get_time;
+}
+
+void ctrl_sched_set_clock(ctrl_sched_t *s, int64_t (*clock)(void)) {
+    s->clock = clock;
+}
+
+int ctrl_sched_add(ctrl_sched_t *s, const char *name, ctrl_loop_fn_t fn, void *arg,
+                   uint32_t period_ticks, uint32_t phase_ticks) {
+    if (s->num_loops >= CTRL_SCHED_MAX_LOOPS || period_ticks == 0) return -1;
+
+    ctrl_loop_t *l = &s->loops[s->num_loops];
+    l->name = name;
+    l->fn = fn;
+    l->arg = arg;
+    l->period_ticks = period_ticks;
+    l->phase_ticks = phase_ticks % period_ticks;
+
+    ESP_LOGI(TAG, "Loop '%s': %lu us period, phase %lu us", name,
+             (unsigned long)(period_ticks * s->tick_us), (unsigned long)(l->phase_ticks * s->tick_us));
+    return s->num_loops++;
+}
+
+void ctrl_sched_set_period(ctrl_sched_t *s, int idx, uint32_t period_ticks) {
+    if (idx < 0 || idx >= s->num_loops || period_ticks == 0) return;
+
+    ctrl_loop_t *l = &s->loops[idx];
+    if (l->period_ticks == period_ticks) return;
+    l->period_ticks = period_ticks;
+    l->phase_ticks %= period_ticks;
+    ESP_LOGI(TAG, "Loop '%s': period now %lu us", l->name, (unsigned long)(period_ticks * s->tick_us));
+}
+
+/**
+ * @brief 调度主循环
+ * * @param s 调度器
+ */
+void ctrl_sched_run(ctrl_sched_t *s) {
+    s->task = xTaskGetCurrentTaskHandle();
+
+    const esp_timer_create_args_t args = {
+        .callback = ctrl_sched_tick_cb,
+        .arg = s,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ctrl_tick",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &s->timer));
+    s->start_us = s->clock();
+    ESP_ERROR_CHECK(esp_timer_start_periodic(s->timer, s->tick_us));
+
+    uint32_t done = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t tick = atomic_load_explicit(&s->ticks, memory_order_relaxed);
+
+        // 1. 调度落后：被跳过节拍上到期的回路记为错过，不做补偿性连续执行
+        while (tick - done > 1) {
+            done++;
+            for (int i = 0; i < s->num_loops; i++) {
+                if (loop_due(&s->loops[i], done)) s->loops[i].stats.misses++;
+            }
+        }
+        done = tick;
+
+        // 2. 执行本节拍到期的回路
+        ctrl_sched_step(s, tick, s->start_us + (int64_t)tick * s->tick_us);
+    }
+}
+
+void ctrl_sched_step(ctrl_sched_t *s, uint32_t tick, int64_t release_us) {
+    for (int i = 0; i < s->num_loops; i++) {
+        ctrl_loop_t *l = &s->loops[i];
+        if (!loop_due(l, tick)) continue;
+
+        int64_t t0 = s->clock();
+        l->fn(l->arg);
+        int64_t t1 = s->clock();
+
+        uint32_t exec_us = (uint32_t)(t1 - t0);
+        l->stats.runs++;
+        l->stats.last_exec_us = exec_us;
+        if (exec_us > l->stats.max_exec_us) l->stats.max_exec_us = exec_us;
+        if (t1 > release_us + (int64_t)l->period_ticks * s->tick_us) l->stats.misses++;
+    }
+}
+
+void ctrl_sched_get_stats(const ctrl_sched_t *s, int idx, ctrl_loop_stats_t *out) {
+    if (idx < 0 || idx >= s->num_loops) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = s->loops[idx].stats;
+}
+
+void ctrl_sched_report(ctrl_sched_t *s) {
+    for (int i = 0; i < s->num_loops; i++) {
+        ctrl_loop_t *l = &s->loops[i];
+        uint32_t misses = l->stats.misses;
+        if (misses == l->reported_misses) continue;
+
+        ESP_LOGW(TAG, "Loop '%s': %lu new deadline misses (total %lu / %lu runs, max exec %lu us)",
+                 l->name, (unsigned long)(misses - l->reported_misses), (unsigned long)misses,
+                 (unsigned long)l->stats.runs, (unsigned long)l->stats.max_exec_us);
+        l->reported_misses = misses;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef CTRL_SCHED_H
+#define CTRL_SCHED_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#define CTRL_SCHED_MAX_LOOPS 4
+
+typedef void (*ctrl_loop_fn_t)(void *arg);
+
+// 单个回路的运行统计
+typedef struct {
+    uint32_t runs;          ///< 已执行次数
+    uint32_t misses;        ///< 错过截止期次数 (超时完成或因调度落后被跳过)
+    uint32_t last_exec_us;  ///< 最近一次执行耗时
+    uint32_t max_exec_us;   ///< 最大执行耗时
+} ctrl_loop_stats_t;
+
+typedef struct {
+    const char    *name;
+    ctrl_loop_fn_t fn;
+    void          *arg;
+    uint32_t       period_ticks;   ///< 周期 (基础节拍数)
+    uint32_t       phase_ticks;    ///< 相位偏移 (基础节拍数)，用于错开各回路的负载
+    ctrl_loop_stats_t stats;
+    uint32_t       reported_misses;
+} ctrl_loop_t;
+
+// 多速率调度器：esp_timer 产生基础节拍，调度任务按各回路的周期/相位依次执行
+typedef struct {
+    ctrl_loop_t        loops[CTRL_SCHED_MAX_LOOPS];
+    int                num_loops;
+    uint32_t           tick_us;
+    TaskHandle_t       task;
+    esp_timer_handle_t timer;
+    atomic_uint        ticks;
+    int64_t            start_us;
+    int64_t          (*clock)(void);  ///< 节拍释放与回路完成时刻 (默认 esp_timer_get_time)
+} ctrl_sched_t;
+
+// 初始化调度器，tick_us 为基础节拍周期
+void ctrl_sched_init(ctrl_sched_t *s, uint32_t tick_us);
+
+// 替换时钟 (仿真中为仿真时钟，与 ctrl_sched_step 的 release_us 同源)
+void ctrl_sched_set_clock(ctrl_sched_t *s, int64_t (*clock)(void));
+
+// 注册回路，同一节拍内按注册顺序执行；返回回路索引，失败返回 -1
+int ctrl_sched_add(ctrl_sched_t *s, const char *name, ctrl_loop_fn_t fn, void *arg,
+                   uint32_t period_ticks, uint32_t phase_ticks);
+
+// 修改回路周期 (相位保持不变)，只能在调度任务中调用 (如回路函数内)，下一节拍生效
+void ctrl_sched_set_period(ctrl_sched_t *s, int idx, uint32_t period_ticks);
+
+// 在调用者任务中运行调度器 (不返回)
+void ctrl_sched_run(ctrl_sched_t *s);
+
+// 执行第 tick 个节拍上到期的回路 (由 ctrl_sched_run 调用；仿真中可直接按仿真时钟驱动)
+// release_us: 该节拍的释放时刻，用于截止期判断
+void ctrl_sched_step(ctrl_sched_t *s, uint32_t tick, int64_t release_us);
+
+// 读取回路统计
+void ctrl_sched_get_stats(const ctrl_sched_t *s, int idx, ctrl_loop_stats_t *out);
+
+// 打印自上次报告以来出现新截止期错过的回路
+void ctrl_sched_report(ctrl_sched_t *s);
+
+#endif // CTRL_SCHED_H
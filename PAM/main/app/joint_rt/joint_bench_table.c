@@ -0,0 +1,18 @@
+//开销基准用的关节描述表 (sim/sim_main.c 的多关节仿真与 bench/bench_main.c 的 joint_rt 微基准)
+//通道映射与合成关节的判定见 joint_rt.h 中 JOINT_BENCH_SYNTHETIC 的说明。
+
+#include "joint_rt.h"
+
+#define BENCH_JOINT(n) {                                                        \
+    .name = "j" #n, .angle_ch = n, .press_ch = { 2 * (n), 2 * (n) + 1 },        \
+    .angle = JOINT_ANGLE_PID_DEFAULT, .press = JOINT_PRESS_PID_DEFAULT,         \
+    .base_pressure = BASE_PRESSURE, .angle_min = -1024.0f, .angle_max = 1024.0f }
+
+const joint_desc_t joint_bench_table[JOINT_MAX] = {
+    BENCH_JOINT(0), BENCH_JOINT(1),                                     // 本机硬件
+    BENCH_JOINT(2), BENCH_JOINT(3),                                     // 合成: 无 LEDC 通道
+    BENCH_JOINT(4), BENCH_JOINT(5), BENCH_JOINT(6), BENCH_JOINT(7),     // 合成: 气压通道超出 MUX
+};
+
+_Static_assert(JOINT_MAX == 8, "update joint_bench_table for the new JOINT_MAX");
+_Static_assert(JOINT_HW_MAX == 2 && PRESS_MUX_CHANNELS == 8, "update the synthetic row comments");
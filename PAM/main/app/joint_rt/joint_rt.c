@@ -0,0 +1,208 @@
+#include "joint_rt.h"
+#include <string.h>
+
+// 采样龄 (us)，时钟不同步导致的负值按 0 计
+static uint32_t sample_age(int64_t now_us, int64_t t_us) {
+    return now_us > t_us ? (uint32_t)(now_us - t_us) : 0;
+}
+
+// 距上一次采样的间隔 (s)；同一采样重复读取时为 0 (PID 不积分)，首次取回路周期
+static float sample_dt(int64_t *last_us, int64_t t_us, float period_s) {
+    float dt = (*last_us >= 0) ? (float)(t_us - *last_us) * 1e-6f : period_s;
+    *last_us = t_us;
+    return dt;
+}
+
+#if PAM_FIXED_POINT
+static q16_t sample_dt_q16(int64_t *last_us, int64_t t_us, q16_t period) {
+    q16_t dt = (*last_us >= 0) ? q16_ratio(t_us - *last_us, 1000000) : period;
+    *last_us = t_us;
+    return dt;
+}
+#endif
+
+static void joint_pid_init(joint_pid_t *p, const param_pid_t *gains, float t_nom) {
+    pid_timed_init(&p->f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f);
+    param_pid_apply(gains, t_nom, &p->f);
+#if PAM_FIXED_POINT
+    pid_q_config(&p->q, &p->f);
+    pid_q_reset(&p->q);
+#endif
+}
+
+void joint_rt_init(joint_rt_t *rt, const joint_desc_t *table, int n, const joint_io_t *io) {
+    if (n > JOINT_MAX) n = JOINT_MAX;
+    memset(rt, 0, sizeof(*rt));
+    rt->n = n;
+    rt->io = *io;
+    rt->angle_period = ANGLE_LOOP_PERIOD_TICKS;
+    rt->press_period = PRESS_LOOP_PERIOD_TICKS;
+    rt->angle_period_s = ANGLE_LOOP_NOMINAL_S;
+    rt->press_period_s = PRESS_LOOP_NOMINAL_S;
+#if PAM_FIXED_POINT
+    rt->press_period_q = q16_ratio(PRESS_LOOP_PERIOD_TICKS * CTRL_BASE_TICK_US, 1000000);
+#endif
+
+    mailbox_init(&rt->mb_stats, rt->stats_buf, sizeof(rt->stats_buf));
+
+    rt->alloc.dead_band = VALVE_DEAD_BAND;
+    rt->alloc.min_pulse = VALVE_MIN_PULSE;      // 多关节不做阀门标定
+    rt->alloc.max_duty = (float)VALVE_MAX_DUTY;
+    rt->alloc.exhaust = true;
+
+    for (int j = 0; j < n; j++) {
+        joint_t *jt = &rt->joints[j];
+        const joint_desc_t *d = &table[j];
+        jt->d = d;
+        joint_pid_init(&jt->angle_pid, &d->angle, ANGLE_LOOP_NOMINAL_S);
+        joint_pid_init(&jt->press_pid[0], &d->press, PRESS_LOOP_NOMINAL_S);
+        joint_pid_init(&jt->press_pid[1], &d->press, PRESS_LOOP_NOMINAL_S);
+        traj_init(&jt->traj, 0.0f);
+        jt->angle_last_us = -1;
+        jt->press_last_us[0] = jt->press_last_us[1] = -1;
+        jt->press_sp[0] = jt->press_sp[1] = d->base_pressure;
+
+        // 相位均匀错开: 每节拍到期的关节数为 ceil(n / 周期)
+        jt->angle_phase = (uint8_t)(j * rt->angle_period / n);
+        jt->press_phase = (uint8_t)(j * rt->press_period / n);
+    }
+}
+
+// 角度环 PID (定点路径在此换算: 轨迹仍为浮点)
+static float angle_pid_compute(joint_pid_t *p, float setpoint, float angle, float rate, float dt) {
+    p->f.setpoint = setpoint;
+#if PAM_FIXED_POINT
+    p->q.setpoint = q16_from_float(setpoint);
+    return q16_to_float(pid_q_compute_rate(&p->q, q16_from_float(angle), q16_from_float(rate), q16_from_float(dt)));
+#else
+    return pid_timed_compute_rate(&p->f, angle, rate, dt);
+#endif
+}
+
+/**
+ * @brief 关节角度环: 读取角度 (本关节的采集时间片)，按轨迹参考计算两块肌肉的压力设定值
+ * * 读取失败时保持上一次的设定值
+ */
+static void joint_angle_step(joint_rt_t *rt, joint_t *jt, int64_t now_us) {
+    const joint_desc_t *d = jt->d;
+
+    if (!rt->io.read_angle(rt->io.ctx, d->angle_ch, &jt->angle)) {
+        jt->st.angle_faults++;
+        return;
+    }
+    uint32_t age = sample_age(now_us, jt->angle.t_us);
+    jt->st.angle_reads++;
+    jt->st.angle_age_sum_us += age;
+    if (age > jt->st.angle_age_max_us) jt->st.angle_age_max_us = age;
+
+    float dt = sample_dt(&jt->angle_last_us, jt->angle.t_us, rt->angle_period_s);
+
+    traj_ref_t ref;
+    if (jt->ext_ref) ref = jt->ext;
+    else traj_step(&jt->traj, dt, &ref);
+    float total = angle_pid_compute(&jt->angle_pid, ref.pos, jt->angle.angle, jt->angle.vel - ref.vel, dt);
+    if (total > d->base_pressure) total = d->base_pressure;
+    else if (total < -d->base_pressure) total = -d->base_pressure;
+
+    jt->total = total;
+    jt->press_sp[0] = d->base_pressure + total;
+    jt->press_sp[1] = d->base_pressure - total;
+}
+
+// 一块肌肉的压力环，返回有符号阀门指令；没有气压数据时为 0
+static float joint_press_control(joint_rt_t *rt, joint_t *jt, int m, int64_t now_us) {
+    uint32_t pa;
+    int64_t t_us;
+    if (!rt->io.read_press(rt->io.ctx, jt->d->press_ch[m], &pa, &t_us)) return 0.0f;
+
+    uint32_t age = sample_age(now_us, t_us);
+    jt->st.press_reads++;
+    jt->st.press_age_sum_us += age;
+    if (age > jt->st.press_age_max_us) jt->st.press_age_max_us = age;
+
+    joint_pid_t *p = &jt->press_pid[m];
+#if PAM_FIXED_POINT
+    q16_t dt = sample_dt_q16(&jt->press_last_us[m], t_us, rt->press_period_q);
+    jt->press_kpa[m] = (float)pa * 1e-3f;
+    p->q.setpoint = q16_from_float(jt->press_sp[m]);
+    return q16_to_float(pid_q_compute(&p->q, q16_ratio(pa, 1000), dt));
+#else
+    float dt = sample_dt(&jt->press_last_us[m], t_us, rt->press_period_s);
+    jt->press_kpa[m] = (float)pa * 1e-3f;
+    p->f.setpoint = jt->press_sp[m];
+    return pid_timed_compute(&p->f, jt->press_kpa[m], dt);
+#endif
+}
+
+// 关节压力环: 两块肌肉各自计算，分配到阀对后本关节四路一次提交
+static void joint_press_step(joint_rt_t *rt, joint_t *jt, int64_t now_us) {
+    float u_A = joint_press_control(rt, jt, 0, now_us);
+    float u_B = joint_press_control(rt, jt, 1, now_us);
+
+    valve_pair_t vA = valve_alloc(&rt->alloc, u_A);
+    valve_pair_t vB = valve_alloc(&rt->alloc, u_B);
+    jt->duty[0] = vA.in;
+    jt->duty[1] = vA.out;
+    jt->duty[2] = vB.in;
+    jt->duty[3] = vB.out;
+    rt->io.write_valves(rt->io.ctx, jt->d, jt->duty);
+}
+
+// 统计窗口结束: 发布各关节统计并开始新窗口 (只在控制任务中写 st，读者经邮箱取完整快照)
+static void joint_stats_publish(joint_rt_t *rt) {
+    joint_stats_t win[JOINT_MAX] = { 0 };
+    for (int j = 0; j < rt->n; j++) {
+        win[j] = rt->joints[j].st;
+        memset(&rt->joints[j].st, 0, sizeof(rt->joints[j].st));
+    }
+    mailbox_post(&rt->mb_stats, win);
+    rt->stats_tick = 0;
+}
+
+void joint_rt_tick(joint_rt_t *rt, int64_t now_us) {
+    uint32_t a_ph = rt->tick % rt->angle_period;
+    uint32_t p_ph = rt->tick % rt->press_period;
+
+    // 同一节拍内先外环后内环 (与 arm_control 的注册顺序一致)
+    for (int j = 0; j < rt->n; j++) {
+        joint_t *jt = &rt->joints[j];
+        if (jt->angle_phase == a_ph) joint_angle_step(rt, jt, now_us);
+    }
+    for (int j = 0; j < rt->n; j++) {
+        joint_t *jt = &rt->joints[j];
+        if (jt->press_phase == p_ph) joint_press_step(rt, jt, now_us);
+    }
+    rt->tick++;
+    if (++rt->stats_tick >= JOINT_STATS_WINDOW_TICKS) joint_stats_publish(rt);
+}
+
+bool joint_rt_move_to(joint_rt_t *rt, int j, float angle, float duration_s, int profile) {
+    if (j < 0 || j >= rt->n) return false;
+    const joint_desc_t *d = rt->joints[j].d;
+    if (angle < d->angle_min) angle = d->angle_min;
+    else if (angle > d->angle_max) angle = d->angle_max;
+
+    traj_waypoint_t wp = { angle, duration_s, (uint8_t)profile };
+    return traj_push(&rt->joints[j].traj, &wp);
+}
+
+void joint_rt_set_ref(joint_rt_t *rt, int j, float pos, float vel) {
+    if (j < 0 || j >= rt->n) return;
+    joint_t *jt = &rt->joints[j];
+    jt->ext.pos = pos;
+    jt->ext.vel = vel;
+    jt->ext.acc = 0.0f;
+    jt->ext_ref = true;
+}
+
+void joint_rt_clear_ref(joint_rt_t *rt, int j) {
+    if (j < 0 || j >= rt->n) return;
+    joint_t *jt = &rt->joints[j];
+    if (!jt->ext_ref) return;
+    traj_hold(&jt->traj, jt->ext.pos);
+    jt->ext_ref = false;
+}
+
+uint32_t joint_rt_get_stats(joint_rt_t *rt, joint_stats_t out[JOINT_MAX]) {
+    return mailbox_peek(&rt->mb_stats, out);
+}
@@ -0,0 +1,170 @@
+//表驱动的多关节控制运行时
+//每个关节由编译期常量描述 (joint_desc_t，const 表存放在 flash): 角度/气压传感器的 MUX 通道、
+//四路阀门的 LEDC 通道与定时器、角度环与压力环增益、限幅。运行状态按关节连续存放 (joint_t)，
+//一个关节的回路只访问自己的结构体。
+//调度: 运行时在调度器中只占一个基础节拍回路，每节拍执行到期关节的回路；关节 j 的角度环与
+//压力环相位按关节数均匀错开，每节拍的负载与关节数近似无关地平摊。
+//采集按时间片进行: 关节的角度在其角度环所在节拍读取 (直接模式下每节拍最多 ceil(N/周期) 次
+//阻塞 I2C 读)，气压快照在压力环中读取，采样龄分别以读取耗时与气压采样周期为界，统计见 joint_stats_t。
+//与 arm_control 使用相同的 PID/轨迹/阀门分配算法；自整定、模型前馈、遥测与参数表只在单关节
+//的 arm_control 中提供，多关节的增益直接取自描述表。
+
+#ifndef JOINT_RT_H
+#define JOINT_RT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "hardware_config.h"
+#include "param_store.h"
+#include "hal_valves.h"
+#include "pid.h"
+#include "pid_q.h"
+#include "traj.h"
+#include "valve_alloc.h"
+#include "mailbox.h"
+
+#define JOINT_MAX           8       // AS5600 MUX 通道数
+#define JOINT_HW_MAX        2       // 本机可接的关节数: LEDC 低速模式 8 个通道，每关节四路阀门
+#define JOINT_STATS_WINDOW_TICKS (1000000 / CTRL_BASE_TICK_US)  // 统计窗口 (1 s)，窗口结束时发布并清零
+
+// 关节描述 (只读)
+typedef struct {
+    const char  *name;
+    uint8_t      angle_ch;          ///< AS5600 MUX 通道
+    uint8_t      press_ch[2];       ///< 肌肉 A/B 气压 MUX 通道
+    valve_port_t valve[VALVE_NUM];  ///< A_IN, A_OUT, B_IN, B_OUT
+    param_pid_t  angle;             ///< 角度环 (输出: 压力差 kPa)，量纲同参数表
+    param_pid_t  press;             ///< 压力环 (输出: 有符号占空比)，两块肌肉相同
+    float        base_pressure;     ///< 基础气压 (kPa)
+    float        angle_min;         ///< 目标角度范围 (计数)
+    float        angle_max;
+} joint_desc_t;
+
+// 与参数表默认值相同的增益 (同一来源，见 param_store.h)
+#define JOINT_ANGLE_PID_DEFAULT PARAM_PID_INIT(PARAM_ANGLE_PID_DEFAULTS)
+#define JOINT_PRESS_PID_DEFAULT PARAM_PID_INIT(PARAM_PRESS_PID_DEFAULTS)
+
+// 一次角度读取
+typedef struct {
+    float   angle;                  ///< 相对零点的角度 (计数)
+    float   vel;                    ///< 角速度估计 (计数/秒)
+    int64_t t_us;                   ///< 采样时刻
+} joint_angle_t;
+
+// 硬件访问 (目标上为驱动，见 joint_rt_io_drivers；仿真基准中为被控对象模型)
+typedef struct {
+    bool (*read_angle)(void *ctx, int ch, joint_angle_t *out);              ///< 读取一次，失败返回 false
+    bool (*read_press)(void *ctx, int ch, uint32_t *pa, int64_t *t_us);     ///< 最新快照，无数据返回 false
+    void (*write_valves)(void *ctx, const joint_desc_t *d, const uint32_t duty[VALVE_NUM]);
+    void *ctx;
+} joint_io_t;
+
+// 单关节采样龄与读取统计 (采样龄 = 回路使用时刻 - 采样时刻)
+typedef struct {
+    uint32_t angle_reads;
+    uint32_t angle_faults;
+    uint32_t angle_age_max_us;
+    uint64_t angle_age_sum_us;
+    uint32_t press_reads;
+    uint32_t press_age_max_us;
+    uint64_t press_age_sum_us;
+} joint_stats_t;
+
+// 回路 PID: 浮点配置；PAM_FIXED_POINT 时由定点 PID 按同一配置运行
+typedef struct {
+    pid_timed_t f;
+#if PAM_FIXED_POINT
+    pid_q_t     q;
+#endif
+} joint_pid_t;
+
+// 单关节运行状态 (连续存放，按描述表顺序)
+typedef struct {
+    const joint_desc_t *d;
+    joint_pid_t angle_pid;
+    joint_pid_t press_pid[2];
+    traj_t      traj;
+    bool        ext_ref;            ///< 参考由 joint_rt_set_ref 给出 (任务空间控制)，不再使用 traj
+    traj_ref_t  ext;
+    joint_angle_t angle;            ///< 最近一次角度读数
+    int64_t     angle_last_us;      ///< PID 按实际采样间隔计算
+    int64_t     press_last_us[2];
+    float       press_sp[2];        ///< 角度环 -> 压力环的压力设定值 (kPa)
+    float       press_kpa[2];       ///< 最近一次气压读数
+    float       total;              ///< 角度环输出的压力差 (kPa)
+    uint32_t    duty[VALVE_NUM];    ///< 最近一次阀门输出
+    uint8_t     angle_phase;        ///< 角度环相位 (节拍)
+    uint8_t     press_phase;
+    joint_stats_t st;               ///< 当前统计窗口 (只由控制任务读写)
+} joint_t;
+
+typedef struct {
+    joint_t  joints[JOINT_MAX];
+    int      n;
+    joint_io_t io;
+    valve_alloc_cfg_t alloc;
+    uint32_t tick;
+    uint32_t angle_period;          ///< 节拍
+    uint32_t press_period;
+    float    angle_period_s;
+    float    press_period_s;
+#if PAM_FIXED_POINT
+    q16_t    press_period_q;
+#endif
+    uint32_t stats_tick;            ///< 当前统计窗口已过的节拍
+    joint_stats_t stats_buf[JOINT_MAX];
+    mailbox_t mb_stats;             ///< 控制任务 -> 外部观察: 上一个完整窗口的各关节统计
+} joint_rt_t;
+
+// 由描述表建立 n 个关节 (n <= JOINT_MAX)，回路周期取 ANGLE/PRESS_LOOP_PERIOD_TICKS
+void joint_rt_init(joint_rt_t *rt, const joint_desc_t *table, int n, const joint_io_t *io);
+
+// 执行一个基础节拍: 到期关节的角度读取 + 角度环，到期关节的气压读取 + 压力环 + 阀门输出
+void joint_rt_tick(joint_rt_t *rt, int64_t now_us);
+
+// 追加关节 j 的路点 (目标角度限制在描述表范围内)；队列满或 j 非法时返回 false
+bool joint_rt_move_to(joint_rt_t *rt, int j, float angle, float duration_s, int profile);
+
+// 外部参考 (关节计数与计数/秒): 设置后关节 j 的角度环以此代替轨迹，只能在调度任务中、
+// joint_rt_tick 之前调用 (如 cart_ctrl_step)
+void joint_rt_set_ref(joint_rt_t *rt, int j, float pos, float vel);
+
+// 取消外部参考: 关节静止于最后一次外部参考，之后回到轨迹 (外部参考期间追加的路点从这里依次执行)；
+// 调用约束同 joint_rt_set_ref
+void joint_rt_clear_ref(joint_rt_t *rt, int j);
+
+// 读取上一个完整统计窗口的各关节统计 (out[0..n-1])，可在任意任务中调用；返回窗口序号，0 表示尚无
+uint32_t joint_rt_get_stats(joint_rt_t *rt, joint_stats_t out[JOINT_MAX]);
+
+// 目标驱动: as5600 (流水线模式读扫描快照，否则直接读取) / press 快照 / hal_valves 端口
+void joint_rt_io_drivers(joint_io_t *io);
+
+// 本机关节描述表 (joint_table.c) 与关节数
+extern const joint_desc_t joint_table[];
+extern const int joint_table_len;
+
+// 开销基准用的关节描述表 (仿真与微基准共用)，共 JOINT_MAX 行: 关节 n 的角度通道为 n，气压通道为
+// 2n/2n+1。阀门不使用端口 (基准的 io 直接写入被控对象或丢弃)。超过 JOINT_HW_MAX 或气压通道超出
+// PRESS_MUX_CHANNELS 的行是合成关节 (本机没有对应的 LEDC 通道/MUX 通道，读数由基准的 io 虚拟给出)，
+// 只用于测量开销随关节数的变化
+#define JOINT_BENCH_SYNTHETIC(n) ((n) >= JOINT_HW_MAX || 2 * (n) + 1 >= PRESS_MUX_CHANNELS)
+extern const joint_desc_t joint_bench_table[JOINT_MAX];
+
+// 以 joint_table 启动运行时任务 (绑定控制核，基础节拍 CTRL_BASE_TICK_US)，代替 arm_control_task；
+// CART_CONTROL_ENABLE 时逆运动学表建立失败则不启动
+esp_err_t joint_rt_start(void);
+
+// 全局运行时实例上的路点命令 (joint_rt_start 之后)
+bool joint_move_to(int j, float angle, float duration_s, int profile);
+
+// 全局运行时实例上的末端路点命令 (CART_CONTROL_ENABLE，位置 mm)
+bool joint_cart_move_to(float x, float y, float duration_s, int profile);
+
+// 结束任务空间控制: 丢弃未执行的末端路点，肩/肘关节回到关节空间路点 (joint_move_to)
+void joint_cart_release(void);
+
+// 打印各关节的采样龄统计
+void joint_rt_report(void);
+
+#endif // JOINT_RT_H
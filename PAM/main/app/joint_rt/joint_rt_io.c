@@ -0,0 +1,155 @@
+//多关节运行时在目标上的驱动绑定与任务
+//角度: 流水线模式下读取采集核的扫描快照 (全部 MUX 通道)，否则直接读取一次 (阻塞 I2C)；
+//气压: 采集引擎的快照；阀门: 按关节描述表中的 LEDC 端口批量提交。
+
+#include "joint_rt.h"
+#include "as5600.h"
+#include "press.h"
+#include "cart_ctrl.h"
+#include "ctrl_sched.h"
+#include "loop_prof.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "JOINT_RT";
+
+static bool drv_read_angle(void *ctx, int ch, joint_angle_t *out) {
+    if (ch >= AS5600_CHANNEL_COUNT) return false;
+#if PAM_PIPELINE_MODE
+    static as5600_scan_t scan;      // 只在控制任务中使用
+    as5600_get_snapshot(&scan);
+    const as5600_sample_t *s = &scan.ch[ch];
+    if (!s->valid) return false;
+    out->angle = (float)s->angle;
+    out->vel = s->velocity;
+    out->t_us = s->t_us;
+#else
+    out->angle = (float)as5600_get_angle(ch);
+    out->vel = as5600_get_velocity(ch);
+    out->t_us = esp_timer_get_time();
+#endif
+    return true;
+}
+
+static bool drv_read_press(void *ctx, int ch, uint32_t *pa, int64_t *t_us) {
+    press_sample_t s;
+    if (!pressure_get_sample(ch, &s)) return false;
+    *pa = s.pa;
+    *t_us = s.timestamp_us;
+    return true;
+}
+
+static void drv_write_valves(void *ctx, const joint_desc_t *d, const uint32_t duty[VALVE_NUM]) {
+    valve_set_ports(d->valve, duty, VALVE_NUM);
+}
+
+void joint_rt_io_drivers(joint_io_t *io) {
+    io->read_angle = drv_read_angle;
+    io->read_press = drv_read_press;
+    io->write_valves = drv_write_valves;
+    io->ctx = NULL;
+}
+
+// ---------------- 任务 ----------------
+
+static joint_rt_t   rt;
+static ctrl_sched_t sched;
+static loop_prof_t *prof;
+static int span_joints;
+static bool pwm_synced;
+#if CART_CONTROL_ENABLE
+static ik_table_t  ik;
+static cart_ctrl_t cart;
+#endif
+
+static void joints_loop(void *arg) {
+#if VALVE_PWM_SYNC
+    // 全部关节共用的 PWM 周期起点对齐到 第一个节拍 + VALVE_PWM_LEAD_US
+    if (!pwm_synced) {
+        valves_pwm_sync(esp_timer_get_time() + VALVE_PWM_LEAD_US);
+        pwm_synced = true;
+    }
+#endif
+    PROF_PERIOD(prof);
+    PROF_MARK(t);
+#if CART_CONTROL_ENABLE
+    cart_ctrl_step(&cart, &rt, CTRL_BASE_TICK_US * 1e-6f);
+#endif
+    joint_rt_tick(&rt, esp_timer_get_time());
+    PROF_LAP(prof, span_joints, t);
+}
+
+static void joints_task(void *pvParameters) {
+    ctrl_sched_run(&sched);
+}
+
+esp_err_t joint_rt_start(void) {
+#if CART_CONTROL_ENABLE
+    // 关节索引已由 joint_table.c 静态检查；表建立失败时阀门端口尚未初始化，保持关闭
+    ik_arm_t arm;
+    cart_ctrl_arm(&arm, &joint_table[CART_SHOULDER_JOINT], &joint_table[CART_ELBOW_JOINT],
+                  CART_LINK1_MM, CART_LINK2_MM, CART_ELBOW_MARGIN_DEG * (3.14159265f / 180.0f));
+    if (!ik_table_build(&ik, &arm)) {
+        ESP_LOGE(TAG, "IK table: elbow range leaves no reachable workspace");
+        return ESP_ERR_INVALID_STATE;
+    }
+#endif
+
+    joint_io_t io;
+    joint_rt_io_drivers(&io);
+    for (int j = 0; j < joint_table_len; j++) {
+        valves_init_ports(joint_table[j].valve, VALVE_NUM);
+    }
+    joint_rt_init(&rt, joint_table, joint_table_len, &io);
+#if CART_CONTROL_ENABLE
+    cart_ctrl_init(&cart, &ik, CART_SHOULDER_JOINT, CART_ELBOW_JOINT);
+#endif
+
+    prof = loop_prof_register("joints", CTRL_BASE_TICK_US);
+    span_joints = loop_prof_add_span(prof, "joints");
+    ctrl_sched_init(&sched, CTRL_BASE_TICK_US);
+    ctrl_sched_add(&sched, "joints", joints_loop, NULL, 1, 0);
+    xTaskCreatePinnedToCore(joints_task, "Joint_Task", 4096, NULL, 5, NULL, CONTROL_CORE);
+
+    ESP_LOGI(TAG, "Joint runtime started (%d joints)", rt.n);
+    return ESP_OK;
+}
+
+bool joint_move_to(int j, float angle, float duration_s, int profile) {
+    return joint_rt_move_to(&rt, j, angle, duration_s, profile);
+}
+
+bool joint_cart_move_to(float x, float y, float duration_s, int profile) {
+#if CART_CONTROL_ENABLE
+    return cart_ctrl_move_to(&cart, x, y, duration_s, profile);
+#else
+    return false;
+#endif
+}
+
+void joint_cart_release(void) {
+#if CART_CONTROL_ENABLE
+    cart_ctrl_release(&cart);
+#endif
+}
+
+void joint_rt_report(void) {
+    ctrl_sched_report(&sched);
+    joint_stats_t win[JOINT_MAX];
+    joint_rt_get_stats(&rt, win);
+    for (int j = 0; j < rt.n; j++) {
+        const joint_stats_t *s = &win[j];
+        ESP_LOGI(TAG, "%s: angle age %lu/%lu us (mean/max, %lu faults), press age %lu/%lu us",
+                 rt.joints[j].d->name,
+                 (unsigned long)(s->angle_reads ? s->angle_age_sum_us / s->angle_reads : 0),
+                 (unsigned long)s->angle_age_max_us, (unsigned long)s->angle_faults,
+                 (unsigned long)(s->press_reads ? s->press_age_sum_us / s->press_reads : 0),
+                 (unsigned long)s->press_age_max_us);
+    }
+#if CART_CONTROL_ENABLE
+    ESP_LOGI(TAG, "Cartesian ref (%.1f, %.1f) mm, %lu clamped ticks",
+             cart.x_ref, cart.y_ref, (unsigned long)cart.clamped);
+#endif
+}
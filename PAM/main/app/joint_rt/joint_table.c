@@ -0,0 +1,33 @@
+//本机关节描述表 (ARM_JOINT_RUNTIME 为 1 时由 joint_rt_start 使用)
+//新增关节: 追加一行，指定角度/气压 MUX 通道与四路阀门的 GPIO / LEDC 通道。
+//LEDC 低速模式共 8 个通道，按每关节四路计最多两个关节直接由 LEDC 驱动。
+
+#include "joint_rt.h"
+
+const joint_desc_t joint_table[] = {
+    {
+        .name     = "elbow",
+        .angle_ch = 0,
+        .press_ch = { 0, 1 },
+        .valve    = {
+            { VALVE_A_IN_PIN,  0, VALVE_LEDC_TIMER },
+            { VALVE_A_OUT_PIN, 1, VALVE_LEDC_TIMER },
+            { VALVE_B_IN_PIN,  2, VALVE_LEDC_TIMER },
+            { VALVE_B_OUT_PIN, 3, VALVE_LEDC_TIMER },
+        },
+        .angle         = JOINT_ANGLE_PID_DEFAULT,
+        .press         = JOINT_PRESS_PID_DEFAULT,
+        .base_pressure = BASE_PRESSURE,
+        .angle_min     = -1024.0f,      // ±90°
+        .angle_max     = 1024.0f,
+    },
+};
+
+const int joint_table_len = sizeof(joint_table) / sizeof(joint_table[0]);
+
+_Static_assert(sizeof(joint_table) / sizeof(joint_table[0]) <= JOINT_HW_MAX, "more joints than LEDC channels");
+#if CART_CONTROL_ENABLE
+_Static_assert(CART_SHOULDER_JOINT < sizeof(joint_table) / sizeof(joint_table[0]) &&
+               CART_ELBOW_JOINT < sizeof(joint_table) / sizeof(joint_table[0]),
+               "CART_SHOULDER_JOINT/CART_ELBOW_JOINT outside joint_table");
+#endif
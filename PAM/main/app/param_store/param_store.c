@@ -0,0 +1,248 @@
+#include "param_store.h"
+#include "hardware_config.h"
+#include "mailbox.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include "nvs.h"
+#endif
+
+static const char *TAG = "PARAM";
+
+#define PARAM_NVS_NAMESPACE "pam"
+#define PARAM_NVS_KEY       "params"
+#define PARAM_LAYOUT_VER    6           // pam_params_t 布局变化时加 1，旧的 NVS 数据将被忽略
+
+#define F32(field, lo, hi, d) { #field, PARAM_F32, offsetof(pam_params_t, field), lo, hi, d }
+#define U32(field, lo, hi, d) { #field, PARAM_U32, offsetof(pam_params_t, field), lo, hi, d }
+
+// 一组 PID 参数: 增益上限、输出范围、积分限幅上限、死区上限与默认值列表 (PARAM_*_PID_DEFAULTS)
+#define PID_PARAMS(grp, kp_max, ki_max, kd_max, out_lo, out_hi, lim_max, dz_max, defaults) \
+    PID_PARAMS_(grp, kp_max, ki_max, kd_max, out_lo, out_hi, lim_max, dz_max, defaults)
+#define PID_PARAMS_(grp, kp_max, ki_max, kd_max, out_lo, out_hi, lim_max, dz_max, d_kp, d_ki, d_kd, d_min, d_max, d_lim, d_dz, d_sw, d_df) \
+    F32(grp.kp,        0.0f,   kp_max,  d_kp),                               \
+    F32(grp.ki,        0.0f,   ki_max,  d_ki),                               \
+    F32(grp.kd,        0.0f,   kd_max,  d_kd),                               \
+    F32(grp.out_min,   out_lo, out_hi,  d_min),                              \
+    F32(grp.out_max,   out_lo, out_hi,  d_max),                              \
+    F32(grp.int_limit, 0.0f,   lim_max, d_lim),                              \
+    F32(grp.dead_zone, 0.0f,   dz_max,  d_dz),                               \
+    F32(grp.sp_weight, 0.0f,   1.0f,    d_sw),                               \
+    F32(grp.d_filter,  0.0f,   1.0f,    d_df)
+
+// 默认值与 arm_control 原先写死的参数一致。ki 由原 50Hz 换算到默认周期 (角度环 ×1/2，压力环 ×1/10)，
+// 积分限幅按误差累加和保存，须同比例放大，积分项的输出上限 ki·int_limit 才与原来相同
+// (角度环 0.1 × 150 = 15 kPa，压力环 0.5 × 4095.5 ≈ 2048)
+static const param_desc_t table[] = {
+    PID_PARAMS(angle,   100.0f,  10.0f,  100.0f, -400.0f, 400.0f, 1.0e5f, 100.0f, PARAM_ANGLE_PID_DEFAULTS),
+    PID_PARAMS(press_a, 1000.0f, 100.0f, 1000.0f, -(float)VALVE_MAX_DUTY, (float)VALVE_MAX_DUTY, 1.0e6f, 50.0f,
+               PARAM_PRESS_PID_DEFAULTS),
+    PID_PARAMS(press_b, 1000.0f, 100.0f, 1000.0f, -(float)VALVE_MAX_DUTY, (float)VALVE_MAX_DUTY, 1.0e6f, 50.0f,
+               PARAM_PRESS_PID_DEFAULTS),
+    F32(base_pressure,      0.0f, 600.0f, BASE_PRESSURE),
+    F32(valve_dead_band,    0.0f, 2000.0f, VALVE_DEAD_BAND),
+    F32(valve_min_pulse,    0.0f, 4000.0f, VALVE_MIN_PULSE),
+    U32(valve_exhaust,      0.0f, 1.0f,   1),
+    U32(press_period_ticks, 1.0f, 50.0f,  PRESS_LOOP_PERIOD_TICKS),
+    U32(angle_period_ticks, 1.0f, 200.0f, ANGLE_LOOP_PERIOD_TICKS),
+    F32(traj_kv,            0.0f, 10.0f,  TRAJ_FF_KV),
+    F32(traj_ka,            0.0f, 1.0f,   TRAJ_FF_KA),
+    U32(ff_enable,          0.0f, 1.0f,   PAM_FF_ENABLE),
+    U32(press_obs,          0.0f, 1.0f,   PRESS_OBS_ENABLE),
+};
+
+#define PARAM_NUM ((int)(sizeof(table) / sizeof(table[0])))
+
+// 写端的工作副本 (在 write_lock 内修改)，修改完成后整体发布到邮箱
+static pam_params_t master;
+static portMUX_TYPE write_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static mailbox_t    mb_params;
+static pam_params_t mb_buf;
+
+static const param_desc_t *find(const char *name) {
+    for (int i = 0; i < PARAM_NUM; i++) {
+        if (strcmp(table[i].name, name) == 0) return &table[i];
+    }
+    return NULL;
+}
+
+static float load_field(const pam_params_t *p, const param_desc_t *d) {
+    const uint8_t *base = (const uint8_t *)p + d->offset;
+    if (d->type == PARAM_U32) return (float)*(const uint32_t *)base;
+    return *(const float *)base;
+}
+
+static void store_field(pam_params_t *p, const param_desc_t *d, float v) {
+    uint8_t *base = (uint8_t *)p + d->offset;
+    if (d->type == PARAM_U32) *(uint32_t *)base = (uint32_t)(v + 0.5f);
+    else *(float *)base = v;
+}
+
+static bool in_range(const param_desc_t *d, float v) {
+    return v >= d->min && v <= d->max;   // NaN 不通过
+}
+
+// 输出上下限必须成对有效
+static bool pid_valid(const param_pid_t *pid) {
+    return pid->out_min < pid->out_max;
+}
+
+static bool params_valid(const pam_params_t *p) {
+    return pid_valid(&p->angle) && pid_valid(&p->press_a) && pid_valid(&p->press_b);
+}
+
+static void load_defaults(pam_params_t *p) {
+    memset(p, 0, sizeof(*p));
+    for (int i = 0; i < PARAM_NUM; i++) store_field(p, &table[i], table[i].def);
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+typedef struct {
+    uint32_t     layout;
+    pam_params_t params;
+} param_blob_t;
+
+static void load_nvs(pam_params_t *p) {
+    nvs_handle_t h;
+    if (nvs_open(PARAM_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return;
+
+    param_blob_t blob;
+    size_t len = sizeof(blob);
+    esp_err_t err = nvs_get_blob(h, PARAM_NVS_KEY, &blob, &len);
+    nvs_close(h);
+    if (err != ESP_OK) return;
+
+    if (len != sizeof(blob) || blob.layout != PARAM_LAYOUT_VER) {
+        ESP_LOGW(TAG, "Stored parameters have an old layout, using defaults");
+        return;
+    }
+
+    // 逐项检查，越界的项保留默认值
+    for (int i = 0; i < PARAM_NUM; i++) {
+        float v = load_field(&blob.params, &table[i]);
+        if (in_range(&table[i], v)) store_field(p, &table[i], v);
+        else ESP_LOGW(TAG, "Stored %s out of range, using default", table[i].name);
+    }
+    if (!params_valid(p)) {
+        ESP_LOGW(TAG, "Stored PID limits inconsistent, using defaults");
+        load_defaults(p);
+        return;
+    }
+    ESP_LOGI(TAG, "Parameters loaded from NVS");
+}
+#endif
+
+// 在 write_lock 内调用
+static void publish(void) {
+    mailbox_post(&mb_params, &master);
+}
+
+void param_store_init(void) {
+    mailbox_init(&mb_params, &mb_buf, sizeof(mb_buf));
+    load_defaults(&master);
+#if !CONFIG_IDF_TARGET_LINUX
+    load_nvs(&master);
+#endif
+    publish();
+}
+
+uint32_t param_store_get(pam_params_t *out) {
+    return mailbox_peek(&mb_params, out);
+}
+
+uint32_t param_store_version(void) {
+    return mailbox_version(&mb_params);
+}
+
+esp_err_t param_set(const char *name, float value) {
+    const param_desc_t *d = find(name);
+    if (!d) return ESP_ERR_NOT_FOUND;
+    if (!in_range(d, value)) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&write_lock);
+    float old = load_field(&master, d);
+    store_field(&master, d, value);
+    if (params_valid(&master)) {
+        publish();
+    } else {
+        store_field(&master, d, old);
+        err = ESP_ERR_INVALID_ARG;
+    }
+    portEXIT_CRITICAL(&write_lock);
+    return err;
+}
+
+esp_err_t param_get(const char *name, float *value) {
+    const param_desc_t *d = find(name);
+    if (!d) return ESP_ERR_NOT_FOUND;
+
+    pam_params_t p;
+    param_store_get(&p);
+    *value = load_field(&p, d);
+    return ESP_OK;
+}
+
+void param_store_reset(void) {
+    portENTER_CRITICAL(&write_lock);
+    load_defaults(&master);
+    publish();
+    portEXIT_CRITICAL(&write_lock);
+}
+
+esp_err_t param_store_save(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return ESP_ERR_NOT_SUPPORTED;   // 仿真每次从默认值开始
+#else
+    param_blob_t blob = { .layout = PARAM_LAYOUT_VER };
+    param_store_get(&blob.params);
+
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(PARAM_NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, PARAM_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+
+    if (err == ESP_OK) ESP_LOGI(TAG, "Parameters saved");
+    else ESP_LOGE(TAG, "Save failed: %s", esp_err_to_name(err));
+    return err;
+#endif
+}
+
+int param_count(void) {
+    return PARAM_NUM;
+}
+
+const param_desc_t *param_desc(int idx) {
+    if (idx < 0 || idx >= PARAM_NUM) return NULL;
+    return &table[idx];
+}
+
+/**
+ * @brief 参数表增益 -> 连续时间增益
+ * * 参数表按默认周期 t_nom 下每次调用的量纲保存 (ki 累加误差、kd 乘一个周期内的变化量)，
+ * * 积分限幅按误差累加和保存，换算为输出单位；反算抗饱和的跟踪时间取 √(Ti·Td)，无微分时取 Ti
+ */
+void param_pid_apply(const param_pid_t *p, float t_nom, pid_timed_t *pid) {
+    pid->kp = p->kp;
+    pid->ki = p->ki / t_nom;
+    pid->kd = p->kd * t_nom;
+    pid->beta = p->sp_weight;
+    pid->d_tau = p->d_filter;
+    pid->out_min = p->out_min;
+    pid->out_max = p->out_max;
+    pid->int_limit = p->ki * p->int_limit;
+    pid->dead_zone = p->dead_zone;
+
+    pid->kb = 0.0f;     // 无比例或无积分时退化为条件积分
+    if (pid->kp > 0.0f && pid->ki > 0.0f) {
+        float ti = pid->kp / pid->ki;
+        float td = pid->kd / pid->kp;
+        pid->kb = 1.0f / (td > 0.0f ? sqrtf(ti * td) : ti);
+    }
+}
@@ -0,0 +1,99 @@
+//运行时参数表
+//所有可调参数 (PID 增益与限幅、死区、基础气压、回路周期、前馈) 集中在一个结构体中，
+//按名称读写并做范围检查。写端在修改后整体发布一份新快照 (基于 seqlock 的邮箱)，
+//控制回路在周期边界比较版本号，有新版本时一次性取走整份参数，不加互斥锁。
+//参数可保存到 NVS，上电时覆盖默认值。
+
+#ifndef PARAM_STORE_H
+#define PARAM_STORE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "pid.h"
+
+// 与 pid_ctrl_t 的可调字段一一对应
+typedef struct {
+    float kp;
+    float ki;
+    float kd;
+    float out_min;
+    float out_max;
+    float int_limit;
+    float dead_zone;
+    float sp_weight;                ///< 比例项设定值权重 (pid_timed_t.beta)
+    float d_filter;                 ///< 微分滤波时间常数 (s)
+} param_pid_t;
+
+// 回路 PID 默认值 (默认周期下每次调用的量纲，依次为 kp, ki, kd, out_min, out_max, int_limit, dead_zone,
+// sp_weight, d_filter)。参数表与多关节描述表 (JOINT_*_PID_DEFAULT) 都由这里展开，只在此处修改。
+// ki 与积分限幅的换算说明见 param_store.c
+#define PARAM_ANGLE_PID_DEFAULTS    2.0f, 0.05f, 1.0f, -150.0f, 150.0f, 300.0f, 1.0f, 1.0f, 0.0f
+#define PARAM_PRESS_PID_DEFAULTS    15.0f, 0.05f, 0.0f, -(float)VALVE_MAX_DUTY, (float)VALVE_MAX_DUTY, \
+                                    40955.0f, 0.0f, 1.0f, 0.0f
+
+// 由默认值列表构造 param_pid_t 初始化器 (按字段名)
+#define PARAM_PID_INIT(...)         PARAM_PID_INIT_(__VA_ARGS__)
+#define PARAM_PID_INIT_(kp_, ki_, kd_, min_, max_, lim_, dz_, sw_, df_)                 \
+    { .kp = kp_, .ki = ki_, .kd = kd_, .out_min = min_, .out_max = max_, .int_limit = lim_, \
+      .dead_zone = dz_, .sp_weight = sw_, .d_filter = df_ }
+
+typedef struct {
+    param_pid_t angle;              ///< 角度外环 (输出: 压力差 kPa)
+    param_pid_t press_a;            ///< 肌肉A 压力内环 (输出: 有符号占空比，正充气负放气)
+    param_pid_t press_b;            ///< 肌肉B 压力内环
+    float       base_pressure;      ///< 基础气压 (kPa)
+    float       valve_dead_band;    ///< 阀门分配死区 (占空比计数)
+    float       valve_min_pulse;    ///< 阀门最小有效占空比
+    uint32_t    valve_exhaust;      ///< 1: 负输出开排气阀; 0: 只用进气阀
+    uint32_t    press_period_ticks; ///< 压力内环周期 (基础节拍)
+    uint32_t    angle_period_ticks; ///< 角度外环周期 (基础节拍)
+    float       traj_kv;            ///< 轨迹速度前馈 (kPa / (计数/秒))
+    float       traj_ka;            ///< 轨迹加速度前馈 (kPa / (计数/秒²))
+    uint32_t    ff_enable;          ///< 1: 叠加静态模型前馈 (pam_ff)
+    uint32_t    press_obs;          ///< 1: 压力环使用观测器估计 (press_obs)，故障时进入安全模式
+} pam_params_t;
+
+typedef enum {
+    PARAM_F32 = 0,
+    PARAM_U32,
+} param_type_t;
+
+// 参数描述 (名称、类型、在 pam_params_t 中的偏移、范围与默认值)
+typedef struct {
+    const char  *name;
+    param_type_t type;
+    uint16_t     offset;
+    float        min;
+    float        max;
+    float        def;
+} param_desc_t;
+
+// 载入默认值，再用 NVS 中保存的值覆盖 (需先调用 nvs_flash_init)
+void param_store_init(void);
+
+// 读取整份参数快照 (无锁)，返回版本号
+uint32_t param_store_get(pam_params_t *out);
+
+// 当前版本号 (无锁)，控制回路用它判断是否需要重新读取
+uint32_t param_store_version(void);
+
+// 按名称读写单个参数
+// 返回 ESP_ERR_NOT_FOUND: 无此参数; ESP_ERR_INVALID_ARG: 超出范围或 out_min >= out_max
+esp_err_t param_set(const char *name, float value);
+esp_err_t param_get(const char *name, float *value);
+
+// 恢复默认值 (不修改 NVS)
+void param_store_reset(void);
+
+// 将当前参数写入 NVS
+esp_err_t param_store_save(void);
+
+// 参数表 (用于列出全部参数)
+int param_count(void);
+
+// 参数表增益 (默认周期 t_nom 下每次调用的量纲) 换算为 pid_timed_t 的连续时间增益与限幅
+// (运行状态不变)；多关节运行时的关节描述表使用同样的量纲
+void param_pid_apply(const param_pid_t *p, float t_nom, pid_timed_t *pid);
+const param_desc_t *param_desc(int idx);
+
+#endif // PARAM_STORE_H
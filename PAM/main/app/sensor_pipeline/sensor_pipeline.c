@@ -0,0 +1,143 @@
+//双核流水线的采集阶段
+//采集任务绑定 SENSOR_CORE，周期性扫描 AS5600 (I2C) 并读取气压快照 (UART 引擎同样在该核)，
+//打包成带时间戳的传感器帧，经 SPSC 环形队列无锁交给 CONTROL_CORE 上的控制任务。
+//轨迹回放时，每周期先把到期的记录事件交给各驱动的回放入口，再照常扫描与打包。
+
+#include "sensor_pipeline.h"
+#include "spsc_ring.h"
+#include "as5600.h"
+#include "press.h"
+#include "hal_pump.h"
+#include "sensor_trace.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "SENSOR_PIPE";
+
+static spsc_ring_t ring;
+static sensor_frame_t ring_buf[SENSOR_RING_LEN];
+
+static TaskHandle_t acq_task;
+static esp_timer_handle_t acq_timer;
+
+// 控制核侧统计 (仅控制任务写)
+static uint32_t frames_rx;
+static uint32_t last_latency_us;
+static uint32_t max_latency_us;
+static uint64_t sum_latency_us;
+static uint32_t latency_count;
+static uint32_t actuated_seq;       ///< 最近一次记录延迟的帧序号
+static bool     actuated_any;
+
+static void acq_tick_cb(void *arg) {
+    xTaskNotifyGive(acq_task);
+}
+
+#if PAM_TRACE_ENABLE
+// 回放事件分发到对应驱动
+static void replay_sink(const trace_event_t *ev) {
+    switch (ev->type) {
+    case TRACE_EV_ANGLE:
+        as5600_replay_sample(ev->ch, (uint16_t)ev->value, ev->ok, ev->t_us);
+        break;
+    case TRACE_EV_PRESS:
+        pressure_replay_sample(ev->ch, ev->value, ev->ok, ev->t_us);
+        break;
+    case TRACE_EV_PUMP:
+        pump_replay_switch(ev->value != 0, ev->ch == TRACE_PUMP_EDGE, ev->t_us);
+        break;
+    default:
+        break;
+    }
+}
+#endif
+
+/**
+ * @brief 采集阶段任务 (SENSOR_CORE)
+ * * @param pvParameters 未使用
+ */
+static void sensor_acq_task(void *pvParameters) {
+    sensor_frame_t f = {0};
+    press_snapshot_t ps;
+    as5600_scan_t as;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+#if PAM_TRACE_ENABLE
+        if (trace_replaying()) trace_replay_until(esp_timer_get_time(), replay_sink);
+#endif
+
+        // 1. 角度: 扫描全部通道一轮 (异步 I2C，只占用本核)；超时的通道保持上次的值
+        as5600_scan();
+        as5600_get_snapshot(&as);
+        f.angle = (float)as.ch[0].angle;
+        f.angle_vel = as.ch[0].velocity;
+        f.angle_faults = as.fault_mask;
+        f.t_us = esp_timer_get_time();
+
+        // 2. 气压 (采集引擎的快照，不阻塞)
+        pressure_get_snapshot(&ps);
+        for (int i = 0; i < PRESS_CHANNEL_COUNT; i++) {
+            f.press_kpa[i] = ps.ch[i].valid ? (float)ps.ch[i].kpa : 0.0f;
+            f.press_q16[i] = ps.ch[i].valid ? q16_ratio(ps.ch[i].pa, 1000) : 0;
+            f.press_t_us[i] = ps.ch[i].timestamp_us;
+        }
+
+        // 3. 交给控制核；队列满说明控制核跟不上，丢弃并计数
+        spsc_ring_push(&ring, &f);
+        f.seq++;
+    }
+}
+
+void sensor_pipeline_start(void) {
+    spsc_ring_init(&ring, ring_buf, SENSOR_RING_LEN, sizeof(sensor_frame_t));
+
+    xTaskCreatePinnedToCore(sensor_acq_task, "Sensor_Acq", 3072, NULL,
+                            SENSOR_ACQ_TASK_PRIO, &acq_task, SENSOR_CORE);
+
+    const esp_timer_create_args_t args = {
+        .callback = acq_tick_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sensor_acq",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &acq_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(acq_timer, SENSOR_ACQ_PERIOD_US));
+
+    ESP_LOGI(TAG, "Sensor pipeline started (core %d -> core %d, %d us)",
+             SENSOR_CORE, CONTROL_CORE, SENSOR_ACQ_PERIOD_US);
+}
+
+bool sensor_pipeline_latest(sensor_frame_t *frame) {
+    bool fresh = false;
+    while (spsc_ring_pop(&ring, frame)) {
+        frames_rx++;
+        fresh = true;
+    }
+    return fresh;
+}
+
+void sensor_pipeline_mark_actuated(const sensor_frame_t *frame) {
+    // 没有新帧的周期沿用上一帧，不重复计入 (否则延迟随帧的陈旧程度虚增)
+    if (actuated_any && frame->seq == actuated_seq) return;
+    actuated_seq = frame->seq;
+    actuated_any = true;
+
+    uint32_t lat = (uint32_t)(esp_timer_get_time() - frame->t_us);
+    last_latency_us = lat;
+    if (lat > max_latency_us) max_latency_us = lat;
+    sum_latency_us += lat;
+    latency_count++;
+}
+
+void sensor_pipeline_get_stats(sensor_pipeline_stats_t *out) {
+    out->frames = frames_rx;
+    out->drops = ring.drops;
+    out->depth = spsc_ring_depth(&ring);
+    out->max_depth = ring.max_depth;
+    out->last_latency_us = last_latency_us;
+    out->max_latency_us = max_latency_us;
+    out->mean_latency_us = latency_count ? (uint32_t)(sum_latency_us / latency_count) : 0;
+}
@@ -0,0 +1,42 @@
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware_config.h"
+#include "fixq.h"
+
+// 采集核 -> 控制核 传递的带时间戳传感器帧
+typedef struct {
+    uint32_t seq;                               ///< 帧序号
+    int64_t  t_us;                              ///< 采集时刻
+    float    angle;                             ///< 角度 (AS5600 通道0)
+    float    angle_vel;                         ///< 角速度估计 (计数/秒)
+    uint32_t angle_faults;                      ///< 本轮扫描超时的角度通道 (位 = MUX 通道)
+    float    press_kpa[PRESS_CHANNEL_COUNT];    ///< 各通道最新气压
+    q16_t    press_q16[PRESS_CHANNEL_COUNT];    ///< 同上 (Q16.16 kPa，由 Pa 换算，供定点控制路径)
+    int64_t  press_t_us[PRESS_CHANNEL_COUNT];   ///< 各通道气压的采样时刻
+} sensor_frame_t;
+
+typedef struct {
+    uint32_t frames;          ///< 已送达控制核的帧数
+    uint32_t drops;           ///< 队列满丢弃的帧数
+    uint32_t depth;           ///< 当前队列深度
+    uint32_t max_depth;       ///< 历史最大队列深度
+    uint32_t last_latency_us; ///< 最近一次 采集->阀门输出 延迟
+    uint32_t max_latency_us;  ///< 最大 采集->阀门输出 延迟
+    uint32_t mean_latency_us; ///< 平均 采集->阀门输出 延迟
+} sensor_pipeline_stats_t;
+
+// 启动采集阶段 (绑定 SENSOR_CORE)
+void sensor_pipeline_start(void);
+
+// 控制核调用：取走队列中所有帧，把最新一帧写入 frame；没有新帧时 frame 不变并返回 false
+bool sensor_pipeline_latest(sensor_frame_t *frame);
+
+// 控制核调用：阀门输出完成后记录该帧的 采集->阀门 延迟；同一帧只记录第一次
+void sensor_pipeline_mark_actuated(const sensor_frame_t *frame);
+
+void sensor_pipeline_get_stats(sensor_pipeline_stats_t *out);
+
+#endif // SENSOR_PIPELINE_H
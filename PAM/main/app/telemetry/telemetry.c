@@ -0,0 +1,175 @@
+#include "telemetry.h"
+#include "hardware_config.h"
+#include "spsc_ring.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <stdio.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TELEM_OUT_FILE  1               // 仿真: 写入当前目录下的 pam_telem.bin，由仿真循环调用 telemetry_flush
+#else
+#include "soc/soc_caps.h"
+#if SOC_USB_SERIAL_JTAG_SUPPORTED
+#include "driver/usb_serial_jtag.h"
+#define TELEM_OUT_USB   1
+#endif
+#endif
+
+static const char *TAG = "TELEMETRY";
+
+#define TELEM_RING_LEN      64          // 记录队列长度 (2 的幂)
+#define TELEM_TASK_PERIOD   10          // 发送任务周期 (ms)
+#define TELEM_FRAME_MAX     (1 + 2 + 4 + 2 + TELEM_SIG_NUM * 4)
+#define TELEM_COBS_MAX      (TELEM_FRAME_MAX + TELEM_FRAME_MAX / 254 + 2)
+#define TELEM_OUT_BUF       1024
+
+static spsc_ring_t ring;
+static telem_record_t ring_buf[TELEM_RING_LEN];
+
+// 默认抽取系数 (以控制回路记录频率为基准)
+static uint16_t decimation[TELEM_SIG_NUM] = {
+    [TELEM_ANGLE]      = 1,
+    [TELEM_ANGLE_SP]   = 5,
+    [TELEM_ANGLE_VEL]  = 1,
+    [TELEM_PRESS_SP_A] = 1,
+    [TELEM_PRESS_SP_B] = 1,
+    [TELEM_PRESS_A]    = 1,
+    [TELEM_PRESS_B]    = 1,
+    [TELEM_DUTY_A_IN]  = 1,
+    [TELEM_DUTY_A_OUT] = 1,
+    [TELEM_DUTY_B_IN]  = 1,
+    [TELEM_DUTY_B_OUT] = 1,
+    [TELEM_PID_P]      = 5,
+    [TELEM_PID_I]      = 5,
+    [TELEM_PID_D]      = 5,
+};
+
+#if TELEM_OUT_FILE
+static FILE *out_file;
+#endif
+
+static int64_t (*clock_fn)(void) = esp_timer_get_time;
+
+void telemetry_set_clock(int64_t (*clock)(void)) {
+    clock_fn = clock;
+}
+
+void telemetry_push(telem_record_t *rec) {
+    static uint16_t seq;
+    rec->t_us = (uint32_t)clock_fn();
+    rec->seq = seq++;
+    spsc_ring_push(&ring, rec);
+}
+
+void telemetry_set_decimation(telem_signal_t sig, uint16_t n) {
+    if (sig < TELEM_SIG_NUM) decimation[sig] = n;
+}
+
+uint32_t telemetry_dropped(void) {
+    return ring.drops;
+}
+
+// COBS 编码，返回编码后长度 (不含 0x00 分隔符)
+static size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_idx = 0, o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_idx] = code;
+            code_idx = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_idx] = code;
+                code_idx = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_idx] = code;
+    return o;
+}
+
+static void telem_write(const uint8_t *buf, size_t len) {
+#if TELEM_OUT_USB
+    usb_serial_jtag_write_bytes(buf, len, 0);
+#elif TELEM_OUT_FILE
+    if (out_file) fwrite(buf, 1, len, out_file);
+#else
+    (void)buf;
+    (void)len;
+#endif
+}
+
+// 按抽取系数挑选字段并打包，返回帧长度；本条记录无字段需要发送时返回 0
+static size_t telem_pack(const telem_record_t *rec, uint8_t *frame) {
+    uint16_t mask = 0;
+    size_t n = 9;
+
+    for (int i = 0; i < TELEM_SIG_NUM; i++) {
+        if (decimation[i] == 0 || rec->seq % decimation[i] != 0) continue;
+        mask |= (uint16_t)(1u << i);
+        memcpy(frame + n, &rec->v[i], 4);
+        n += 4;
+    }
+    if (mask == 0) return 0;
+
+    frame[0] = TELEM_VERSION;
+    memcpy(frame + 1, &rec->seq, 2);
+    memcpy(frame + 3, &rec->t_us, 4);
+    memcpy(frame + 7, &mask, 2);
+    return n;
+}
+
+/**
+ * @brief 取出所有记录 -> 抽取 -> COBS -> 批量写出
+ */
+void telemetry_flush(void) {
+    static uint8_t out[TELEM_OUT_BUF];
+    uint8_t frame[TELEM_FRAME_MAX];
+    telem_record_t rec;
+
+    size_t used = 0;
+    while (spsc_ring_pop(&ring, &rec)) {
+        size_t len = telem_pack(&rec, frame);
+        if (len == 0) continue;
+
+        if (used + TELEM_COBS_MAX + 1 > sizeof(out)) {
+            telem_write(out, used);
+            used = 0;
+        }
+        used += cobs_encode(frame, len, out + used);
+        out[used++] = 0x00;
+    }
+    if (used) telem_write(out, used);
+}
+
+static void telemetry_task(void *pvParameters) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(TELEM_TASK_PERIOD));
+        telemetry_flush();
+    }
+}
+
+void telemetry_init(void) {
+    spsc_ring_init(&ring, ring_buf, TELEM_RING_LEN, sizeof(telem_record_t));
+
+#if TELEM_OUT_USB
+    usb_serial_jtag_driver_config_t cfg = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    usb_serial_jtag_driver_install(&cfg);
+#elif TELEM_OUT_FILE
+    out_file = fopen("pam_telem.bin", "wb");
+#else
+    ESP_LOGW(TAG, "No USB Serial/JTAG on this chip, telemetry disabled");
+#endif
+
+#if !CONFIG_IDF_TARGET_LINUX
+    xTaskCreate(telemetry_task, "Telem_Task", 3072, NULL, 2, NULL);
+#endif
+    ESP_LOGI(TAG, "Telemetry started (%d signals)", TELEM_SIG_NUM);
+}
@@ -0,0 +1,59 @@
+//二进制遥测
+//控制回路把定长记录 (所有信号的 float 值) 写入 SPSC 无锁队列，不做任何格式化；
+//低优先级任务按各信号的抽取系数挑选字段，打包成 COBS 帧经 USB-CDC 发送。
+//帧格式 (COBS 编码前，小端):
+//  ver(u8) seq(u16) t_us(u32) mask(u16) value[popcount(mask)](f32)
+//mask 第 i 位表示信号 i 是否出现在本帧中，解码见 tools/pam_telemetry_decode.py。
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEM_VERSION   1
+
+// 信号编号 (与解码工具中的列顺序一致，只能在末尾追加)
+typedef enum {
+    TELEM_ANGLE = 0,        ///< 角度 (计数)
+    TELEM_ANGLE_SP,         ///< 角度设定值
+    TELEM_ANGLE_VEL,        ///< 角速度估计 (计数/秒)
+    TELEM_PRESS_SP_A,       ///< 肌肉A 压力设定 (kPa)
+    TELEM_PRESS_SP_B,
+    TELEM_PRESS_A,          ///< 肌肉A 压力测量 (kPa)
+    TELEM_PRESS_B,
+    TELEM_DUTY_A_IN,        ///< 阀门占空比 (0-8191)
+    TELEM_DUTY_A_OUT,
+    TELEM_DUTY_B_IN,
+    TELEM_DUTY_B_OUT,
+    TELEM_PID_P,            ///< 角度环 P/I/D 项
+    TELEM_PID_I,
+    TELEM_PID_D,
+    TELEM_SIG_NUM
+} telem_signal_t;
+
+// 控制回路每周期写入的定长记录
+typedef struct {
+    uint32_t t_us;
+    uint16_t seq;           ///< 写入序号 (队列满丢弃的记录同样占用序号)
+    float    v[TELEM_SIG_NUM];
+} telem_record_t;
+
+// 启动发送任务
+void telemetry_init(void);
+
+// 控制回路调用：填入时间戳与序号并写入一条记录 (队列满时丢弃并计数，接收端表现为序号缺口)
+void telemetry_push(telem_record_t *rec);
+
+// 发送队列中的全部记录 (发送任务周期调用；仿真中由仿真循环调用)
+void telemetry_flush(void);
+
+// 替换时间戳来源 (仿真时钟)，默认 esp_timer_get_time
+void telemetry_set_clock(int64_t (*clock)(void));
+
+// 设置信号 sig 的抽取系数: 每 n 条记录发送一次，0 = 关闭
+void telemetry_set_decimation(telem_signal_t sig, uint16_t n);
+
+// 已丢弃的记录数 (队列满)
+uint32_t telemetry_dropped(void);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,277 @@
+#include "valve_cal.h"
+#include "hardware_config.h"
+#include "press.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include "nvs.h"
+#endif
+
+static const char *TAG = "VALVE_CAL";
+
+#define CAL_NVS_NAMESPACE   "pam"
+#define CAL_NVS_KEY         "valve_lin"
+#define CAL_LAYOUT_VER      1
+
+#define CAL_INLET_START_KPA 150.0f  // 进气阀测量的起始压力
+#define CAL_OUTLET_START_KPA 350.0f // 排气阀测量的起始压力
+#define CAL_PREP_TIMEOUT_MS 5000    // 充/放到起始压力的超时
+#define CAL_REST_MS         300     // 到达起始压力后静置 (等关节摆动与气体温度平稳)
+#define CAL_SETTLE_MS       40      // 阀门动作后丢弃的过渡时间 (2 个 PWM 周期)
+#define CAL_WINDOW_MS       200     // 斜率拟合窗口 (最长)
+#define CAL_MAX_DELTA_KPA   30.0f   // 压力偏离起始值超过此值即结束窗口，使各点都在相同压差下测量
+#define CAL_NOISE_FRAC      0.05f   // 低于满流量 5% 的读数视为零 (基线受关节摆动影响)
+#define CAL_POLL_MS         10          // 一个 RTOS 节拍 (100 Hz)
+
+static valve_lin_t tables[VALVE_NUM];
+static bool        tables_valid;
+static valve_lin_t identity;        // 越界索引的返回值
+
+typedef struct {
+    uint32_t    layout;
+    valve_lin_t tab[VALVE_NUM];
+} cal_blob_t;
+
+static void set_identity(void) {
+    valve_lin_identity(&identity, VALVE_MAX_DUTY);
+    for (int v = 0; v < VALVE_NUM; v++) valve_lin_identity(&tables[v], VALVE_MAX_DUTY);
+    tables_valid = false;
+}
+
+static void all_closed(void) {
+    const uint32_t zero[VALVE_NUM] = { 0 };
+    valve_set_duty_all(zero);
+}
+
+static float read_kpa(int ch) {
+    press_sample_t s;
+    if (!pressure_get_sample(ch, &s)) return 0.0f;
+    return (float)s.kpa;
+}
+
+/**
+ * @brief 用满开的进气或排气阀把肌肉充/放到起始压力，然后关阀静置
+ * * @return true 在超时前到达
+ */
+static bool bring_to(int muscle, float target_kpa, valve_cal_wait_t wait) {
+    int in = muscle * 2, out = muscle * 2 + 1;
+    bool fill = read_kpa(muscle) < target_kpa;
+
+    all_closed();
+    valve_set_duty(fill ? in : out, VALVE_MAX_DUTY);
+
+    bool ok = false;
+    for (uint32_t t = 0; t < CAL_PREP_TIMEOUT_MS; t += CAL_POLL_MS) {
+        wait(CAL_POLL_MS);
+        float p = read_kpa(muscle);
+        if (fill ? p >= target_kpa : p <= target_kpa) {
+            ok = true;
+            break;
+        }
+    }
+    all_closed();
+    wait(CAL_REST_MS);
+    return ok;
+}
+
+/**
+ * @brief 在窗口内对新到达的气压采样做最小二乘直线拟合
+ * * @return float 压力变化率 (kPa/s)
+ */
+static float measure_slope(int ch, valve_cal_wait_t wait) {
+    press_sample_t s;
+    pressure_get_sample(ch, &s);
+    uint32_t last_frames = s.frames;
+    int64_t t0 = s.timestamp_us;
+
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = 0;
+    for (uint32_t t = 0; t < CAL_WINDOW_MS; t += CAL_POLL_MS) {
+        wait(CAL_POLL_MS);
+        if (!pressure_get_sample(ch, &s) || s.frames == last_frames) continue;
+        last_frames = s.frames;
+
+        double x = (double)(s.timestamp_us - t0) * 1e-6;
+        double y = (double)s.kpa;
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        n++;
+
+        if (n >= 3 && fabs(y - sy / n) > CAL_MAX_DELTA_KPA) break;
+    }
+
+    double den = n * sxx - sx * sx;
+    if (n < 3 || den <= 0.0) return 0.0f;
+    return (float)((n * sxy - sx * sy) / den);
+}
+
+/**
+ * @brief 单点测量: 回到起始压力，以给定占空比打开被测阀并测量压力变化率
+ * * @param flow 流量指标 (kPa/s，进气为正，排气取反后为正)
+ * * @return false 超时未到达起始压力 (阀门或传感器故障)，应中止标定
+ */
+static bool measure_flow(int valve, uint32_t duty, valve_cal_wait_t wait, float *flow) {
+    int muscle = valve / 2;
+    bool inlet = (valve % 2) == 0;
+
+    if (!bring_to(muscle, inlet ? CAL_INLET_START_KPA : CAL_OUTLET_START_KPA, wait)) {
+        ESP_LOGE(TAG, "Valve %d: muscle %d did not reach start pressure", valve, muscle);
+        return false;
+    }
+    valve_set_duty(valve, duty);
+    wait(CAL_SETTLE_MS);
+    float slope = measure_slope(muscle, wait);
+    all_closed();
+
+    *flow = inlet ? slope : -slope;
+    return true;
+}
+
+/**
+ * @brief 扫描点的相对流量: 测量该点后紧接着测一次满开参考，
+ *        以前后两次参考的均值归一化。进气流量随储气罐压力 (400~600 kPa 滞环) 变化明显，
+ *        只用一次满开测量归一化时整条曲线会随测量时刻的气源压力整体偏移。
+ * * @param ref 输入上一次参考值，输出本次参考值
+ */
+static bool measure_rel(int valve, uint32_t duty, float base, float *ref, valve_cal_wait_t wait, float *rel) {
+    float f, r;
+    if (!measure_flow(valve, duty, wait, &f) || !measure_flow(valve, VALVE_MAX_DUTY, wait, &r)) return false;
+
+    r -= base;
+    float den = 0.5f * (*ref + r);
+    *ref = r;
+    *rel = den > 0.0f ? (f - base) / den : 0.0f;
+    return true;
+}
+
+int valve_cal_run(valve_cal_wait_t wait) {
+    const float step = (float)VALVE_MAX_DUTY / (float)(VALVE_LIN_POINTS - 1);
+    valve_lin_t tab[VALVE_NUM];
+    int ok = 0;
+
+    for (int v = 0; v < VALVE_NUM; v++) {
+        float flow[VALVE_LIN_POINTS];
+        float base, ref;
+
+        // 占空比 0 的读数为泄漏等基线，从各点中扣除
+        if (!measure_flow(v, 0, wait, &base) || !measure_flow(v, VALVE_MAX_DUTY, wait, &ref)) goto abort;
+        ref -= base;
+
+        float peak = 0.0f;
+        flow[0] = 0.0f;
+        for (int i = 1; i < VALVE_LIN_POINTS; i++) {
+            if (!measure_rel(v, (uint32_t)(i * step + 0.5f), base, &ref, wait, &flow[i])) goto abort;
+            if (flow[i] > peak) peak = flow[i];
+        }
+        for (int i = 1; i < VALVE_LIN_POINTS; i++) {
+            if (flow[i] < peak * CAL_NOISE_FRAC) flow[i] = 0.0f;
+        }
+
+        if (valve_lin_build(&tab[v], flow, VALVE_MAX_DUTY)) {
+            ok++;
+            ESP_LOGI(TAG, "Valve %d: full flow %.0f kPa/s, onset duty %u", v, ref, tab[v].duty[0]);
+        } else {
+            ESP_LOGE(TAG, "Valve %d: no flow measured, left uncalibrated", v);
+        }
+    }
+
+    all_closed();
+    memcpy(tables, tab, sizeof(tables));
+    tables_valid = ok == VALVE_NUM;
+    return ok;
+
+abort:
+    // 中止: 不采用任何部分结果，查找表保持恒等映射
+    all_closed();
+    set_identity();
+    ESP_LOGE(TAG, "Calibration aborted");
+    return 0;
+}
+
+float valve_cal_linearity(int valve, bool linearized, valve_cal_wait_t wait) {
+    if (valve < 0 || valve >= VALVE_NUM) return 0.0f;
+
+    float base, ref;
+    if (!measure_flow(valve, 0, wait, &base) || !measure_flow(valve, VALVE_MAX_DUTY, wait, &ref)) return 1.0f;
+    ref -= base;
+    if (ref <= 0.0f) return 1.0f;
+
+    float max_err = 0.0f;
+    for (int k = 1; k <= 10; k++) {
+        float q = (float)k / 10.0f;
+        uint32_t cmd = (uint32_t)(q * VALVE_MAX_DUTY + 0.5f);
+        uint32_t duty = linearized ? valve_lin_apply(&tables[valve], cmd, VALVE_MAX_DUTY) : cmd;
+
+        float got;
+        if (!measure_rel(valve, duty, base, &ref, wait, &got)) return 1.0f;
+        float err = fabsf(got - q);
+        if (err > max_err) max_err = err;
+    }
+    return max_err;
+}
+
+bool valve_cal_load(void) {
+    set_identity();
+#if CONFIG_IDF_TARGET_LINUX
+    return false;
+#else
+    nvs_handle_t h;
+    if (nvs_open(CAL_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return false;
+
+    cal_blob_t blob;
+    size_t len = sizeof(blob);
+    esp_err_t err = nvs_get_blob(h, CAL_NVS_KEY, &blob, &len);
+    nvs_close(h);
+    if (err != ESP_OK || len != sizeof(blob) || blob.layout != CAL_LAYOUT_VER) return false;
+
+    // 查找表必须单调且落在量程内
+    for (int v = 0; v < VALVE_NUM; v++) {
+        for (int i = 1; i < VALVE_LIN_POINTS; i++) {
+            if (blob.tab[v].duty[i] < blob.tab[v].duty[i - 1] || blob.tab[v].duty[i] > VALVE_MAX_DUTY) {
+                ESP_LOGW(TAG, "Stored table for valve %d invalid, ignoring calibration", v);
+                return false;
+            }
+        }
+    }
+
+    memcpy(tables, blob.tab, sizeof(tables));
+    tables_valid = true;
+    ESP_LOGI(TAG, "Valve tables loaded from NVS");
+    return true;
+#endif
+}
+
+esp_err_t valve_cal_save(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    cal_blob_t blob = { .layout = CAL_LAYOUT_VER };
+    memcpy(blob.tab, tables, sizeof(tables));
+
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(CAL_NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, CAL_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+
+    if (err != ESP_OK) ESP_LOGE(TAG, "Save failed: %s", esp_err_to_name(err));
+    return err;
+#endif
+}
+
+const valve_lin_t *valve_cal_table(int valve) {
+    // 越界时返回恒等映射 (调用者直接把返回值交给 valve_lin_apply)
+    if (valve < 0 || valve >= VALVE_NUM) {
+        ESP_LOGE(TAG, "Invalid valve index %d", valve);
+        return &identity;
+    }
+    return &tables[valve];
+}
+
+bool valve_cal_valid(void) {
+    return tables_valid;
+}
@@ -0,0 +1,38 @@
+//阀门标定
+//逐个阀门扫描占空比，用气压驱动测量对应的压力变化率作为流量指标，
+//建立每个阀门的线性化查找表 (valve_lin)，保存在 NVS 中。
+//标定过程会直接驱动阀门，必须在控制任务启动之前 (或暂停期间) 运行。
+
+#ifndef VALVE_CAL_H
+#define VALVE_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "hal_valves.h"
+#include "valve_lin.h"
+
+// 等待函数: 目标上为 vTaskDelay，仿真中推进仿真时钟
+typedef void (*valve_cal_wait_t)(uint32_t ms);
+
+// 从 NVS 载入查找表，失败时使用恒等映射并返回 false
+bool valve_cal_load(void);
+
+// 保存当前查找表到 NVS
+esp_err_t valve_cal_save(void);
+
+// 依次标定四个阀门并更新查找表 (阻塞，约 1.5 分钟)；返回成功标定的阀门数，
+// 任一测量点无法回到起始压力时中止并返回 0 (查找表保持恒等映射)
+int valve_cal_run(valve_cal_wait_t wait);
+
+// 线性度误差: 按 10%..100% 流量指令输出 (linearized 选择是否经过查找表)，
+// 返回实测归一化流量与指令之差的最大绝对值
+float valve_cal_linearity(int valve, bool linearized, valve_cal_wait_t wait);
+
+// 当前查找表 (控制回路只读)
+const valve_lin_t *valve_cal_table(int valve);
+
+// 是否已有标定数据 (否则查找表为恒等映射)
+bool valve_cal_valid(void);
+
+#endif // VALVE_CAL_H
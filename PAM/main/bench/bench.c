@@ -0,0 +1,135 @@
+#include "bench.h"
+#include "hardware_config.h"
+#include "freertos/FreeRTOS.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+
+#ifdef CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define BENCH_CPU_MHZ   CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#else
+#define BENCH_CPU_MHZ   0       // linux 目标: 没有周期计数器
+#endif
+
+#if CONFIG_COMPILER_OPTIMIZATION_PERF
+#define BENCH_OPT       "perf"
+#elif CONFIG_COMPILER_OPTIMIZATION_SIZE
+#define BENCH_OPT       "size"
+#elif CONFIG_COMPILER_OPTIMIZATION_DEBUG
+#define BENCH_OPT       "debug"
+#elif CONFIG_COMPILER_OPTIMIZATION_NONE
+#define BENCH_OPT       "none"
+#elif defined(__OPTIMIZE_SIZE__)
+#define BENCH_OPT       "size"
+#elif defined(__OPTIMIZE__)
+#define BENCH_OPT       "perf"
+#else
+#define BENCH_OPT       "none"
+#endif
+
+volatile uint32_t bench_sink;
+
+// 计时: 目标上为 CPU 周期，linux 上为 ns
+#if CONFIG_IDF_TARGET_LINUX
+static inline uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#define irq_save()      ((void)0)
+#define irq_restore()   ((void)0)
+#else
+static inline uint64_t bench_now(void) {
+    return esp_cpu_get_cycle_count();
+}
+#define irq_save()      portDISABLE_INTERRUPTS()
+#define irq_restore()   portENABLE_INTERRUPTS()
+#endif
+
+// 字符串按 JSON 转义输出 (只处理引号、反斜杠与控制字符)
+static void json_str(const char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') printf("\\%c", *s);
+        else if ((unsigned char)*s < 0x20) printf("\\u%04x", *s);
+        else putchar(*s);
+    }
+    putchar('"');
+}
+
+void bench_begin(void) {
+    const char *tag = PAM_BENCH_TAG;
+#if CONFIG_IDF_TARGET_LINUX
+    if (getenv("PAM_BENCH_TAG")) tag = getenv("PAM_BENCH_TAG");
+#endif
+    printf("{\"type\":\"build\",\"tag\":");
+    json_str(tag);
+    printf(",\"target\":");
+    json_str(CONFIG_IDF_TARGET);
+    printf(",\"cpu_mhz\":%d,\"compiler\":", BENCH_CPU_MHZ);
+    json_str(__VERSION__);
+    printf(",\"opt\":\"%s\",\"fixed_point\":%d,\"pipeline\":%d}\n", BENCH_OPT, PAM_FIXED_POINT, PAM_PIPELINE_MODE);
+    fflush(stdout);
+}
+
+void bench_run(const bench_kernel_t *k, bench_result_t *out) {
+    bench_result_t r = { 0 };
+    double ns_m2 = 0.0, cyc_m2 = 0.0;
+    uint32_t warmup = k->warmup ? k->warmup : 1;
+
+    for (uint32_t b = 0; b < warmup + k->batches; b++) {
+        if (k->prep) k->prep(k->ctx, b);
+
+        if (k->irq_off) irq_save();
+        uint64_t t0 = bench_now();
+        for (uint32_t i = 0; i < k->iters; i++) {
+            k->run(k->ctx, i);
+        }
+        uint64_t t1 = bench_now();
+        if (k->irq_off) irq_restore();
+        if (b < warmup) continue;
+
+        // 每批的平均值为一个样本 (Welford 在线方差)
+#if CONFIG_IDF_TARGET_LINUX
+        double ns = (double)(t1 - t0) / k->iters;
+        double cyc = 0.0;
+#else
+        double cyc = (double)(uint32_t)(t1 - t0) / k->iters;   // 计数器 32 位回绕
+        double ns = cyc * 1000.0 / BENCH_CPU_MHZ;
+#endif
+        r.samples++;
+        double d = ns - r.ns_mean;
+        r.ns_mean += d / r.samples;
+        ns_m2 += d * (ns - r.ns_mean);
+        d = cyc - r.cyc_mean;
+        r.cyc_mean += d / r.samples;
+        cyc_m2 += d * (cyc - r.cyc_mean);
+        if (r.samples == 1 || ns < r.ns_min) { r.ns_min = ns; r.cyc_min = cyc; }
+        if (r.samples == 1 || ns > r.ns_max) { r.ns_max = ns; r.cyc_max = cyc; }
+    }
+    if (r.samples > 1) {
+        r.ns_sd = sqrt(ns_m2 / (r.samples - 1));
+        r.cyc_sd = sqrt(cyc_m2 / (r.samples - 1));
+    }
+
+    printf("{\"type\":\"result\",\"name\":");
+    json_str(k->name);
+    if (k->arg >= 0) printf(",\"arg\":%ld", (long)k->arg);
+    if (k->synthetic) printf(",\"synthetic\":true");
+    printf(",\"iters\":%lu,\"batches\":%lu,\"irq_off\":%s,\"ns_per_op\":%.1f,\"ns_sd\":%.1f,\"ns_min\":%.1f,\"ns_max\":%.1f",
+           (unsigned long)k->iters, (unsigned long)r.samples, k->irq_off ? "true" : "false",
+           r.ns_mean, r.ns_sd, r.ns_min, r.ns_max);
+#if CONFIG_IDF_TARGET_LINUX
+    printf(",\"cycles_per_op\":null,\"cycles_sd\":null,\"cycles_min\":null,\"cycles_max\":null}\n");
+#else
+    printf(",\"cycles_per_op\":%.1f,\"cycles_sd\":%.1f,\"cycles_min\":%.1f,\"cycles_max\":%.1f}\n",
+           r.cyc_mean, r.cyc_sd, r.cyc_min, r.cyc_max);
+#endif
+    fflush(stdout);
+    if (out) *out = r;
+}
@@ -0,0 +1,47 @@
+//微基准: 算法与驱动热路径的单次耗时
+//每个内核按批运行: 批前执行不计时的准备函数，然后连续调用 iters 次并计时；以每批的平均值为
+//一个样本，统计每次调用的 ns 与 CPU 周期数的均值、标准差、最小/最大值 (标准差反映批间波动)。
+//目标上使用 CPU 周期计数器，纯计算内核在批内屏蔽本核中断；linux 目标使用 CLOCK_MONOTONIC，
+//没有周期数 (输出 null)。
+//结果逐行输出 JSON (JSON Lines): 第一行为构建信息，之后每个内核一行，可直接从串口日志中提取，
+//由 tools/pam_bench_compare.py 对比不同构建与编译选项。
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef PAM_BENCH_TAG
+#define PAM_BENCH_TAG           ""      // 构建标签 (idf.py -DPAM_BENCH_TAG=...)，linux 目标可用环境变量覆盖
+#endif
+
+typedef struct {
+    const char *name;
+    void (*run)(void *ctx, uint32_t i);         ///< 被测操作 (一次调用)，i 为批内序号
+    void (*prep)(void *ctx, uint32_t batch);    ///< 批前准备，不计时 (可为 NULL)
+    void *ctx;
+    int32_t  arg;               ///< 输出中的参数 (如关节数)，< 0 不输出
+    uint32_t iters;             ///< 每批调用次数
+    uint32_t batches;           ///< 样本数
+    uint32_t warmup;            ///< 不计入统计的起始批数
+    bool     irq_off;           ///< 批内屏蔽中断 (只用于不等待外设的内核)
+    bool     synthetic;         ///< 参数超出本机硬件 (如合成关节)，输出中标记 "synthetic"
+} bench_kernel_t;
+
+typedef struct {
+    uint32_t samples;
+    double   ns_mean, ns_sd, ns_min, ns_max;        ///< 每次调用 (ns)
+    double   cyc_mean, cyc_sd, cyc_min, cyc_max;    ///< 每次调用 (CPU 周期)，无周期计数器时为 0
+} bench_result_t;
+
+// 防止被测结果被优化掉: 内核把结果累加到这里
+extern volatile uint32_t bench_sink;
+
+// 输出构建信息行 (目标、CPU 频率、编译器与优化级别、数值路径、标签)
+void bench_begin(void);
+
+// 运行一个内核并输出结果行；out 可为 NULL
+void bench_run(const bench_kernel_t *k, bench_result_t *out);
+
+#endif // BENCH_H
@@ -0,0 +1,655 @@
+//微基准入口 (idf.py -DPAM_BENCH=1 build，目标与 linux 目标相同)
+//依次测量: 算法内核 (浮点与 Q16.16 定点的 PID / 卡尔曼滤波、1~8 通道的角度滤波器组、N 个 PID / 一维
+//卡尔曼滤波按结构体数组逐个计算与 ctrl_bank 一次计算的对比、CRC-8、帧解析)，驱动读写
+//(as5600 单次读取、扫描快照、阀门批量提交)，遥测 (二进制记录的写入与发送，对比同一记录格式化为
+//文本行及经 printf 输出到 stderr)，单关节 arm_control 的调度节拍，以及 1~8 个关节的
+//joint_rt 完整控制周期 (ANGLE_LOOP_PERIOD_TICKS 个节拍，关节 I/O 为内存中的合成读数，只计算控制本身，超出本机硬件的关节数在结果行中标记 synthetic)。
+//linux 目标上驱动由 sim_hal 的被控对象实现，节拍之间推进仿真时钟；目标上按实时 1 kHz 节拍运行，
+//会驱动阀门 (须断开气源)，气泵不启动。基准任务绑定控制核。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "hardware_config.h"
+#include "bench.h"
+#include "hal_pump.h"
+#include "hal_valves.h"
+#include "as5600.h"
+#include "as5600_track.h"
+#include "press.h"
+#include "press_frame.h"
+#include "arm_control.h"
+#include "joint_rt.h"
+#include "param_store.h"
+#include "valve_cal.h"
+#include "telemetry.h"
+#include "traj.h"
+#include "kalman.h"
+#include "kalman_q.h"
+#include "pid.h"
+#include "pid_q.h"
+#include "ctrl_bank.h"
+#include "press_obs.h"
+#include "ik_table.h"
+#include "cart_ctrl.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "sim_hal.h"
+#else
+#include "sensor_pipeline.h"
+#include "nvs_flash.h"
+#endif
+
+static const char *TAG = "BENCH";
+
+#define KERNEL_ITERS        1000    // 算法内核每批调用次数
+#define KERNEL_BATCHES      50
+#define DRIVER_ITERS        10      // 驱动内核 (I2C 读取约 100 us)
+#define DRIVER_BATCHES      50
+#define ARM_TICKS           2000    // arm_control 计时的节拍数 (每节拍一个样本)
+#define ARM_WARMUP_TICKS    100     // 含第一次压力环的 PWM 同步
+#define ARM_MOVE_TICKS      1000    // 每隔这么多节拍追加一个路点，使轨迹始终在运动
+#define JOINT_CYCLES        500     // joint_rt 每种关节数的控制周期数
+#define JOINT_MOVE_CYCLES   50
+
+// ---------------- 输入 ----------------
+
+// 256 个 [-1, 1) 的伪随机数，内核按调用序号取用 (输入不是常量，且只多一次加载)
+#define NOISE_LEN   256
+static float noise[NOISE_LEN];
+static q16_t noise_q[NOISE_LEN];
+
+static void noise_init(void) {
+    uint32_t s = 12345;
+    for (int i = 0; i < NOISE_LEN; i++) {
+        s = s * 1664525u + 1013904223u;
+        noise[i] = (float)(s >> 8) * (2.0f / 16777216.0f) - 1.0f;
+        noise_q[i] = q16_from_float(noise[i]);
+    }
+}
+
+#define NOISE(i)    noise[(i) & (NOISE_LEN - 1)]
+#define NOISE_Q(i)  noise_q[(i) & (NOISE_LEN - 1)]
+
+// ---------------- 算法内核 ----------------
+
+static pid_ctrl_t  k_pid;
+static pid_timed_t k_pid_t;
+static pid_timed_t k_pid_td;        ///< 差分微分 + 一阶滤波
+static pid_timed_t k_pid_sat;       ///< 设定值远超量程: 输出持续饱和，反算抗饱和每次生效
+static pid_q_t     k_pid_q;
+static KalmanFilter k_kf;
+static kf_q_t      k_kf_q;
+static kf_cv_t     k_kf_cv;
+static kf_cv_q_t   k_kf_cv_q;
+static press_parser_t k_parser;
+static pam_model_params_t k_obs_model;
+static press_obs_t k_obs;
+static int64_t     k_obs_t_us;
+static ik_table_t  k_ik;
+static float       k_ik_pts[NOISE_LEN][2];     ///< 可达区域内的末端位置
+static uint8_t     k_frame[PRESS_FRAME_MIN_LEN] = { PRESS_FRAME_HEADER, PRESS_FRAME_MIN_LEN, PRESS_FRAME_P1 };
+
+static void run_nop(void *ctx, uint32_t i) {
+    bench_sink += i;
+}
+
+static void run_pid(void *ctx, uint32_t i) {
+    float u = pid_compute(&k_pid, 100.0f * NOISE(i));
+    bench_sink += (uint32_t)(int32_t)u;
+}
+
+static void run_pid_timed(void *ctx, uint32_t i) {
+    float u = pid_timed_compute_rate(&k_pid_t, 100.0f * NOISE(i), 500.0f * NOISE(i + 1), ANGLE_LOOP_NOMINAL_S);
+    bench_sink += (uint32_t)(int32_t)u;
+}
+
+static void run_pid_timed_diff(void *ctx, uint32_t i) {
+    float u = pid_timed_compute(&k_pid_td, 100.0f * NOISE(i), ANGLE_LOOP_NOMINAL_S);
+    bench_sink += (uint32_t)(int32_t)u;
+}
+
+static void run_pid_timed_sat(void *ctx, uint32_t i) {
+    float u = pid_timed_compute_rate(&k_pid_sat, 100.0f * NOISE(i), 500.0f * NOISE(i + 1), ANGLE_LOOP_NOMINAL_S);
+    bench_sink += (uint32_t)(int32_t)u;
+}
+
+static void run_pid_q(void *ctx, uint32_t i) {
+    static const q16_t dt = (q16_t)(ANGLE_LOOP_NOMINAL_S * Q16_ONE);
+    q16_t u = pid_q_compute_rate(&k_pid_q, 100 * NOISE_Q(i), 500 * NOISE_Q(i + 1), dt);
+    bench_sink += (uint32_t)u;
+}
+
+static void run_kf(void *ctx, uint32_t i) {
+    float x = kf_update(&k_kf, 100.0f + NOISE(i));
+    bench_sink += (uint32_t)(int32_t)x;
+}
+
+static void run_kf_q(void *ctx, uint32_t i) {
+    q16_t x = kf_q_update(&k_kf_q, q16_from_int(100) + NOISE_Q(i));
+    bench_sink += (uint32_t)x;
+}
+
+static void run_kf_cv(void *ctx, uint32_t i) {
+    float x = kf_cv_update(&k_kf_cv, 100.0f + NOISE(i), ANGLE_LOOP_NOMINAL_S);
+    bench_sink += (uint32_t)(int32_t)x;
+}
+
+static void run_kf_cv_q(void *ctx, uint32_t i) {
+    q16_t x = kf_cv_q_update(&k_kf_cv_q, q16_from_int(100) + NOISE_Q(i), ANGLE_LOOP_PERIOD_TICKS * CTRL_BASE_TICK_US);
+    bench_sink += (uint32_t)x;
+}
+
+// 一帧气压应答 (不含 CRC 字节) 的 CRC-8
+static void run_crc8(void *ctx, uint32_t i) {
+    k_frame[3] = (uint8_t)i;
+    bench_sink += press_crc8(k_frame, PRESS_FRAME_MIN_LEN - 1);
+}
+
+// 写入一帧完整应答并取出 (含 CRC 校验)
+static void run_parser(void *ctx, uint32_t i) {
+    k_frame[3] = (uint8_t)i;
+    k_frame[PRESS_FRAME_MIN_LEN - 1] = press_crc8(k_frame, PRESS_FRAME_MIN_LEN - 1);
+    size_t done = 0;
+    while (done < PRESS_FRAME_MIN_LEN) {
+        uint8_t *p;
+        size_t n = press_parser_write_ptr(&k_parser, &p);
+        if (n > PRESS_FRAME_MIN_LEN - done) n = PRESS_FRAME_MIN_LEN - done;
+        memcpy(p, k_frame + done, n);
+        press_parser_commit(&k_parser, n);
+        done += n;
+    }
+    press_frame_t f;
+    if (press_parser_next(&k_parser, &f)) bench_sink += f.value;
+}
+
+// 压力环每周期的观测器更新: 外推一个压力环周期 (按 PRESS_OBS_SUBSTEP_US 分步) + 一次新采样的校正
+// (最坏情况: 每个周期都有新采样，需回溯预测历史)
+static void run_press_obs(void *ctx, uint32_t i) {
+    k_obs_t_us += PRESS_LOOP_PERIOD_TICKS * CTRL_BASE_TICK_US;
+    float u = NOISE(i);
+    press_obs_predict(&k_obs, k_obs_t_us, u > 0.0f ? u : 0.0f, u < 0.0f ? -u : 0.0f, PUMP_SWITCH_HIGH_KPA,
+                      0.3f * NOISE(i + 7), NOISE(i + 13));
+    press_obs_correct(&k_obs, k_obs.p_hat + NOISE(i + 3), k_obs_t_us - SENSOR_ACQ_PERIOD_US);
+    bench_sink += (uint32_t)k_obs.p_hat;
+}
+
+static void run_ik_lookup(void *ctx, uint32_t i) {
+    ik_sol_t sol;
+    ik_table_lookup(&k_ik, k_ik_pts[i & (NOISE_LEN - 1)][0], k_ik_pts[i & (NOISE_LEN - 1)][1], &sol);
+    bench_sink += (uint32_t)(sol.q[1] * 1000.0f);
+}
+
+// 角度滤波器组: 一次调用更新 arg 个通道 (与驱动扫描一轮相同: 回绕展开 + 匀速模型滤波)，
+// 各通道的原始读数在 0/4095 附近游走，包含回绕
+typedef struct {
+    as5600_track_t ch[8];
+    int      n;
+    int64_t  t_us;
+} track_bank_t;
+
+static track_bank_t k_track;
+
+static void run_track_bank(void *ctx, uint32_t i) {
+    track_bank_t *b = ctx;
+    b->t_us += SENSOR_ACQ_PERIOD_US;
+    for (int c = 0; c < b->n; c++) {
+        uint16_t raw = (uint16_t)((int32_t)(40.0f * NOISE(i + c * 31)) + 4096) & 0x0FFF;
+        as5600_track_update(&b->ch[c], raw, b->t_us);
+    }
+    bench_sink += (uint32_t)as5600_track_pos(&b->ch[0]);
+}
+
+// N 个控制器: 逐个结构体调用 (AoS) 与 ctrl_bank 一次计算 (SoA)，参数与输入相同，一次调用更新全部 N 个
+typedef struct {
+    int          n;
+    pid_ctrl_t   pid[CTRL_BANK_MAX];
+    KalmanFilter kf[CTRL_BANK_MAX];
+    pid_bank_t   pid_bank;
+    kf_bank_t    kf_bank;
+    float        in[CTRL_BANK_MAX];
+    float        out[CTRL_BANK_MAX];
+} ctrl_set_t;
+
+static ctrl_set_t k_set;
+
+static void set_inputs(ctrl_set_t *c, uint32_t i) {
+    for (int j = 0; j < c->n; j++) c->in[j] = 100.0f * NOISE(i + j * 7);
+}
+
+static void run_pid_structs(void *ctx, uint32_t i) {
+    ctrl_set_t *c = ctx;
+    set_inputs(c, i);
+    for (int j = 0; j < c->n; j++) c->out[j] = pid_compute(&c->pid[j], c->in[j]);
+    bench_sink += (uint32_t)(int32_t)c->out[c->n - 1];
+}
+
+static void run_pid_bank(void *ctx, uint32_t i) {
+    ctrl_set_t *c = ctx;
+    set_inputs(c, i);
+    pid_bank_compute(&c->pid_bank, c->in, c->out);
+    bench_sink += (uint32_t)(int32_t)c->out[c->n - 1];
+}
+
+static void run_kf_structs(void *ctx, uint32_t i) {
+    ctrl_set_t *c = ctx;
+    set_inputs(c, i);
+    for (int j = 0; j < c->n; j++) c->out[j] = kf_update(&c->kf[j], c->in[j]);
+    bench_sink += (uint32_t)(int32_t)c->out[c->n - 1];
+}
+
+static void run_kf_bank(void *ctx, uint32_t i) {
+    ctrl_set_t *c = ctx;
+    set_inputs(c, i);
+    kf_bank_update(&c->kf_bank, c->in, c->out);
+    bench_sink += (uint32_t)(int32_t)c->out[c->n - 1];
+}
+
+static void ctrl_set_init(ctrl_set_t *c, int n) {
+    c->n = n;
+    pid_bank_init(&c->pid_bank, n);
+    kf_bank_init(&c->kf_bank, n);
+    for (int j = 0; j < n; j++) {
+        pid_init(&c->pid[j], 2.0f, 0.05f, 1.0f, -150.0f, 150.0f);
+        pid_bank_config(&c->pid_bank, j, 2.0f, 0.05f, 1.0f, -150.0f, 150.0f);
+        kf_init(&c->kf[j], 0.0f, 1.0f, 0.01f, 1.0f);
+        kf_bank_config(&c->kf_bank, j, 0.0f, 1.0f, 0.01f, 1.0f);
+    }
+}
+
+static void kernels_init(void) {
+    noise_init();
+    pid_init(&k_pid, 2.0f, 0.05f, 1.0f, -150.0f, 150.0f);
+    k_pid.int_limit = 150.0f;
+    // 角度环默认增益 (微分、设定值权重与反算抗饱和都参与计算)
+    static const param_pid_t gains = JOINT_ANGLE_PID_DEFAULT;
+    pid_timed_init(&k_pid_t, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    param_pid_apply(&gains, ANGLE_LOOP_NOMINAL_S, &k_pid_t);
+    k_pid_td = k_pid_t;
+    k_pid_td.d_tau = 0.02f;
+    k_pid_sat = k_pid_t;
+    k_pid_sat.setpoint = 1e4f;
+    pid_q_config(&k_pid_q, &k_pid_t);
+    pid_q_reset(&k_pid_q);
+    kf_init(&k_kf, 100.0f, 1.0f, 0.01f, 1.0f);
+    kf_q_init(&k_kf_q, q16_from_int(100), 1.0f, 0.01f, 1.0f);
+    kf_cv_init(&k_kf_cv, 100.0f, 1e6f, 1.0f);
+    kf_cv_q_init(&k_kf_cv_q, q16_from_int(100), 1e6f, 1.0f);
+    press_parser_init(&k_parser);
+
+    press_obs_cfg_t obs_cfg = {
+        .gain = PRESS_OBS_GAIN, .resid_alpha = PRESS_OBS_RESID_ALPHA, .resid_limit_kpa = PRESS_OBS_RESID_KPA,
+        .stale_us = PRESS_OBS_STALE_MS * 1000, .coast_us = PRESS_OBS_COAST_MS * 1000,
+        .substep_us = PRESS_OBS_SUBSTEP_US,
+    };
+    pam_model_default_params(&k_obs_model);
+    press_obs_init(&k_obs, &k_obs_model, 0, &obs_cfg);
+    k_obs_t_us = 0;
+    press_obs_correct(&k_obs, BASE_PRESSURE, k_obs_t_us);
+
+    // 肩/肘取基准关节表的前两个关节 (±90°)；查表点为随机位形的正运动学
+    ik_arm_t arm;
+    cart_ctrl_arm(&arm, &joint_bench_table[0], &joint_bench_table[1], CART_LINK1_MM, CART_LINK2_MM,
+                  CART_ELBOW_MARGIN_DEG * (3.14159265f / 180.0f));
+    ik_table_build(&k_ik, &arm);
+    for (int i = 0; i < NOISE_LEN; i++) {
+        float q[2] = { arm.q_max[0] * NOISE(i), arm.q2_margin + (arm.q_max[1] - arm.q2_margin) * fabsf(NOISE(i + 5)) };
+        ik_forward(&arm, q, &k_ik_pts[i][0], &k_ik_pts[i][1]);
+    }
+}
+
+static void bench_algorithms(void) {
+    static const struct { const char *name; void (*run)(void *, uint32_t); } k[] = {
+        { "nop",                    run_nop },          // 调用与循环开销
+        { "pid_compute",            run_pid },
+        { "pid_timed_compute_rate", run_pid_timed },
+        { "pid_timed_compute",      run_pid_timed_diff },
+        { "pid_timed_saturated",    run_pid_timed_sat },
+        { "pid_q_compute_rate",     run_pid_q },
+        { "kf_update",              run_kf },
+        { "kf_q_update",            run_kf_q },
+        { "kf_cv_update",           run_kf_cv },
+        { "kf_cv_q_update",         run_kf_cv_q },
+        { "press_crc8",             run_crc8 },
+        { "press_parser_frame",     run_parser },
+        { "press_obs_update",       run_press_obs },
+        { "ik_table_lookup",        run_ik_lookup },
+    };
+    kernels_init();
+    for (size_t i = 0; i < sizeof(k) / sizeof(k[0]); i++) {
+        bench_kernel_t bk = {
+            .name = k[i].name, .run = k[i].run, .arg = -1,
+            .iters = KERNEL_ITERS, .batches = KERNEL_BATCHES, .irq_off = true,
+        };
+        bench_run(&bk, NULL);
+    }
+
+    static const int bank_n[] = { 1, 4, 8 };
+    for (size_t i = 0; i < sizeof(bank_n) / sizeof(bank_n[0]); i++) {
+        memset(&k_track, 0, sizeof(k_track));
+        k_track.n = bank_n[i];
+        for (int c = 0; c < k_track.n; c++) as5600_track_reset(&k_track.ch[c]);
+        bench_kernel_t bk = {
+            .name = "as5600_track_bank", .run = run_track_bank, .ctx = &k_track, .arg = bank_n[i],
+            .iters = KERNEL_ITERS, .batches = KERNEL_BATCHES, .irq_off = true,
+        };
+        bench_run(&bk, NULL);
+    }
+
+    // 每次调用更新 N 个，按 N 除即为每关节/每回路的耗时
+    static const struct { const char *name; void (*run)(void *, uint32_t); } set_k[] = {
+        { "pid_compute_structs",    run_pid_structs },
+        { "pid_bank_compute",       run_pid_bank },
+        { "kf_update_structs",      run_kf_structs },
+        { "kf_bank_update",         run_kf_bank },
+    };
+    static const int set_n[] = { 2, 8, CTRL_BANK_MAX };
+    for (size_t i = 0; i < sizeof(set_n) / sizeof(set_n[0]); i++) {
+        for (size_t j = 0; j < sizeof(set_k) / sizeof(set_k[0]); j++) {
+            ctrl_set_init(&k_set, set_n[i]);
+            bench_kernel_t bk = {
+                .name = set_k[j].name, .run = set_k[j].run, .ctx = &k_set, .arg = set_n[i],
+                .iters = KERNEL_ITERS, .batches = KERNEL_BATCHES, .irq_off = true,
+            };
+            bench_run(&bk, NULL);
+        }
+    }
+}
+
+// ---------------- 驱动 ----------------
+
+static void run_as5600_read(void *ctx, uint32_t i) {
+    bench_sink += (uint32_t)as5600_get_angle(0);
+}
+
+static void run_as5600_snapshot(void *ctx, uint32_t i) {
+    static as5600_scan_t scan;
+    as5600_get_snapshot(&scan);
+    bench_sink += (uint32_t)scan.ch[0].angle;
+}
+
+// 全关 (目标上不会让关节动作)；提交时刻距 PWM 周期起点不足保护时间时包含等待
+static void run_valves_commit(void *ctx, uint32_t i) {
+    static const uint32_t closed[VALVE_NUM] = { 0 };
+    valve_set_duty_all(closed);
+}
+
+// 单次 I2C 读取在采集流水线启动之前测量 (之后由采集核独占总线)
+static void bench_drivers(void) {
+    static const struct { const char *name; void (*run)(void *, uint32_t); bool irq_off; } k[] = {
+        { "as5600_get_angle",       run_as5600_read,     false },
+        { "as5600_get_snapshot",    run_as5600_snapshot, true },
+        { "valve_set_duty_all",     run_valves_commit,   false },
+    };
+    for (size_t i = 0; i < sizeof(k) / sizeof(k[0]); i++) {
+        bench_kernel_t bk = {
+            .name = k[i].name, .run = k[i].run, .arg = -1,
+            .iters = DRIVER_ITERS, .batches = DRIVER_BATCHES, .irq_off = k[i].irq_off,
+        };
+        bench_run(&bk, NULL);
+    }
+}
+
+// ---------------- 遥测 ----------------
+
+#if PAM_TELEMETRY_ENABLE
+static telem_record_t k_telem;
+
+static void telem_fill(uint32_t i) {
+    for (int s = 0; s < TELEM_SIG_NUM; s++) k_telem.v[s] = 100.0f * NOISE(i + s);
+}
+
+// 控制回路中的开销: 写入一条定长记录 (批前清空队列，批内不会丢弃)
+static void telem_prep_flush(void *ctx, uint32_t batch) {
+    telemetry_flush();
+}
+
+static void run_telem_push(void *ctx, uint32_t i) {
+    telem_fill(i);
+    telemetry_push(&k_telem);
+}
+
+// 发送任务中的开销: 每条记录的抽取、打包、COBS 与写出
+static void telem_prep_push(void *ctx, uint32_t batch) {
+    telem_fill(batch);
+    telemetry_push(&k_telem);
+}
+
+static void run_telem_flush(void *ctx, uint32_t i) {
+    telemetry_flush();
+}
+
+// 文本方式: 同一条记录格式化为一行 CSV (只格式化 / 经 printf 输出到控制台)。输出写到 stderr:
+// 目标上与 stdout 是同一控制台 (开销相同)，主机上不混入 stdout 的 JSON Lines 结果
+static int telem_format(char *buf, size_t len, uint32_t i) {
+    telem_fill(i);
+    const float *v = k_telem.v;
+    return snprintf(buf, len, "%lu,%.1f,%.1f,%.1f,%.2f,%.2f,%.2f,%.2f,%.0f,%.0f,%.0f,%.0f,%.3f,%.3f,%.3f\n",
+                    (unsigned long)i, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
+                    v[11], v[12], v[13]);
+}
+
+static void run_telem_snprintf(void *ctx, uint32_t i) {
+    static char line[192];
+    bench_sink += (uint32_t)telem_format(line, sizeof(line), i);
+}
+
+static void run_telem_printf(void *ctx, uint32_t i) {
+    static char line[192];
+    telem_format(line, sizeof(line), i);
+    bench_sink += (uint32_t)fprintf(stderr, "%s", line);
+}
+
+static void bench_telemetry(void) {
+    static const struct {
+        const char *name;
+        void (*run)(void *, uint32_t);
+        void (*prep)(void *, uint32_t);
+        uint32_t iters, batches;
+    } k[] = {
+        { "telemetry_push",     run_telem_push,     telem_prep_flush, 32,           KERNEL_BATCHES },
+        { "telemetry_flush_1",  run_telem_flush,    telem_prep_push,  1,            KERNEL_BATCHES * 10 },
+        { "telemetry_snprintf", run_telem_snprintf, NULL,             KERNEL_ITERS, KERNEL_BATCHES },
+        { "telemetry_printf",   run_telem_printf,   NULL,             1,            20 },
+    };
+    for (size_t i = 0; i < sizeof(k) / sizeof(k[0]); i++) {
+        bench_kernel_t bk = {
+            .name = k[i].name, .run = k[i].run, .prep = k[i].prep, .arg = -1,
+            .iters = k[i].iters, .batches = k[i].batches, .irq_off = false,
+        };
+        bench_run(&bk, NULL);
+    }
+    fflush(stdout);
+}
+#endif
+
+// ---------------- 单关节 arm_control ----------------
+
+static uint32_t arm_tick;
+#if !CONFIG_IDF_TARGET_LINUX
+static int64_t  arm_next_us;
+#endif
+
+// 节拍之间: linux 目标推进被控对象，目标上等到下一个 1 ms 节拍 (不计时)
+static void arm_prep(void *ctx, uint32_t batch) {
+#if CONFIG_IDF_TARGET_LINUX
+    sim_hal_advance(CTRL_BASE_TICK_US);
+#else
+    if (batch % 100 == 0) vTaskDelay(1);    // 让出控制核，空闲任务喂看门狗
+    while (esp_timer_get_time() < arm_next_us) { }
+    arm_next_us = esp_timer_get_time() + CTRL_BASE_TICK_US;
+#endif
+    if (batch % ARM_MOVE_TICKS == 0) {
+        arm_move_to((batch / ARM_MOVE_TICKS) & 1 ? -200.0f : 200.0f, 0.6f, TRAJ_MIN_JERK);
+    }
+}
+
+// 一次调度节拍 (arm_control_task 的一次迭代: 到期的角度环与压力环)
+static void run_arm_step(void *ctx, uint32_t i) {
+    arm_control_step(++arm_tick);
+}
+
+static void bench_arm_control(void) {
+    bench_kernel_t bk = {
+        .name = "arm_control_step", .run = run_arm_step, .prep = arm_prep, .arg = -1,
+        .iters = 1, .batches = ARM_TICKS, .warmup = ARM_WARMUP_TICKS, .irq_off = false,
+    };
+    bench_run(&bk, NULL);
+}
+
+// ---------------- 多关节 joint_rt ----------------
+
+typedef struct {
+    joint_rt_t rt;
+    int64_t    now_us;
+    uint32_t   tick;
+} joint_bench_t;
+
+static joint_bench_t jb;
+
+// 合成读数: 角度与气压在噪声表上按节拍游走，各通道错开
+static bool jb_read_angle(void *ctx, int ch, joint_angle_t *out) {
+    joint_bench_t *b = ctx;
+    out->angle = 50.0f * NOISE(b->tick / 4 + ch * 31);
+    out->vel = 500.0f * NOISE(b->tick / 4 + ch * 31 + 1);
+    out->t_us = b->now_us;
+    return true;
+}
+
+static bool jb_read_press(void *ctx, int ch, uint32_t *pa, int64_t *t_us) {
+    joint_bench_t *b = ctx;
+    *pa = (uint32_t)((BASE_PRESSURE + 20.0f * NOISE(b->tick / 8 + ch * 17)) * 1000.0f);
+    *t_us = b->now_us - SENSOR_ACQ_PERIOD_US / 2;
+    return true;
+}
+
+static void jb_write_valves(void *ctx, const joint_desc_t *d, const uint32_t duty[VALVE_NUM]) {
+    bench_sink += duty[0] + duty[1] + duty[2] + duty[3];
+}
+
+static void jb_prep(void *ctx, uint32_t batch) {
+    joint_bench_t *b = ctx;
+    if (batch % JOINT_MOVE_CYCLES != 0) return;
+    float target = (batch / JOINT_MOVE_CYCLES) & 1 ? -200.0f : 200.0f;
+    for (int j = 0; j < b->rt.n; j++) {
+        joint_rt_move_to(&b->rt, j, target, 0.3f, TRAJ_MIN_JERK);
+    }
+}
+
+// 一个完整控制周期: 每个关节的角度环各一次、压力环各 ANGLE/PRESS 周期比次
+static void run_joint_cycle(void *ctx, uint32_t i) {
+    joint_bench_t *b = ctx;
+    for (int t = 0; t < ANGLE_LOOP_PERIOD_TICKS; t++) {
+        b->tick++;
+        b->now_us += CTRL_BASE_TICK_US;
+        joint_rt_tick(&b->rt, b->now_us);
+    }
+}
+
+static void bench_joints(void) {
+    joint_io_t io = { jb_read_angle, jb_read_press, jb_write_valves, &jb };
+    for (int n = 1; n <= JOINT_MAX; n++) {
+        memset(&jb, 0, sizeof(jb));
+        joint_rt_init(&jb.rt, joint_bench_table, n, &io);
+        bench_kernel_t bk = {
+            .name = "joint_rt_cycle", .run = run_joint_cycle, .prep = jb_prep, .ctx = &jb, .arg = n,
+            .iters = 1, .batches = JOINT_CYCLES, .irq_off = true,
+            .synthetic = JOINT_BENCH_SYNTHETIC(n - 1),
+        };
+        bench_run(&bk, NULL);
+    }
+}
+
+// ---------------- 任务空间 cart_ctrl ----------------
+
+static joint_rt_t  cart_rt;             ///< 只接收外部参考，不运行回路
+static cart_ctrl_t k_cart;
+
+// 每批 (KERNEL_ITERS 个基础节拍) 追加一段末端直线，两端点交替，轨迹始终在运动
+static void cart_prep(void *ctx, uint32_t batch) {
+    static const float q_deg[2][2] = { { -15.0f, 30.0f }, { 15.0f, 50.0f } };
+    const float *qd = q_deg[batch & 1];
+    float q[2] = { qd[0] * (3.14159265f / 180.0f), qd[1] * (3.14159265f / 180.0f) }, x, y;
+    ik_forward(&k_ik.arm, q, &x, &y);
+    cart_ctrl_move_to(&k_cart, x, y, (float)KERNEL_ITERS * CTRL_BASE_TICK_US * 1e-6f * 0.8f, TRAJ_MIN_JERK);
+}
+
+// 一个基础节拍: 两轴轨迹 + 查表 + 两关节外部参考
+static void run_cart_step(void *ctx, uint32_t i) {
+    cart_ctrl_step(&k_cart, &cart_rt, CTRL_BASE_TICK_US * 1e-6f);
+}
+
+static void bench_cart(void) {
+    joint_io_t io = { jb_read_angle, jb_read_press, jb_write_valves, &jb };
+    joint_rt_init(&cart_rt, joint_bench_table, 2, &io);
+    cart_rt.joints[0].angle.angle = 0.0f;
+    cart_rt.joints[1].angle.angle = 45.0f * (4096.0f / 360.0f);    // 从可达位形起步
+    cart_ctrl_init(&k_cart, &k_ik, 0, 1);
+    bench_kernel_t bk = {
+        .name = "cart_ctrl_step", .run = run_cart_step, .prep = cart_prep, .arg = -1,
+        .iters = KERNEL_ITERS, .batches = KERNEL_BATCHES, .irq_off = true,
+    };
+    bench_run(&bk, NULL);
+}
+
+// ---------------- 入口 ----------------
+
+static void bench_task(void *arg) {
+    bench_begin();
+    bench_algorithms();
+    bench_drivers();
+#if PAM_TELEMETRY_ENABLE
+    bench_telemetry();
+#endif
+#if PAM_PIPELINE_MODE
+    sensor_pipeline_start();
+#endif
+    bench_arm_control();
+    bench_joints();
+    bench_cart();
+    ESP_LOGI(TAG, "Done");
+#if CONFIG_IDF_TARGET_LINUX
+    exit(0);
+#else
+    vTaskDelete(NULL);
+#endif
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "========= PAM Micro-benchmark =========");
+
+    // 与 main.c 相同的初始化顺序 (不启动控制任务；目标上不启动气泵、不做阀门标定)
+#if CONFIG_IDF_TARGET_LINUX
+    sim_hal_init(BASE_PRESSURE);
+    pump_init();
+    arm_control_set_clock(sim_hal_now_us);  // 采样时刻与被控对象同为仿真时钟
+#endif
+    valves_init();
+    as5600_init();
+    pressure_sensor_init();
+#if !CONFIG_IDF_TARGET_LINUX
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+#endif
+    param_store_init();
+    valve_cal_load();
+    arm_control_init();
+#if PAM_TELEMETRY_ENABLE
+    telemetry_init();       // 压力环每周期写遥测记录
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+    bench_task(NULL);
+#else
+    xTaskCreatePinnedToCore(bench_task, "Bench_Task", 8192, NULL, 5, NULL, CONTROL_CORE);
+#endif
+}
@@ -1,19 +1,62 @@
+//AS5600 角度传感器驱动：多通道批量扫描
+//使用新版 I2C 主机驱动的异步模式，事务完成回调置位标志并释放信号量；扫描时发出当前通道的读事务后，
+//在总线传输期间处理上一通道的数据 (展开 + 卡尔曼滤波)，一轮结束后以时间戳快照整体发布。
+//单个通道超时只标记该通道，不影响其余通道；超时的事务必须等驱动结束 (必要时复位总线) 后
+//才能发起下一个，否则迟到的完成回调会被当作下一事务的结果，收发缓冲也可能仍在被写入。
+//每个原始读数 (含超时) 都写入传感器轨迹；回放时 as5600_scan 不访问总线，
+//由 as5600_replay_sample 注入记录的原始读数，经相同的展开与滤波后发布。
+
 #include "as5600.h"
 #include "hardware_config.h"
-#include "kalman.h"
-#include "driver/i2c.h"
-#include "esp_log.h"
+#include "as5600_track.h"
+#include "sensor_trace.h"
+#include "seqlock.h"
+#include "driver/i2c_master.h"
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_rom_sys.h"
+#include <string.h>
+#include <stdatomic.h>
 
 static const char *TAG = "AS5600";
 #define AS5600_ADDR 0x36
+#define REG_STATUS  0x0B    // STATUS, RAW_ANGLE_H/L, ANGLE_H/L 连续排列
 #define REG_ANGLE_H 0x0E
-#define REG_ANGLE_L 0x0F
+#define REG_AGC     0x1A
+
+// 异步事务状态 (回调写，扫描任务读)
+#define XFER_PENDING    0
+#define XFER_DONE       1
+#define XFER_FAILED     2
 
-static KalmanFilter kf;
-static uint16_t zero_offset = 0;
+// 每个 MUX 通道独立的滤波状态
+typedef struct {
+    as5600_track_t track;   // 展开 + 滤波
+    int32_t  zero;          // 零点 (展开后的计数)
+    bool     zero_pending;  // 零点请求时尚无读数: 以首个读数为零点
+    uint8_t  rx[5];         // 异步事务接收缓冲 (事务完成前必须保持有效)
+} as5600_chan_t;
+
+static as5600_chan_t chans[AS5600_CHANNEL_COUNT];
+static atomic_bool zero_request;
 static uint8_t zero_set_flag = 0;
 
+static i2c_master_bus_handle_t bus;
+static i2c_master_dev_handle_t dev;
+static atomic_int xfer_state;
+static SemaphoreHandle_t xfer_sem;     ///< 完成回调释放，等待方阻塞获取
+static StaticSemaphore_t xfer_sem_buf;
+static bool bus_stuck;                  ///< 超时事务无法结束: 不再发起事务 (收发缓冲可能仍被占用)
+
+// 扫描结果：扫描任务写，控制任务读
+static seqlock_t snap_lock = SEQLOCK_INIT;
+static as5600_scan_t snap;
+static as5600_scan_t work;      ///< 正在进行的一轮 (仅扫描任务访问)
+
 // 多路选择器通道切换
 static void as5600_select_channel(int channel) {
     // 根据 hardware_config.h 中的定义设置 GPIO
@@ -22,18 +65,37 @@ static void as5600_select_channel(int channel) {
     gpio_set_level(MUX_AS5600_C, (channel >> 2) & 0x01);
 }
 
+static bool IRAM_ATTR xfer_done_cb(i2c_master_dev_handle_t d, const i2c_master_event_data_t *evt, void *arg) {
+    BaseType_t woken = pdFALSE;
+    atomic_store_explicit(&xfer_state, evt->event == I2C_EVENT_DONE ? XFER_DONE : XFER_FAILED,
+                          memory_order_release);
+    xSemaphoreGiveFromISR(xfer_sem, &woken);
+    return woken == pdTRUE;
+}
+
 void as5600_init(void) {
-    // 1. 配置 I2C
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
+    // 1. 配置 I2C (trans_queue_depth > 0 即异步模式)
+    i2c_master_bus_config_t bus_cfg = {
+        .i2c_port = I2C_MASTER_NUM,
         .sda_io_num = I2C_MASTER_SDA_IO,
         .scl_io_num = I2C_MASTER_SCL_IO,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .trans_queue_depth = 2,
+        .flags.enable_internal_pullup = true,
+    };
+    ESP_ERROR_CHECK(i2c_new_master_bus(&bus_cfg, &bus));
+
+    // 所有传感器地址相同，经 MUX 区分，总线上只挂一个设备
+    i2c_device_config_t dev_cfg = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = AS5600_ADDR,
+        .scl_speed_hz = I2C_MASTER_FREQ_HZ,
     };
-    i2c_param_config(I2C_MASTER_NUM, &conf);
-    i2c_driver_install(I2C_MASTER_NUM, conf.mode, 0, 0, 0);
+    ESP_ERROR_CHECK(i2c_master_bus_add_device(bus, &dev_cfg, &dev));
+    xfer_sem = xSemaphoreCreateBinaryStatic(&xfer_sem_buf);
+    i2c_master_event_callbacks_t cbs = { .on_trans_done = xfer_done_cb };
+    ESP_ERROR_CHECK(i2c_master_register_event_callbacks(dev, &cbs, NULL));
 
     // 2. 配置多路选择器引脚
     gpio_config_t io_conf = {
@@ -45,50 +107,211 @@ void as5600_init(void) {
     };
     gpio_config(&io_conf);
 
-    // 3. 初始化卡尔曼滤波
-    kf_init(&kf, 0, 2, 1, 1);
-    
-    ESP_LOGI(TAG, "AS5600 Sensor Initialized");
+    // 3. 卡尔曼滤波在每个通道首次读数时初始化
+    for (int i = 0; i < AS5600_CHANNEL_COUNT; i++) {
+        as5600_track_reset(&chans[i].track);
+    }
+    memset(&snap, 0, sizeof(snap));
+    memset(&work, 0, sizeof(work));
+
+    ESP_LOGI(TAG, "AS5600 Sensor Initialized (scan mask 0x%02x)", (unsigned)AS5600_SCAN_MASK);
 }
 
-static uint16_t read_raw_angle() {
-    uint8_t data[2];
-    uint8_t reg = REG_ANGLE_H; // 从高位寄存器开始读
-    
-    // I2C 写地址
-    i2c_master_write_read_device(I2C_MASTER_NUM, AS5600_ADDR, &reg, 1, data, 2, pdMS_TO_TICKS(100));
-    
-    // 拼接高低位 (AS5600 数据格式: HighByte << 8 | LowByte)
-    // 注意：你队友的代码是先读L再读H，标准做法通常是一次读2字节或者按序读
-    // 这里使用标准 I2C 读取
-    uint16_t angle = ((data[0] << 8) | data[1]) & 0x0FFF; // 12位精度
-    return angle;
+// 发出一次 “写寄存器地址 + 读 len 字节” 事务，立即返回
+static bool xfer_start(uint8_t reg, uint8_t *rx, size_t len) {
+    static uint8_t tx;      // 异步事务期间保持有效
+    if (bus_stuck) return false;
+    tx = reg;
+    xSemaphoreTake(xfer_sem, 0);    // 上一事务的完成信号已处理过 (或已被丢弃)
+    atomic_store_explicit(&xfer_state, XFER_PENDING, memory_order_relaxed);
+    return i2c_master_transmit_receive(dev, &tx, 1, rx, len, AS5600_XFER_DRAIN_MS) == ESP_OK;
 }
 
-void as5600_set_zero(void) {
-    as5600_select_channel(0); // 默认校准通道0
-    uint16_t raw = read_raw_angle();
-    zero_offset = raw;
-    zero_set_flag = 1;
-    ESP_LOGI(TAG, "Zero Point Set: %d", zero_offset);
+// 超时: 等驱动结束该事务 (完成或失败回调都会到达)，结束不了就复位总线再等一次
+static void xfer_abort(void) {
+    if (i2c_master_bus_wait_all_done(bus, AS5600_XFER_DRAIN_MS) == ESP_OK) return;
+    i2c_master_bus_reset(bus);
+    if (i2c_master_bus_wait_all_done(bus, AS5600_XFER_DRAIN_MS) == ESP_OK) return;
+    bus_stuck = true;
+    ESP_LOGE(TAG, "I2C transaction cannot be terminated, angle sensors disabled");
 }
 
-int16_t as5600_get_angle(int channel) {
+// 阻塞等待事务完成 (完成回调唤醒)；超时则先结束该事务再返回
+static bool xfer_wait(void) {
+    // 多等一拍: 只等 1 拍时可能在下一个节拍中断立即到期
+    const TickType_t ticks = (AS5600_XFER_TIMEOUT_MS + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS + 1;
+    if (xSemaphoreTake(xfer_sem, ticks) != pdTRUE) {
+        xfer_abort();
+        return false;
+    }
+    return atomic_load_explicit(&xfer_state, memory_order_acquire) == XFER_DONE;
+}
+
+static bool read_regs(int channel, uint8_t reg, uint8_t *rx, size_t len) {
     as5600_select_channel(channel);
-    
-    uint16_t raw = read_raw_angle();
-    
-    // 卡尔曼滤波
-    float filtered = kf_update(&kf, (float)raw);
-    
+    esp_rom_delay_us(AS5600_MUX_SETTLE_US);
+    return xfer_start(reg, rx, len) && xfer_wait();
+}
+
+/**
+ * @brief 用新读数更新通道的展开角度与滤波状态
+ * * @return int16_t 相对零点的角度 (计数)
+ */
+static int16_t chan_update(int channel, uint16_t raw, int64_t now) {
+    as5600_chan_t *c = &chans[channel];
+
+    as5600_track_update(&c->track, raw, now);
+    if (c->zero_pending) {
+        c->zero = as5600_track_pos(&c->track);
+        c->zero_pending = false;
+    }
     if (!zero_set_flag) return 0;
+    return as5600_track_rel(&c->track, c->zero);
+}
 
-    // 计算相对角度
-    int32_t diff = (int32_t)filtered - (int32_t)zero_offset;
-    
-    // 处理过零点问题 (0-4096 回绕)
-    if (diff > 2048) diff -= 4096;
-    else if (diff < -2048) diff += 4096;
+// 零点请求: 各通道以当前滤波位置为零点 (在读取路径开头执行，避免与扫描并发修改通道状态)；
+// 尚无读数的通道保留原零点，收到首个读数时再取零点
+static void apply_zero_request(void) {
+    if (!atomic_exchange(&zero_request, false)) return;
+    for (int i = 0; i < AS5600_CHANNEL_COUNT; i++) {
+        if (chans[i].track.started) chans[i].zero = as5600_track_pos(&chans[i].track);
+        else chans[i].zero_pending = true;
+    }
+    zero_set_flag = 1;
+    ESP_LOGI(TAG, "Zero Point Set: %ld", (long)chans[0].zero);
+}
+
+void as5600_set_zero(void) {
+    atomic_store(&zero_request, true);
+}
+
+// 处理一个通道已完成的读数 (ANGLE 在接收缓冲中的偏移: 健康检查事务从 STATUS 开始)
+// 原始读数进入通道状态 (实时扫描与回放共用)
+static void sample_apply(int channel, uint16_t raw, int64_t t_us) {
+    as5600_sample_t *s = &work.ch[channel];
+    s->raw = raw;
+    s->t_us = t_us;
+    s->angle = chan_update(channel, raw, t_us);
+    s->velocity = as5600_track_vel(&chans[channel].track);
+    s->reads++;
+    s->valid = true;
+}
 
-    return (int16_t)diff;
-}
\ No newline at end of file
+static void sample_fail(int channel) {
+    work.ch[channel].timeouts++;
+    work.fault_mask |= 1u << channel;
+}
+
+// 处理一个通道已完成的读数 (ANGLE 在接收缓冲中的偏移: 健康检查事务从 STATUS 开始)
+static void scan_process(int channel, bool health) {
+    as5600_sample_t *s = &work.ch[channel];
+    if (!s->ok) {
+        trace_angle(channel, 0, false, work.t_us);
+        sample_fail(channel);
+        return;
+    }
+
+    const uint8_t *rx = chans[channel].rx;
+    const uint8_t *ang = health ? &rx[3] : rx;
+    uint16_t raw = ((ang[0] << 8) | ang[1]) & 0x0FFF; // 12位精度
+    if (health) {
+        s->status = rx[0] & (AS5600_STATUS_MD | AS5600_STATUS_ML | AS5600_STATUS_MH);
+        s->checked = true;
+    }
+
+    trace_angle(channel, raw, true, s->t_us);
+    sample_apply(channel, raw, s->t_us);
+}
+
+static void scan_publish(void) {
+    seqlock_write_begin(&snap_lock);
+    snap = work;
+    seqlock_write_end(&snap_lock);
+    work.pass++;
+}
+
+/**
+ * @brief 扫描一轮
+ * * 通道 ch 的事务在总线上传输时处理上一通道的读数，一轮结束后整体发布
+ * * 回放时不访问总线，只发布上一轮以来注入的读数
+ */
+void as5600_scan(void) {
+    bool health = AS5600_HEALTH_PASSES > 0 && work.pass % AS5600_HEALTH_PASSES == 0;
+    int prev = -1;
+
+    apply_zero_request();
+    work.t_us = esp_timer_get_time();
+    if (trace_replaying()) {
+        scan_publish();
+        work.fault_mask = 0;
+        return;
+    }
+    work.fault_mask = 0;
+
+    for (int ch = 0; ch < AS5600_CHANNEL_COUNT; ch++) {
+        if (!(AS5600_SCAN_MASK & (1u << ch))) continue;
+        as5600_sample_t *s = &work.ch[ch];
+
+        as5600_select_channel(ch);
+        esp_rom_delay_us(AS5600_MUX_SETTLE_US);
+        bool started = health ? xfer_start(REG_STATUS, chans[ch].rx, 5)
+                              : xfer_start(REG_ANGLE_H, chans[ch].rx, 2);
+
+        if (prev >= 0) scan_process(prev, health);     // 与本通道的总线传输重叠
+
+        s->ok = started && xfer_wait();
+        if (s->ok) s->t_us = esp_timer_get_time();
+        if (health && s->ok) {
+            static uint8_t agc;     // 异步事务期间保持有效
+            if (xfer_start(REG_AGC, &agc, 1) && xfer_wait()) s->agc = agc;
+        }
+        prev = ch;
+    }
+    if (prev >= 0) scan_process(prev, health);
+
+    scan_publish();
+}
+
+void as5600_replay_sample(int channel, uint16_t raw, bool ok, int64_t t_us) {
+    if (channel < 0 || channel >= AS5600_CHANNEL_COUNT) return;
+    work.ch[channel].ok = ok;
+    if (ok) sample_apply(channel, raw & 0x0FFF, t_us);
+    else sample_fail(channel);
+}
+
+void as5600_get_snapshot(as5600_scan_t *out) {
+    unsigned s;
+    do {
+        s = seqlock_read_begin(&snap_lock);
+        *out = snap;
+    } while (seqlock_read_retry(&snap_lock, s));
+}
+
+bool as5600_magnet_ok(const as5600_sample_t *s) {
+    if (!s->checked) return true;
+    return (s->status & (AS5600_STATUS_MD | AS5600_STATUS_ML | AS5600_STATUS_MH)) == AS5600_STATUS_MD;
+}
+
+int16_t as5600_get_angle(int channel) {
+    if (channel < 0 || channel >= AS5600_CHANNEL_COUNT) return 0;
+    as5600_chan_t *c = &chans[channel];
+    as5600_sample_t *s = &work.ch[channel];
+
+    apply_zero_request();
+    if (trace_replaying()) return s->angle;     // 读数由 as5600_replay_sample 注入
+    if (read_regs(channel, REG_ANGLE_H, c->rx, 2)) {
+        uint16_t raw = ((c->rx[0] << 8) | c->rx[1]) & 0x0FFF;
+        int64_t now = esp_timer_get_time();
+        trace_angle(channel, raw, true, now);
+        sample_apply(channel, raw, now);
+    } else {
+        trace_angle(channel, 0, false, esp_timer_get_time());
+        s->timeouts++;      // 超时: 保持上次的角度
+    }
+    return s->angle;
+}
+
+float as5600_get_velocity(int channel) {
+    if (channel < 0 || channel >= AS5600_CHANNEL_COUNT) return 0.0f;
+    return as5600_track_vel(&chans[channel].track);
+}
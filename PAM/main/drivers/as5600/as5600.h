@@ -2,15 +2,64 @@
 #define AS5600_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "hardware_config.h"
 
-// 初始化 I2C 和 多路选择引脚
+// STATUS 寄存器位
+#define AS5600_STATUS_MH    0x08    // 磁场过强
+#define AS5600_STATUS_ML    0x10    // 磁场过弱
+#define AS5600_STATUS_MD    0x20    // 检测到磁铁
+
+// 单通道最近一次扫描结果
+typedef struct {
+    int16_t  angle;         ///< 滤波后相对零点的角度 (计数，4096 计数 = 360°)；未设零点时为 0
+    float    velocity;      ///< 角速度估计 (计数/秒)
+    uint16_t raw;           ///< 最近一次成功读到的 ANGLE 寄存器
+    int64_t  t_us;          ///< 最近一次成功读取的完成时刻
+    uint32_t reads;         ///< 累计成功读取次数
+    uint32_t timeouts;      ///< 累计超时/NACK 次数
+    uint8_t  status;        ///< 最近一次健康检查的 STATUS (MD/ML/MH)
+    uint8_t  agc;           ///< 最近一次健康检查的 AGC (磁场越弱越大)
+    bool     checked;       ///< 做过健康检查 (status/agc 有效)
+    bool     ok;            ///< 本轮读取成功 (false: 超时，angle 为上次的值)
+    bool     valid;         ///< 至少成功读取过一次
+} as5600_sample_t;
+
+// 一轮扫描的完整角度向量
+typedef struct {
+    uint32_t pass;          ///< 扫描轮次
+    int64_t  t_us;          ///< 本轮开始时刻
+    uint32_t fault_mask;    ///< 本轮超时的通道 (位 = MUX 通道)
+    as5600_sample_t ch[AS5600_CHANNEL_COUNT];
+} as5600_scan_t;
+
+// 初始化 I2C (异步主机驱动) 和 多路选择引脚
 void as5600_init(void);
 
-// 设置当前位置为零点
+// 设置当前位置为零点 (各通道在下一次读取时记录)
 void as5600_set_zero(void);
 
-// 获取经过卡尔曼滤波后的角度
-// channel: 0-7 (对应多路选择器通道，如果没有MUX，传0即可)
+// 扫描 AS5600_SCAN_MASK 中的全部通道一轮并发布结果 (由采集任务周期调用)
+// 每个通道: 切换 MUX -> 等待稳定 -> 一次事务读 2 字节 ANGLE；每 AS5600_HEALTH_PASSES 轮加读 STATUS/AGC
+// 某通道超时只标记该通道，继续扫描其余通道
+void as5600_scan(void);
+
+// 读取最近一轮扫描结果，不阻塞
+void as5600_get_snapshot(as5600_scan_t *out);
+
+// 磁铁状态是否正常 (检测到磁铁且强度在范围内)；尚未做过健康检查时返回 true
+bool as5600_magnet_ok(const as5600_sample_t *s);
+
+// 单独读取一个通道并返回经过卡尔曼滤波后的角度 (单位: 计数，4096 计数 = 360°)
+// channel: 0 ~ AS5600_CHANNEL_COUNT-1 (对应多路选择器通道，如果没有MUX，传0即可)
+// 与 as5600_scan 共用滤波状态，同一配置下只应使用其中一种方式
 int16_t as5600_get_angle(int channel);
 
+// 获取该通道最近一次更新的角速度估计 (单位: 计数/秒)
+float as5600_get_velocity(int channel);
+
+// 回放: 注入一个记录的原始读数 (ok = false 为超时)，与实时读数经过相同的展开与滤波
+// 在下一次 as5600_scan 时发布；应在采集任务中调用
+void as5600_replay_sample(int channel, uint16_t raw, bool ok, int64_t t_us);
+
 #endif
@@ -0,0 +1,62 @@
+#include "as5600_track.h"
+#include <math.h>
+#include <string.h>
+
+// 匀速模型滤波参数 (单位: 计数, 4096 计数 = 360°)
+#define KF_ACCEL_NOISE  1.0e6f  // 角加速度谱密度 (计数²/s³)
+#define KF_MEAS_NOISE   1.0f    // 测量噪声方差 (计数²)
+
+void as5600_track_reset(as5600_track_t *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+void as5600_track_update(as5600_track_t *t, uint16_t raw, int64_t t_us) {
+    // 先展开 0-4095 回绕，再对连续角度滤波，避免在 4095->0 处拖尾
+    if (!t->started) {
+        t->unwrapped = raw;
+#if PAM_FIXED_POINT
+        kf_cv_q_init(&t->kf, q16_from_int(raw), KF_ACCEL_NOISE, KF_MEAS_NOISE);
+#else
+        kf_cv_init(&t->kf, (float)raw, KF_ACCEL_NOISE, KF_MEAS_NOISE);
+#endif
+        t->started = 1;
+    } else {
+        int32_t step = (int32_t)raw - (int32_t)t->last_raw;
+        if (step > 2048) step -= 4096;
+        else if (step < -2048) step += 4096;
+        t->unwrapped += step;
+
+#if PAM_FIXED_POINT
+        kf_cv_q_update(&t->kf, q16_from_int(t->unwrapped), (int32_t)(t_us - t->last_us));
+#else
+        kf_cv_update(&t->kf, (float)t->unwrapped, (float)(t_us - t->last_us) * 1e-6f);
+#endif
+    }
+    t->last_raw = raw;
+    t->last_us = t_us;
+}
+
+int32_t as5600_track_pos(const as5600_track_t *t) {
+#if PAM_FIXED_POINT
+    return q16_round(t->kf.x);
+#else
+    return (int32_t)lroundf(t->kf.x);
+#endif
+}
+
+float as5600_track_vel(const as5600_track_t *t) {
+    if (!t->started) return 0.0f;
+#if PAM_FIXED_POINT
+    return q16_to_float(kf_cv_q_velocity(&t->kf));
+#else
+    return t->kf.v;
+#endif
+}
+
+int16_t as5600_track_rel(const as5600_track_t *t, int32_t zero) {
+    // 处理过零点问题 (0-4096 回绕)
+    int32_t diff = (as5600_track_pos(t) - zero) % 4096;
+    if (diff > 2048) diff -= 4096;
+    else if (diff < -2048) diff += 4096;
+    return (int16_t)diff;
+}
@@ -0,0 +1,39 @@
+//AS5600 单通道读数处理: 0-4095 回绕展开 + 匀速模型卡尔曼滤波 + 相对零点换算
+//与总线无关，驱动、仿真与传感器轨迹回放共用，保证同一串原始读数得到完全相同的角度与速度。
+//PAM_FIXED_POINT 时滤波为 Q16.16 定点实现 (kalman_q)。
+
+#ifndef AS5600_TRACK_H
+#define AS5600_TRACK_H
+
+#include <stdint.h>
+#include "hardware_config.h"
+#include "kalman.h"
+#include "kalman_q.h"
+
+typedef struct {
+#if PAM_FIXED_POINT
+    kf_cv_q_t kf;           ///< 对展开后的角度滤波
+#else
+    kf_cv_t  kf;
+#endif
+    uint16_t last_raw;      ///< 上一次原始读数
+    int32_t  unwrapped;     ///< 展开后的连续角度 (计数)
+    int64_t  last_us;       ///< 上一次更新时刻
+    uint8_t  started;
+} as5600_track_t;
+
+void as5600_track_reset(as5600_track_t *t);
+
+// 以 t_us 时刻的 12 位原始读数更新
+void as5600_track_update(as5600_track_t *t, uint16_t raw, int64_t t_us);
+
+// 滤波后的展开角度 (计数，四舍五入)
+int32_t as5600_track_pos(const as5600_track_t *t);
+
+// 角速度估计 (计数/秒)，未开始时为 0
+float as5600_track_vel(const as5600_track_t *t);
+
+// 相对零点 (展开后的计数) 的角度，回绕到 ±2048
+int16_t as5600_track_rel(const as5600_track_t *t, int32_t zero);
+
+#endif // AS5600_TRACK_H
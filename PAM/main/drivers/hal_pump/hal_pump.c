@@ -1,44 +1,136 @@
 //气泵控制模块，使用 GPIO 输出控制继电器
+//压力开关边沿中断唤醒气泵任务，任务内去抖后交给 pump_ctrl 做滞环控制，
+//状态快照经邮箱发布给其他任务。
+//开关的每个原始边沿 (含触点抖动) 写入传感器轨迹；回放时忽略中断，由 pump_replay_switch 注入边沿。
 
 #include "hal_pump.h"
 #include "hardware_config.h"
+#include "mailbox.h"
+#include "sensor_trace.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <stdatomic.h>
 
 static const char *TAG = "PUMP_HAL";
 
+static pump_ctrl_t  ctrl;           ///< 只在气泵任务中访问
+static TaskHandle_t pump_task_handle;
+static atomic_uint  switch_edges;   ///< ISR 计数的原始边沿
+static atomic_int   pending_mode = -1;
+static atomic_bool  replay_low;     ///< 回放中的开关电平
+
+static mailbox_t     mb_status;
+static pump_status_t status_buf;
+
+// QPM11 (NC常闭): 低压闭合接地读到 0，高压断开被上拉读到 1
+static bool switch_low(void) {
+    return gpio_get_level(PRESSURE_SWITCH_PIN) == 0;
+}
+
+static void IRAM_ATTR switch_isr(void *arg) {
+    if (trace_replaying()) return;
+    trace_pump(switch_low(), true, esp_timer_get_time());
+    atomic_fetch_add_explicit(&switch_edges, 1, memory_order_relaxed);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(pump_task_handle, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief 气泵任务: 平时阻塞，只在开关边沿或推迟动作到期时运行
+ * * @param pvParameters 未使用
+ */
+static void pump_task(void *pvParameters) {
+    int64_t next_us = 0;
+    TickType_t timeout = 0;     // 启动时立即评估一次开关状态
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, timeout);
+
+        // 去抖: 开关在 PUMP_DEBOUNCE_MS 内不再出现边沿才采信
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PUMP_DEBOUNCE_MS)) > 0) {
+        }
+
+        bool low = trace_replaying() ? atomic_load(&replay_low) : switch_low();
+
+        int mode = atomic_exchange(&pending_mode, -1);
+        if (mode >= 0) pump_ctrl_set_mode(&ctrl, mode);
+        ctrl.st.edges = atomic_load_explicit(&switch_edges, memory_order_relaxed);
+
+        bool on = pump_ctrl_update(&ctrl, low, esp_timer_get_time(), &next_us);
+        // 回放时控制逻辑按记录的开关事件运行，继电器不动作 (阀门全关，不耗气)
+        gpio_set_level(PUMP_RELAY_PIN, on && !trace_replaying() ? 1 : 0);
+        mailbox_post(&mb_status, &ctrl.st);
+
+        // 最短开/关时间未到: 到期时再评估一次
+        if (next_us) {
+            int64_t wait_us = next_us - esp_timer_get_time();
+            timeout = wait_us > 0 ? pdMS_TO_TICKS(wait_us / 1000) + 1 : 1;
+        } else {
+            timeout = portMAX_DELAY;
+        }
+    }
+}
+
 void pump_init(void) {
     // 1. 配置继电器 (输出)
     gpio_reset_pin(PUMP_RELAY_PIN);
     gpio_set_direction(PUMP_RELAY_PIN, GPIO_MODE_OUTPUT);
     gpio_set_level(PUMP_RELAY_PIN, 0); // 默认关闭
 
-    // 2. 配置 QPM11 压力开关 (输入)
+    // 2. 配置 QPM11 压力开关 (输入，双边沿中断)
     gpio_reset_pin(PRESSURE_SWITCH_PIN);
     gpio_set_direction(PRESSURE_SWITCH_PIN, GPIO_MODE_INPUT);
     // 关键：启用内部上拉电阻
     // 因为 QPM11 另一端接 GND。闭合时接地(0)，断开时被拉高(1)。
     gpio_set_pull_mode(PRESSURE_SWITCH_PIN, GPIO_PULLUP_ONLY);
+    gpio_set_intr_type(PRESSURE_SWITCH_PIN, GPIO_INTR_ANYEDGE);
+
+    // 3. 控制器与状态邮箱
+    pump_ctrl_init(&ctrl, PUMP_MIN_ON_MS, PUMP_MIN_OFF_MS,
+                   PUMP_TANK_VOLUME_L * (PUMP_SWITCH_HIGH_KPA - PUMP_SWITCH_LOW_KPA) / 101.325f,
+                   esp_timer_get_time());
+    mailbox_init(&mb_status, &status_buf, sizeof(status_buf));
+    mailbox_post(&mb_status, &ctrl.st);
+
+    // 4. 任务先于中断就绪
+    xTaskCreate(pump_task, "Pump_Task", 2048, NULL, PUMP_TASK_PRIO, &pump_task_handle);
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) ESP_ERROR_CHECK(err);   // 已安装时忽略
+    ESP_ERROR_CHECK(gpio_isr_handler_add(PRESSURE_SWITCH_PIN, switch_isr, NULL));
 
     ESP_LOGI(TAG, "Pump Hardware Initialized (Relay: %d, Switch: %d)", PUMP_RELAY_PIN, PRESSURE_SWITCH_PIN);
 }
 
-void pump_control_loop(void) {
-    // 读取开关状态
-    int sw_state = gpio_get_level(PRESSURE_SWITCH_PIN);
-
-    // QPM11 (NC常闭) 逻辑:
-    // 气压低 -> 开关闭合 -> 导通到GND -> 读到 0
-    // 气压高 -> 开关断开 -> 内部上拉   -> 读到 1
-    
-    if (sw_state == 0) {
-        // 气压不足，开启气泵
-        gpio_set_level(PUMP_RELAY_PIN, 1);
-        // ESP_LOGD(TAG, "Pressure LOW -> Pump ON");
-    } else {
-        // 气压已满，关闭气泵
-        gpio_set_level(PUMP_RELAY_PIN, 0);
-        // ESP_LOGD(TAG, "Pressure HIGH -> Pump OFF");
-    }
+void pump_get_status(pump_status_t *out) {
+    mailbox_peek(&mb_status, out);
+}
+
+float pump_supply_margin(void) {
+    pump_status_t st;
+    mailbox_peek(&mb_status, &st);
+    return pump_ctrl_margin(&st, esp_timer_get_time());
+}
+
+bool pump_supply_low(void) {
+    return pump_supply_margin() < PUMP_SUPPLY_LOW_MARGIN;
+}
+
+void pump_trace_level(void) {
+    trace_pump(switch_low(), false, esp_timer_get_time());
+}
+
+void pump_replay_switch(bool low, bool edge, int64_t t_us) {
+    (void)t_us;     // 去抖在任务中按实际时间进行，与实时边沿相同
+    atomic_store(&replay_low, low);
+    if (edge) atomic_fetch_add_explicit(&switch_edges, 1, memory_order_relaxed);
+    if (pump_task_handle) xTaskNotifyGive(pump_task_handle);
+}
+
+void pump_set_mode(int mode) {
+    atomic_store(&pending_mode, mode);
+    if (pump_task_handle) xTaskNotifyGive(pump_task_handle);
 }
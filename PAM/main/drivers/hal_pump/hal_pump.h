@@ -1,11 +1,31 @@
 #ifndef HAL_PUMP_H
 #define HAL_PUMP_H
 
-// 初始化气泵和压力开关 GPIO
+#include <stdbool.h>
+#include <stdint.h>
+#include "pump_ctrl.h"
+
+// 初始化气泵继电器与压力开关 GPIO，并启动事件驱动的气泵任务:
+// 开关边沿中断唤醒任务，去抖后执行滞环控制 (最短开/关时间见 hardware_config.h)
 void pump_init(void);
 
-// 气泵保压逻辑任务 (放在 FreeRTOS 任务中运行)
-// 它会自动检测 QPM11 状态并启停气泵
-void pump_control_loop(void);
+// 读取气泵状态与统计 (无锁快照)
+void pump_get_status(pump_status_t *out);
+
+// 储气余量估计: 1 = 刚充满，0 = 到达低压阈值 (估计方法见 pump_ctrl_margin)
+float pump_supply_margin(void);
+
+// 预测气源不足 (余量低于 PUMP_SUPPLY_LOW_MARGIN)，控制器据此收敛激进动作
+bool pump_supply_low(void);
+
+// 设置当前控制模式 (PUMP_MODE_*)，耗气量按模式分别统计
+void pump_set_mode(int mode);
+
+// 把当前开关电平写入传感器轨迹 (开始记录时调用，回放据此得到初始电平)
+void pump_trace_level(void);
+
+// 回放: 注入一个记录的开关事件 (low: 事件后的电平；edge = false 为记录开始时的电平)，
+// 与中断路径相同地唤醒任务去抖
+void pump_replay_switch(bool low, bool edge, int64_t t_us);
 
 #endif
@@ -0,0 +1,95 @@
+#include "pump_ctrl.h"
+#include <string.h>
+
+void pump_ctrl_init(pump_ctrl_t *pc, uint32_t min_on_ms, uint32_t min_off_ms, float band_nl, int64_t now_us) {
+    memset(pc, 0, sizeof(*pc));
+    pc->min_on_ms = min_on_ms;
+    pc->min_off_ms = min_off_ms;
+    pc->band_nl = band_nl;
+    pc->start_us = now_us;
+    pc->last_relay_us = now_us - (int64_t)min_off_ms * 1000;   // 上电后允许立即启泵
+    pc->drain_mode = -1;
+}
+
+void pump_ctrl_set_mode(pump_ctrl_t *pc, int mode) {
+    if (mode < 0 || mode >= PUMP_MODE_NUM || mode == pc->mode) return;
+    pc->mode = mode;
+    pc->drain_mode = -1;    // 本次耗气跨越两种模式，不计入统计
+}
+
+// 开关边沿: 记录补气/耗气时间
+static void switch_edge(pump_ctrl_t *pc, bool low, int64_t now_us) {
+    pump_status_t *st = &pc->st;
+
+    if (low) {
+        // 高压 -> 低压: 一次完整的耗气过程 (需已见过高压边沿)
+        if (st->high_edge_us) {
+            st->last_drain_ms = (uint32_t)((now_us - st->high_edge_us) / 1000);
+            if (pc->drain_mode >= 0 && st->last_drain_ms) {
+                int m = pc->drain_mode;
+                pc->mode_nl[m] += pc->band_nl;
+                pc->mode_min[m] += st->last_drain_ms / 60000.0;
+                st->demand_nl_min[m] = (float)(pc->mode_nl[m] / pc->mode_min[m]);
+            }
+        }
+        st->low_edge_us = now_us;
+    } else {
+        if (st->low_edge_us) st->last_refill_ms = (uint32_t)((now_us - st->low_edge_us) / 1000);
+        st->high_edge_us = now_us;
+        pc->drain_mode = pc->mode;
+    }
+    st->switch_low = low;
+}
+
+/**
+ * @brief 滞环控制: 低压开泵、高压停泵，继电器两次动作之间至少间隔最短开/关时间
+ * * @param pc 控制器
+ * @param switch_low 去抖后的开关状态
+ * @param now_us 当前时刻
+ * @param next_us 输出: 推迟动作的到期时刻，无则为 0
+ * @return bool 继电器状态
+ */
+bool pump_ctrl_update(pump_ctrl_t *pc, bool switch_low, int64_t now_us, int64_t *next_us) {
+    pump_status_t *st = &pc->st;
+    *next_us = 0;
+
+    if (switch_low != st->switch_low) switch_edge(pc, switch_low, now_us);
+
+    if (switch_low != st->on) {
+        int64_t hold_us = (int64_t)(st->on ? pc->min_on_ms : pc->min_off_ms) * 1000;
+        int64_t due_us = pc->last_relay_us + hold_us;
+        if (now_us < due_us) {
+            if (!pc->deferred) st->held++;
+            pc->deferred = true;
+            *next_us = due_us;
+        } else {
+            if (st->on) pc->on_acc_us += now_us - pc->last_relay_us;
+            else st->cycles++;
+            st->on = switch_low;
+            pc->last_relay_us = now_us;
+            pc->deferred = false;
+        }
+    } else {
+        pc->deferred = false;   // 开关在推迟期间回到原状态，待执行的动作已无意义
+    }
+
+    st->on_us = pc->on_acc_us + (st->on ? now_us - pc->last_relay_us : 0);
+    st->elapsed_us = now_us - pc->start_us;
+    return st->on;
+}
+
+float pump_ctrl_margin(const pump_status_t *st, int64_t now_us) {
+    float frac;
+
+    if (st->switch_low) {
+        // 补气中: 上次补气时间内从低压阈值回升到高压阈值
+        if (!st->on || st->last_refill_ms == 0) return 0.0f;
+        frac = (float)(now_us - st->low_edge_us) / (st->last_refill_ms * 1000.0f);
+        return frac >= 1.0f ? 1.0f : frac;
+    }
+
+    // 耗气中: 上次耗气时间内从高压阈值降到低压阈值
+    if (st->last_drain_ms == 0 || st->high_edge_us == 0) return 1.0f;   // 尚无耗气数据
+    frac = (float)(now_us - st->high_edge_us) / (st->last_drain_ms * 1000.0f);
+    return frac >= 1.0f ? 0.0f : 1.0f - frac;
+}
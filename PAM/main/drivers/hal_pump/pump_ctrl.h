@@ -0,0 +1,64 @@
+//气泵滞环控制逻辑 (与硬件无关，目标与仿真共用)
+//输入为去抖后的压力开关状态，输出继电器状态；强制最短开/关时间防止继电器抖动，
+//并统计占空比、补气时间与各控制模式下的耗气量，据此预测“气源即将不足”。
+
+#ifndef PUMP_CTRL_H
+#define PUMP_CTRL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 控制模式: 耗气量按模式分别统计 (由控制器按阀门分配方式设置)
+enum {
+    PUMP_MODE_INLET_ONLY = 0,   // 只用进气阀 (valve_exhaust = 0)
+    PUMP_MODE_EXHAUST,          // 负输出开排气阀
+    PUMP_MODE_NUM
+};
+
+// 对外发布的状态快照
+typedef struct {
+    bool     on;                ///< 继电器状态
+    bool     switch_low;        ///< 去抖后的开关状态: true = 低压
+    uint32_t cycles;            ///< 启泵次数
+    uint32_t edges;             ///< 开关原始边沿数 (含抖动)
+    uint32_t held;              ///< 因最短开/关时间推迟动作的次数
+    uint32_t last_refill_ms;    ///< 最近一次补气: 低压 -> 高压
+    uint32_t last_drain_ms;     ///< 最近一次耗气: 高压 -> 低压 (气泵关闭期间)
+    int64_t  high_edge_us;      ///< 最近一次开关变为高压的时刻
+    int64_t  low_edge_us;       ///< 最近一次开关变为低压的时刻
+    int64_t  on_us;             ///< 累计运行时间 (占空比 = on_us / elapsed_us)
+    int64_t  elapsed_us;        ///< 统计起点至最近一次更新
+    float    demand_nl_min[PUMP_MODE_NUM];  ///< 各模式平均耗气量估计 (标准升/分钟)
+} pump_status_t;
+
+typedef struct {
+    uint32_t min_on_ms;
+    uint32_t min_off_ms;
+    float    band_nl;           ///< 储气罐在开关上下阈值之间的储气量 (标准升)
+
+    pump_status_t st;
+    int64_t  start_us;
+    int64_t  last_relay_us;     ///< 上次继电器动作
+    int64_t  on_acc_us;         ///< 已结束的运行区间累计
+    bool     deferred;          ///< 当前动作已被推迟 (held 只计一次)
+    int      mode;              ///< 当前控制模式
+    int      drain_mode;        ///< 本次耗气期间的模式，期间模式改变则为 -1
+    double   mode_nl[PUMP_MODE_NUM];
+    double   mode_min[PUMP_MODE_NUM];
+} pump_ctrl_t;
+
+// band_nl: 储气罐容积 × (高阈值 - 低阈值) / 大气压
+void pump_ctrl_init(pump_ctrl_t *pc, uint32_t min_on_ms, uint32_t min_off_ms, float band_nl, int64_t now_us);
+
+// 输入去抖后的开关状态，返回继电器应处的状态
+// *next_us: 因最短开/关时间推迟动作时，需在该时刻再次调用；否则为 0
+bool pump_ctrl_update(pump_ctrl_t *pc, bool switch_low, int64_t now_us, int64_t *next_us);
+
+// 设置当前控制模式 (PUMP_MODE_*)，用于耗气量分类统计
+void pump_ctrl_set_mode(pump_ctrl_t *pc, int mode);
+
+// 由状态快照估计储气余量: 1 = 刚充满，0 = 已到低压阈值
+// 耗气期间按上次耗气时间线性递减，补气期间按上次补气时间线性回升，低压且气泵未运行时为 0
+float pump_ctrl_margin(const pump_status_t *st, int64_t now_us);
+
+#endif // PUMP_CTRL_H
@@ -1,55 +1,161 @@
 //电磁阀控制模块，使用 LEDC 进行 PWM 输出
-//每个阀门对应一个 LEDC 通道，频率固定为 50Hz，分辨率为 13 位（0-8191）
+//每个阀门对应一个 LEDC 通道；同一 LEDC 定时器上的阀门为一组，频率与分辨率按组配置
+//(默认 VALVE_PWM_FREQ_HZ / 13 位)，接口占空比始终为 0~VALVE_MAX_DUTY。
+//定时器使用 APB 时钟 (由 PLL 分频)，esp_timer 使用 systimer (XTAL)，两者不同源: 组的周期起点经
+//valves_pwm_sync 与控制节拍对齐后仍有晶振误差引起的缓慢漂移，VALVE_PWM_LEAD_US 须留出余量。
+//热路径 (批量提交) 不断言: 驱动错误计入组统计，由上层定期报告。
+//传感器轨迹回放期间所有阀门保持关闭。
 
 #include "hal_valves.h"
 #include "hardware_config.h"
+#include "sensor_trace.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 static const char *TAG = "VALVE_HAL";
 
-// 建立通道到 GPIO 的映射数组，方便索引
-static const int valve_gpios[4] = {
-    VALVE_A_IN_PIN, 
-    VALVE_A_OUT_PIN, 
-    VALVE_B_IN_PIN, 
-    VALVE_B_OUT_PIN
+// 单关节接线: 通道 0~3 对应 A_IN, A_OUT, B_IN, B_OUT
+static const valve_port_t default_ports[VALVE_NUM] = {
+    { VALVE_A_IN_PIN,  0, VALVE_LEDC_TIMER },
+    { VALVE_A_OUT_PIN, 1, VALVE_LEDC_TIMER },
+    { VALVE_B_IN_PIN,  2, VALVE_LEDC_TIMER },
+    { VALVE_B_OUT_PIN, 3, VALVE_LEDC_TIMER },
 };
 
-void valves_init(void) {
-    // 1. 配置定时器
+typedef struct {
+    valve_group_cfg_t  cfg;         ///< freq_hz 为 0 表示使用默认值
+    bool               ready;       ///< LEDC 定时器已配置
+    valve_pwm_timing_t timing;
+    valve_pwm_stats_t  stats;       ///< 只由提交方 (控制任务) 写入
+} valve_group_t;
+
+static valve_group_t groups[VALVE_GROUP_MAX];
+static uint32_t mark_level;
+
+void valves_config_group(int timer, const valve_group_cfg_t *cfg) {
+    if (timer < 0 || timer >= VALVE_GROUP_MAX) return;
+    groups[timer].cfg = *cfg;
+}
+
+// 配置组的 LEDC 定时器 (只配置一次)，周期起点先取配置时刻，同步后精确
+static void group_setup(int timer) {
+    valve_group_t *g = &groups[timer];
+    if (g->ready) return;
+    if (g->cfg.freq_hz == 0) {
+        g->cfg.freq_hz = VALVE_PWM_FREQ_HZ;
+        g->cfg.res_bits = VALVE_LEDC_RES;
+    }
+
     ledc_timer_config_t ledc_timer = {
         .speed_mode       = VALVE_LEDC_MODE,
-        .timer_num        = VALVE_LEDC_TIMER,
-        .duty_resolution  = VALVE_LEDC_RES,
-        .freq_hz          = VALVE_PWM_FREQ_HZ, 
-        .clk_cfg          = LEDC_AUTO_CLK
+        .timer_num        = (ledc_timer_t)timer,
+        .duty_resolution  = (ledc_timer_bit_t)g->cfg.res_bits,
+        .freq_hz          = g->cfg.freq_hz,
+        .clk_cfg          = LEDC_USE_APB_CLK
     };
     ESP_ERROR_CHECK(ledc_timer_config(&ledc_timer));
 
-    // 2. 配置 4 个通道
-    for (int i = 0; i < 4; i++) {
+    // 分频系数为 10.8 定点: 不能整除时实际周期与名义周期不同，周期起点相对节拍漂移
+    uint64_t counts = (uint64_t)g->cfg.freq_hz << g->cfg.res_bits;
+    if ((80000000ull * 256) % counts != 0 || 1000000u % g->cfg.freq_hz != 0) {
+        ESP_LOGW(TAG, "Timer %d: %lu Hz / %u bit is not an exact period, PWM edges will drift from the control tick",
+                 timer, (unsigned long)g->cfg.freq_hz, g->cfg.res_bits);
+    }
+
+    valve_pwm_timing_init(&g->timing, g->cfg.freq_hz, esp_timer_get_time());
+    valve_pwm_stats_reset(&g->stats);
+    g->ready = true;
+}
+
+void valves_init_ports(const valve_port_t *ports, int n) {
+    for (int i = 0; i < n; i++) {
+        // 1. 配置定时器 (每组一次)
+        group_setup(ports[i].ledc_timer);
+
+        // 2. 配置通道
         ledc_channel_config_t ledc_channel = {
             .speed_mode     = VALVE_LEDC_MODE,
-            .channel        = (ledc_channel_t)i, // 动态分配通道 0,1,2,3
-            .timer_sel      = VALVE_LEDC_TIMER,
+            .channel        = (ledc_channel_t)ports[i].ledc_channel,
+            .timer_sel      = (ledc_timer_t)ports[i].ledc_timer,
             .intr_type      = LEDC_INTR_DISABLE,
-            .gpio_num       = valve_gpios[i],    // 从数组取引脚
+            .gpio_num       = ports[i].gpio,
             .duty           = 0,                 // 默认关闭
-            .hpoint         = 0
+            .hpoint         = 0                  // 脉冲从周期起点开始
         };
         ESP_ERROR_CHECK(ledc_channel_config(&ledc_channel));
     }
-    ESP_LOGI(TAG, "PWM Valves Initialized (Freq: %dHz)", VALVE_PWM_FREQ_HZ);
+
+    if (VALVE_LA_MARK_PIN >= 0) {
+        gpio_reset_pin(VALVE_LA_MARK_PIN);
+        gpio_set_direction(VALVE_LA_MARK_PIN, GPIO_MODE_OUTPUT);
+        gpio_set_level(VALVE_LA_MARK_PIN, 0);
+    }
+}
+
+void valves_init(void) {
+    valves_init_ports(default_ports, VALVE_NUM);
+    const valve_group_cfg_t *c = &groups[VALVE_LEDC_TIMER].cfg;
+    ESP_LOGI(TAG, "PWM Valves Initialized (Freq: %luHz, %u bit)", (unsigned long)c->freq_hz, c->res_bits);
+}
+
+// 接口占空比 (0~VALVE_MAX_DUTY) -> 组分辨率下的 LEDC 占空比
+static uint32_t hw_duty(const valve_group_t *g, uint32_t duty) {
+    if (duty > VALVE_MAX_DUTY) duty = VALVE_MAX_DUTY;
+    if (g->cfg.res_bits == 13) return duty;
+    return (uint32_t)((uint64_t)duty * ((1u << g->cfg.res_bits) - 1) / VALVE_MAX_DUTY);
+}
+
+/**
+ * @brief 一批通道的提交: 先写入全部占空比，再连续置更新位，在同一个周期起点生效
+ * * 距周期起点不足 VALVE_COMMIT_GUARD_US 时等起点过去再提交，避免一批被分到两个周期；
+ * * 更新位先置关闭的通道再置打开的通道，即使被分开也不会出现同一肌肉两阀同时打开
+ */
+static void commit_ports(const valve_port_t *ports, const uint32_t *duty, int n) {
+    // 回放: 读数来自记录，控制栈照常计算与提交 (时序、统计不变)，但实际输出保持全关
+    static const uint32_t closed[2 * VALVE_NUM];
+    if (trace_replaying()) duty = closed;
+
+    valve_group_t *g = &groups[ports[0].ledc_timer];
+    int64_t now = esp_timer_get_time();
+    int64_t at = valve_pwm_commit_time(&g->timing, now, VALVE_COMMIT_GUARD_US);
+    if (at != now) {
+        while (esp_timer_get_time() <= at) { }
+    }
+
+    for (int i = 0; i < n; i++) {
+        esp_err_t err = ledc_set_duty(VALVE_LEDC_MODE, (ledc_channel_t)ports[i].ledc_channel,
+                                      hw_duty(&groups[ports[i].ledc_timer], duty[i]));
+        if (err != ESP_OK) valve_pwm_note_error(&g->stats, err);
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < n; i++) {
+            if ((duty[i] == 0) != (pass == 0)) continue;
+            esp_err_t err = ledc_update_duty(VALVE_LEDC_MODE, (ledc_channel_t)ports[i].ledc_channel);
+            if (err != ESP_OK) valve_pwm_note_error(&g->stats, err);
+        }
+    }
+    if (VALVE_LA_MARK_PIN >= 0) gpio_set_level(VALVE_LA_MARK_PIN, mark_level ^= 1);
+
+    valve_pwm_note_commit(&g->stats, &g->timing, at, at != now);
 }
 
 void valve_set_duty(int channel, uint32_t duty) {
     if (channel < 0 || channel > 3) return;
-    if (duty > VALVE_MAX_DUTY) duty = VALVE_MAX_DUTY;
+    commit_ports(&default_ports[channel], &duty, 1);
+}
 
-    // 关键修复：使用传入的 channel，而不是写死 Channel 0
-    ESP_ERROR_CHECK(ledc_set_duty(VALVE_LEDC_MODE, (ledc_channel_t)channel, duty));
-    ESP_ERROR_CHECK(ledc_update_duty(VALVE_LEDC_MODE, (ledc_channel_t)channel));
+void valve_set_ports(const valve_port_t *ports, const uint32_t *duty, int n) {
+    uint32_t d[2 * VALVE_NUM];
+    if (n > 2 * VALVE_NUM) n = 2 * VALVE_NUM;
+    valve_pwm_interlock(duty, d, n, VALVE_MAX_DUTY);
+    commit_ports(ports, d, n);
+}
+
+void valve_set_duty_all(const uint32_t duty[VALVE_NUM]) {
+    valve_set_ports(default_ports, duty, VALVE_NUM);
 }
 
 void valve_open_full(int channel) {
@@ -58,4 +164,54 @@ void valve_open_full(int channel) {
 
 void valve_close_full(int channel) {
     valve_set_duty(channel, 0);
-}
\ No newline at end of file
+}
+
+void valves_pwm_sync(int64_t at_us) {
+    while (esp_timer_get_time() < at_us) { }
+    int64_t t0 = esp_timer_get_time();
+    for (int t = 0; t < VALVE_GROUP_MAX; t++) {
+        if (groups[t].ready) ledc_timer_rst(VALVE_LEDC_MODE, (ledc_timer_t)t);
+    }
+    for (int t = 0; t < VALVE_GROUP_MAX; t++) {
+        if (groups[t].ready) groups[t].timing.epoch_us = t0;
+    }
+}
+
+int64_t valves_commit_edge(void) {
+    return groups[default_ports[0].ledc_timer].stats.pend_edge_us;
+}
+
+bool valves_get_stats(int timer, valve_pwm_stats_t *out) {
+    if (timer < 0 || timer >= VALVE_GROUP_MAX || !groups[timer].ready) return false;
+    *out = groups[timer].stats;
+    return true;
+}
+
+#define LA_PHASES   16      // 提交时刻在周期内的扫描点数
+
+void valves_la_test(int steps) {
+    valve_group_t *g = &groups[default_ports[0].ledc_timer];
+    uint32_t p = g->timing.period_us;
+    ESP_LOGI(TAG, "LA test: %d steps, period %lu us, mark pin %d", steps, (unsigned long)p, VALVE_LA_MARK_PIN);
+    valves_pwm_sync(esp_timer_get_time() + 1000);
+
+    for (int i = 0; i < steps; i++) {
+        // 提交时刻: 至少一个周期之后的周期起点 + 扫描偏移 (每个阀门扫过全部偏移)
+        int valve = (i / LA_PHASES) % VALVE_NUM;
+        uint32_t offset = p * (i % LA_PHASES) / LA_PHASES;
+        int64_t at = valve_pwm_next_edge(&g->timing, esp_timer_get_time() + p) + offset;
+        while (esp_timer_get_time() < at) { }
+        uint32_t duty[VALVE_NUM] = { 0 };
+        duty[valve] = VALVE_MAX_DUTY / 2;
+        valve_set_duty_all(duty);
+        uint32_t predicted = g->stats.pend_lat_us;
+
+        vTaskDelay(pdMS_TO_TICKS(3 * p / 1000 + 10));
+        uint32_t off[VALVE_NUM] = { 0 };
+        valve_set_duty_all(off);
+        ESP_LOGI(TAG, "LA step %d: valve %d, offset %lu us, predicted latency %lu us", i, valve,
+                 (unsigned long)offset, (unsigned long)predicted);
+        vTaskDelay(pdMS_TO_TICKS(3 * p / 1000 + 10));
+    }
+    valve_pwm_stats_reset(&g->stats);
+}
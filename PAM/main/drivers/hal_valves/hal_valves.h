@@ -2,6 +2,28 @@
 #define HAL_VALVES_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "valve_pwm.h"
+
+#define VALVE_NUM 4
+#define VALVE_GROUP_MAX 4           // LEDC 定时器数: 同一定时器上的阀门为一组，共用频率/分辨率/相位
+
+// 一路阀门输出: GPIO 与所用 LEDC 通道/定时器 (多关节描述表使用)
+typedef struct {
+    int16_t gpio;
+    uint8_t ledc_channel;
+    uint8_t ledc_timer;
+} valve_port_t;
+
+// 阀门组 PWM 配置 (接口占空比始终为 0~VALVE_MAX_DUTY，按组分辨率换算)
+typedef struct {
+    uint32_t freq_hz;
+    uint8_t  res_bits;
+} valve_group_cfg_t;
+
+// 设置组 (LEDC 定时器 timer) 的频率与分辨率，须在 valves_init / valves_init_ports 之前调用；
+// 未设置的组使用 VALVE_PWM_FREQ_HZ / VALVE_LEDC_RES
+void valves_config_group(int timer, const valve_group_cfg_t *cfg);
 
 // 初始化所有电磁阀 PWM
 void valves_init(void);
@@ -11,8 +33,34 @@ void valves_init(void);
 // duty: 0 ~ 8191 (0=全关, 8191=全开)
 void valve_set_duty(int channel, uint32_t duty);
 
+// 批量更新全部阀门: 先写入所有通道的占空比，再连续提交，使各阀在同一 PWM 周期生效
+// duty 按通道顺序 (A_IN, A_OUT, B_IN, B_OUT)；同一肌肉的进/排气阀同时非零时两阀均关闭
+void valve_set_duty_all(const uint32_t duty[VALVE_NUM]);
+
+// 按端口表配置 LEDC: 表中出现的每个定时器配置一次 (频率与分辨率见 valves_config_group)，
+// 每个端口一个通道，初始占空比为 0
+void valves_init_ports(const valve_port_t *ports, int n);
+
+// 批量更新 n 路端口 (先全部写入再连续提交)；ports 每相邻两路为同一肌肉的进/排气阀，
+// 两者同时非零时均关闭。一批端口应属于同一组 (距周期起点的保护按 ports[0] 的组判断)
+void valve_set_ports(const valve_port_t *ports, const uint32_t *duty, int n);
+
 // 辅助函数：全开或全关
 void valve_open_full(int channel);
 void valve_close_full(int channel);
 
-#endif
\ No newline at end of file
+// PWM 相位同步: 等到 at_us (esp_timer 时刻) 后同时复位全部已配置组的定时器，此后各组的
+// 周期起点为 at_us + k * 周期。控制任务在第一个节拍中以 节拍时刻 + VALVE_PWM_LEAD_US 调用一次
+void valves_pwm_sync(int64_t at_us);
+
+// 最近一次默认端口 (valve_set_duty / valve_set_duty_all) 提交的生效时刻 (PWM 周期起点)
+int64_t valves_commit_edge(void);
+
+// 组 timer 的提交统计 (读取后不清零)；组未配置时返回 false
+bool valves_get_stats(int timer, valve_pwm_stats_t *out);
+
+// 逻辑分析仪延迟测试: 以 steps 次阶跃轮流驱动四个阀门，提交时翻转 VALVE_LA_MARK_PIN，
+// 提交时刻在 PWM 周期内均匀扫过；输出每次阶跃的预测延迟，与分析仪上 标记 -> 阀门边沿 对比
+void valves_la_test(int steps);
+
+#endif
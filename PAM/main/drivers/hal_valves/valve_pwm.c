@@ -0,0 +1,51 @@
+#include "valve_pwm.h"
+#include <string.h>
+
+void valve_pwm_timing_init(valve_pwm_timing_t *t, uint32_t freq_hz, int64_t epoch_us) {
+    t->period_us = freq_hz ? 1000000u / freq_hz : 1000000u;
+    t->epoch_us = epoch_us;
+}
+
+int64_t valve_pwm_next_edge(const valve_pwm_timing_t *t, int64_t now_us) {
+    int64_t p = t->period_us;
+    int64_t d = now_us - t->epoch_us;
+    int64_t k = d >= 0 ? d / p + 1 : -((-d) / p);   // 同步时刻可以在将来 (仿真)
+    if (t->epoch_us + k * p <= now_us) k++;
+    return t->epoch_us + k * p;
+}
+
+int64_t valve_pwm_commit_time(const valve_pwm_timing_t *t, int64_t now_us, uint32_t guard_us) {
+    int64_t edge = valve_pwm_next_edge(t, now_us);
+    return edge - now_us < (int64_t)guard_us ? edge : now_us;
+}
+
+void valve_pwm_stats_reset(valve_pwm_stats_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->pend_edge_us = -1;
+}
+
+void valve_pwm_note_commit(valve_pwm_stats_t *s, const valve_pwm_timing_t *t, int64_t commit_us, bool late) {
+    // 上一次提交在本次之前已到达周期起点: 它生效了
+    if (s->pend_edge_us >= 0 && commit_us >= s->pend_edge_us) {
+        s->applied++;
+        s->lat_sum_us += s->pend_lat_us;
+        if (s->pend_lat_us > s->lat_max_us) s->lat_max_us = s->pend_lat_us;
+    }
+    int64_t edge = valve_pwm_next_edge(t, commit_us);
+    s->pend_edge_us = edge;
+    s->pend_lat_us = (uint32_t)(edge - commit_us);
+    s->wait_sum_us += s->pend_lat_us;
+    if (s->pend_lat_us > s->wait_max_us) s->wait_max_us = s->pend_lat_us;
+    s->commits++;
+    if (late) s->late++;
+}
+
+void valve_pwm_interlock(const uint32_t *duty, uint32_t *out, int n, uint32_t max_duty) {
+    for (int m = 0; m + 1 < n; m += 2) {
+        uint32_t in = duty[m] > max_duty ? max_duty : duty[m];
+        uint32_t ex = duty[m + 1] > max_duty ? max_duty : duty[m + 1];
+        if (in && ex) in = ex = 0;
+        out[m] = in;
+        out[m + 1] = ex;
+    }
+}
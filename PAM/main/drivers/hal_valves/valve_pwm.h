@@ -0,0 +1,59 @@
+//阀门 PWM 周期时序与提交统计 (与硬件无关，目标与仿真共用)
+//LEDC 在 PWM 周期起点锁存新占空比: 一次提交在下一个周期起点生效，之前的再次提交会覆盖它。
+//周期起点与控制节拍对齐 (相对节拍偏移 lead) 后，压力环在节拍后 lead 内完成的提交在同一起点
+//生效，提交 -> 输出延迟约为 lead 减去计算时间，且一批提交不会被周期起点分到两个周期。
+//回路频率高于 PWM 频率时大部分提交在生效前被覆盖: 命令 -> 输出滞后按全部提交统计
+//(每次提交到下一个周期起点)，生效提交的延迟只说明周期起点前的对齐。
+//距周期起点不足 guard 的提交推迟到起点之后 (整批在下一周期生效)，记为 late。
+//一批占空比提交前经 valve_pwm_interlock 限幅与进/排气互锁。
+
+#ifndef VALVE_PWM_H
+#define VALVE_PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t period_us;             ///< PWM 周期
+    int64_t  epoch_us;              ///< 任一周期起点 (同步时刻)
+} valve_pwm_timing_t;
+
+// 提交统计 (驱动错误只计数，热路径不断言)
+typedef struct {
+    uint32_t commits;               ///< 批量提交次数
+    uint32_t applied;               ///< 在周期起点生效的提交 (其余在生效前被下一次提交覆盖)
+    uint32_t late;                  ///< 距周期起点不足 guard，推迟到起点之后
+    uint32_t errors;                ///< 驱动调用失败次数
+    int32_t  last_err;              ///< 最近一次失败的错误码
+    uint64_t wait_sum_us;           ///< 全部提交到下一个周期起点的时间之和 (命令 -> 输出滞后)
+    uint32_t wait_max_us;
+    uint64_t lat_sum_us;            ///< 生效提交的 提交 -> 输出 延迟之和 (同步后不超过 lead)
+    uint32_t lat_max_us;
+    int64_t  pend_edge_us;          ///< 最近一次提交的生效时刻 (-1: 无)
+    uint32_t pend_lat_us;
+} valve_pwm_stats_t;
+
+void valve_pwm_timing_init(valve_pwm_timing_t *t, uint32_t freq_hz, int64_t epoch_us);
+
+// now_us 之后 (不含) 的第一个周期起点
+int64_t valve_pwm_next_edge(const valve_pwm_timing_t *t, int64_t now_us);
+
+// 提交时刻: 距下一个周期起点不足 guard_us 时返回该起点 (调用者等到此刻再提交)，否则返回 now_us
+int64_t valve_pwm_commit_time(const valve_pwm_timing_t *t, int64_t now_us, uint32_t guard_us);
+
+void valve_pwm_stats_reset(valve_pwm_stats_t *s);
+
+// 记录一次在 commit_us 的提交 (late: 被 guard 推迟)
+void valve_pwm_note_commit(valve_pwm_stats_t *s, const valve_pwm_timing_t *t, int64_t commit_us, bool late);
+
+// 一批占空比的限幅 (0 ~ max_duty) 与互锁: duty 每相邻两路为同一肌肉的进/排气阀，两者同时非零时
+// 均关闭 (同时打开会直接把气源排空)。结果写入 out，n 为偶数
+void valve_pwm_interlock(const uint32_t *duty, uint32_t *out, int n, uint32_t max_duty);
+
+// 记录一次驱动错误
+static inline void valve_pwm_note_error(valve_pwm_stats_t *s, int32_t err) {
+    s->errors++;
+    s->last_err = err;
+}
+
+#endif // VALVE_PWM_H
@@ -1,16 +1,38 @@
+//气压传感器驱动：UART 事件驱动的异步采集引擎
+//后台任务按状态机 (press_acq，仿真中由模拟串口驱动同一状态机) 轮询各 MUX 通道，收到上一通道的
+//应答后立即切换并发出下一通道请求，再发布上一帧，使处理与下一次传输/转换重叠；
+//结果以时间戳快照发布，控制任务无阻塞读取。
+//帧的同步、长度与 CRC 校验由 press_frame 流式解析器完成。
+//每帧 (含应答超时) 写入传感器轨迹；回放时采集任务照常运行但不发布，快照由 pressure_replay_sample 写入。
+
 #include "press.h"
+#include "press_frame.h"
+#include "press_acq.h"
 #include "hardware_config.h"
+#include "seqlock.h"
+#include "sensor_trace.h"
 #include "driver/uart.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 #include <string.h>
 
 static const char *TAG = "PRESS_SENSOR";
 #define BUF_SIZE 1024
+#define UART_EVENT_QUEUE_LEN 16
 
 // 协议命令
 #define CMD_CAL_P1 0x0D // 获取实时气压
 
+static QueueHandle_t uart_queue;
+
+// 快照：采集任务写，控制任务读
+static seqlock_t snap_lock = SEQLOCK_INIT;
+static press_snapshot_t snap;
+
 // 多路选择
 static void press_select_channel(int channel) {
     gpio_set_level(MUX_PRESS_A, channel & 0x01);
@@ -18,21 +40,105 @@ static void press_select_channel(int channel) {
     gpio_set_level(MUX_PRESS_C, (channel >> 2) & 0x01);
 }
 
-// CRC 校验算法 
-static uint8_t calc_crc(uint8_t *arr, uint8_t len) {
-    uint8_t crc = 0;
-    while (len--) {
-        crc ^= *arr++;
-        for (int i = 0; i < 8; i++) {
-            if (crc & 0x01) crc = (crc >> 1) ^ 0x8c;
-            else crc >>= 1;
+// 切换 MUX 并发出读取命令 (4 字节直接进 FIFO，不阻塞)
+static void press_send_request(void *ctx, int channel) {
+    press_select_channel(channel);
+
+    uint8_t cmd_buf[4] = {0x55, 0x04, CMD_CAL_P1, 0x00};
+    cmd_buf[3] = press_crc8(cmd_buf, 3);
+    uart_write_bytes(UART_PORT_NUM, (const char *)cmd_buf, 4);
+}
+
+// 发布一个通道的结果
+static void press_publish(int channel, uint32_t pa, int64_t t_us) {
+    seqlock_write_begin(&snap_lock);
+    press_sample_t *s = &snap.ch[channel];
+    s->kpa = pa / 1000; // P1 负载单位为 Pa
+    s->pa = pa;
+    s->timestamp_us = t_us;
+    s->frames++;
+    s->valid = true;
+    seqlock_write_end(&snap_lock);
+}
+
+static void press_publish_timeout(int channel) {
+    seqlock_write_begin(&snap_lock);
+    snap.ch[channel].timeouts++;
+    seqlock_write_end(&snap_lock);
+}
+
+// 状态机回调: 回放时不发布 (快照由 pressure_replay_sample 写入)
+static void acq_publish(void *ctx, int channel, uint32_t pa, int64_t t_us) {
+    if (trace_replaying()) return;
+    trace_press(channel, pa, true, t_us);
+    press_publish(channel, pa, t_us);
+}
+
+static void acq_timeout(void *ctx, int channel, int64_t t_us) {
+    if (trace_replaying()) return;
+    trace_press(channel, 0, false, t_us);
+    press_publish_timeout(channel);
+}
+
+static void acq_flush_input(void *ctx) {
+    uart_flush_input(UART_PORT_NUM);
+}
+
+/**
+ * @brief 气压采集任务
+ * * 在 UART 事件队列上阻塞到当前通道的应答截止时刻，状态机见 press_acq
+ * @param pvParameters 未使用
+ */
+static void press_acq_task(void *pvParameters) {
+    static press_acq_t acq;
+    static const press_acq_io_t io = { press_send_request, acq_publish, acq_timeout, acq_flush_input, NULL };
+    uart_event_t event;
+
+    press_acq_init(&acq, &io, PRESS_CHANNEL_COUNT, PRESS_RESP_TIMEOUT_MS * 1000u);
+    press_acq_start(&acq, esp_timer_get_time());
+
+    while (1) {
+        int64_t remain_us = press_acq_deadline(&acq) - esp_timer_get_time();
+        TickType_t wait = remain_us > 0 ? pdMS_TO_TICKS(remain_us / 1000) : 0;
+        if (remain_us > 0 && wait == 0) wait = 1;
+
+        if (xQueueReceive(uart_queue, &event, wait) != pdTRUE) {
+            // 应答超时：记录并跳到下一通道
+            press_acq_timeout(&acq, esp_timer_get_time());
+            continue;
+        }
+
+        switch (event.type) {
+        case UART_DATA: {
+            // 直接读入解析器的环形缓冲区 (环绕时分两段)
+            size_t pending = event.size;
+            while (pending > 0) {
+                uint8_t *dst;
+                size_t room = press_parser_write_ptr(&acq.parser, &dst);
+                if (room == 0) break;
+                if (room > pending) room = pending;
+                int n = uart_read_bytes(UART_PORT_NUM, dst, room, 0);
+                if (n <= 0) break;
+                press_parser_commit(&acq.parser, n);
+                pending -= n;
+            }
+            press_acq_rx(&acq, esp_timer_get_time());
+            break;
+        }
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            ESP_LOGW(TAG, "UART RX overflow, flushing");
+            xQueueReset(uart_queue);
+            press_acq_overflow(&acq);
+            break;
+        default:
+            break;
         }
     }
-    return crc;
 }
 
 void pressure_sensor_init(void) {
-    // 1. 配置 UART
+    // 1. 配置 UART (带事件队列)
     uart_config_t uart_config = {
         .baud_rate = UART_BAUD_RATE,
         .data_bits = UART_DATA_8_BITS,
@@ -41,7 +147,7 @@ void pressure_sensor_init(void) {
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
         .source_clk = UART_SCLK_DEFAULT,
     };
-    uart_driver_install(UART_PORT_NUM, BUF_SIZE * 2, 0, 0, NULL, 0);
+    uart_driver_install(UART_PORT_NUM, BUF_SIZE * 2, 0, UART_EVENT_QUEUE_LEN, &uart_queue, 0);
     uart_param_config(UART_PORT_NUM, &uart_config);
     uart_set_pin(UART_PORT_NUM, UART_TX_PIN, UART_RX_PIN, -1, -1);
 
@@ -54,36 +160,51 @@ void pressure_sensor_init(void) {
         .pull_up_en = 0,
     };
     gpio_config(&io_conf);
-    
-    ESP_LOGI(TAG, "Pressure Sensor Initialized");
+
+    // 3. 启动后台采集任务 (与其他传感器 I/O 同核)
+    memset(&snap, 0, sizeof(snap));
+    xTaskCreatePinnedToCore(press_acq_task, "Press_Acq", 3072, NULL, PRESS_ACQ_TASK_PRIO, NULL, SENSOR_CORE);
+
+    ESP_LOGI(TAG, "Pressure Sensor Initialized (%d channels)", PRESS_CHANNEL_COUNT);
 }
 
-uint32_t pressure_read_kpa(int channel) {
-    press_select_channel(channel);
-    
-    // 1. 发送读取命令
-    uint8_t cmd_buf[4] = {0x55, 0x04, CMD_CAL_P1, 0x00};
-    cmd_buf[3] = calc_crc(cmd_buf, 3);
-    uart_write_bytes(UART_PORT_NUM, (const char *)cmd_buf, 4);
+void pressure_replay_sample(int channel, uint32_t pa, bool ok, int64_t t_us) {
+    if (channel < 0 || channel >= PRESS_CHANNEL_COUNT) return;
+    if (ok) press_publish(channel, pa, t_us);
+    else press_publish_timeout(channel);
+}
 
-    // 2. 等待响应
-    vTaskDelay(pdMS_TO_TICKS(50)); // 传感器处理时间
+void pressure_get_snapshot(press_snapshot_t *out) {
+    unsigned s;
+    do {
+        s = seqlock_read_begin(&snap_lock);
+        *out = snap;
+    } while (seqlock_read_retry(&snap_lock, s));
+}
 
-    // 3. 读取数据
-    uint8_t data[128];
-    int len = uart_read_bytes(UART_PORT_NUM, data, BUF_SIZE, pdMS_TO_TICKS(50));
+bool pressure_get_sample(int channel, press_sample_t *out) {
+    if (channel < 0 || channel >= PRESS_CHANNEL_COUNT) return false;
 
-    if (len >= 5 && data[0] == 0xAA) {
-        // 解析: AA(头) Len Type Data...
-        // 假设数据类型是 P1 (0x09)
-        // 注意数组索引保护
-        if (len >= 8) { // 确保有足够数据
-             uint32_t pressure = (data[5] << 16) | (data[4] << 8) | (data[3]);
-             return pressure / 1000; // 返回 kPa
-        }
+    unsigned s;
+    do {
+        s = seqlock_read_begin(&snap_lock);
+        *out = snap.ch[channel];
+    } while (seqlock_read_retry(&snap_lock, s));
+
+    return out->valid;
+}
+
+uint32_t pressure_read_kpa(int channel) {
+    press_sample_t sample;
+    if (!pressure_get_sample(channel, &sample)) {
+        // 读不到返回 0 表示异常
+        return 0;
     }
-    
-    // 读不到返回一个错误码或者上一次的值 (这里返回0表示异常)
-    // ESP_LOGW(TAG, "Press Read Fail Ch:%d", channel);
-    return 0; 
-}
\ No newline at end of file
+    return sample.kpa;
+}
+
+q16_t pressure_read_q16(int channel) {
+    press_sample_t sample;
+    if (!pressure_get_sample(channel, &sample)) return 0;
+    return q16_ratio(sample.pa, 1000);
+}
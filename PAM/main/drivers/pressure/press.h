@@ -2,11 +2,44 @@
 #define PRESS_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "hardware_config.h"
+#include "fixq.h"
 
+// 单通道最新采样
+typedef struct {
+    uint32_t kpa;           ///< 气压 (kPa)
+    uint32_t pa;            ///< 气压 (Pa，传感器原始分辨率)
+    int64_t  timestamp_us;  ///< 该帧接收完成时刻 (esp_timer_get_time)
+    uint32_t frames;        ///< 累计有效帧数 (可用于计算采样率)
+    uint32_t timeouts;      ///< 累计应答超时次数
+    bool     valid;         ///< 至少收到过一帧有效数据
+} press_sample_t;
+
+// 所有通道的一致快照
+typedef struct {
+    press_sample_t ch[PRESS_CHANNEL_COUNT];
+} press_snapshot_t;
+
+// 初始化 UART / MUX，并启动后台采集任务
 void pressure_sensor_init(void);
 
-// 读取指定通道的气压值 (单位: kPa)
-// channel: 0-7 (MUX通道)
+// 读取指定通道的最新气压值 (单位: kPa)，不阻塞
+// channel: 0-7 (MUX通道)，未采到有效数据时返回 0
 uint32_t pressure_read_kpa(int channel);
 
-#endif
\ No newline at end of file
+// 读取指定通道的最新气压值 (Q16.16 kPa，由 Pa 换算，不经过浮点)，不阻塞
+// 未采到有效数据时返回 0
+q16_t pressure_read_q16(int channel);
+
+// 读取指定通道的最新带时间戳采样，不阻塞
+// 返回 false 表示通道号非法或尚无有效数据
+bool pressure_get_sample(int channel, press_sample_t *out);
+
+// 一次性读取所有通道的快照，不阻塞
+void pressure_get_snapshot(press_snapshot_t *out);
+
+// 回放: 以记录的帧 (ok = false 为应答超时) 更新快照，与实时帧的发布路径相同
+void pressure_replay_sample(int channel, uint32_t pa, bool ok, int64_t t_us);
+
+#endif
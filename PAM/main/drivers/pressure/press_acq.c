@@ -0,0 +1,49 @@
+#include "press_acq.h"
+
+void press_acq_init(press_acq_t *a, const press_acq_io_t *io, int channels, uint32_t timeout_us) {
+    press_parser_init(&a->parser);
+    a->io = *io;
+    a->channels = channels > 0 ? channels : 1;
+    a->timeout_us = timeout_us;
+    a->channel = 0;
+    a->deadline_us = 0;
+}
+
+static void request(press_acq_t *a, int channel, int64_t now_us) {
+    a->channel = channel;
+    a->io.send_request(a->io.ctx, channel);
+    a->deadline_us = now_us + a->timeout_us;
+}
+
+void press_acq_start(press_acq_t *a, int64_t now_us) {
+    press_parser_reset(&a->parser);
+    a->io.flush_input(a->io.ctx);
+    request(a, 0, now_us);
+}
+
+void press_acq_timeout(press_acq_t *a, int64_t now_us) {
+    a->io.timeout(a->io.ctx, a->channel, now_us);
+    press_parser_reset(&a->parser);
+    a->io.flush_input(a->io.ctx);
+    request(a, (a->channel + 1) % a->channels, now_us);
+}
+
+int press_acq_rx(press_acq_t *a, int64_t now_us) {
+    press_frame_t frame;
+    int n = 0;
+    while (press_parser_next(&a->parser, &frame)) {
+        if (frame.type != PRESS_FRAME_P1) continue;
+
+        // 整帧到齐：先切换到下一通道并发出请求，再发布本帧
+        int done = a->channel;
+        request(a, (a->channel + 1) % a->channels, now_us);
+        a->io.publish(a->io.ctx, done, frame.value, now_us);
+        n++;
+    }
+    return n;
+}
+
+void press_acq_overflow(press_acq_t *a) {
+    a->io.flush_input(a->io.ctx);
+    press_parser_reset(&a->parser);
+}
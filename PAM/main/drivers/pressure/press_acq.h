@@ -0,0 +1,49 @@
+//气压采集状态机 (与硬件无关，目标与仿真共用)
+//按 MUX 通道轮询: 发请求(ch) -> 等待应答 -> 整帧到齐后先切换并请求 ch+1，再发布 ch 的结果；
+//超时未应答则记一次超时并跳到下一通道。UART 字节由调用者直接写入 parser (零拷贝)，
+//再调用 press_acq_rx 取帧；请求发送、结果发布与输入清空经回调交给驱动 (目标) 或模拟串口 (仿真)。
+
+#ifndef PRESS_ACQ_H
+#define PRESS_ACQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "press_frame.h"
+
+typedef struct {
+    void (*send_request)(void *ctx, int channel);
+    void (*publish)(void *ctx, int channel, uint32_t pa, int64_t t_us);
+    void (*timeout)(void *ctx, int channel, int64_t t_us);
+    void (*flush_input)(void *ctx);         ///< 丢弃接收缓冲中尚未读出的字节
+    void *ctx;
+} press_acq_io_t;
+
+typedef struct {
+    press_parser_t parser;                  ///< UART 数据直接读入这里
+    press_acq_io_t io;
+    int      channels;
+    uint32_t timeout_us;
+    int      channel;                       ///< 正在等待应答的通道
+    int64_t  deadline_us;
+} press_acq_t;
+
+void press_acq_init(press_acq_t *a, const press_acq_io_t *io, int channels, uint32_t timeout_us);
+
+// 清空输入并向通道 0 发出第一个请求
+void press_acq_start(press_acq_t *a, int64_t now_us);
+
+// 当前通道的应答截止时刻 (调用者据此决定阻塞等待多久)
+static inline int64_t press_acq_deadline(const press_acq_t *a) {
+    return a->deadline_us;
+}
+
+// 截止时刻已过: 记一次超时，清空输入并请求下一通道
+void press_acq_timeout(press_acq_t *a, int64_t now_us);
+
+// 新数据已提交到 parser: 取出全部完整帧 (一次唤醒可能包含多帧)；返回发布的帧数
+int press_acq_rx(press_acq_t *a, int64_t now_us);
+
+// 接收溢出: 清空 parser，继续等待当前通道 (超时后照常跳到下一通道)
+void press_acq_overflow(press_acq_t *a);
+
+#endif // PRESS_ACQ_H
@@ -0,0 +1,57 @@
+//气压传感器协议的流式帧解析器
+//字节直接由 UART 读入解析器内部的环形缓冲区 (零拷贝)，解析器增量地寻找 0xAA 帧头、
+//校验长度与 CRC，失败时只丢弃一个字节重新同步，因此能从粘包/断包/误码中恢复。
+
+#ifndef PRESS_FRAME_H
+#define PRESS_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define PRESS_FRAME_HEADER      0xAA
+#define PRESS_FRAME_MIN_LEN     7     // AA Len Type P0 P1 P2 CRC
+#define PRESS_FRAME_MAX_LEN     32
+#define PRESS_RING_SIZE         256   // 必须是 2 的幂
+
+// 应答帧类型
+typedef enum {
+    PRESS_FRAME_P1 = 0x09,            // 实时气压 P1
+} press_frame_type_t;
+
+// 解析后的帧
+typedef struct {
+    uint8_t  type;        ///< 帧类型 (press_frame_type_t 或未知值)
+    uint8_t  len;         ///< 整帧长度
+    uint32_t value;       ///< 负载前 3 字节的小端值 (P1 帧为气压, 单位 Pa)
+} press_frame_t;
+
+typedef struct {
+    uint8_t  ring[PRESS_RING_SIZE];
+    uint16_t head;        ///< 写位置 (自由递增，取模使用)
+    uint16_t tail;        ///< 读位置
+
+    uint32_t frames;      ///< 有效帧计数
+    uint32_t crc_errors;  ///< CRC 错误次数
+    uint32_t len_errors;  ///< 长度字段非法次数
+    uint32_t dropped;     ///< 重新同步时丢弃的字节数
+} press_parser_t;
+
+void press_parser_init(press_parser_t *p);
+
+// 清空缓冲区 (统计保留)
+void press_parser_reset(press_parser_t *p);
+
+// 获取一段连续可写空间，UART 数据直接读入这里；返回可写字节数
+size_t press_parser_write_ptr(press_parser_t *p, uint8_t **ptr);
+
+// 提交刚写入的 n 个字节
+void press_parser_commit(press_parser_t *p, size_t n);
+
+// 取出下一帧；没有完整帧时返回 false。一次唤醒可循环调用取出多帧
+bool press_parser_next(press_parser_t *p, press_frame_t *out);
+
+// 查表法 CRC-8 (Dallas/Maxim 反射多项式 0x8C)，与协议文档的逐位算法结果一致
+uint8_t press_crc8(const uint8_t *data, size_t len);
+
+#endif
@@ -3,21 +3,42 @@
 #ifndef HARDWARE_CONFIG_H
 #define HARDWARE_CONFIG_H
 
+#include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "driver/gpio.h"
 #include "driver/ledc.h"
 #include "driver/uart.h"
-#include "driver/i2c.h"
+#include "driver/i2c_master.h"
+#endif
 
 // 1. 气泵与压力开关 (QPM11)
 #define PUMP_RELAY_PIN          GPIO_NUM_14   // 气泵继电器控制引脚
 #define PRESSURE_SWITCH_PIN     GPIO_NUM_21   // QPM11 压力开关引脚 (NC常闭: 低压闭合/高压断开)
+#define PUMP_SWITCH_LOW_KPA     400.0f        // QPM11 闭合 (启泵) 阈值，表压 kPa
+#define PUMP_SWITCH_HIGH_KPA    600.0f        // QPM11 断开 (停泵) 阈值，表压 kPa
+#define PUMP_TANK_VOLUME_L      2.0f          // 储气罐容积 (L)，用于耗气量估计
+#define PUMP_DEBOUNCE_MS        20            // 开关边沿去抖: 最后一个边沿后稳定这么久才采信
+#define PUMP_MIN_ON_MS          2000          // 继电器最短接通时间
+#define PUMP_MIN_OFF_MS         2000          // 继电器最短断开时间
+#define PUMP_SUPPLY_LOW_MARGIN  0.2f          // 储气余量低于此值时预测气源不足
+#define PUMP_LOW_SUPPLY_SCALE   0.5f          // 气源不足时轨迹的时间缩放 (放慢运动)
+#define PUMP_TASK_PRIO          4
 
 // 2. 电磁阀 PWM 配置 (两位三通阀)
-#define VALVE_PWM_FREQ_HZ       50            // 50Hz
+#define VALVE_PWM_FREQ_HZ       50            // 50Hz (默认组；其他组见 valves_config_group)
 #define VALVE_LEDC_TIMER        LEDC_TIMER_0
 #define VALVE_LEDC_MODE         LEDC_LOW_SPEED_MODE
 #define VALVE_LEDC_RES          LEDC_TIMER_13_BIT // 13位分辨率 (0-8191)
 #define VALVE_MAX_DUTY          8191
+#define VALVE_PWM_SYNC          1             // PWM 周期起点与控制节拍对齐 (第一个压力环节拍中同步)
+#define VALVE_PWM_LEAD_US       300           // 周期起点在节拍后的偏移: 须大于压力环从节拍到提交的最坏耗时
+#define VALVE_COMMIT_GUARD_US   30            // 距周期起点不足此时间的提交等起点过去后再提交
+#define VALVE_LA_TEST           0             // 1: 上电后运行逻辑分析仪延迟测试 (驱动阀门，须断开气源)
+#define VALVE_LA_TEST_STEPS     64
+#define VALVE_LA_MARK_PIN       GPIO_NUM_NC   // 每次提交翻转的标记引脚 (GPIO_NUM_NC: 不输出)
+#define VALVE_DEAD_BAND         40.0f         // 阀门分配死区 (占空比计数)，参数表默认值
+#define VALVE_MIN_PULSE         1200.0f       // 阀门可靠开启的最小占空比 (≈15%)，参数表默认值 (未标定时使用)
+#define VALVE_CAL_ON_BOOT       0             // 1: NVS 中没有阀门标定表时上电自动标定 (约 1.5 分钟，会驱动关节；须确认关节可自由摆动)
 
 // 使用 ESP32-S3 侧边排列的 GPIO，避开 USB 和 JTAG
 #define VALVE_A_IN_PIN          GPIO_NUM_10   // 肌肉A 进气阀
@@ -31,6 +52,12 @@
 #define I2C_MASTER_SCL_IO       GPIO_NUM_5
 #define I2C_MASTER_FREQ_HZ      400000
 #define I2C_MASTER_NUM          I2C_NUM_0
+#define AS5600_CHANNEL_COUNT    1             // 已接入的角度传感器数量 (MUX 通道 0..N-1)，决定滤波器组大小
+#define AS5600_SCAN_MASK        ((1u << AS5600_CHANNEL_COUNT) - 1) // 每轮扫描的 MUX 通道集合
+#define AS5600_MUX_SETTLE_US    5             // MUX 切换后等待信号稳定再发起事务
+#define AS5600_XFER_TIMEOUT_MS  1             // 单通道事务超时 (阻塞等待，按 RTOS 节拍向上取整再加一拍)，超时后标记该通道
+#define AS5600_XFER_DRAIN_MS    20            // 超时后等待驱动结束该事务的时限，仍未结束则复位总线再等一次
+#define AS5600_HEALTH_PASSES    100           // 每 N 轮扫描加读一次 STATUS/AGC (磁铁状态)，0 = 不读
 
 // UART (气压传感器)
 #define UART_TX_PIN             GPIO_NUM_15   // 接传感器的 RX
@@ -38,13 +65,81 @@
 #define UART_PORT_NUM           UART_NUM_1
 #define UART_BAUD_RATE          9600
 
-#endif // HARDWARE_CONFIG_H
+// 气压采集引擎
+#define PRESS_CHANNEL_COUNT     2             // 已接入的气压传感器数量 (MUX 通道 0..N-1)
+#define PRESS_MUX_CHANNELS      8             // 气压 MUX 通道数 (PRESS_CHANNEL_COUNT 的上限)
+#define PRESS_RESP_TIMEOUT_MS   100           // 单通道应答超时，超时后跳到下一通道
+#define PRESS_ACQ_TASK_PRIO     6             // 采集任务优先级 (大部分时间阻塞在 UART 事件队列上)
 
 // ==========================================
 // 4. 控制参数
 // ==========================================
+// 以下为参数表的默认值，运行时以 param_store 中的值为准
 #define BASE_PRESSURE           300.0f  // 基础气压 (kPa)
 
+// 多速率调度: 基础节拍 1 kHz，压力内环 500 Hz，角度外环 100 Hz
+#define CTRL_BASE_TICK_US       1000    // 基础节拍周期 (us)
+#define PRESS_LOOP_PERIOD_TICKS 2       // 压力内环周期 (节拍)
+#define PRESS_LOOP_PHASE_TICKS  0
+#define ANGLE_LOOP_PERIOD_TICKS 10      // 角度外环周期 (节拍)
+#define ANGLE_LOOP_PHASE_TICKS  1       // 与内环错开一个节拍，分散 CPU 负载
+// 参数表中的 PID 增益按默认周期下“每次调用”的量纲保存，运行时换算为连续时间增益，
+// 回路周期修改或抖动时控制效果不变
+#define PRESS_LOOP_NOMINAL_S    ((float)(PRESS_LOOP_PERIOD_TICKS * CTRL_BASE_TICK_US) * 1e-6f)
+#define ANGLE_LOOP_NOMINAL_S    ((float)(ANGLE_LOOP_PERIOD_TICKS * CTRL_BASE_TICK_US) * 1e-6f)
+
+// 轨迹参考前馈: 压力差 += kv × 参考速度 + ka × 参考加速度 (计数/秒, 计数/秒²)
+#define TRAJ_FF_KV              0.0f
+#define TRAJ_FF_KA              0.0f
+
+// 静态模型前馈: 按参考角度/角速度查表得到平衡压力差，叠加在角度环输出上 (模型参数见 pam_model)
+// 表由 pam_model 的默认参数建立，未按实物辨识前默认关闭 (参数表 ff_enable)；仿真中由 sim_main 打开
+#define PAM_FF_ENABLE           0
+#define PAM_FF_TASK_PRIO        1             // 基础气压改变时在此优先级的后台任务中重建前馈表
+
+// 压力观测器 (press_obs): 压力环使用腔体模型外推并按采样校正的腔压估计，采样失败或过期时不中断
+#define PRESS_OBS_ENABLE        0             // 参数表 press_obs 的默认值 (模型参数未按实物辨识前关闭，仿真检查中显式打开)
+#define PRESS_OBS_GAIN          0.5f          // 新采样的校正增益
+#define PRESS_OBS_RESID_ALPHA   0.2f          // 残差指数平均系数 (每个采样)
+#define PRESS_OBS_RESID_KPA     25.0f         // 残差平均上限，超过判为传感器故障
+#define PRESS_OBS_STALE_MS      40            // 超过此时间没有新采样: 只靠模型外推 (采样周期的 2.5 倍)
+#define PRESS_OBS_COAST_MS      250           // 超过此时间没有新采样: 判为故障
+#define PRESS_OBS_SUBSTEP_US    500           // 外推积分步长上限
+
+// 继电反馈自整定 (autotune): 先压力内环后角度外环，全程监视压力与关节偏移
+#define AUTOTUNE_ON_BOOT        0             // 上电后自动整定一次并保存
+#define AUTOTUNE_SETTLE_S       2.0f          // 每个实验前两肌肉保持基础气压的时间
+#define AUTOTUNE_PRESS_RELAY_DUTY 3000.0f     // 压力环继电器幅值 (占空比计数)
+#define AUTOTUNE_PRESS_HYST_KPA 3.0f          // 压力环继电器回差
+#define AUTOTUNE_PRESS_TIMEOUT_S 5.0f
+#define AUTOTUNE_ANGLE_RELAY_KPA 30.0f        // 角度环继电器幅值 (压力差)
+#define AUTOTUNE_ANGLE_HYST     4.0f          // 角度环继电器回差 (计数)
+#define AUTOTUNE_ANGLE_TIMEOUT_S 20.0f
+#define AUTOTUNE_SKIP_CYCLES    2             // 丢弃的起始振荡周期
+#define AUTOTUNE_CYCLES         4             // 参与平均的振荡周期
+#define AUTOTUNE_PRESS_MAX_KPA  500.0f        // 默认压力硬限: 任一肌肉超过即中止
+#define AUTOTUNE_ANGLE_SPAN     400.0f        // 默认角度硬限: 偏离起始角度超过即中止 (计数, ≈35°)
+
+// 控制运行时选择
+// 0: arm_control 单关节 (参数表、自整定、模型前馈、阀门线性化、遥测)
+// 1: joint_rt 按 app/joint_rt/joint_table.c 中的关节描述表运行 N 个关节 (增益取自描述表)
+#define ARM_JOINT_RUNTIME       0
+
+// 任务空间控制 (cart_ctrl): 平面两连杆末端命令，需 ARM_JOINT_RUNTIME 且描述表中有肩/肘两个关节
+#define CART_CONTROL_ENABLE     0
+#define CART_SHOULDER_JOINT     0             // joint_table 中的索引
+#define CART_ELBOW_JOINT        1
+#define CART_LINK1_MM           200.0f        // 肩 -> 肘
+#define CART_LINK2_MM           150.0f        // 肘 -> 末端
+#define CART_ELBOW_MARGIN_DEG   5.0f          // 肘角距伸直位形的最小值 (奇异位形附近按不可达处理)
+
+#if CART_CONTROL_ENABLE && !ARM_JOINT_RUNTIME
+#error "CART_CONTROL_ENABLE requires ARM_JOINT_RUNTIME: cart_ctrl drives joints of the joint runtime"
+#endif
+#if CART_CONTROL_ENABLE && (CART_SHOULDER_JOINT == CART_ELBOW_JOINT || CART_SHOULDER_JOINT < 0 || CART_ELBOW_JOINT < 0)
+#error "CART_SHOULDER_JOINT and CART_ELBOW_JOINT must be two different joint_table indices"
+#endif
+
 // ==========================================
 // 5. 多路选择器引脚 (MUX) 
 // ==========================================
@@ -57,4 +152,69 @@
 // 气压传感器 MUX 控制脚 (对应 A, B, C)
 #define MUX_PRESS_A             GPIO_NUM_38
 #define MUX_PRESS_B             GPIO_NUM_39
-#define MUX_PRESS_C             GPIO_NUM_40
\ No newline at end of file
+#define MUX_PRESS_C             GPIO_NUM_40
+
+// ==========================================
+// 6. 双核流水线
+// ==========================================
+// 1: 采集阶段 (I2C/UART) 与控制阶段 (PID/阀门) 分核运行，经 SPSC 队列传递传感器帧
+// 0: 控制回路直接调用传感器驱动
+#if CONFIG_IDF_TARGET_LINUX
+#define PAM_PIPELINE_MODE       0             // 仿真按仿真时钟单线程驱动
+#else
+#define PAM_PIPELINE_MODE       1
+#endif
+
+#if CONFIG_FREERTOS_UNICORE
+#define SENSOR_CORE             0
+#define CONTROL_CORE            0
+#else
+#define SENSOR_CORE             0             // 采集核: AS5600 + 气压 UART
+#define CONTROL_CORE            1             // 控制核: PID + 阀门
+#endif
+
+#define SENSOR_ACQ_PERIOD_US    2000          // 采集周期 (与压力内环同频)
+#define SENSOR_ACQ_TASK_PRIO    6
+#define SENSOR_RING_LEN         8             // 传感器帧队列长度 (2 的幂)
+
+// ==========================================
+// 7. 定点控制路径
+// ==========================================
+// 1: 角度卡尔曼滤波与压力/角度 PID 使用 Q16.16 定点运算 (utils/fixq)，用于没有硬件 FPU 的芯片
+// 0: 单精度浮点 (ESP32-S3 有 FPU)
+// 轨迹、前馈、阀门分配与压力观测器仍为浮点，在回路边界换算 (每个回路周期数次 q16_from_float/to_float)
+#ifndef PAM_FIXED_POINT
+#if CONFIG_IDF_TARGET_ESP32C2 || CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32C6 || CONFIG_IDF_TARGET_ESP32H2
+#define PAM_FIXED_POINT         1
+#else
+#define PAM_FIXED_POINT         0
+#endif
+#endif
+
+// ==========================================
+// 8. 调试与插桩
+// ==========================================
+#define PAM_PROFILE_ENABLE      1             // 控制回路计时插桩 (0: 编译为空)
+#define PAM_TELEMETRY_ENABLE    1             // 压力环每周期写一条二进制遥测记录 (0: 关闭)
+
+// 传感器轨迹记录/回放 (utils/sensor_trace)
+#define TRACE_BOOT_MODE         0             // 上电行为 0: 不记录 1: 开始记录 2: 回放分区中的轨迹 (需 PAM_PIPELINE_MODE)
+#if CONFIG_IDF_TARGET_LINUX
+#define PAM_TRACE_ENABLE        1             // 仿真: 记录整次运行并回放检查
+#else
+#define PAM_TRACE_ENABLE        (TRACE_BOOT_MODE != 0)  // 0: 记录入口编译为空，不占用缓冲
+#endif
+#define TRACE_BLOCK_BYTES       512           // 块长 (含块头)，每块可独立解码
+#if CONFIG_IDF_TARGET_LINUX
+#define TRACE_RAM_BLOCKS        4096          // 仿真: 2 MB，足够记录整次仿真
+#else
+#define TRACE_RAM_BLOCKS        64            // 32 KB 环形缓冲，约 5 s 的全部传感器事件
+#endif
+#define TRACE_PARTITION_LABEL   "pamtrace"    // 转存用数据分区 (见 partitions.csv，大小不小于缓冲)
+#define TRACE_FLUSH_AFTER_S     4             // 记录模式: 上电后多少秒停止记录并转存
+
+#if !CONFIG_IDF_TARGET_LINUX && TRACE_BOOT_MODE == 2 && !PAM_PIPELINE_MODE   // 仿真按仿真时钟回放，不用此项
+#error "TRACE_BOOT_MODE 2 requires PAM_PIPELINE_MODE: recorded events are injected by the sensor acquisition task"
+#endif
+
+#endif // HARDWARE_CONFIG_H
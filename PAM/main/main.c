@@ -9,15 +9,38 @@
 #include "as5600.h"
 #include "press.h"
 #include "arm_control.h"
+#include "joint_rt.h"
+#include "sensor_pipeline.h"
+#include "loop_prof.h"
+#include "telemetry.h"
+#include "param_store.h"
+#include "valve_cal.h"
+#include "traj.h"
+#include "autotune.h"
+#include "sensor_trace.h"
+#include "nvs_flash.h"
+#include "esp_timer.h"
 
 static const char *TAG = "MAIN";
+
+// 阀门标定期间控制任务尚未启动 (气泵任务已在 pump_init 中启动，由开关中断驱动)
+static void cal_wait(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
 void app_main(void) {
     ESP_LOGI(TAG, "========= PAM Robot Arm System Start =========");
 
     // --- 1. 硬件抽象层 (HAL) 初始化 ---
     ESP_LOGI(TAG, "[1/3] Initializing HAL...");
-    pump_init();    // 气泵 & 压力开关
-    valves_init();  // 电磁阀 PWM
+    pump_init();    // 气泵 & 压力开关 (启动事件驱动的气泵任务)
+#if !ARM_JOINT_RUNTIME
+    valves_init();  // 电磁阀 PWM (多关节运行时按描述表配置)
+#endif
+#if VALVE_LA_TEST && !ARM_JOINT_RUNTIME
+    // 逻辑分析仪延迟测试: 标记引脚与四个阀门引脚，测 标记边沿 -> 阀门上升沿 并与预测值对比
+    valves_la_test(VALVE_LA_TEST_STEPS);
+#endif
 
     // --- 2. 传感器层初始化 ---
     ESP_LOGI(TAG, "[2/3] Initializing Sensors...");
@@ -26,42 +49,129 @@ void app_main(void) {
 
     // --- 3. 控制层初始化 ---
     ESP_LOGI(TAG, "[3/3] Initializing Control System...");
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
+    param_store_init();     // 运行时参数 (默认值 + NVS 中保存的值)
+#if !ARM_JOINT_RUNTIME
+    if (!valve_cal_load() && VALVE_CAL_ON_BOOT) {
+        // 首次上电: 扫描四个阀门建立线性化查找表
+        ESP_LOGW(TAG, "No valve calibration stored, running calibration...");
+        if (valve_cal_run(cal_wait) == VALVE_NUM) valve_cal_save();
+    }
     arm_control_init();     // PID 参数初始化
+#endif
+
+#if PAM_TRACE_ENABLE && TRACE_BOOT_MODE == 1
+    // 从此刻起记录全部传感器原始事件，TRACE_FLUSH_AFTER_S 后转存到 flash；
+    // 转存分区在这里 (控制任务启动、阀门动作之前) 擦除，运行中只写入
+    if (trace_partition_erase() != ESP_OK) ESP_LOGE(TAG, "Trace partition not erased, trace will not be flushed");
+    trace_record_start();
+    pump_trace_level();
+#elif PAM_TRACE_ENABLE && TRACE_BOOT_MODE == 2
+    // 以记录的传感器事件代替实时读数，时间轴平移到当前时刻；回放期间阀门保持关闭、气泵不启动
+    if (trace_replay_load() == ESP_OK) {
+        trace_replay_start(esp_timer_get_time() - trace_replay_first_us());
+    } else {
+        ESP_LOGE(TAG, "No sensor trace in '%s', running live", TRACE_PARTITION_LABEL);
+    }
+#endif
 
     // --- 4. 启动 RTOS 任务 ---
     ESP_LOGI(TAG, "Starting Tasks...");
 
-    // 任务 A: 气泵自动保压任务 (优先级 4)
-    // 负责监控储气罐压力，自动启停气泵
-    xTaskCreate(
-        (TaskFunction_t)pump_control_loop, // 任务函数 (注意: 之前pump_control_loop如果是死循环直接用，如果不是需封装)
-        "Pump_Task",                       // 任务名
-        2048,                              // 栈大小
-        NULL,                              // 参数
-        4,                                 // 优先级
-        NULL                               // 句柄
-    );
+#if PAM_PIPELINE_MODE
+    // 流水线采集阶段: 绑定采集核，读取 I2C/UART 并经无锁队列送往控制核
+    sensor_pipeline_start();
+#endif
 
+#if ARM_JOINT_RUNTIME
+    // 任务 B: 多关节运行时 (优先级 5，绑定控制核)，每个基础节拍执行到期关节的回路
+    if (joint_rt_start() != ESP_OK) ESP_LOGE(TAG, "Joint runtime not started");
+#else
     // 任务 B: 机械臂核心运动控制任务 (优先级 5 - 实时性高)
-    // 负责 50Hz 的 PID 计算和阀门控制
-    xTaskCreate(
+    // 运行多速率调度器: 100Hz 角度外环 + 500Hz 压力内环，绑定控制核
+    xTaskCreatePinnedToCore(
         arm_control_task,
         "Arm_Ctrl_Task",
         4096,
         NULL,
         5,
-        NULL
+        NULL,
+        CONTROL_CORE
     );
+#endif
+
+    // 插桩汇总任务 (低优先级)
+    loop_prof_start();
+
+#if PAM_TELEMETRY_ENABLE
+    // 二进制遥测发送任务 (低优先级，USB-CDC)
+    telemetry_init();
+#endif
 
     // 测试动作：让机械臂动起来
     // 延时 2 秒等待系统稳定
     vTaskDelay(pdMS_TO_TICKS(2000));
+#if AUTOTUNE_ON_BOOT && !ARM_JOINT_RUNTIME
+    // 继电反馈自整定 (约 10 s，关节会小幅振荡)，成功后增益由主循环写入 NVS
+    autotune_cfg_t tune_cfg = AUTOTUNE_CFG_DEFAULT;
+    if (autotune_start(&tune_cfg) == ESP_OK) {
+        while (autotune_running()) vTaskDelay(pdMS_TO_TICKS(100));
+    }
+#endif
     ESP_LOGI(TAG, "Command: Go to 30 degrees");
-    arm_set_target_angle(30.0f);
+#if ARM_JOINT_RUNTIME
+    for (int j = 0; j < joint_table_len; j++) joint_move_to(j, 30.0f, 1.0f, TRAJ_MIN_JERK);
+#else
+    arm_move_to(30.0f, 1.0f, TRAJ_MIN_JERK);   // 1 秒最小加加速度轨迹，避免阶跃使角度环饱和
+#endif
 
+    int seconds = 0;
+#if PAM_TRACE_ENABLE && TRACE_BOOT_MODE == 2
+    bool replay_reported = false;
+#endif
     while (1) {
         // 主循环每 1 秒打印一次存活信息
         // 实际应用中可以处理 USB 命令或 WIFI 通信
         vTaskDelay(pdMS_TO_TICKS(1000));
+#if ARM_JOINT_RUNTIME
+        joint_rt_report();
+#else
+        arm_control_report();
+        autotune_poll();
+#endif
+#if PAM_TRACE_ENABLE && TRACE_BOOT_MODE == 1
+        if (seconds + 1 == TRACE_FLUSH_AFTER_S) trace_flush();
+#elif PAM_TRACE_ENABLE && TRACE_BOOT_MODE == 2
+        if (trace_replaying() && trace_replay_done() && !replay_reported) {
+            ESP_LOGI(TAG, "Trace replay finished after %d s", seconds + 1);
+            replay_reported = true;
+        }
+#endif
+
+        // 每 10 秒转储一次回路计时统计与气泵统计
+        if (++seconds % 10 == 0) {
+            loop_prof_request_dump();
+
+            pump_status_t ps;
+            pump_get_status(&ps);
+            ESP_LOGI(TAG, "Pump: %lu cycles, duty %.1f%%, last refill %lu ms, margin %.2f",
+                     (unsigned long)ps.cycles, ps.elapsed_us ? (double)ps.on_us / ps.elapsed_us * 100.0 : 0.0,
+                     (unsigned long)ps.last_refill_ms, pump_supply_margin());
+
+            valve_pwm_stats_t vs;
+            if (valves_get_stats(VALVE_LEDC_TIMER, &vs) && vs.commits) {
+                ESP_LOGI(TAG, "Valves: %lu commits, %lu applied, %lu late, %lu errors (last %s), "
+                         "applied latency mean %lu max %lu us, output lag (all commits) mean %lu max %lu us",
+                         (unsigned long)vs.commits, (unsigned long)vs.applied, (unsigned long)vs.late,
+                         (unsigned long)vs.errors, vs.errors ? esp_err_to_name(vs.last_err) : "-",
+                         (unsigned long)(vs.applied ? vs.lat_sum_us / vs.applied : 0), (unsigned long)vs.lat_max_us,
+                         (unsigned long)(vs.wait_sum_us / vs.commits), (unsigned long)vs.wait_max_us);
+            }
+        }
     }
 }
\ No newline at end of file
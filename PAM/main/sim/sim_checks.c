@@ -0,0 +1,583 @@
+#include "sim_checks.h"
+#include "hardware_config.h"
+#include "press_acq.h"
+#include "press_frame.h"
+#include "spsc_ring.h"
+#include "pid.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <math.h>
+
+static const char *TAG = "SIM_CHECK";
+
+// 确定性伪随机数 (LCG)
+static uint32_t rng_next(uint32_t *s) {
+    *s = *s * 1664525u + 1013904223u;
+    return *s >> 8;
+}
+
+// ---------------- 气压采集 (模拟串口) ----------------
+
+#define ACQ_RUN_US          10000000    // 每种配置的运行时间
+#define ACQ_READ_US         2000        // 控制任务读取快照的周期 (压力环)
+#define ACQ_CONV_US         1500        // 传感器收到请求到开始应答
+#define ACQ_MAX_CH          8
+
+// 模拟串口 + 传感器: 请求 4 字节、转换、应答 7 字节，整帧到齐后再过 1 字节时间 (接收超时) 产生一次
+// UART_DATA 事件。按概率不应答 (drop) 或应答中翻转 1 位 (flip，必被 CRC/长度检查发现)。
+// 气压值 = (100 + 通道号) kPa + 序号 Pa，发布时据此检查通道归属
+typedef struct {
+    press_acq_t acq;
+    uint32_t byte_us;
+    int      channels;
+    uint32_t drop_pct, flip_pct;
+    uint32_t rng;
+
+    int64_t  now_us;
+    int64_t  reply_at;                  ///< 应答事件时刻，-1: 无
+    uint8_t  reply[PRESS_FRAME_MIN_LEN];
+    uint32_t seq;
+    uint32_t faults;                    ///< 注入的故障数 (每个应导致一次超时)
+
+    int64_t  last_us[ACQ_MAX_CH];       ///< 最新采样时刻，-1: 尚无
+    uint32_t frames[ACQ_MAX_CH];
+    uint32_t timeouts;
+    uint32_t wrong;                     ///< 通道归属错误的帧
+    double   age_sum;
+    uint32_t age_n;
+    int64_t  age_max;
+} mock_uart_t;
+
+static void mock_send(void *ctx, int ch) {
+    mock_uart_t *m = ctx;
+    uint32_t r = rng_next(&m->rng) % 100;
+    if (r < m->drop_pct) {
+        m->faults++;
+        return;
+    }
+    uint32_t pa = (100 + (uint32_t)ch) * 1000 + m->seq++ % 1000;
+    uint8_t *f = m->reply;
+    f[0] = PRESS_FRAME_HEADER;
+    f[1] = PRESS_FRAME_MIN_LEN;
+    f[2] = PRESS_FRAME_P1;
+    f[3] = pa & 0xFF;
+    f[4] = (pa >> 8) & 0xFF;
+    f[5] = (pa >> 16) & 0xFF;
+    f[6] = press_crc8(f, PRESS_FRAME_MIN_LEN - 1);
+    if (r < m->drop_pct + m->flip_pct) {
+        uint32_t bit = rng_next(&m->rng) % (PRESS_FRAME_MIN_LEN * 8);
+        f[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        m->faults++;
+    }
+    m->reply_at = m->now_us + (4 + PRESS_FRAME_MIN_LEN + 1) * m->byte_us + ACQ_CONV_US;
+}
+
+static void mock_publish(void *ctx, int ch, uint32_t pa, int64_t t_us) {
+    mock_uart_t *m = ctx;
+    if ((int)(pa / 1000) - 100 != ch) m->wrong++;
+    m->last_us[ch] = t_us;
+    m->frames[ch]++;
+}
+
+static void mock_timeout(void *ctx, int ch, int64_t t_us) {
+    mock_uart_t *m = ctx;
+    m->timeouts++;
+}
+
+static void mock_flush(void *ctx) {
+    // 应答在事件时刻整帧写入解析器，没有未读出的字节
+}
+
+typedef struct {
+    uint32_t baud;
+    int      channels;
+    uint32_t drop_pct;
+    uint32_t flip_pct;
+} acq_case_t;
+
+static bool acq_run(const acq_case_t *c) {
+    static mock_uart_t m;
+    memset(&m, 0, sizeof(m));
+    m.byte_us = (10 * 1000000u + c->baud - 1) / c->baud;    // 8N1: 10 位/字节
+    m.channels = c->channels;
+    m.drop_pct = c->drop_pct;
+    m.flip_pct = c->flip_pct;
+    m.rng = 2463534242u;
+    m.reply_at = -1;
+    for (int i = 0; i < ACQ_MAX_CH; i++) m.last_us[i] = -1;
+
+    press_acq_io_t io = { mock_send, mock_publish, mock_timeout, mock_flush, &m };
+    press_acq_init(&m.acq, &io, c->channels, PRESS_RESP_TIMEOUT_MS * 1000u);
+    press_acq_start(&m.acq, 0);
+
+    int64_t next_read = ACQ_READ_US;
+    while (m.now_us < ACQ_RUN_US) {
+        int64_t deadline = press_acq_deadline(&m.acq);
+        int64_t t = deadline;
+        if (m.reply_at >= 0 && m.reply_at < t) t = m.reply_at;
+        if (next_read < t) {
+            // 控制任务读取快照: 统计各通道的采样龄
+            m.now_us = next_read;
+            next_read += ACQ_READ_US;
+            for (int ch = 0; ch < c->channels; ch++) {
+                if (m.last_us[ch] < 0) continue;
+                int64_t age = m.now_us - m.last_us[ch];
+                m.age_sum += (double)age;
+                m.age_n++;
+                if (age > m.age_max) m.age_max = age;
+            }
+            continue;
+        }
+        m.now_us = t;
+        if (t == m.reply_at) {
+            m.reply_at = -1;
+            uint8_t *dst;
+            size_t done = 0;
+            while (done < PRESS_FRAME_MIN_LEN) {
+                size_t n = press_parser_write_ptr(&m.acq.parser, &dst);
+                if (n > PRESS_FRAME_MIN_LEN - done) n = PRESS_FRAME_MIN_LEN - done;
+                memcpy(dst, m.reply + done, n);
+                press_parser_commit(&m.acq.parser, n);
+                done += n;
+            }
+            press_acq_rx(&m.acq, t);
+        } else {
+            press_acq_timeout(&m.acq, t);
+        }
+    }
+
+    // 无故障时每个请求一个完整周期: 请求 + 转换 + 应答 + 接收超时
+    double cycle_us = (double)(4 + PRESS_FRAME_MIN_LEN + 1) * m.byte_us + ACQ_CONV_US;
+    double expect_hz = 1e6 / (cycle_us * c->channels);
+    double rate_min = 1e9;
+    for (int ch = 0; ch < c->channels; ch++) {
+        double hz = m.frames[ch] * 1e6 / ACQ_RUN_US;
+        if (hz < rate_min) rate_min = hz;
+    }
+
+    // 运行结束时最后一个请求的故障可能还没到超时
+    bool ok = m.wrong == 0 && m.timeouts <= m.faults && m.timeouts + 1 >= m.faults && rate_min > 0.0;
+    if (c->drop_pct == 0 && c->flip_pct == 0) ok &= rate_min > 0.98 * expect_hz;
+    printf("%lu,%d,%lu,%lu,%.1f,%.1f,%.2f,%.2f,%lu,%lu,%lu,%lu\n", (unsigned long)c->baud, c->channels,
+           (unsigned long)c->drop_pct, (unsigned long)c->flip_pct, rate_min, expect_hz,
+           m.age_n ? m.age_sum / m.age_n * 1e-3 : 0.0, (double)m.age_max * 1e-3,
+           (unsigned long)m.timeouts, (unsigned long)m.faults, (unsigned long)m.acq.parser.crc_errors,
+           (unsigned long)m.wrong);
+    return ok;
+}
+
+/**
+ * @brief 采集状态机接模拟串口运行 10 s (仿真时间)，输出每通道最低采样率、无故障时的理论值与采样龄
+ * * 无故障: 采样率不低于理论值的 98%，无超时；有故障: 超时数与注入的故障数相等 (每次失败只损失
+ * * 一个请求)，不出现通道归属错误的帧，所有通道都有采样
+ */
+bool sim_check_press_acq(void) {
+    static const acq_case_t cases[] = {
+        {   9600, 2, 0, 0 },
+        {   9600, 8, 0, 0 },
+        { 115200, 2, 0, 0 },
+        { 115200, 8, 0, 0 },
+        {   9600, 2, 5, 5 },
+        { 115200, 8, 5, 5 },
+    };
+    bool ok = true;
+    printf("press_acq_baud,channels,drop_pct,flip_pct,rate_hz_min,rate_hz_ideal,age_mean_ms,age_max_ms,"
+           "timeouts,faults,crc_errors,wrong_channel\n");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        ok &= acq_run(&cases[i]);
+    }
+    ESP_LOGI(TAG, "Pressure acquisition check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ---------------- 帧解析器 (模糊测试与吞吐) ----------------
+
+#define PARSE_CAP_BYTES     (1 << 20)   // 每段采集数据的字节数
+#define PARSE_MAX_FRAMES    (PARSE_CAP_BYTES / PRESS_FRAME_MIN_LEN)
+
+typedef struct {
+    uint8_t  type;
+    uint8_t  len;
+    uint32_t value;
+} ref_frame_t;
+
+static double mono_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 参考解码器: 对整段数据线性扫描，规则与流式解析器相同 (帧头 -> 长度 -> CRC，失败时只前进 1 字节)
+static size_t ref_decode(const uint8_t *buf, size_t n, ref_frame_t *out) {
+    size_t i = 0, k = 0;
+    while (i + 2 <= n) {
+        uint8_t len = buf[i + 1];
+        if (buf[i] != PRESS_FRAME_HEADER || len < PRESS_FRAME_MIN_LEN || len > PRESS_FRAME_MAX_LEN) {
+            i++;
+            continue;
+        }
+        if (i + len > n) break;
+        if (press_crc8(&buf[i], len - 1) != buf[i + len - 1]) {
+            i++;
+            continue;
+        }
+        out[k].type = buf[i + 2];
+        out[k].len = len;
+        out[k].value = ((uint32_t)buf[i + 5] << 16) | ((uint32_t)buf[i + 4] << 8) | buf[i + 3];
+        k++;
+        i += len;
+    }
+    return k;
+}
+
+// 生成一段采集数据: 首尾相接的应答帧 (粘包)，可选地翻转位、插入随机字节或截断帧；
+// injected 为完好写入的帧数
+static size_t parse_capture(uint8_t *buf, uint32_t *rng, uint32_t corrupt_pct, size_t *injected) {
+    size_t n = 0;
+    *injected = 0;
+    while (n + PRESS_FRAME_MAX_LEN * 2 <= PARSE_CAP_BYTES) {
+        uint32_t r = rng_next(rng) % 100;
+        if (corrupt_pct && r < corrupt_pct / 3) {
+            // 随机字节 (含伪帧头)
+            int k = 1 + rng_next(rng) % 16;
+            for (int i = 0; i < k; i++) {
+                buf[n++] = (rng_next(rng) & 3) == 0 ? PRESS_FRAME_HEADER : (uint8_t)rng_next(rng);
+            }
+            continue;
+        }
+        // 偶尔出现长度 > 7 的未知类型帧，检查长度字段的处理
+        uint8_t len = (rng_next(rng) % 8) == 0 ? (uint8_t)(PRESS_FRAME_MIN_LEN + rng_next(rng) % 8)
+                                               : PRESS_FRAME_MIN_LEN;
+        uint8_t *f = &buf[n];
+        f[0] = PRESS_FRAME_HEADER;
+        f[1] = len;
+        f[2] = len == PRESS_FRAME_MIN_LEN ? PRESS_FRAME_P1 : 0x10;
+        for (int i = 3; i < len - 1; i++) f[i] = (uint8_t)rng_next(rng);
+        f[len - 1] = press_crc8(f, len - 1);
+        if (corrupt_pct && r < corrupt_pct * 2 / 3) {
+            uint32_t bit = rng_next(rng) % (len * 8u);
+            f[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            n += len;
+        } else if (corrupt_pct && r < corrupt_pct) {
+            n += 1 + rng_next(rng) % (len - 1);         // 断包: 只有前半帧
+        } else {
+            n += len;
+            (*injected)++;
+        }
+    }
+    return n;
+}
+
+// 以给定的块长 (0: 随机 1..64) 把数据流式写入解析器；check 非空时逐帧与参考结果比较
+static bool parse_stream(const uint8_t *buf, size_t n, int chunk, uint32_t *rng,
+                         const ref_frame_t *check, size_t check_n, size_t *frames) {
+    static press_parser_t p;
+    press_parser_init(&p);
+    size_t pos = 0, k = 0;
+    bool ok = true;
+    while (pos < n) {
+        uint8_t *dst;
+        size_t room = press_parser_write_ptr(&p, &dst);
+        size_t want = chunk > 0 ? (size_t)chunk : 1 + rng_next(rng) % 64;
+        if (want > room) want = room;
+        if (want > n - pos) want = n - pos;
+        memcpy(dst, buf + pos, want);
+        press_parser_commit(&p, want);
+        pos += want;
+
+        press_frame_t f;
+        while (press_parser_next(&p, &f)) {
+            if (check) {
+                if (k >= check_n || f.type != check[k].type || f.len != check[k].len ||
+                    f.value != check[k].value) {
+                    ok = false;
+                }
+            }
+            k++;
+        }
+    }
+    *frames = k;
+    return ok && (!check || k == check_n);
+}
+
+/**
+ * @brief 帧解析器的差分模糊测试与吞吐
+ * * 随机生成粘包、误码、断包与插入杂字节的采集数据，以不同块长流式写入 (模拟 UART 每次唤醒
+ * * 读到的字节数)，取出的帧序列必须与参考解码器对整段数据的结果逐帧一致；损坏数据中完好的帧
+ * * 至少恢复 99%。之后对干净与损坏的数据按块长计时，输出字节/秒与帧/秒
+ */
+bool sim_check_press_parser(void) {
+    uint8_t *buf = malloc(PARSE_CAP_BYTES);
+    ref_frame_t *ref = malloc(PARSE_MAX_FRAMES * sizeof(ref_frame_t));
+    if (!buf || !ref) {
+        free(buf);
+        free(ref);
+        return false;
+    }
+
+    bool ok = true;
+    uint32_t rng = 88172645u;
+    printf("press_parser_fuzz_seed,corrupt_pct,bytes,frames_injected,frames_ref,frames_out,match\n");
+    for (int seed = 0; seed < 8; seed++) {
+        uint32_t corrupt = seed == 0 ? 0 : (uint32_t)(5 * seed);
+        size_t injected;
+        size_t n = parse_capture(buf, &rng, corrupt, &injected);
+        size_t ref_n = ref_decode(buf, n, ref);
+        bool match = true;
+        size_t out_n = 0;
+        static const int chunks[] = { 1, 7, 64, 120, 0 };
+        for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            match &= parse_stream(buf, n, chunks[c], &rng, ref, ref_n, &out_n);
+        }
+        // 参考结果还包含误码后恰好 CRC 正确的帧与未知类型帧，故只要求不少于完好帧的 99%
+        bool recovered = ref_n * 100 >= injected * 99;
+        ok &= match && recovered;
+        printf("%d,%lu,%lu,%lu,%lu,%lu,%d\n", seed, (unsigned long)corrupt, (unsigned long)n,
+               (unsigned long)injected, (unsigned long)ref_n, (unsigned long)out_n, match);
+    }
+
+    printf("press_parser_corrupt_pct,chunk,mbytes_per_s,kframes_per_s\n");
+    static const uint32_t corrupt_cases[] = { 0, 20 };
+    static const int tp_chunks[] = { 1, 7, 120 };
+    for (size_t c = 0; c < sizeof(corrupt_cases) / sizeof(corrupt_cases[0]); c++) {
+        size_t injected;
+        size_t n = parse_capture(buf, &rng, corrupt_cases[c], &injected);
+        for (size_t k = 0; k < sizeof(tp_chunks) / sizeof(tp_chunks[0]); k++) {
+            size_t frames = 0;
+            double t0 = mono_s();
+            for (int rep = 0; rep < 8; rep++) {
+                parse_stream(buf, n, tp_chunks[k], &rng, NULL, 0, &frames);
+            }
+            double dt = mono_s() - t0;
+            ok &= frames > 0;
+            printf("%lu,%d,%.1f,%.1f\n", (unsigned long)corrupt_cases[c], tp_chunks[k],
+                   8.0 * n / dt * 1e-6, 8.0 * frames / dt * 1e-3);
+        }
+    }
+
+    free(buf);
+    free(ref);
+    ESP_LOGI(TAG, "Pressure parser check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ---------------- SPSC 环形队列 (多线程压力测试) ----------------
+
+#define SPSC_ITEMS          2000000
+
+// 元素为序号与由序号导出的负载，消费者据此发现撕裂 (读到写了一半的元素) 与乱序
+typedef struct {
+    uint32_t seq;
+    uint32_t payload[5];
+} spsc_item_t;
+
+typedef struct {
+    spsc_ring_t ring;
+    int         burst;          ///< 生产者每连续写入 burst 个后让出一次 CPU
+    uint32_t    pushed;
+    atomic_bool done;
+} spsc_test_t;
+
+static void *spsc_producer(void *arg) {
+    spsc_test_t *t = arg;
+    spsc_item_t it;
+    for (uint32_t i = 0; i < SPSC_ITEMS; i++) {
+        it.seq = i;
+        for (int k = 0; k < 5; k++) it.payload[k] = i * 2654435761u + (uint32_t)k;
+        while (!spsc_ring_push(&t->ring, &it)) sched_yield();    // 队列满: 让消费者取走后重试
+        t->pushed++;
+        if (t->burst && i % (uint32_t)t->burst == 0) sched_yield();
+    }
+    atomic_store(&t->done, true);
+    return NULL;
+}
+
+/**
+ * @brief SPSC 队列的生产者/消费者线程压力测试
+ * * 两个线程并发 push/pop，队列容量从 2 到 64 (满与空频繁交替)，生产者在队列满时重试而不丢弃；
+ * * 消费者检查序号严格递增、负载与序号一致 (无撕裂)，结束时全部条目都经队列取出
+ */
+bool sim_check_spsc_ring(void) {
+    static const uint32_t caps[] = { 2, 8, 64 };
+    static const int bursts[] = { 0, 16 };
+    bool ok = true;
+    printf("spsc_capacity,producer_burst,pushed,popped,full_retries,max_depth,order_errors,torn\n");
+    for (size_t c = 0; c < sizeof(caps) / sizeof(caps[0]); c++) {
+        for (size_t b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++) {
+            static spsc_item_t storage[64];
+            static spsc_test_t t;
+            spsc_ring_init(&t.ring, storage, caps[c], sizeof(spsc_item_t));
+            t.burst = bursts[b];
+            t.pushed = 0;
+            atomic_init(&t.done, false);
+
+            pthread_t prod;
+            if (pthread_create(&prod, NULL, spsc_producer, &t) != 0) return false;
+
+            uint32_t popped = 0, order_err = 0, torn = 0;
+            int64_t last = -1;
+            spsc_item_t it;
+            while (1) {
+                bool fin = atomic_load(&t.done);
+                bool got = false;
+                while (spsc_ring_pop(&t.ring, &it)) {
+                    got = true;
+                    if ((int64_t)it.seq <= last) order_err++;
+                    last = it.seq;
+                    for (int k = 0; k < 5; k++) {
+                        if (it.payload[k] != it.seq * 2654435761u + (uint32_t)k) {
+                            torn++;
+                            break;
+                        }
+                    }
+                    popped++;
+                }
+                if (fin) break;     // 生产者结束后再清空一次
+                if (!got) sched_yield();    // 单核主机上不空转占满时间片
+            }
+            pthread_join(prod, NULL);
+
+            bool pass = order_err == 0 && torn == 0 && t.pushed == SPSC_ITEMS && popped == SPSC_ITEMS &&
+                        t.ring.max_depth <= caps[c];
+            ok &= pass;
+            printf("%lu,%d,%lu,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)caps[c], bursts[b],
+                   (unsigned long)t.pushed, (unsigned long)popped, (unsigned long)t.ring.drops,
+                   (unsigned long)t.ring.max_depth, (unsigned long)order_err, (unsigned long)torn);
+        }
+    }
+    ESP_LOGI(TAG, "SPSC ring check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ---------------- PID (pid_timed) ----------------
+
+#define PID_PLANT_TAU       0.1f        // 被控对象: 一阶惯性 y' = (u - y) / tau
+#define PID_PLANT_DT        0.0001f     // 对象积分步长 (s)
+#define PID_SIM_S           2.0f
+#define PID_CHECK_EVERY     100         // 每 100 个对象步长 (10 ms) 比较一次响应
+
+static void pid_test_init(pid_timed_t *pid, float beta) {
+    pid_timed_init(pid, 1.0f, 20.0f, 0.01f, -10.0f, 10.0f);
+    pid->d_tau = 0.005f;
+    pid->beta = beta;
+    pid->int_limit = 10.0f;
+}
+
+/**
+ * @brief 闭环单位阶跃响应: 控制器按给定周期 (可带抖动) 采样，对象以固定小步长积分
+ * * @param period_s 名义采样周期
+ * @param jitter 周期抖动比例 (0 = 无抖动)，按 [1 - jitter, 1 + jitter] 均匀分布
+ * @param y 输出: 每 10 ms 的对象输出
+ * @return float 超调 (相对阶跃幅值)
+ */
+static float pid_step_response(float period_s, float jitter, float beta, float *y, int n) {
+    pid_timed_t pid;
+    pid_test_init(&pid, beta);
+    pid.setpoint = 1.0f;
+
+    uint32_t rng = 12345;
+    float plant = 0.0f, u = 0.0f, t = 0.0f, next = 0.0f, last = 0.0f, peak = 0.0f;
+    for (int k = 0; k < n * PID_CHECK_EVERY; k++, t += PID_PLANT_DT) {
+        if (t >= next) {
+            u = pid_timed_compute(&pid, plant, k ? t - last : 0.0f);
+            last = t;
+            float r = jitter > 0.0f ? (float)(rng_next(&rng) & 0xFFFF) / 65535.0f * 2.0f - 1.0f : 0.0f;
+            next += period_s * (1.0f + jitter * r);
+        }
+        plant += (u - plant) / PID_PLANT_TAU * PID_PLANT_DT;
+        if (plant > peak) peak = plant;
+        if ((k + 1) % PID_CHECK_EVERY == 0) y[k / PID_CHECK_EVERY] = plant;
+    }
+    return peak - 1.0f;
+}
+
+/**
+ * @brief pid_timed 的单元检查
+ * * dt 不变性: 同一组连续时间增益在 1/2/5 ms 与带 ±50% 抖动的周期下，阶跃响应与 1 ms 相差不超过 5%；
+ *   dt = 0 (重复样本) 不改变状态
+ * * 无微分冲击: 测量值不变时设定值阶跃，输出只有比例项 kp·beta·Δsp
+ * * 抗饱和: 对象卡死使输出长时间饱和后误差反向，反算与条件积分两种方式都在 2 个周期内退出饱和
+ * * 设定值权重: beta = 0.5 时阶跃瞬间的比例项减半、超调减小，稳态误差仍收敛到 0
+ */
+bool sim_check_pid(void) {
+    enum { N = (int)(PID_SIM_S / PID_PLANT_DT) / PID_CHECK_EVERY };
+    static const struct { const char *name; float period_s, jitter; } cases[] = {
+        { "2ms", 0.002f, 0.0f }, { "5ms", 0.005f, 0.0f }, { "1ms_jitter50", 0.001f, 0.5f },
+    };
+    static float ref[N], y[N];
+    bool ok = true, pass;
+
+    printf("pid_case,metric,limit,pass\n");
+
+    // 1. dt 不变性
+    pid_step_response(0.001f, 0.0f, 1.0f, ref, N);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        pid_step_response(cases[c].period_s, cases[c].jitter, 1.0f, y, N);
+        float dev = 0.0f;
+        for (int i = 0; i < N; i++) dev = fmaxf(dev, fabsf(y[i] - ref[i]));
+        pass = dev <= 0.05f;
+        ok &= pass;
+        printf("dt_invariance_%s,%.4f,0.05,%d\n", cases[c].name, dev, pass);
+    }
+
+    pid_timed_t pid;
+    pid_test_init(&pid, 1.0f);
+    pid.setpoint = 1.0f;
+    pid_timed_compute(&pid, 0.2f, 0.001f);
+    pid_timed_compute(&pid, 0.3f, 0.001f);
+    pid_timed_t before = pid;
+    pid_timed_compute(&pid, 0.3f, 0.0f);
+    pass = pid.integral == before.integral && pid.d_state == before.d_state;
+    ok &= pass;
+    printf("repeated_sample_state,%.6f,0,%d\n", fabsf(pid.integral - before.integral), pass);
+
+    // 2. 无微分冲击
+    pid_test_init(&pid, 1.0f);
+    for (int i = 0; i < 10; i++) pid_timed_compute(&pid, 0.0f, 0.001f);
+    pid.setpoint = 1.0f;
+    float kick = pid_timed_compute(&pid, 0.0f, 0.001f) - pid.kp * 1.0f;
+    pass = fabsf(kick) < 1e-5f;
+    ok &= pass;
+    printf("derivative_kick,%.6f,1e-05,%d\n", fabsf(kick), pass);
+
+    // 3. 抗饱和: 输出限幅 ±1，测量值卡在 0、误差 1 持续 2 s，然后误差变为 -0.2
+    for (int mode = 0; mode < 2; mode++) {
+        pid_test_init(&pid, 1.0f);
+        pid.out_min = -1.0f;
+        pid.out_max = 1.0f;
+        if (mode == 1) pid.kb = 0.0f;
+        pid.setpoint = 1.0f;
+        for (int i = 0; i < 2000; i++) pid_timed_compute(&pid, 0.0f, 0.001f);
+        pid.setpoint = -0.2f;
+        int steps = 0;
+        while (steps < 1000 && pid_timed_compute(&pid, 0.0f, 0.001f) >= pid.out_max) steps++;
+        pass = steps < 2;
+        ok &= pass;
+        printf("anti_windup_%s_steps,%d,2,%d\n", mode ? "conditional" : "back_calc", steps, pass);
+    }
+
+    // 4. 设定值权重
+    pid_test_init(&pid, 0.5f);
+    pid.setpoint = 1.0f;
+    float p0 = pid_timed_compute(&pid, 0.0f, 0.001f);
+    pass = fabsf(p0 - 0.5f * pid.kp) < 1e-5f;
+    ok &= pass;
+    printf("sp_weight_initial,%.4f,%.4f,%d\n", p0, 0.5f * pid.kp, pass);
+
+    float over1 = pid_step_response(0.001f, 0.0f, 1.0f, ref, N);
+    float over05 = pid_step_response(0.001f, 0.0f, 0.5f, y, N);
+    pass = over05 < over1;
+    ok &= pass;
+    printf("sp_weight_overshoot,%.4f,%.4f,%d\n", over05, over1, pass);
+    pass = fabsf(y[N - 1] - 1.0f) < 0.01f;
+    ok &= pass;
+    printf("sp_weight_final_err,%.4f,0.01,%d\n", fabsf(y[N - 1] - 1.0f), pass);
+
+    ESP_LOGI(TAG, "PID check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
@@ -0,0 +1,21 @@
+//模块级主机检查: 不经过被控对象，直接以模拟外设或多线程驱动单个模块，输出 CSV 指标。
+//由 sim_main 在仿真结束后调用，任一检查失败时以非零状态退出。
+
+#ifndef SIM_CHECKS_H
+#define SIM_CHECKS_H
+
+#include <stdbool.h>
+
+// 气压采集状态机 (press_acq) 接模拟串口: 不同波特率、通道数与故障下的每通道采样率与采样龄
+bool sim_check_press_acq(void);
+
+// 帧解析器: 与参考解码器的差分模糊测试 (粘包/误码/断包/任意块长)，以及字节/秒与帧/秒吞吐
+bool sim_check_press_parser(void);
+
+// SPSC 环形队列: 生产者/消费者两个线程并发读写，检查顺序、撕裂与计数
+bool sim_check_spsc_ring(void);
+
+// 按实际间隔计算的 PID (pid_timed): dt 不变性、无微分冲击、抗饱和与设定值权重
+bool sim_check_pid(void);
+
+#endif // SIM_CHECKS_H
@@ -0,0 +1,494 @@
+#include "sim_hal.h"
+#include "hardware_config.h"
+#include "hal_valves.h"
+#include "hal_pump.h"
+#include "as5600.h"
+#include "press.h"
+#include "as5600_track.h"
+#include "sensor_trace.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "SIM_HAL";
+
+#define COUNTS_PER_RAD  (4096.0f / 6.28318531f)
+
+static pam_model_params_t params;
+static pam_model_state_t  state;
+static int64_t now_us;
+
+// 传感器状态
+static press_snapshot_t press_snap;
+static int64_t next_press_us;
+static int next_press_ch;
+
+// 气压传感器故障注入
+static int64_t drop_t0_us;
+static uint32_t drop_period_us, drop_len_us;
+static bool    stuck[2];
+static uint32_t stuck_pa[2];
+
+// 气泵: 开关触点与控制器
+static pump_ctrl_t pump;
+static bool    switch_level;        ///< 开关引脚电平 (true = 低压闭合)，含抖动
+static int     bounce_left;         ///< 本次切换剩余的抖动翻转次数
+static int64_t next_bounce_us;
+static int64_t debounce_due_us;     ///< 最后一个边沿 + 去抖时间，0 表示无待处理边沿
+static int64_t pump_next_us;        ///< 最短开/关时间推迟的动作到期时刻
+
+static void pump_poll(void);
+static void switch_edge(bool level);
+static void press_publish(int channel, uint32_t pa, int64_t t_us);
+static bool press_dropped(int channel);
+
+static as5600_track_t angle_track[AS5600_CHANNEL_COUNT];
+static int32_t zero_offset;
+static uint8_t zero_set_flag;
+static as5600_scan_t scan_snap;
+
+// 回放: 角度读数按读取次序出队 (每次 as5600_get_angle 取走一个记录的读数)
+#define ANGLE_FIFO_LEN  8
+typedef struct {
+    uint16_t raw[ANGLE_FIFO_LEN];
+    int64_t  t_us[ANGLE_FIFO_LEN];
+    uint8_t  head, count;
+} angle_fifo_t;
+static angle_fifo_t angle_fifo[AS5600_CHANNEL_COUNT];
+static uint32_t replay_misses;
+static uint32_t replay_mark;
+static bool     replay_mark_seen;
+
+static uint32_t duty_hash;
+
+// 阀门 PWM: 提交的占空比在周期起点锁存 (与 LEDC 相同)，只模拟默认组 (定时器 0)
+static valve_pwm_timing_t pwm;
+static valve_pwm_stats_t  pwm_stats;
+static float   pwm_stage[VALVE_NUM];    ///< 已写入、尚未提交
+static float   pwm_pending[VALVE_NUM];  ///< 已提交，在 pwm_pending_at 之后的第一个周期起点锁存
+static int64_t pwm_pending_at;
+static float   pwm_prev[VALVE_NUM];     ///< 被推迟的提交之前的值，在 pwm_pending_at (周期起点) 锁存
+static bool    pwm_prev_valid;
+static bool    pwm_latch;
+
+void sim_hal_init(float init_kpa) {
+    pam_model_default_params(&params);
+    pam_model_init(&state, &params, init_kpa);
+    now_us = 0;
+
+    memset(&press_snap, 0, sizeof(press_snap));
+    next_press_us = 0;
+    next_press_ch = 0;
+    drop_period_us = drop_len_us = 0;
+    memset(stuck, 0, sizeof(stuck));
+    for (int i = 0; i < AS5600_CHANNEL_COUNT; i++) as5600_track_reset(&angle_track[i]);
+    memset(&scan_snap, 0, sizeof(scan_snap));
+    memset(angle_fifo, 0, sizeof(angle_fifo));
+    zero_set_flag = 0;
+    replay_misses = 0;
+    replay_mark_seen = false;
+    duty_hash = 2166136261u;
+
+    valve_pwm_timing_init(&pwm, VALVE_PWM_FREQ_HZ, 0);
+    valve_pwm_stats_reset(&pwm_stats);
+    memset(pwm_stage, 0, sizeof(pwm_stage));
+    memset(pwm_pending, 0, sizeof(pwm_pending));
+    pwm_pending_at = 0;
+    pwm_prev_valid = false;
+    pwm_latch = true;
+}
+
+#if PAM_TRACE_ENABLE
+// 回放事件进入与实时采样相同的处理路径
+static void replay_sink(const trace_event_t *ev) {
+    switch (ev->type) {
+    case TRACE_EV_ANGLE:
+        as5600_replay_sample(ev->ch, (uint16_t)ev->value, ev->ok, ev->t_us);
+        break;
+    case TRACE_EV_PRESS:
+        pressure_replay_sample(ev->ch, ev->value, ev->ok, ev->t_us);
+        break;
+    case TRACE_EV_PUMP:
+        pump_replay_switch(ev->value != 0, ev->ch == TRACE_PUMP_EDGE, ev->t_us);
+        break;
+    case TRACE_EV_MARK:
+        replay_mark = ev->value;
+        replay_mark_seen = true;
+        break;
+    }
+}
+#endif
+
+void sim_hal_advance(uint32_t us) {
+    // 区间内的 PWM 周期起点把被控对象的积分分段，起点处锁存待生效的占空比
+    int64_t end_us = now_us + us;
+    while (pwm_latch) {
+        int64_t edge = valve_pwm_next_edge(&pwm, now_us);
+        if (edge > end_us) break;
+        pam_model_step(&state, &params, (float)(edge - now_us) * 1e-6f);
+        now_us = edge;
+        if (pwm_pending_at < edge) memcpy(state.duty, pwm_pending, sizeof(pwm_pending));
+        else if (pwm_prev_valid && pwm_pending_at == edge) memcpy(state.duty, pwm_prev, sizeof(pwm_prev));
+    }
+    pam_model_step(&state, &params, (float)(end_us - now_us) * 1e-6f);
+    now_us = end_us;
+#if PAM_TRACE_ENABLE
+    if (trace_replaying()) trace_replay_until(now_us, replay_sink);
+#endif
+    pump_poll();
+
+    // 气压传感器按 UART 轮询节奏逐通道刷新 (传感器分辨率 1 Pa)；回放时由记录的帧刷新
+    while (now_us >= next_press_us) {
+        int ch = next_press_ch;
+        if (ch < 2 && !trace_replaying()) {
+            uint32_t pa = stuck[ch] ? stuck_pa[ch] : (uint32_t)lroundf(state.p_kpa[ch] * 1000.0f);
+            if (press_dropped(ch)) {
+                trace_press(ch, 0, false, now_us);
+                press_snap.ch[ch].timeouts++;
+            } else {
+                trace_press(ch, pa, true, now_us);
+                press_publish(ch, pa, now_us);
+            }
+        }
+        next_press_ch = (next_press_ch + 1) % PRESS_CHANNEL_COUNT;
+        next_press_us += SIM_PRESS_PERIOD_US / PRESS_CHANNEL_COUNT;
+    }
+}
+
+void sim_hal_replay_finish(void) {
+#if PAM_TRACE_ENABLE
+    if (trace_replaying()) trace_replay_until(INT64_MAX, replay_sink);
+#endif
+}
+
+bool sim_hal_replay_mark(uint32_t *value) {
+    *value = replay_mark;
+    return replay_mark_seen;
+}
+
+uint32_t sim_hal_replay_misses(void) { return replay_misses; }
+uint32_t sim_hal_duty_hash(void) { return duty_hash; }
+
+int64_t sim_hal_now_us(void) { return now_us; }
+pam_model_state_t *sim_hal_state(void) { return &state; }
+pam_model_params_t *sim_hal_params(void) { return &params; }
+
+// ---------------- hal_valves ----------------
+
+void valves_init(void) {
+    ESP_LOGI(TAG, "Simulated valves (PWM %lu Hz)", (unsigned long)(1000000u / pwm.period_us));
+}
+
+// 仿真中可随时修改 (周期起点不变)，分辨率不影响被控对象
+void valves_config_group(int timer, const valve_group_cfg_t *cfg) {
+    if (timer != 0) return;
+    valve_pwm_timing_init(&pwm, cfg->freq_hz, pwm.epoch_us);
+}
+
+void valves_pwm_sync(int64_t at_us) {
+    pwm.epoch_us = at_us;       // 仿真时钟在调用期间不前进: 直接把周期起点设在 at_us
+}
+
+int64_t valves_commit_edge(void) {
+    return pwm_latch ? pwm_stats.pend_edge_us : now_us;
+}
+
+bool valves_get_stats(int timer, valve_pwm_stats_t *out) {
+    if (timer != 0) return false;
+    *out = pwm_stats;
+    return true;
+}
+
+void sim_hal_valve_latch(bool on) {
+    pwm_latch = on;
+    valve_pwm_stats_reset(&pwm_stats);
+    if (!on) memcpy(state.duty, pwm_pending, sizeof(pwm_pending));
+}
+
+// 一批提交: 距周期起点不足保护时间时按驱动的做法推迟到起点之后 (该起点仍锁存之前的值)
+static void valve_commit(void) {
+    int64_t at = valve_pwm_commit_time(&pwm, now_us, VALVE_COMMIT_GUARD_US);
+    valve_pwm_note_commit(&pwm_stats, &pwm, at, at != now_us);
+    pwm_prev_valid = at != now_us;
+    if (pwm_prev_valid) memcpy(pwm_prev, pwm_pending, sizeof(pwm_pending));
+    memcpy(pwm_pending, pwm_stage, sizeof(pwm_stage));
+    pwm_pending_at = at;
+    if (!pwm_latch) memcpy(state.duty, pwm_pending, sizeof(pwm_pending));
+}
+
+static void valve_write(int channel, uint32_t duty) {
+    if (duty > VALVE_MAX_DUTY) duty = VALVE_MAX_DUTY;
+    pwm_stage[channel] = (float)duty / (float)VALVE_MAX_DUTY;
+
+    // FNV-1a: 记录与回放的阀门命令序列逐位比较
+    uint32_t v = ((uint32_t)channel << 28) ^ duty;
+    for (int i = 0; i < 4; i++) {
+        duty_hash = (duty_hash ^ ((v >> (8 * i)) & 0xFF)) * 16777619u;
+    }
+}
+
+void valve_set_duty(int channel, uint32_t duty) {
+    if (channel < 0 || channel > 3) return;
+    valve_write(channel, duty);
+    valve_commit();
+}
+
+void valve_set_duty_all(const uint32_t duty[VALVE_NUM]) {
+    uint32_t d[VALVE_NUM];
+    valve_pwm_interlock(duty, d, VALVE_NUM, VALVE_MAX_DUTY);     // 与驱动相同
+    for (int i = 0; i < VALVE_NUM; i++) valve_write(i, d[i]);
+    valve_commit();
+}
+
+void valve_open_full(int channel) {
+    valve_set_duty(channel, VALVE_MAX_DUTY);
+}
+
+void valve_close_full(int channel) {
+    valve_set_duty(channel, 0);
+}
+
+// ---------------- hal_pump ----------------
+// 模拟开关触点抖动，按与 hal_pump.c 中气泵任务相同的方式去抖后交给 pump_ctrl
+
+void pump_init(void) {
+    pump_ctrl_init(&pump, PUMP_MIN_ON_MS, PUMP_MIN_OFF_MS,
+                   PUMP_TANK_VOLUME_L * (PUMP_SWITCH_HIGH_KPA - PUMP_SWITCH_LOW_KPA) / 101.325f, now_us);
+    switch_level = state.switch_low;
+    bounce_left = 0;
+    debounce_due_us = now_us;   // 启动时立即评估一次开关状态
+    pump_next_us = 0;
+    state.pump_on = false;
+}
+
+void pump_trace_level(void) {
+    trace_pump(switch_level, false, now_us);
+}
+
+void pump_replay_switch(bool low, bool edge, int64_t t_us) {
+    (void)t_us;
+    if (edge) switch_edge(low);
+    else switch_level = low;        // 记录开始时的电平
+}
+
+// 一个开关边沿 (对应 hal_pump.c 的中断): 重新开始去抖计时
+static void switch_edge(bool level) {
+    trace_pump(level, true, now_us);
+    switch_level = level;
+    pump.st.edges++;
+    debounce_due_us = now_us + PUMP_DEBOUNCE_MS * 1000;
+}
+
+// 每个仿真步调用: 生成开关边沿 (含抖动，回放时边沿来自轨迹)，
+// 去抖到期或推迟动作到期时运行控制器
+static void pump_poll(void) {
+    if (!trace_replaying()) {
+        if (state.switch_low != switch_level && bounce_left == 0) {
+            bounce_left = SIM_SWITCH_BOUNCES * 2 + 1;   // 奇数次翻转后停在新状态
+            next_bounce_us = now_us;
+        }
+        while (bounce_left > 0 && now_us >= next_bounce_us) {
+            switch_edge(!switch_level);
+            bounce_left--;
+            next_bounce_us += SIM_SWITCH_BOUNCE_US;
+        }
+    }
+
+    // 与气泵任务相同: 最后一个边沿之后 PUMP_DEBOUNCE_MS 内不评估
+    if (debounce_due_us) {
+        if (now_us < debounce_due_us) return;
+    } else if (!pump_next_us || now_us < pump_next_us) {
+        return;
+    }
+
+    debounce_due_us = 0;
+    state.pump_on = pump_ctrl_update(&pump, switch_level, now_us, &pump_next_us);
+}
+
+void pump_get_status(pump_status_t *out) {
+    *out = pump.st;
+}
+
+float pump_supply_margin(void) {
+    return pump_ctrl_margin(&pump.st, now_us);
+}
+
+bool pump_supply_low(void) {
+    return pump_supply_margin() < PUMP_SUPPLY_LOW_MARGIN;
+}
+
+void pump_set_mode(int mode) {
+    pump_ctrl_set_mode(&pump, mode);
+}
+
+// ---------------- as5600 ----------------
+
+// 12 位量化后的原始读数
+static uint16_t sim_raw_angle(void) {
+    int32_t counts = (int32_t)lroundf(state.theta * COUNTS_PER_RAD);
+    return (uint16_t)(counts & 0x0FFF);
+}
+
+void as5600_init(void) {
+    ESP_LOGI(TAG, "Simulated AS5600");
+}
+
+// 一次读取: 实时为被控对象角度的 12 位量化值 (写入轨迹)，回放时取下一个记录的读数
+static bool angle_read(int channel) {
+    uint16_t raw;
+    int64_t t_us;
+    if (trace_replaying()) {
+        angle_fifo_t *q = &angle_fifo[channel];
+        if (q->count == 0) {
+            replay_misses++;
+            return false;
+        }
+        raw = q->raw[q->head];
+        t_us = q->t_us[q->head];
+        q->head = (q->head + 1) % ANGLE_FIFO_LEN;
+        q->count--;
+    } else {
+        raw = sim_raw_angle();
+        t_us = now_us;
+        trace_angle(channel, raw, true, t_us);
+    }
+    as5600_track_update(&angle_track[channel], raw, t_us);
+    return true;
+}
+
+// 与 as5600.c 相同: 以当前滤波位置为零点
+void as5600_set_zero(void) {
+    angle_read(0);
+    zero_offset = as5600_track_pos(&angle_track[0]);
+    zero_set_flag = 1;
+}
+
+int16_t as5600_get_angle(int channel) {
+    if (channel < 0 || channel >= AS5600_CHANNEL_COUNT) return 0;
+
+    angle_read(channel);
+    if (!zero_set_flag) return 0;
+    return as5600_track_rel(&angle_track[channel], zero_offset);
+}
+
+float sim_hal_angle(void) {
+    if (!zero_set_flag) return 0.0f;
+    // 展开计数与 theta·COUNTS_PER_RAD 相差 4096 的整数倍，相对零点后回绕到 ±2048
+    float rel = state.theta * COUNTS_PER_RAD - (float)zero_offset;
+    return rel - 4096.0f * floorf((rel + 2048.0f) / 4096.0f);
+}
+
+float as5600_get_velocity(int channel) {
+    if (channel < 0 || channel >= AS5600_CHANNEL_COUNT) return 0.0f;
+    return as5600_track_vel(&angle_track[channel]);
+}
+
+// 回放: 读数进入队列，由之后的读取按次序取走 (仿真中读取时刻即采样时刻)
+void as5600_replay_sample(int channel, uint16_t raw, bool ok, int64_t t_us) {
+    if (channel < 0 || channel >= AS5600_CHANNEL_COUNT || !ok) return;
+    angle_fifo_t *q = &angle_fifo[channel];
+    if (q->count == ANGLE_FIFO_LEN) {
+        replay_misses++;
+        return;
+    }
+    int i = (q->head + q->count++) % ANGLE_FIFO_LEN;
+    q->raw[i] = raw;
+    q->t_us[i] = t_us;
+}
+
+// 仿真只有通道 0 接有关节，扫描中其余通道按超时处理
+void as5600_scan(void) {
+    scan_snap.t_us = now_us;
+    scan_snap.fault_mask = 0;
+    for (int ch = 0; ch < AS5600_CHANNEL_COUNT; ch++) {
+        if (!(AS5600_SCAN_MASK & (1u << ch))) continue;
+        as5600_sample_t *s = &scan_snap.ch[ch];
+        s->ok = ch == 0;
+        if (!s->ok) {
+            s->timeouts++;
+            scan_snap.fault_mask |= 1u << ch;
+            continue;
+        }
+        s->angle = as5600_get_angle(ch);
+        s->velocity = as5600_get_velocity(ch);
+        s->raw = angle_track[ch].last_raw;
+        s->t_us = now_us;
+        s->reads++;
+        s->status = AS5600_STATUS_MD;
+        s->agc = 128;
+        s->checked = true;
+        s->valid = true;
+    }
+    scan_snap.pass++;
+}
+
+void as5600_get_snapshot(as5600_scan_t *out) {
+    *out = scan_snap;
+}
+
+bool as5600_magnet_ok(const as5600_sample_t *s) {
+    if (!s->checked) return true;
+    return (s->status & (AS5600_STATUS_MD | AS5600_STATUS_ML | AS5600_STATUS_MH)) == AS5600_STATUS_MD;
+}
+
+// ---------------- press ----------------
+
+void pressure_sensor_init(void) {
+    ESP_LOGI(TAG, "Simulated pressure sensors");
+}
+
+// 周期性中断的窗口内 (两通道相位错开半个周期) 传感器不应答
+static bool press_dropped(int channel) {
+    if (drop_period_us == 0) return false;
+    int64_t phase = (now_us - drop_t0_us + (int64_t)channel * (drop_period_us / 2)) % drop_period_us;
+    return phase < (int64_t)drop_len_us;
+}
+
+void sim_hal_press_dropout(uint32_t period_us, uint32_t len_us) {
+    drop_t0_us = now_us;
+    drop_period_us = period_us;
+    drop_len_us = len_us;
+}
+
+void sim_hal_press_stuck(int channel, bool on, uint32_t pa) {
+    if (channel < 0 || channel >= 2) return;
+    stuck[channel] = on;
+    stuck_pa[channel] = pa;
+}
+
+static void press_publish(int channel, uint32_t pa, int64_t t_us) {
+    press_sample_t *s = &press_snap.ch[channel];
+    s->kpa = pa / 1000;
+    s->pa = pa;
+    s->timestamp_us = t_us;
+    s->frames++;
+    s->valid = true;
+}
+
+void pressure_replay_sample(int channel, uint32_t pa, bool ok, int64_t t_us) {
+    if (channel < 0 || channel >= PRESS_CHANNEL_COUNT) return;
+    if (ok) press_publish(channel, pa, t_us);
+    else press_snap.ch[channel].timeouts++;
+}
+
+void pressure_get_snapshot(press_snapshot_t *out) {
+    *out = press_snap;
+}
+
+bool pressure_get_sample(int channel, press_sample_t *out) {
+    if (channel < 0 || channel >= PRESS_CHANNEL_COUNT) return false;
+    *out = press_snap.ch[channel];
+    return out->valid;
+}
+
+uint32_t pressure_read_kpa(int channel) {
+    press_sample_t sample;
+    if (!pressure_get_sample(channel, &sample)) return 0;
+    return sample.kpa;
+}
+
+q16_t pressure_read_q16(int channel) {
+    press_sample_t sample;
+    if (!pressure_get_sample(channel, &sample)) return 0;
+    return q16_ratio(sample.pa, 1000);
+}
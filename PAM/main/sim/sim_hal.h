@@ -0,0 +1,56 @@
+//软件在环仿真的硬件抽象层
+//以 pam_model 为被控对象，实现 hal_valves / hal_pump / as5600 / press 的全部接口，
+//使 algorithm/ 与 app/ 的源码不经修改即可在 IDF linux 目标上以仿真时钟运行。
+//传感器轨迹回放时 (trace_replaying)，角度读数、气压帧与开关边沿取自轨迹，被控对象的输出不再被读取。
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pam_model.h"
+
+#define SIM_PRESS_PERIOD_US     16000   // 每通道气压采样周期 (9600bps 下两通道轮询)
+#define SIM_SWITCH_BOUNCES      3       // 压力开关每次切换的触点抖动次数
+#define SIM_SWITCH_BOUNCE_US    2000    // 抖动翻转间隔
+
+// 复位仿真: 两肌肉初始表压 init_kpa
+void sim_hal_init(float init_kpa);
+
+// 仿真时钟前进 us 微秒 (被控对象积分 + 传感器采样 + 气泵开关事件)
+// 回放时先交付时刻不晚于新时钟的全部轨迹事件
+void sim_hal_advance(uint32_t us);
+
+// 回放结束: 交付剩余的全部轨迹事件 (含末尾的标记)
+void sim_hal_replay_finish(void);
+
+// 回放中读到的最后一个 MARK 事件的值；没有时返回 false
+bool sim_hal_replay_mark(uint32_t *value);
+
+// 回放中读取时没有对应记录读数的次数 (非 0 说明读取次序与记录时不同)
+uint32_t sim_hal_replay_misses(void);
+
+// 气压传感器周期性中断: 从当前时刻起每 period_us 中有 len_us 不应答 (超时)，
+// 通道 1 相位错开半个周期；period_us = 0 关闭。只作用于实时采样，回放时由轨迹决定
+void sim_hal_press_dropout(uint32_t period_us, uint32_t len_us);
+
+// 气压传感器卡死: on 时通道 channel 持续报告 pa (帧正常到达)
+void sim_hal_press_stuck(int channel, bool on, uint32_t pa);
+
+// 阀门占空比在 PWM 周期起点锁存 (默认，与 LEDC 相同)；off 时提交立即作用于被控对象 (理想执行器)
+// 切换时清零提交统计 (valves_get_stats)
+void sim_hal_valve_latch(bool on);
+
+// 全部阀门命令 (通道, 占空比) 序列的 FNV-1a 散列
+uint32_t sim_hal_duty_hash(void);
+
+int64_t sim_hal_now_us(void);
+
+// 被控对象的真实角度 (计数，相对 as5600_set_zero 的零点，未量化)，供指标统计；
+// 不读传感器，不推进角度滤波器
+float sim_hal_angle(void);
+
+pam_model_state_t *sim_hal_state(void);
+pam_model_params_t *sim_hal_params(void);
+
+#endif // SIM_HAL_H
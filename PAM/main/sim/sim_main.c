@@ -0,0 +1,1150 @@
+//软件在环仿真入口 (IDF linux 目标)
+//与 main.c 相同的初始化顺序，但不启动 RTOS 任务：按仿真时钟逐节拍驱动被控对象和
+//arm_control 的调度器，运行速度只受 CPU 限制，远快于实时。每个动作结束后输出
+//上升时间、超调、调节时间与耗气量；动作序列分别在“只用进气阀”和“进排气双向”两种
+//阀门分配下运行，第 1 个动作 (正向 -> 反向) 的上升时间即换向时间；双向分配下再以最小
+//加加速度和梯形速度轨迹运行同一序列，与阶跃比较跟踪误差和峰值压力差需求。
+//以上均不带模型前馈；之后在开启前馈 (模型准确 / 被控对象负载与阻尼偏大 30%) 时重复
+//阶跃与最小加加速度序列，比较调节时间。最后运行继电反馈自整定 (先检查压力硬限触发时
+//中止并恢复原增益)，输出各回路的 Ku/Tu 与增益，并以整定后的增益重复最小加加速度序列，
+//再把角度环降到 50 Hz 重复一次 (PID 按实际采样间隔计算，增益含义不随周期变化)。
+//之后比较压力环使用原始读数与压力观测器 (正常采样 / 气压传感器周期性中断) 时的跟踪误差，
+//并注入传感器卡死与长时间中断，检查安全模式的进入、锁存与解除，不符合预期时以非零状态退出。
+//阀门占空比与 LEDC 相同在 PWM 周期起点锁存；分别以未同步 (周期起点与节拍重合 / 任意相位)、
+//与节拍同步 (50/100/500 Hz) 和理想执行器运行同一序列，输出 提交 -> 输出 延迟。
+//开始前先对四个阀门做一次标定，输出标定前后的线性度误差。
+//气泵由带触点抖动的仿真压力开关驱动，结束时输出气泵统计，并用脚本化开关序列检查
+//最短开/关时间。最后把定点 (Q16.16) 卡尔曼滤波与 PID 在同一组带噪声和采样抖动的输入下
+//与浮点实现对比；气泵、自整定或定点检查失败时以非零状态退出。
+//以 -DPAM_FIXED_POINT=1 编译时控制回路本身使用定点路径，可与浮点版本的动作指标直接对比。
+//整次运行的传感器原始事件记录到 pam_trace.bin，末尾附加全部阀门命令的散列；设置环境变量
+//PAM_TRACE_REPLAY 后以该轨迹代替被控对象的传感器输出重跑同一流程，阀门命令散列必须与记录一致
+//(逐位可复现)，否则以非零状态退出。
+//最后以 1/4/8 个独立的被控对象运行多关节运行时 (joint_rt)，输出每节拍的主机耗时与各关节的
+//角度/气压采样龄 (全部气压通道共用一条 UART 轮询)，任一关节最终误差超限时以非零状态退出。
+//任务空间控制: 逆运动学查找表与闭式解对比精度并计时，再以肩/肘两个被控对象走两段末端直线，
+//查表误差、不可达钳位或末端最终误差超限时以非零状态退出。
+//最后运行模块级检查 (sim_checks): 气压采集状态机接模拟串口的每通道采样率与采样龄，
+//帧解析器的差分模糊测试与吞吐，SPSC 队列的双线程压力测试。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "esp_log.h"
+
+#include "hardware_config.h"
+#include "hal_pump.h"
+#include "hal_valves.h"
+#include "as5600.h"
+#include "press.h"
+#include "arm_control.h"
+#include "sim_hal.h"
+#include "sim_metrics.h"
+#include "sim_checks.h"
+#include "loop_prof.h"
+#include "telemetry.h"
+#include "param_store.h"
+#include "valve_cal.h"
+#include "traj.h"
+#include "autotune.h"
+#include "kalman.h"
+#include "kalman_q.h"
+#include "pid.h"
+#include "pid_q.h"
+#include "sensor_trace.h"
+#include "joint_rt.h"
+#include "cart_ctrl.h"
+#include "ik_table.h"
+#include "pam_model.h"
+#include "as5600_track.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+static const char *TAG = "SIM";
+
+#define TELEM_FLUSH_TICKS   10      // 遥测写出周期 (与目标上发送任务的 10ms 一致)
+#define SETTLE_BAND         5.0f    // 调节带 (计数, ≈0.44°)
+#define COUNTS_TO_DEG       (360.0f / 4096.0f)
+#define RHO_ANR             1.185   // 标准状态空气密度 kg/m³
+
+// 动作序列: 目标角度 (计数，与 arm_set_target_angle 同单位)、轨迹时长与保持时间 (含运动)
+typedef struct {
+    float target;
+    float move_s;
+    float hold_s;
+} sim_move_t;
+
+static const sim_move_t moves[] = {
+    {  200.0f, 0.6f, 3.0f },
+    { -200.0f, 0.8f, 3.0f },
+    {    0.0f, 0.6f, 3.0f },
+    {  400.0f, 1.0f, 3.0f },
+};
+
+static uint32_t tick;
+
+// 插桩使用仿真时钟 (1 计数 = 1 us)
+static uint32_t sim_clock(void) {
+    return (uint32_t)sim_hal_now_us();
+}
+
+// 一个基础节拍: 推进被控对象，运行到期的控制回路
+static void sim_step(void) {
+    sim_hal_advance(CTRL_BASE_TICK_US);
+    tick++;
+    arm_control_step(tick);
+    arm_control_ff_service();
+    loop_prof_poll();
+#if PAM_TELEMETRY_ENABLE
+    if (tick % TELEM_FLUSH_TICKS == 0) telemetry_flush();
+#endif
+}
+
+// 运行 duration_s 秒仿真，可选记录阶跃指标
+static void sim_run(float duration_s, sim_metrics_t *m) {
+    uint32_t n = (uint32_t)(duration_s * 1e6f / CTRL_BASE_TICK_US);
+    for (uint32_t i = 0; i < n; i++) {
+        sim_step();
+
+        if (m) {
+            arm_ctrl_state_t cs;
+            float y = sim_hal_angle();
+            arm_control_get_state(&cs);
+            sim_metrics_update(m, (float)(sim_hal_now_us() * 1e-6), y);
+            sim_metrics_track(m, cs.ref_pos, y, cs.delta_pressure);
+        }
+    }
+}
+
+// 标定期间控制回路不运行，只推进被控对象 (气泵逻辑由开关事件驱动)
+static void sim_wait_ms(uint32_t ms) {
+    for (uint32_t i = 0; i < ms * 1000 / CTRL_BASE_TICK_US; i++) {
+        sim_hal_advance(CTRL_BASE_TICK_US);
+    }
+}
+
+// 阀门标定，并比较标定前后的线性度误差
+static void sim_valve_cal(void) {
+    static const char *names[VALVE_NUM] = { "A_IN", "A_OUT", "B_IN", "B_OUT" };
+
+    int64_t t0 = sim_hal_now_us();
+    int ok = valve_cal_run(sim_wait_ms);
+    ESP_LOGI(TAG, "Valve calibration: %d/%d valves, %.1f s sim time", ok, VALVE_NUM,
+             (sim_hal_now_us() - t0) * 1e-6);
+
+    printf("valve,onset_duty,lin_err_raw,lin_err_cal\n");
+    for (int v = 0; v < VALVE_NUM; v++) {
+        float raw = valve_cal_linearity(v, false, sim_wait_ms);
+        float cal = valve_cal_linearity(v, true, sim_wait_ms);
+        printf("%s,%u,%.3f,%.3f\n", names[v], valve_cal_table(v)->duty[0], raw, cal);
+    }
+}
+
+// 用脚本化的开关序列单独检查 pump_ctrl: 低压持续时间短于最短开机时间、
+// 开机后立即回到高压，继电器都必须保持到最短开/关时间到期；
+// 推迟期间开关回到原状态后再次推迟，应重新计一次 held
+static bool sim_pump_check(void) {
+    // 开关状态 (true = 低压) 与持续时间 ms
+    static const struct { bool low; uint32_t ms; } script[] = {
+        { true, 50 }, { false, 300 }, { true, 100 }, { false, 300 }, { true, 5000 }, { false, 100 }, { true, 100 }, { false, 8000 },
+        { true, 3000 }, { false, 3000 },
+    };
+    pump_ctrl_t pc;
+    int64_t t = 0, next_us, last_change = -1;
+    bool on = false, ok = true;
+    uint32_t min_on = UINT32_MAX, min_off = UINT32_MAX;
+
+    pump_ctrl_init(&pc, PUMP_MIN_ON_MS, PUMP_MIN_OFF_MS, 4.0f, t);
+    for (size_t i = 0; i < sizeof(script) / sizeof(script[0]); i++) {
+        for (uint32_t ms = 0; ms < script[i].ms; ms++, t += 1000) {
+            bool now_on = pump_ctrl_update(&pc, script[i].low, t, &next_us);
+            if (now_on == on) continue;
+            uint32_t held_ms = (uint32_t)((t - last_change) / 1000);
+            if (last_change >= 0) {
+                if (on && held_ms < min_on) min_on = held_ms;
+                if (!on && held_ms < min_off) min_off = held_ms;
+            }
+            on = now_on;
+            last_change = t;
+        }
+    }
+    ok = min_on >= PUMP_MIN_ON_MS && min_off >= PUMP_MIN_OFF_MS && !on && pc.st.cycles == 2 && pc.st.held == 3;
+    ESP_LOGI(TAG, "Pump check %s: %lu cycles, %lu held, min on %lu ms, min off %lu ms",
+             ok ? "OK" : "FAILED", (unsigned long)pc.st.cycles, (unsigned long)pc.st.held,
+             (unsigned long)min_on, (unsigned long)min_off);
+    return ok;
+}
+
+// 气泵管理器统计，并与被控对象的真实值对照
+static void sim_pump_report(void) {
+    pump_status_t ps;
+    pump_get_status(&ps);
+    pam_model_state_t *st = sim_hal_state();
+    double used_nl = st->air_used_kg / RHO_ANR * 1000.0;
+
+    ESP_LOGI(TAG, "Pump: %lu cycles, %lu switch edges, %lu held by min on/off, duty %.1f%%",
+             (unsigned long)ps.cycles, (unsigned long)ps.edges, (unsigned long)ps.held,
+             ps.elapsed_us ? (double)ps.on_us / ps.elapsed_us * 100.0 : 0.0);
+    ESP_LOGI(TAG, "Pump: last refill %.1f s, last drain %.1f s, supply margin %.2f",
+             ps.last_refill_ms * 1e-3, ps.last_drain_ms * 1e-3, pump_supply_margin());
+    ESP_LOGI(TAG, "Pump: demand inlet %.1f nl/min, bidir %.1f nl/min (plant mean %.1f nl/min)",
+             ps.demand_nl_min[0], ps.demand_nl_min[1], used_nl / (st->time_s / 60.0));
+}
+
+// 运行一次自整定直到结束 (最长 60 s)
+static void sim_autotune(const autotune_cfg_t *cfg, autotune_status_t *st) {
+    if (autotune_start(cfg) != ESP_OK) {
+        st->phase = AUTOTUNE_FAILED;
+        st->error = "start rejected";
+        return;
+    }
+    for (int i = 0; i < 600 && autotune_running(); i++) sim_run(0.1f, NULL);
+    if (autotune_running()) {
+        autotune_abort();
+        sim_run(0.1f, NULL);
+    }
+    autotune_get_status(st);
+}
+
+// 自整定端到端检查: 压力硬限低于继电振荡幅度时必须中止并恢复原增益；
+// 正常限值下三个回路都应整定成功，输出每个回路的 Ku/Tu 与增益
+static bool sim_autotune_check(void) {
+    static const char *names[AUTOTUNE_LOOP_NUM] = { "press_a", "press_b", "angle" };
+    autotune_cfg_t cfg = AUTOTUNE_CFG_DEFAULT;
+    autotune_status_t st;
+    float kp0, kp1;
+
+    cfg.save = false;                       // 仿真不写 NVS
+    cfg.press_max_kpa = BASE_PRESSURE + AUTOTUNE_PRESS_HYST_KPA;
+    param_get("press_a.kp", &kp0);
+    sim_autotune(&cfg, &st);
+    param_get("press_a.kp", &kp1);
+    bool limit_ok = st.phase == AUTOTUNE_FAILED && kp1 == kp0;
+    ESP_LOGI(TAG, "Autotune limit check %s: %s", limit_ok ? "OK" : "FAILED", st.error ? st.error : "-");
+
+    sim_run(2.0f, NULL);
+    cfg.press_max_kpa = AUTOTUNE_PRESS_MAX_KPA;
+    int64_t t0 = sim_hal_now_us();
+    sim_autotune(&cfg, &st);
+    bool tune_ok = st.phase == AUTOTUNE_DONE;
+    ESP_LOGI(TAG, "Autotune %s in %.1f s%s%s", tune_ok ? "done" : "FAILED", (sim_hal_now_us() - t0) * 1e-6,
+             st.error ? ": " : "", st.error ? st.error : "");
+
+    printf("loop,ku,tu_s,amp,kp,ki,kd\n");
+    for (int i = 0; i < AUTOTUNE_LOOP_NUM; i++) {
+        const autotune_loop_t *l = &st.loop[i];
+        if (l->valid) printf("%s,%.4g,%.4f,%.2f,%.4g,%.4g,%.4g\n", names[i], l->ku, l->tu, l->amp, l->kp, l->ki, l->kd);
+    }
+    return limit_ok && tune_ok;
+}
+
+// 定点检查用的确定性伪随机数 (LCG)，返回 [-1, 1)
+static uint32_t fixq_rng = 12345;
+static float fixq_noise(void) {
+    fixq_rng = fixq_rng * 1664525u + 1013904223u;
+    return (float)(int32_t)fixq_rng * (1.0f / 2147483648.0f);
+}
+
+// 以同一组带抖动的采样驱动浮点与定点滤波器，返回位置/速度的最大偏差
+static void fixq_check_kf(float *dx, float *dv) {
+    kf_cv_t kf;
+    kf_cv_q_t kq;
+    int64_t t_us = 0;
+
+    *dx = *dv = 0.0f;
+    for (int i = 0; i < 2500; i++) {
+        float t = (float)t_us * 1e-6f;
+        int32_t z = (int32_t)lroundf(300.0f * sinf(9.42f * t) + 80.0f * t + fixq_noise());
+        if (i == 0) {
+            kf_cv_init(&kf, (float)z, 1.0e6f, 1.0f);
+            kf_cv_q_init(&kq, q16_from_int(z), 1.0e6f, 1.0f);
+        } else {
+            int32_t dt_us = 2000 + (int32_t)(200.0f * fixq_noise());   // 2 ms ± 10%
+            t_us += dt_us;
+            kf_cv_update(&kf, (float)z, (float)dt_us * 1e-6f);
+            kf_cv_q_update(&kq, q16_from_int(z), dt_us);
+        }
+        *dx = fmaxf(*dx, fabsf(kf.x - q16_to_float(kq.x)));
+        *dv = fmaxf(*dv, fabsf(kf.v - q16_to_float(kf_cv_q_velocity(&kq))));
+        if (i == 0) t_us += 2000;
+    }
+}
+
+/**
+ * @brief 浮点与定点 PID 各自闭环控制一个相同的被控对象，返回输出与被控量的最大偏差
+ * * 压力环: 一阶对象 (时间常数 50 ms)，测量按 Pa 量化；角度环: 带阻尼的二阶对象，
+ * * 速度测量带噪声，开启微分滤波与设定值权重。设定值阶跃使两者都进入饱和与抗饱和。
+ * * 角度设定值取半计数: 误差恰为 0 时比例项按死区规则跳变 (beta < 1)，量化差一个计数即放大为跳变
+ */
+static void fixq_check_pid(bool angle, float *du, float *dy) {
+    pid_timed_t pf;
+    pid_q_t pq;
+    float y[2] = { 0.0f, 0.0f }, v[2] = { 0.0f, 0.0f };
+    float period = angle ? 0.01f : 0.002f;
+
+    if (angle) {
+        pid_timed_init(&pf, 0.19f, 2.4f, 0.0098f, -100.0f, 100.0f);
+        pf.beta = 0.7f;
+        pf.d_tau = 0.02f;
+    } else {
+        pid_timed_init(&pf, 170.0f, 1210.0f, 0.0f, -8191.0f, 8191.0f);
+        y[0] = y[1] = 200.0f;
+    }
+    pf.kb = pf.ki / pf.kp;
+    pid_q_config(&pq, &pf);
+    pid_q_reset(&pq);
+
+    *du = *dy = 0.0f;
+    for (int i = 0; i < 3000; i++) {
+        float t = i * period;
+        float sp = angle ? (t < 10.0f ? 400.5f : -300.5f) : (t < 2.0f ? 260.0f : 120.0f);
+        float dt = period * (1.0f + 0.1f * fixq_noise());
+        float noise = fixq_noise();
+        float u[2];
+
+        pf.setpoint = sp;
+        pq.setpoint = q16_from_float(sp);
+        if (angle) {
+            float z0 = roundf(y[0]), z1 = roundf(y[1]);
+            u[0] = pid_timed_compute_rate(&pf, z0, v[0] + 20.0f * noise, dt);
+            u[1] = q16_to_float(pid_q_compute_rate(&pq, q16_from_int((int32_t)z1),
+                                                   q16_from_float(v[1] + 20.0f * noise), q16_from_float(dt)));
+        } else {
+            int32_t pa0 = (int32_t)lroundf(y[0] * 1000.0f), pa1 = (int32_t)lroundf(y[1] * 1000.0f);
+            u[0] = pid_timed_compute(&pf, (float)pa0 * 1e-3f, dt);
+            u[1] = q16_to_float(pid_q_compute(&pq, q16_ratio(pa1, 1000), q16_from_float(dt)));
+        }
+        for (int k = 0; k < 2; k++) {
+            if (angle) {
+                v[k] += (20.0f * u[k] - 10.0f * v[k]) * dt;
+                y[k] += v[k] * dt;
+            } else {
+                y[k] += (0.05f * u[k] + 200.0f - y[k]) / 0.05f * dt;
+            }
+        }
+        *du = fmaxf(*du, fabsf(u[0] - u[1]));
+        *dy = fmaxf(*dy, fabsf(y[0] - y[1]));
+    }
+}
+
+/**
+ * @brief 定点控制路径与浮点参考对比: 卡尔曼滤波与两个回路的 PID，偏差超出界限时失败
+ * * 界限: 滤波位置 0.05 计数、速度为信号峰值速度的 0.1%；压力环输出为满量程的 0.2%；
+ * * 角度环输出允许一次测量量化差一个计数 (kp·1 加余量)，被控量不超过一个计数
+ */
+static bool sim_fixq_check(void) {
+    static const char *names[] = { "kf_pos_counts", "kf_vel_counts_s", "press_pid_duty", "press_kpa",
+                                   "angle_pid_kpa", "angle_counts" };
+    static const float bound[] = { 0.05f, 3.0f, 16.0f, 0.05f, 0.5f, 1.0f };
+    float err[6];
+    bool ok = true;
+
+    fixq_check_kf(&err[0], &err[1]);
+    fixq_check_pid(false, &err[2], &err[3]);
+    fixq_check_pid(true, &err[4], &err[5]);
+
+    printf("fixq,max_err,bound\n");
+    for (int i = 0; i < 6; i++) {
+        printf("%s,%.4f,%.2f\n", names[i], err[i], bound[i]);
+        ok &= err[i] < bound[i];
+    }
+    ESP_LOGI(TAG, "Fixed-point check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// 依次执行动作序列，每个动作输出一行 CSV (profile 为 TRAJ_STEP 时按阶跃下发)
+static void run_moves(const char *mode, int profile) {
+    float y = sim_hal_angle();
+    for (size_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        sim_metrics_t m;
+        sim_result_t r;
+        pam_model_state_t *st = sim_hal_state();
+
+        sim_metrics_begin(&m, (float)(sim_hal_now_us() * 1e-6), y, moves[i].target, SETTLE_BAND, st->air_used_kg);
+        arm_move_to(moves[i].target, moves[i].move_s, profile);
+        sim_run(moves[i].hold_s, &m);
+
+        y = sim_hal_angle();
+        sim_metrics_finish(&m, y, st->air_used_kg, &r);
+        printf("%s,%u,%.1f,%.3f,%.1f,%.3f,%.2f,%.3f,%.2f,%.2f,%.1f\n", mode, (unsigned)i,
+               moves[i].target * COUNTS_TO_DEG, r.rise_s, r.overshoot_pct, r.settling_s,
+               r.final_error * COUNTS_TO_DEG, r.air_nl, r.track_rms * COUNTS_TO_DEG,
+               r.track_max * COUNTS_TO_DEG, r.peak_dp_kpa);
+    }
+}
+
+// ---------------- 压力观测器与传感器故障 ----------------
+
+#define OBS_DROP_PERIOD_US  400000  // 周期性中断: 每 400 ms 中断 100 ms (两通道错开)
+#define OBS_DROP_LEN_US     100000
+#define OBS_LONG_DROP_US    600000  // 长时间中断 (超过 PRESS_OBS_COAST_MS)
+#define OBS_RECOVER_ERR_DEG 2.0f    // 故障解除后的最终误差上限
+
+static uint32_t obs_safe_entries(void) {
+    arm_press_health_t h;
+    arm_control_get_press_health(&h);
+    return h.safe_entries;
+}
+
+// 回到零位并运行 s 秒，返回最终误差 (度)
+static float obs_settle(float s) {
+    arm_set_target_angle(0.0f);
+    sim_run(s, NULL);
+    return fabsf(sim_hal_angle()) * COUNTS_TO_DEG;
+}
+
+// 一种故障情形的结果: 期间进入安全模式的次数、结束时是否仍在安全模式、恢复后的最终误差
+static bool obs_case(const char *name, uint32_t entries0, bool expect_safe, float err_deg) {
+    arm_press_health_t h;
+    arm_control_get_press_health(&h);
+    uint32_t entries = h.safe_entries - entries0;
+    bool ok = (expect_safe ? entries > 0 : entries == 0) && !h.safe_mode && err_deg < OBS_RECOVER_ERR_DEG;
+    printf("%s,%lu,%d,%.2f,%.1f,%.1f\n", name, (unsigned long)entries, h.safe_mode, err_deg,
+           h.resid_avg[0], h.resid_avg[1]);
+    return ok;
+}
+
+/**
+ * @brief 观测器检查: 无故障与周期性中断下以原始读数/观测器分别运行最小加加速度序列；
+ * 周期性中断与被控对象偏离观测器模型时不应进入安全模式，传感器卡死与长时间中断必须进入
+ * 安全模式并在恢复后解除
+ */
+static bool sim_press_obs_check(void) {
+    bool ok = true;
+
+    param_set("press_obs", 0.0f);
+    obs_settle(3.0f);
+    run_moves("raw_minjerk", TRAJ_MIN_JERK);
+    param_set("press_obs", 1.0f);
+    obs_settle(3.0f);
+    run_moves("obs_minjerk", TRAJ_MIN_JERK);
+
+    // 周期性中断: 原始读数在中断期间保持最后一帧，观测器外推
+    param_set("press_obs", 0.0f);
+    obs_settle(3.0f);
+    sim_hal_press_dropout(OBS_DROP_PERIOD_US, OBS_DROP_LEN_US);
+    run_moves("raw_dropout", TRAJ_MIN_JERK);
+    sim_hal_press_dropout(0, 0);
+    param_set("press_obs", 1.0f);
+    obs_settle(3.0f);
+    uint32_t e0 = obs_safe_entries();
+    sim_hal_press_dropout(OBS_DROP_PERIOD_US, OBS_DROP_LEN_US);
+    run_moves("obs_dropout", TRAJ_MIN_JERK);
+    sim_hal_press_dropout(0, 0);
+
+    printf("fault,safe_entries,safe_at_end,final_err_deg,resid_a_kpa,resid_b_kpa\n");
+    ok &= obs_case("dropout", e0, false, obs_settle(3.0f));
+
+    // 传感器卡死: 运动中肌肉 A 的读数固定为 0 (帧照常到达)，残差超限后锁存；
+    // 恢复读数后仍保持安全模式，解除后回到零位
+    e0 = obs_safe_entries();
+    arm_move_to(moves[0].target, moves[0].move_s, TRAJ_MIN_JERK);
+    sim_run(0.3f, NULL);
+    sim_hal_press_stuck(0, true, 0);
+    sim_run(2.0f, NULL);
+    sim_hal_press_stuck(0, false, 0);
+    sim_run(0.5f, NULL);
+    arm_press_health_t h;
+    arm_control_get_press_health(&h);
+    bool latched = h.safe_mode;             // 传感器恢复后仍保持安全模式，直到解除
+    arm_control_clear_fault();
+    ok &= obs_case("stuck", e0, true, obs_settle(4.0f)) && latched;
+
+    // 长时间中断: 外推超过 PRESS_OBS_COAST_MS 判为故障
+    e0 = obs_safe_entries();
+    arm_move_to(moves[0].target, moves[0].move_s, TRAJ_MIN_JERK);
+    sim_hal_press_dropout(10 * OBS_LONG_DROP_US, OBS_LONG_DROP_US);
+    sim_run(1.0f, NULL);
+    sim_hal_press_dropout(0, 0);
+    ok &= obs_case("long_dropout", e0, true, obs_settle(4.0f));
+
+    // 模型失配: 被控对象的阀门流导 -30%、死体积 +50%、负载与阻尼 +30%，观测器仍用默认参数；
+    // 整个最小加加速度序列中不应误报故障
+    pam_model_params_t *pp = sim_hal_params();
+    pam_model_params_t nominal = *pp;
+    pp->valve_c *= 0.7f;
+    pp->dead_volume *= 1.5f;
+    pp->load_torque *= 1.3f;
+    pp->damping *= 1.3f;
+    obs_settle(3.0f);
+    e0 = obs_safe_entries();
+    for (size_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++) {
+        arm_move_to(moves[i].target, moves[i].move_s, TRAJ_MIN_JERK);
+        sim_run(moves[i].hold_s, NULL);
+    }
+    ok &= obs_case("model_mismatch", e0, false, obs_settle(3.0f));
+    *pp = nominal;
+
+    ESP_LOGI(TAG, "Pressure observer check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ---------------- 阀门 PWM 时序 ----------------
+
+// PWM 配置: 频率、周期起点相对压力环节拍的偏移、是否在周期起点锁存 (否: 理想执行器)
+typedef struct {
+    const char *name;
+    uint32_t    freq_hz;
+    uint32_t    offset_us;
+    bool        latch;
+} pwm_case_t;
+
+static const pwm_case_t pwm_cases[] = {
+    { "pwm_tick",     VALVE_PWM_FREQ_HZ, 0,                 true  },    // 未同步，最坏: 周期起点与节拍重合
+    { "pwm_free",     VALVE_PWM_FREQ_HZ, 1100,              true  },    // 未同步，任意相位
+    { "pwm_sync",     VALVE_PWM_FREQ_HZ, VALVE_PWM_LEAD_US, true  },
+    { "pwm_guard",    VALVE_PWM_FREQ_HZ, VALVE_COMMIT_GUARD_US / 2, true },  // 提交落在保护时间内: 推迟
+    { "pwm_sync_100", 100,               VALVE_PWM_LEAD_US, true  },
+    { "pwm_sync_500", 500,               VALVE_PWM_LEAD_US, true  },
+    { "ideal",        VALVE_PWM_FREQ_HZ, VALVE_PWM_LEAD_US, false },
+};
+
+static void pwm_apply(const pwm_case_t *c) {
+    valve_group_cfg_t cfg = { .freq_hz = c->freq_hz, .res_bits = 13 };
+    valves_config_group(0, &cfg);
+    valves_pwm_sync(sim_hal_now_us() + c->offset_us);     // 当前时刻为压力环节拍
+    sim_hal_valve_latch(c->latch);
+}
+
+/**
+ * @brief 阀门 PWM 时序: 各配置下运行最小加加速度序列，输出 命令 -> 输出 滞后 (跟踪误差受气源状态
+ * 影响，不在此比较)
+ * * 输出滞后: 全部提交到下一个周期起点的时间 (平均/最大)，被覆盖的提交占比；生效提交的延迟
+ * * (同步后按构造不超过 VALVE_PWM_LEAD_US) 只作对齐参考
+ * * 同步后须没有推迟的提交、每个周期起点都有新命令生效 (没有整周期沿用旧占空比)，
+ * * 且平均滞后不超过半个周期加 VALVE_PWM_LEAD_US，否则以非零状态退出
+ */
+static bool sim_valve_pwm_check(void) {
+    static const char *hdr = "pwm,freq_hz,offset_us,commits,applied,overwritten_pct,late,applied_lat_mean_us,"
+                             "applied_lat_max_us,output_lag_mean_us,output_lag_max_us\n";
+    char rows[sizeof(pwm_cases) / sizeof(pwm_cases[0])][128];
+    bool ok = true;
+
+    for (size_t i = 0; i < sizeof(pwm_cases) / sizeof(pwm_cases[0]); i++) {
+        const pwm_case_t *c = &pwm_cases[i];
+        obs_settle(2.0f);
+        pwm_apply(c);
+        int64_t t0 = sim_hal_now_us();
+        for (size_t k = 0; k < sizeof(moves) / sizeof(moves[0]); k++) {
+            arm_move_to(moves[k].target, moves[k].move_s, TRAJ_MIN_JERK);
+            sim_run(moves[k].hold_s, NULL);
+        }
+
+        valve_pwm_stats_t vs;
+        valves_get_stats(0, &vs);
+        uint32_t period_us = 1000000u / c->freq_hz;
+        uint32_t edges = (uint32_t)((sim_hal_now_us() - t0) / period_us);
+        uint32_t lat_mean = vs.applied ? (uint32_t)(vs.lat_sum_us / vs.applied) : 0;
+        uint32_t lag = vs.commits ? (uint32_t)(vs.wait_sum_us / vs.commits) : 0;
+        double overwritten = vs.commits ? 100.0 * (vs.commits - vs.applied) / vs.commits : 0.0;
+        if (!c->latch) {
+            lat_mean = lag = vs.lat_max_us = vs.wait_max_us = 0;
+            overwritten = 0.0;
+        }
+        snprintf(rows[i], sizeof(rows[i]), "%s,%lu,%lu,%lu,%lu,%.1f,%lu,%lu,%lu,%lu,%lu\n", c->name,
+                 (unsigned long)c->freq_hz, (unsigned long)c->offset_us, (unsigned long)vs.commits,
+                 (unsigned long)vs.applied, overwritten, (unsigned long)vs.late, (unsigned long)lat_mean,
+                 (unsigned long)vs.lat_max_us, (unsigned long)lag, (unsigned long)vs.wait_max_us);
+        if (c->latch && c->offset_us == VALVE_PWM_LEAD_US) {
+            ok &= vs.late == 0 && vs.applied + 1 >= edges && lag <= period_us / 2 + VALVE_PWM_LEAD_US;
+        } else if (c->offset_us > 0 && c->offset_us < VALVE_COMMIT_GUARD_US) {
+            ok &= vs.late > 0;              // 周期起点前保护时间内的提交被推迟 (随后被下一次提交覆盖)
+        }
+    }
+    printf("%s", hdr);
+    for (size_t i = 0; i < sizeof(pwm_cases) / sizeof(pwm_cases[0]); i++) printf("%s", rows[i]);
+
+    // 恢复默认配置 (同步后的默认频率)
+    obs_settle(2.0f);
+    pwm_apply(&pwm_cases[2]);       // pwm_sync
+    ESP_LOGI(TAG, "Valve PWM check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ---------------- 参数并发改写 ----------------
+
+#define HAMMER_RUN_S        2.0f    // 控制回路运行时间 (仿真)
+#define HAMMER_SETS_PER_TICK 8      // 每个节拍内改写的次数 (每次两个参数)
+#define HAMMER_MOD          1000
+
+// 写端按 traj_kv、traj_ka 的次序写入同一序号 k，任何完整快照中 kv 的序号等于 ka 或比它大 1
+static float hammer_kv(uint32_t k) { return (float)(k % HAMMER_MOD) * 1e-6f; }
+static float hammer_ka(uint32_t k) { return (float)(k % HAMMER_MOD) * 1e-7f; }
+
+typedef struct {
+    atomic_bool stop;
+    uint32_t reads;
+    uint32_t versions;          ///< 读到的不同版本数
+    uint32_t torn;              ///< kv/ka 序号不符合写入次序的快照
+    uint32_t unstable;          ///< 同一版本号对应不同内容
+    uint32_t backwards;         ///< 版本号倒退
+} hammer_t;
+
+// 读线程: 与控制回路相同的读法 (先比较版本号，有新版本时取整份快照)，只用无锁的读端
+static void *hammer_reader(void *arg) {
+    hammer_t *h = arg;
+    pam_params_t p;
+    uint32_t last_ver = param_store_get(&p);
+    float last_kv = p.traj_kv, last_ka = p.traj_ka;
+    while (!atomic_load(&h->stop)) {
+        uint32_t v = param_store_version();
+        if (v == last_ver) {
+            sched_yield();
+            continue;
+        }
+        uint32_t ver = param_store_get(&p);
+        h->reads++;
+        if (ver < last_ver) h->backwards++;
+        if (ver == last_ver && (p.traj_kv != last_kv || p.traj_ka != last_ka)) h->unstable++;
+        if (ver != last_ver) h->versions++;
+        int ia = (int)lroundf(p.traj_kv * 1e6f);
+        int ib = (int)lroundf(p.traj_ka * 1e7f);
+        int d = ((ia - ib) % HAMMER_MOD + HAMMER_MOD) % HAMMER_MOD;
+        if (d > 1) h->torn++;
+        last_ver = ver;
+        last_kv = p.traj_kv;
+        last_ka = p.traj_ka;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 控制回路运行中并发改写参数
+ * * 控制回路在主线程按节拍运行，每个节拍内连续改写两个前馈参数；另一个线程以控制回路相同的方式
+ * * 不停读取参数快照。快照中两个参数的写入序号必须符合写入次序 (无撕裂)，版本号不倒退，
+ * * 同一版本号对应同一内容，每次写入都发布了新版本且最终值为最后一次写入。结束后恢复默认值
+ */
+static bool sim_param_hammer_check(void) {
+    static hammer_t h;
+    memset(&h, 0, sizeof(h));
+    atomic_init(&h.stop, false);
+    arm_set_target_angle(0.0f);
+
+    uint32_t ver0 = param_store_version();
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, hammer_reader, &h) != 0) return false;
+
+    uint32_t k = 0;
+    uint32_t ticks = (uint32_t)(HAMMER_RUN_S * 1e6f / CTRL_BASE_TICK_US);
+    for (uint32_t i = 0; i < ticks; i++) {
+        for (int j = 0; j < HAMMER_SETS_PER_TICK; j++) {
+            k++;
+            param_set("traj_kv", hammer_kv(k));
+            param_set("traj_ka", hammer_ka(k));
+        }
+        sim_step();
+        sched_yield();          // 单核主机上让读线程在节拍之间也能运行
+    }
+    uint32_t ver = param_store_version();
+    atomic_store(&h.stop, true);
+    pthread_join(reader, NULL);
+
+    float kv = 0.0f, ka = 0.0f;
+    param_get("traj_kv", &kv);
+    param_get("traj_ka", &ka);
+    bool ok = h.torn == 0 && h.unstable == 0 && h.backwards == 0 && h.reads > 0 &&
+              ver == ver0 + 2 * k && kv == hammer_kv(k) && ka == hammer_ka(k);
+    printf("param_hammer_writes,reader_reads,reader_versions,torn,unstable,backwards\n");
+    printf("%lu,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)(2 * k), (unsigned long)h.reads,
+           (unsigned long)h.versions, (unsigned long)h.torn, (unsigned long)h.unstable, (unsigned long)h.backwards);
+
+    param_set("traj_kv", TRAJ_FF_KV);
+    param_set("traj_ka", TRAJ_FF_KA);
+    ESP_LOGI(TAG, "Parameter hammer check %s", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// 记录: 在轨迹末尾写入阀门命令散列并转存；回放: 与轨迹中的散列比较
+static bool sim_trace_finish(bool replay) {
+#if PAM_TRACE_ENABLE
+    uint32_t hash = sim_hal_duty_hash();
+    if (!replay) {
+        trace_stats_t ts;
+        trace_mark(0, hash, sim_hal_now_us());
+        trace_get_stats(&ts);
+        bool ok = trace_flush() == ESP_OK && ts.overwritten == 0;
+        ESP_LOGI(TAG, "Trace: %lu events, %lu bytes (%.2f B/event), duty hash %08lx%s",
+                 (unsigned long)ts.events, (unsigned long)ts.bytes, ts.events ? (double)ts.bytes / ts.events : 0.0,
+                 (unsigned long)hash, ok ? "" : " (buffer overflow)");
+        return ok;
+    }
+
+    uint32_t recorded = 0;
+    sim_hal_replay_finish();
+    bool ok = sim_hal_replay_mark(&recorded) && recorded == hash && sim_hal_replay_misses() == 0;
+    ESP_LOGI(TAG, "Replay check %s: duty hash %08lx, recorded %08lx, %lu missed reads", ok ? "OK" : "FAILED",
+             (unsigned long)hash, (unsigned long)recorded, (unsigned long)sim_hal_replay_misses());
+    return ok;
+#else
+    (void)replay;
+    return true;
+#endif
+}
+
+// ---------------- 多关节运行时基准 ----------------
+
+#define BENCH_RUN_S         4.0f    // 每种关节数的运行时间 (含 1.5 s 最小加加速度运动，整数个统计窗口)
+#define BENCH_ERR_DEG       5.0f    // 最终误差上限 (默认增益、无前馈，与单关节 bidir_minjerk 同量级)
+
+// 每个关节一个独立的被控对象 (各自的储气罐与气泵)
+typedef struct {
+    pam_model_params_t params;
+    pam_model_state_t  plant[JOINT_MAX];
+    as5600_track_t     track[JOINT_MAX];
+    press_sample_t     press[2 * JOINT_MAX];
+    int64_t            now_us;
+    int64_t            next_press_us;
+    int                next_press_ch;
+    int                n;
+} bench_t;
+
+static bench_t bench;
+
+static bool bench_read_angle(void *ctx, int ch, joint_angle_t *out) {
+    bench_t *b = ctx;
+    int32_t counts = (int32_t)lroundf(b->plant[ch].theta * (4096.0f / 6.28318531f));
+    as5600_track_update(&b->track[ch], (uint16_t)(counts & 0x0FFF), b->now_us);
+    out->angle = (float)as5600_track_rel(&b->track[ch], 0);
+    out->vel = as5600_track_vel(&b->track[ch]);
+    out->t_us = b->now_us;
+    return true;
+}
+
+static bool bench_read_press(void *ctx, int ch, uint32_t *pa, int64_t *t_us) {
+    bench_t *b = ctx;
+    if (!b->press[ch].valid) return false;
+    *pa = b->press[ch].pa;
+    *t_us = b->press[ch].timestamp_us;
+    return true;
+}
+
+static void bench_write_valves(void *ctx, const joint_desc_t *d, const uint32_t duty[VALVE_NUM]) {
+    bench_t *b = ctx;
+    pam_model_state_t *s = &b->plant[d->angle_ch];
+    for (int m = 0; m < VALVE_NUM; m += 2) {
+        bool both = duty[m] && duty[m + 1];
+        s->duty[m]     = both ? 0.0f : (float)duty[m] / (float)VALVE_MAX_DUTY;
+        s->duty[m + 1] = both ? 0.0f : (float)duty[m + 1] / (float)VALVE_MAX_DUTY;
+    }
+}
+
+// 推进全部被控对象；2n 个气压通道与目标上一样由一条 UART 逐通道轮询 (每帧 SIM_PRESS_PERIOD_US / 2)
+static void bench_advance(bench_t *b, uint32_t us) {
+    for (int j = 0; j < b->n; j++) {
+        b->plant[j].pump_on = b->plant[j].switch_low;
+        pam_model_step(&b->plant[j], &b->params, (float)us * 1e-6f);
+    }
+    b->now_us += us;
+    while (b->now_us >= b->next_press_us) {
+        int ch = b->next_press_ch;
+        press_sample_t *s = &b->press[ch];
+        s->pa = (uint32_t)lroundf(b->plant[ch / 2].p_kpa[ch % 2] * 1000.0f);
+        s->timestamp_us = b->now_us;
+        s->valid = true;
+        b->next_press_ch = (ch + 1) % (2 * b->n);
+        b->next_press_us += SIM_PRESS_PERIOD_US / 2;
+    }
+}
+
+static int64_t bench_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// n 个关节同时做不同幅度的最小加加速度运动；返回最终误差是否全部在 BENCH_ERR_DEG 内
+// n 个被控对象从零位开始，建立以其为对象的运行时
+static void bench_setup(bench_t *b, joint_rt_t *rt, const joint_desc_t *table, int n) {
+    memset(b, 0, sizeof(*b));
+    b->n = n;
+    pam_model_default_params(&b->params);
+    for (int j = 0; j < n; j++) {
+        pam_model_init(&b->plant[j], &b->params, BASE_PRESSURE);
+        as5600_track_reset(&b->track[j]);
+    }
+    joint_io_t io = { bench_read_angle, bench_read_press, bench_write_valves, b };
+    joint_rt_init(rt, table, n, &io);
+}
+
+static bool sim_joint_bench_run(int n) {
+    static joint_rt_t rt;
+    bench_t *b = &bench;
+    bench_setup(b, &rt, joint_bench_table, n);
+    for (int j = 0; j < n; j++) {
+        float target = (j & 1 ? -1.0f : 1.0f) * (150.0f + 50.0f * (float)(j / 2));
+        joint_rt_move_to(&rt, j, target, 1.5f, TRAJ_MIN_JERK);
+    }
+
+    uint32_t ticks = (uint32_t)(BENCH_RUN_S * 1e6f / CTRL_BASE_TICK_US);
+    int64_t sum_ns = 0, max_ns = 0;
+    joint_stats_t all = { 0 };
+    uint32_t window = 0;
+    for (uint32_t i = 0; i < ticks; i++) {
+        bench_advance(b, CTRL_BASE_TICK_US);
+        int64_t t0 = bench_ns();
+        joint_rt_tick(&rt, b->now_us);
+        int64_t dt = bench_ns() - t0;
+        sum_ns += dt;
+        if (dt > max_ns) max_ns = dt;
+
+        // 每个统计窗口发布一次，累加全部关节 (运行时间为整数个窗口)
+        joint_stats_t win[JOINT_MAX];
+        if (joint_rt_get_stats(&rt, win) == window) continue;
+        window++;
+        for (int j = 0; j < n; j++) {
+            const joint_stats_t *st = &win[j];
+            all.angle_reads += st->angle_reads;
+            all.angle_age_sum_us += st->angle_age_sum_us;
+            if (st->angle_age_max_us > all.angle_age_max_us) all.angle_age_max_us = st->angle_age_max_us;
+            all.press_reads += st->press_reads;
+            all.press_age_sum_us += st->press_age_sum_us;
+            if (st->press_age_max_us > all.press_age_max_us) all.press_age_max_us = st->press_age_max_us;
+        }
+    }
+
+    bool ok = true;
+    float err_max = 0.0f;
+    for (int j = 0; j < n; j++) {
+        float target = (j & 1 ? -1.0f : 1.0f) * (150.0f + 50.0f * (float)(j / 2));
+        float err = fabsf(rt.joints[j].angle.angle - target) * COUNTS_TO_DEG;
+        if (err > err_max) err_max = err;
+        if (err > BENCH_ERR_DEG) ok = false;
+    }
+    double mean_ns = (double)sum_ns / ticks;
+    bool synthetic = JOINT_BENCH_SYNTHETIC(n - 1);    // 最后一个关节超出本机硬件
+    printf("%d,%d,%.0f,%lld,%.0f,%.0f,%lu,%.0f,%lu,%.2f\n", n, synthetic, mean_ns, (long long)max_ns, mean_ns / n,
+           all.angle_reads ? (double)all.angle_age_sum_us / all.angle_reads : 0.0,
+           (unsigned long)all.angle_age_max_us,
+           all.press_reads ? (double)all.press_age_sum_us / all.press_reads : 0.0,
+           (unsigned long)all.press_age_max_us, err_max);
+    return ok;
+}
+
+static bool sim_joint_bench(void) {
+    static const int counts[] = { 1, 4, JOINT_MAX };
+    bool ok = true;
+    printf("joints,synthetic,tick_ns_mean,tick_ns_max,ns_per_joint,angle_age_mean_us,angle_age_max_us,"
+           "press_age_mean_us,press_age_max_us,final_err_max_deg\n");
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        if (!sim_joint_bench_run(counts[i])) ok = false;
+    }
+    if (!ok) ESP_LOGE(TAG, "Joint runtime bench: final error above %.1f deg", BENCH_ERR_DEG);
+    return ok;
+}
+
+// ---------------- 任务空间控制 ----------------
+
+#define CART_CHECK_SAMPLES  20000   // 精度检查的随机位形数
+#define CART_BENCH_CALLS    1000000 // 查表/闭式解计时的调用次数
+#define CART_POS_ERR_MM     0.5f    // 查表位置误差上限
+#define CART_JINV_ERR_MAX   0.25f   // 逆雅可比速度映射的相对误差上限 (插值斜率在网格间隔内为常数)
+#define CART_TRACK_ERR_MM   30.0f   // 闭环末端最终误差上限 (默认增益下由关节稳态误差决定，≈BENCH_ERR_DEG)
+
+// 肩/肘两个关节: 限位 ±640 计数 (≈±56°，在被控对象的 ±60° 机械限位内)
+static const joint_desc_t cart_table[2] = {
+    { .name = "shoulder", .angle_ch = 0, .press_ch = { 0, 1 },
+      .angle = JOINT_ANGLE_PID_DEFAULT, .press = JOINT_PRESS_PID_DEFAULT,
+      .base_pressure = BASE_PRESSURE, .angle_min = -640.0f, .angle_max = 640.0f },
+    { .name = "elbow", .angle_ch = 1, .press_ch = { 2, 3 },
+      .angle = JOINT_ANGLE_PID_DEFAULT, .press = JOINT_PRESS_PID_DEFAULT,
+      .base_pressure = BASE_PRESSURE, .angle_min = -640.0f, .angle_max = 640.0f },
+};
+
+static ik_table_t cart_ik;
+
+static uint32_t cart_rng = 2463534242u;
+static float cart_uniform(float lo, float hi) {
+    cart_rng ^= cart_rng << 13;
+    cart_rng ^= cart_rng >> 17;
+    cart_rng ^= cart_rng << 5;
+    return lo + (hi - lo) * (float)(cart_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief 查表与闭式解对比
+ * * 可达区域内随机取关节位形，正运动学得到末端位置后查表，统计关节角误差、回代位置误差与
+ * * 逆雅可比的速度映射误差 (J(q)·(∂q/∂x)·v 相对 v)；再检查不可达目标返回可达的钳位位形，
+ * * 并比较每次求解的主机耗时
+ */
+static bool sim_ik_check(void) {
+    ik_arm_t arm;
+    cart_ctrl_arm(&arm, &cart_table[0], &cart_table[1], CART_LINK1_MM, CART_LINK2_MM,
+                  CART_ELBOW_MARGIN_DEG * (3.14159265f / 180.0f));
+    int64_t t0 = bench_ns();
+    bool built = ik_table_build(&cart_ik, &arm);
+    int64_t build_ns = bench_ns() - t0;
+    if (!built) {
+        ESP_LOGE(TAG, "IK table: no reachable node");
+        return false;
+    }
+
+    float q_err_max = 0.0f, p_err_max = 0.0f, v_err_max = 0.0f;
+    double q_err_sq = 0.0, p_err_sq = 0.0;
+    int inside = 0, edge = 0;
+    for (int k = 0; k < CART_CHECK_SAMPLES; k++) {
+        float q[2] = { cart_uniform(arm.q_min[0], arm.q_max[0]), cart_uniform(arm.q2_margin, arm.q_max[1]) };
+        float x, y;
+        ik_forward(&arm, q, &x, &y);
+        ik_sol_t sol;
+        if (ik_table_lookup(&cart_ik, x, y, &sol) != IK_OK) {
+            edge++;
+            continue;
+        }
+        inside++;
+        float eq = fmaxf(fabsf(sol.q[0] - q[0]), fabsf(sol.q[1] - q[1])) * (180.0f / 3.14159265f);
+        float xs, ys;
+        ik_forward(&arm, sol.q, &xs, &ys);
+        float ep = hypotf(xs - x, ys - y);
+        q_err_max = fmaxf(q_err_max, eq);
+        p_err_max = fmaxf(p_err_max, ep);
+        q_err_sq += (double)eq * eq;
+        p_err_sq += (double)ep * ep;
+
+        // 单位末端速度经逆雅可比映射为关节速度，再经精确雅可比映射回末端
+        float vx = cos(k), vy = sin(k);
+        float dq1 = sol.dq[0][0] * vx + sol.dq[0][1] * vy;
+        float dq2 = sol.dq[1][0] * vx + sol.dq[1][1] * vy;
+        float s1 = sinf(q[0]), c1 = cosf(q[0]), s12 = sinf(q[0] + q[1]), c12 = cosf(q[0] + q[1]);
+        float rx = -(arm.l1 * s1 + arm.l2 * s12) * dq1 - arm.l2 * s12 * dq2;
+        float ry = (arm.l1 * c1 + arm.l2 * c12) * dq1 + arm.l2 * c12 * dq2;
+        v_err_max = fmaxf(v_err_max, hypotf(rx - vx, ry - vy));
+    }
+
+    // 不可达目标 (超出臂长、基座后方、原点、肘部伸直): 钳位位形必须在限位内
+    static const float far[][2] = { { 600.0f, 0.0f }, { -200.0f, 50.0f }, { 0.0f, 0.0f }, { 349.9f, 0.0f } };
+    bool clamp_ok = true;
+    for (size_t i = 0; i < sizeof(far) / sizeof(far[0]); i++) {
+        ik_sol_t sol;
+        bool clamped = ik_table_lookup(&cart_ik, far[i][0], far[i][1], &sol) == IK_CLAMPED;
+        if (!clamped || sol.q[0] < arm.q_min[0] || sol.q[0] > arm.q_max[0] ||
+            sol.q[1] < arm.q2_margin - 1e-4f || sol.q[1] > arm.q_max[1] + 1e-4f) {
+            clamp_ok = false;
+        }
+    }
+
+    // 每次求解耗时 (目标在可达区域内随机)
+    static float pts[256][2];
+    for (int i = 0; i < 256; i++) {
+        float q[2] = { cart_uniform(arm.q_min[0], arm.q_max[0]), cart_uniform(arm.q2_margin, arm.q_max[1]) };
+        ik_forward(&arm, q, &pts[i][0], &pts[i][1]);
+    }
+    volatile float sink = 0.0f;
+    t0 = bench_ns();
+    for (int i = 0; i < CART_BENCH_CALLS; i++) {
+        ik_sol_t sol;
+        ik_table_lookup(&cart_ik, pts[i & 255][0], pts[i & 255][1], &sol);
+        sink += sol.q[1];
+    }
+    double lookup_ns = (double)(bench_ns() - t0) / CART_BENCH_CALLS;
+    t0 = bench_ns();
+    for (int i = 0; i < CART_BENCH_CALLS; i++) {
+        float q[2] = { 0.0f, 0.0f };
+        ik_solve_exact(&arm, cart_ik.elbow, pts[i & 255][0], pts[i & 255][1], q);
+        sink += q[1];
+    }
+    double exact_ns = (double)(bench_ns() - t0) / CART_BENCH_CALLS;
+    (void)sink;
+
+    printf("rho_points,table_bytes,build_ms,coverage_pct,q_err_max_deg,q_err_rms_deg,pos_err_max_mm,"
+           "pos_err_rms_mm,jinv_err_max,lookup_ns,exact_ns\n");
+    printf("%d,%u,%.2f,%.1f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f\n", IK_RHO_POINTS, (unsigned)sizeof(ik_table_t),
+           build_ns * 1e-6, 100.0 * inside / (inside + edge), q_err_max, sqrt(q_err_sq / inside),
+           p_err_max, sqrt(p_err_sq / inside), v_err_max, lookup_ns, exact_ns);
+
+    bool ok = clamp_ok && p_err_max < CART_POS_ERR_MM && v_err_max < CART_JINV_ERR_MAX;
+    if (!clamp_ok) ESP_LOGE(TAG, "IK fallback returned an unreachable pose");
+    if (p_err_max >= CART_POS_ERR_MM) ESP_LOGE(TAG, "IK table error %.2f mm above %.1f mm", p_err_max, CART_POS_ERR_MM);
+    if (v_err_max >= CART_JINV_ERR_MAX) {
+        ESP_LOGE(TAG, "IK inverse Jacobian error %.3f above %.2f", v_err_max, CART_JINV_ERR_MAX);
+    }
+    return ok;
+}
+
+// 末端实际位置 (被控对象关节角的正运动学) 与 (x, y) 之差
+static float cart_track_err(const bench_t *b, float x_ref, float y_ref) {
+    float q[2] = { b->plant[0].theta, b->plant[1].theta }, x, y;
+    ik_forward(&cart_ik.arm, q, &x, &y);
+    return hypotf(x - x_ref, y - y_ref);
+}
+
+/**
+ * @brief 闭环: 肩/肘两个被控对象先在关节空间移到起点，再由任务空间控制走两段直线，
+ * * 最后交还两关节 (cart_ctrl_release)，按关节路点回到起点
+ * * 输出每段的末端跟踪误差 (最大/最终) 与 cart_ctrl_step 的主机耗时
+ */
+static bool sim_cart_bench(void) {
+    static joint_rt_t rt;
+    static cart_ctrl_t cart;
+    bench_t *b = &bench;
+    bench_setup(b, &rt, cart_table, 2);
+    cart_ctrl_init(&cart, &cart_ik, 0, 1);
+
+    // 路点按关节位形给出 (度)，末端位置由正运动学得到
+    static const float path_deg[][2] = { { -15.0f, 30.0f }, { 15.0f, 30.0f }, { 0.0f, 50.0f } };
+    float pts[3][2];
+    for (int i = 0; i < 3; i++) {
+        float q[2] = { path_deg[i][0] * (3.14159265f / 180.0f), path_deg[i][1] * (3.14159265f / 180.0f) };
+        ik_forward(&cart_ik.arm, q, &pts[i][0], &pts[i][1]);
+    }
+    joint_rt_move_to(&rt, 0, path_deg[0][0] * (4096.0f / 360.0f), 1.5f, TRAJ_MIN_JERK);
+    joint_rt_move_to(&rt, 1, path_deg[0][1] * (4096.0f / 360.0f), 1.5f, TRAJ_MIN_JERK);
+
+    printf("segment,x_mm,y_mm,track_err_max_mm,final_err_mm,clamped_ticks,step_ns_mean\n");
+    bool ok = true;
+    for (int seg = 0; seg < 4; seg++) {
+        const float *target = pts[seg % 3];
+        if (seg == 3) {
+            cart_ctrl_release(&cart);
+            joint_rt_move_to(&rt, 0, path_deg[0][0] * (4096.0f / 360.0f), 1.5f, TRAJ_MIN_JERK);
+            joint_rt_move_to(&rt, 1, path_deg[0][1] * (4096.0f / 360.0f), 1.5f, TRAJ_MIN_JERK);
+        } else if (seg > 0) {
+            cart_ctrl_move_to(&cart, target[0], target[1], 1.5f, TRAJ_MIN_JERK);
+        }
+        float err_max = 0.0f;
+        int64_t step_ns = 0;
+        uint32_t ticks = (uint32_t)(3.0f * 1e6f / CTRL_BASE_TICK_US);
+        for (uint32_t i = 0; i < ticks; i++) {
+            bench_advance(b, CTRL_BASE_TICK_US);
+            int64_t t0 = bench_ns();
+            cart_ctrl_step(&cart, &rt, CTRL_BASE_TICK_US * 1e-6f);
+            step_ns += bench_ns() - t0;
+            joint_rt_tick(&rt, b->now_us);
+            if (cart.active) err_max = fmaxf(err_max, cart_track_err(b, cart.x_ref, cart.y_ref));
+        }
+        float err = seg > 0 ? cart_track_err(b, target[0], target[1]) : 0.0f;
+        printf("%d,%.1f,%.1f,%.2f,%.2f,%lu,%.0f\n", seg, target[0], target[1], err_max, err,
+               (unsigned long)cart.clamped, (double)step_ns / ticks);
+        if (err > CART_TRACK_ERR_MM) ok = false;
+    }
+    if (cart.clamped) ok = false;       // 路径全部在可达区域内
+    if (cart.active || rt.joints[0].ext_ref || rt.joints[1].ext_ref) ok = false;   // 已交还两关节
+    if (!ok) ESP_LOGE(TAG, "Cartesian bench: final error above %.0f mm, reference clamped or joints not released",
+                      CART_TRACK_ERR_MM);
+    return ok;
+}
+
+void app_main(void) {
+    ESP_LOGI(TAG, "========= PAM Software-in-the-Loop =========");
+
+    bool replay = getenv("PAM_TRACE_REPLAY") != NULL;
+    sim_hal_init(BASE_PRESSURE);
+#if PAM_TRACE_ENABLE
+    if (replay) {
+        if (trace_replay_load() != ESP_OK) {
+            ESP_LOGE(TAG, "No trace to replay");
+            exit(1);
+        }
+        trace_replay_start(0);      // 仿真时钟同样从 0 开始
+    } else {
+        trace_record_start();
+    }
+#endif
+    loop_prof_set_clock(sim_clock, 1);
+    arm_control_set_clock(sim_hal_now_us);
+#if PAM_TELEMETRY_ENABLE
+    telemetry_init();       // 写入 pam_telem.bin
+    telemetry_set_clock(sim_hal_now_us);
+#endif
+    pump_init();
+    if (!replay) pump_trace_level();
+    valves_init();
+    as5600_init();
+    pressure_sensor_init();
+    param_store_init();     // 仿真不读写 NVS，始终从默认值开始
+    valve_cal_load();       // 同上: 恒等映射
+    sim_valve_cal();
+    arm_control_init();
+
+    // 先在零位稳定，再把当前位置设为零点 (标定结束时关节停在限位，回到零位约需 3 s；
+    // 零点即前馈模型中两肌肉等长的位置)
+    sim_run(4.0f, NULL);
+    as5600_set_zero();
+    sim_run(1.0f, NULL);
+
+    // 同一动作序列分别在两种阀门分配模式下运行: 只用进气阀 / 进排气双向
+    param_set("ff_enable", 0.0f);
+    printf("mode,move,target_deg,rise_s,overshoot_pct,settling_s,final_err_deg,air_nl,"
+           "track_rms_deg,track_max_deg,peak_dp_kpa\n");
+    // 只用进气阀时负输出无处可去，压力环输出范围与原进气阀控制器相同 (0 ~ VALVE_MAX_DUTY)，
+    // 抗饱和才按实际能执行的范围工作
+    param_set("valve_exhaust", 0.0f);
+    param_set("press_a.out_min", 0.0f);
+    param_set("press_b.out_min", 0.0f);
+    run_moves("inlet", TRAJ_STEP);
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    param_set("press_a.out_min", -(float)VALVE_MAX_DUTY);
+    param_set("press_b.out_min", -(float)VALVE_MAX_DUTY);
+    param_set("valve_exhaust", 1.0f);
+    run_moves("bidir", TRAJ_STEP);
+
+    // 同一序列改用轨迹下发
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("bidir_minjerk", TRAJ_MIN_JERK);
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("bidir_trapezoid", TRAJ_TRAPEZOID);
+
+    // 静态模型前馈
+    param_set("ff_enable", 1.0f);
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("ff_step", TRAJ_STEP);
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("ff_minjerk", TRAJ_MIN_JERK);
+
+    // 模型失配: 前馈表仍按默认参数建立
+    pam_model_params_t *pp = sim_hal_params();
+    pam_model_params_t nominal = *pp;
+    pp->load_torque *= 1.3f;
+    pp->damping *= 1.3f;
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("ff_minjerk_mismatch", TRAJ_MIN_JERK);
+    *pp = nominal;
+
+    // 继电反馈自整定，再以整定后的增益重复最小加加速度序列
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    bool tune_ok = sim_autotune_check();
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("tuned_minjerk", TRAJ_MIN_JERK);
+
+    // 角度环降到 50 Hz: PID 按实际采样间隔计算，同一组增益的效果应基本不变
+    param_set("angle_period_ticks", 2.0f * ANGLE_LOOP_PERIOD_TICKS);
+    arm_set_target_angle(0.0f);
+    sim_run(3.0f, NULL);
+    run_moves("tuned_minjerk_50hz", TRAJ_MIN_JERK);
+    param_set("angle_period_ticks", ANGLE_LOOP_PERIOD_TICKS);
+
+    bool obs_ok = sim_press_obs_check();
+    bool pwm_ok = sim_valve_pwm_check();
+    bool hammer_ok = sim_param_hammer_check();
+    bool trace_ok = sim_trace_finish(replay);
+
+    loop_prof_dump();
+#if PAM_TELEMETRY_ENABLE
+    telemetry_flush();
+#endif
+
+    pam_model_state_t *st = sim_hal_state();
+    ESP_LOGI(TAG, "Sim time %.1f s, pump duty %.1f%%, tank %.0f kPa",
+             st->time_s, st->pump_on_s / st->time_s * 100.0, st->tank_kpa);
+    sim_pump_report();
+    bool fixq_ok = sim_fixq_check();
+    bool joints_ok = sim_joint_bench();
+    bool cart_ok = sim_ik_check() && sim_cart_bench();
+    bool checks_ok = sim_check_press_acq();
+    checks_ok &= sim_check_press_parser();
+    checks_ok &= sim_check_spsc_ring();
+    checks_ok &= sim_check_pid();
+    exit(sim_pump_check() && tune_ok && fixq_ok && obs_ok && pwm_ok && trace_ok && joints_ok && cart_ok && checks_ok &&
+         hammer_ok ? 0 : 1);
+}
@@ -0,0 +1,51 @@
+#include "sim_metrics.h"
+#include <math.h>
+
+#define RHO_ANR 1.185   // 标准状态空气密度 kg/m³
+
+void sim_metrics_begin(sim_metrics_t *m, float t0, float y0, float target, float band, double air_kg) {
+    m->t0 = t0;
+    m->y0 = y0;
+    m->target = target;
+    m->band = band;
+    m->t10 = -1.0f;
+    m->t90 = -1.0f;
+    m->peak = 0.0f;
+    m->t_outside = t0;
+    m->air0_kg = air_kg;
+    m->err_sq = 0.0;
+    m->err_max = 0.0f;
+    m->dp_peak = 0.0f;
+    m->n = 0;
+}
+
+void sim_metrics_update(sim_metrics_t *m, float t, float y) {
+    float step = m->target - m->y0;
+    float progress = (step != 0.0f) ? (y - m->y0) / step : 1.0f;
+
+    if (m->t10 < 0.0f && progress >= 0.1f) m->t10 = t;
+    if (m->t90 < 0.0f && progress >= 0.9f) m->t90 = t;
+    if (progress * fabsf(step) > m->peak) m->peak = progress * fabsf(step);
+    if (fabsf(y - m->target) > m->band) m->t_outside = t;
+}
+
+void sim_metrics_track(sim_metrics_t *m, float ref, float y, float dp) {
+    float e = fabsf(y - ref);
+    m->err_sq += (double)e * e;
+    if (e > m->err_max) m->err_max = e;
+    if (fabsf(dp) > m->dp_peak) m->dp_peak = fabsf(dp);
+    m->n++;
+}
+
+void sim_metrics_finish(const sim_metrics_t *m, float y_end, double air_kg, sim_result_t *r) {
+    float step = fabsf(m->target - m->y0);
+
+    r->rise_s = (m->t10 >= 0.0f && m->t90 >= 0.0f) ? m->t90 - m->t10 : -1.0f;
+    r->overshoot_pct = (step > 0.0f && m->peak > step) ? (m->peak - step) / step * 100.0f : 0.0f;
+    r->settling_s = m->t_outside - m->t0;
+    r->final_error = y_end - m->target;
+    r->air_nl = (float)((air_kg - m->air0_kg) / RHO_ANR * 1000.0);
+    r->track_rms = m->n ? (float)sqrt(m->err_sq / m->n) : 0.0f;
+    r->track_max = m->err_max;
+    r->peak_dp_kpa = m->dp_peak;
+}
@@ -0,0 +1,40 @@
+//阶跃响应指标: 上升时间、超调、调节时间、耗气量
+//轨迹跟踪指标: 相对参考角度的跟踪误差、角度环的峰值压力差需求
+
+#ifndef SIM_METRICS_H
+#define SIM_METRICS_H
+
+#include <stdint.h>
+
+typedef struct {
+    float  t0, y0, target;
+    float  band;            ///< 调节带宽 (绝对值)
+    float  t10, t90;        ///< 首次到达 10% / 90% 的时刻，<0 表示未到达
+    float  peak;            ///< 沿阶跃方向的最大偏移 (相对 y0)
+    float  t_outside;       ///< 最后一次处于调节带之外的时刻
+    double air0_kg;
+    double err_sq;          ///< 跟踪误差平方和
+    float  err_max;         ///< 最大跟踪误差
+    float  dp_peak;         ///< 最大压力差需求 (绝对值)
+    uint32_t n;             ///< 跟踪采样数
+} sim_metrics_t;
+
+typedef struct {
+    float rise_s;           ///< 10%→90% 上升时间，<0 表示未完成
+    float overshoot_pct;    ///< 超调量 (%)
+    float settling_s;       ///< 调节时间 (进入并保持在调节带内)
+    float final_error;      ///< 结束时的误差
+    float air_nl;           ///< 耗气量 (标准升)
+    float track_rms;        ///< 跟踪误差均方根 (与 y 同单位)
+    float track_max;        ///< 最大跟踪误差
+    float peak_dp_kpa;      ///< 峰值压力差需求 (kPa)
+} sim_result_t;
+
+// band: 调节带 (与 y 同单位)
+void sim_metrics_begin(sim_metrics_t *m, float t0, float y0, float target, float band, double air_kg);
+void sim_metrics_update(sim_metrics_t *m, float t, float y);
+// ref: 当前参考角度 (阶跃时即目标)；dp: 角度环输出的压力差
+void sim_metrics_track(sim_metrics_t *m, float ref, float y, float dp);
+void sim_metrics_finish(const sim_metrics_t *m, float y_end, double air_kg, sim_result_t *r);
+
+#endif // SIM_METRICS_H
@@ -0,0 +1,97 @@
+//定点数运算 (无硬件 FPU 的芯片上替代软件浮点)
+//  q16_t: Q16.16，int32，范围 ±32768，分辨率 1/65536 ≈ 1.5e-5。用于物理量 (kPa、角度计数)、
+//         增益、滤波状态与控制器输出。
+//  q15_t: Q1.15，int16，范围 [-1, 1)，分辨率 1/32768。用于 [0, 1) 内的系数 (滤波器系数、
+//         卡尔曼位置增益)，与 q16_t 相乘时只需 32 位乘法。
+//所有加、减、乘、除都饱和到类型范围，不会回绕；除以 0 时按被除数符号饱和。
+//PAM_FIXED_POINT 构建只把 PID、卡尔曼滤波与压力采样换成定点；轨迹、前馈、阀门分配、压力观测器
+//与遥测仍是浮点，经 q16_from_float / q16_to_float 在回路边界换算，因此回路内仍有少量软件浮点运算。
+
+#ifndef FIXQ_H
+#define FIXQ_H
+
+#include <stdint.h>
+
+typedef int32_t q16_t;
+typedef int16_t q15_t;
+
+#define Q16_SHIFT   16
+#define Q16_ONE     ((q16_t)1 << Q16_SHIFT)
+#define Q16_MAX     INT32_MAX
+#define Q16_MIN     INT32_MIN
+#define Q15_ONE_EPS ((q15_t)0x7FFF)         // Q1.15 能表示的最大值 (1 - 2^-15)
+
+static inline q16_t q16_sat64(int64_t v) {
+    if (v > Q16_MAX) return Q16_MAX;
+    if (v < Q16_MIN) return Q16_MIN;
+    return (q16_t)v;
+}
+
+static inline q16_t q16_from_int(int32_t v) {
+    return q16_sat64((int64_t)v << Q16_SHIFT);
+}
+
+// 四舍五入到整数
+static inline int32_t q16_round(q16_t a) {
+    return (int32_t)(((int64_t)a + (Q16_ONE >> 1)) >> Q16_SHIFT);
+}
+
+// 有理数 num / den 转为 Q16.16 (如 Pa -> kPa: q16_ratio(pa, 1000))
+static inline q16_t q16_ratio(int64_t num, int64_t den) {
+    return q16_sat64((num << Q16_SHIFT) / den);
+}
+
+static inline q16_t q16_from_float(float f) {
+    float v = f * (float)Q16_ONE;
+    if (v >= 2147483647.0f) return Q16_MAX;
+    if (v <= -2147483648.0f) return Q16_MIN;
+    return (q16_t)(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float q16_to_float(q16_t a) {
+    return (float)a * (1.0f / (float)Q16_ONE);
+}
+
+static inline q16_t q16_add(q16_t a, q16_t b) {
+    return q16_sat64((int64_t)a + b);
+}
+
+static inline q16_t q16_sub(q16_t a, q16_t b) {
+    return q16_sat64((int64_t)a - b);
+}
+
+// 乘积四舍五入
+static inline q16_t q16_mul(q16_t a, q16_t b) {
+    return q16_sat64(((int64_t)a * b + (1 << (Q16_SHIFT - 1))) >> Q16_SHIFT);
+}
+
+static inline q16_t q16_div(q16_t a, q16_t b) {
+    if (b == 0) return a >= 0 ? Q16_MAX : Q16_MIN;
+    return q16_sat64(((int64_t)a << Q16_SHIFT) / b);
+}
+
+static inline q16_t q16_clamp(q16_t a, q16_t lo, q16_t hi) {
+    return a > hi ? hi : (a < lo ? lo : a);
+}
+
+static inline q16_t q16_abs(q16_t a) {
+    return a == Q16_MIN ? Q16_MAX : (a < 0 ? -a : a);
+}
+
+// Q16.16 × Q1.15 -> Q16.16
+static inline q16_t q16_mul_q15(q16_t a, q15_t b) {
+    return q16_sat64(((int64_t)a * b + (1 << 14)) >> 15);
+}
+
+// Q16.16 中 [0, 1] 的值转为 Q1.15 (1.0 饱和为 1 - 2^-15)
+static inline q15_t q15_from_q16(q16_t a) {
+    if (a >= Q16_ONE) return Q15_ONE_EPS;
+    if (a <= -Q16_ONE) return (q15_t)-0x8000;
+    return (q15_t)(a >> 1);
+}
+
+static inline q15_t q15_from_float(float f) {
+    return q15_from_q16(q16_from_float(f));
+}
+
+#endif // FIXQ_H
@@ -0,0 +1,218 @@
+#include "loop_prof.h"
+
+#if PAM_PROFILE_ENABLE
+
+#include "spsc_ring.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <stdio.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_cpu.h"
+#endif
+
+static const char *TAG = "LOOP_PROF";
+
+#ifdef CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define DEFAULT_CYCLES_PER_US   CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#else
+#define DEFAULT_CYCLES_PER_US   1       // linux 目标: 时钟以微秒计
+#endif
+
+#define SPAN_PERIOD     0xFF            // 记录类型: 周期间隔
+#define POLL_PERIOD_MS  50
+
+// 热路径写入的原始记录
+typedef struct {
+    uint32_t span;
+    uint32_t cycles;
+} prof_rec_t;
+
+// 汇总统计 (只由汇总方访问)
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[LOOP_PROF_HIST_BUCKETS];
+} prof_stat_t;
+
+struct loop_prof {
+    const char *name;
+    uint32_t    nominal_cycles;
+    const char *span_names[LOOP_PROF_MAX_SPANS];
+    int         num_spans;
+
+    // 热路径 (回路所在任务写)
+    uint32_t    last_start;
+    uint8_t     started;
+    spsc_ring_t ring;
+    prof_rec_t  ring_buf[LOOP_PROF_RING_LEN];
+
+    // 汇总
+    prof_stat_t spans[LOOP_PROF_MAX_SPANS];
+    prof_stat_t period;
+    prof_stat_t jitter;     ///< |实际周期 - 名义周期|
+};
+
+static loop_prof_t profiles[LOOP_PROF_MAX_PROFILES];
+static int num_profiles;
+static atomic_bool dump_requested;
+
+#if CONFIG_IDF_TARGET_LINUX
+static uint32_t default_clock(void) { return (uint32_t)esp_timer_get_time(); }
+#else
+static uint32_t default_clock(void) { return esp_cpu_get_cycle_count(); }
+#endif
+
+static loop_prof_clock_t clock_fn = default_clock;
+static uint32_t cycles_per_us = DEFAULT_CYCLES_PER_US;
+
+uint32_t loop_prof_now(void) {
+    return clock_fn();
+}
+
+void loop_prof_set_clock(loop_prof_clock_t clock, uint32_t cpu_cycles_per_us) {
+    clock_fn = clock;
+    cycles_per_us = cpu_cycles_per_us ? cpu_cycles_per_us : 1;
+}
+
+loop_prof_t *loop_prof_register(const char *name, uint32_t nominal_period_us) {
+    if (num_profiles >= LOOP_PROF_MAX_PROFILES) return NULL;
+
+    loop_prof_t *p = &profiles[num_profiles++];
+    memset(p, 0, sizeof(*p));
+    p->name = name;
+    p->nominal_cycles = nominal_period_us * cycles_per_us;
+    spsc_ring_init(&p->ring, p->ring_buf, LOOP_PROF_RING_LEN, sizeof(prof_rec_t));
+    return p;
+}
+
+int loop_prof_add_span(loop_prof_t *p, const char *name) {
+    if (!p || p->num_spans >= LOOP_PROF_MAX_SPANS) return 0;
+    p->span_names[p->num_spans] = name;
+    return p->num_spans++;
+}
+
+void loop_prof_lap(loop_prof_t *p, int span, uint32_t *t) {
+    uint32_t now = clock_fn();
+    if (p) {
+        prof_rec_t r = { (uint32_t)span, now - *t };
+        spsc_ring_push(&p->ring, &r);
+    }
+    *t = now;
+}
+
+void loop_prof_period(loop_prof_t *p) {
+    if (!p) return;
+    uint32_t now = clock_fn();
+    if (p->started) {
+        prof_rec_t r = { SPAN_PERIOD, now - p->last_start };
+        spsc_ring_push(&p->ring, &r);
+    }
+    p->last_start = now;
+    p->started = 1;
+}
+
+// ---------------- 汇总 ----------------
+
+static inline int log2_bucket(uint32_t v) {
+    int b = 0;
+    while (v > 1 && b < LOOP_PROF_HIST_BUCKETS - 1) {
+        v >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void stat_add(prof_stat_t *s, uint32_t v) {
+    if (s->count == 0 || v < s->min) s->min = v;
+    if (v > s->max) s->max = v;
+    s->sum += v;
+    s->count++;
+    s->hist[log2_bucket(v)]++;
+}
+
+// p99 取所在 log2 桶的上界 (保守估计)
+static uint32_t stat_p99(const prof_stat_t *s) {
+    uint32_t need = s->count - s->count / 100;
+    uint32_t acc = 0;
+    for (int b = 0; b < LOOP_PROF_HIST_BUCKETS; b++) {
+        acc += s->hist[b];
+        if (acc >= need) {
+            uint32_t upper = (b >= 31) ? 0xFFFFFFFFu : ((1u << (b + 1)) - 1);
+            return upper < s->max ? upper : s->max;
+        }
+    }
+    return s->max;
+}
+
+void loop_prof_poll(void) {
+    prof_rec_t r;
+    for (int i = 0; i < num_profiles; i++) {
+        loop_prof_t *p = &profiles[i];
+        while (spsc_ring_pop(&p->ring, &r)) {
+            if (r.span == SPAN_PERIOD) {
+                stat_add(&p->period, r.cycles);
+                uint32_t dev = r.cycles > p->nominal_cycles ? r.cycles - p->nominal_cycles
+                                                            : p->nominal_cycles - r.cycles;
+                stat_add(&p->jitter, dev);
+            } else if (r.span < LOOP_PROF_MAX_SPANS) {
+                stat_add(&p->spans[r.span], r.cycles);
+            }
+        }
+    }
+}
+
+static void stat_log(const char *loop, const char *what, const prof_stat_t *s) {
+    if (s->count == 0) return;
+
+    // 直方图只打印非零桶: "桶号:次数"
+    char hist[160];
+    int n = 0;
+    for (int b = 0; b < LOOP_PROF_HIST_BUCKETS && n < (int)sizeof(hist) - 12; b++) {
+        if (s->hist[b]) n += snprintf(hist + n, sizeof(hist) - n, " %d:%lu", b, (unsigned long)s->hist[b]);
+    }
+
+    float k = 1.0f / (float)cycles_per_us;
+    ESP_LOGI(TAG, "%s/%s n=%lu min=%.2f mean=%.2f max=%.2f p99<=%.2f us |%s",
+             loop, what, (unsigned long)s->count, s->min * k, (float)(s->sum / s->count) * k,
+             s->max * k, stat_p99(s) * k, hist);
+}
+
+void loop_prof_dump(void) {
+    for (int i = 0; i < num_profiles; i++) {
+        loop_prof_t *p = &profiles[i];
+        stat_log(p->name, "period", &p->period);
+        stat_log(p->name, "jitter", &p->jitter);
+        for (int s = 0; s < p->num_spans; s++) {
+            stat_log(p->name, p->span_names[s], &p->spans[s]);
+        }
+        if (p->ring.drops) {
+            ESP_LOGW(TAG, "%s: %lu records dropped", p->name, (unsigned long)p->ring.drops);
+        }
+    }
+}
+
+void loop_prof_request_dump(void) {
+    atomic_store(&dump_requested, true);
+}
+
+static void loop_prof_task(void *pvParameters) {
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(POLL_PERIOD_MS));
+        loop_prof_poll();
+        if (atomic_exchange(&dump_requested, false)) {
+            loop_prof_dump();
+        }
+    }
+}
+
+void loop_prof_start(void) {
+    xTaskCreate(loop_prof_task, "Prof_Task", 3072, NULL, 1, NULL);
+}
+
+#endif // PAM_PROFILE_ENABLE
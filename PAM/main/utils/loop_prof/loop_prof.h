@@ -0,0 +1,71 @@
+//控制回路计时插桩
+//热路径只把 (区段号, 周期数) 写入每个回路自己的 SPSC 无锁缓冲区；低优先级任务负责汇总
+//min/mean/max/p99 与 log2 直方图 (执行时间 + 周期抖动)，随时可转储而不打断控制回路。
+//PAM_PROFILE_ENABLE 为 0 时所有宏展开为空。
+
+#ifndef LOOP_PROF_H
+#define LOOP_PROF_H
+
+#include <stdint.h>
+#include "hardware_config.h"
+
+#define LOOP_PROF_MAX_PROFILES  4     // 最多插桩的回路数
+#define LOOP_PROF_MAX_SPANS     8     // 每个回路最多的命名区段
+#define LOOP_PROF_RING_LEN      256   // 每个回路的记录缓冲 (2 的幂)
+#define LOOP_PROF_HIST_BUCKETS  32    // log2 直方图: 桶 k 统计 [2^k, 2^(k+1)) 个周期
+
+typedef struct loop_prof loop_prof_t;
+
+// 时钟源，返回 CPU 周期数 (可回绕)；仿真中替换为仿真时钟
+typedef uint32_t (*loop_prof_clock_t)(void);
+
+#if PAM_PROFILE_ENABLE
+
+// 注册一个回路，nominal_period_us 为名义周期 (用于计算抖动)；失败返回 NULL
+loop_prof_t *loop_prof_register(const char *name, uint32_t nominal_period_us);
+
+// 为回路添加命名区段，返回区段号
+int loop_prof_add_span(loop_prof_t *p, const char *name);
+
+// 热路径: 记录从 *t 到现在的区段耗时，并把 *t 更新为现在 (连续区段首尾相接)
+void loop_prof_lap(loop_prof_t *p, int span, uint32_t *t);
+
+// 热路径: 回路开始时调用，记录与上次开始的间隔 (周期抖动)
+void loop_prof_period(loop_prof_t *p);
+
+uint32_t loop_prof_now(void);
+void loop_prof_set_clock(loop_prof_clock_t clock, uint32_t cycles_per_us);
+
+// 汇总缓冲区中的记录 (由采集任务或仿真循环调用)
+void loop_prof_poll(void);
+
+// 打印全部统计
+void loop_prof_dump(void);
+
+// 请求采集任务在下一次汇总后打印 (任意任务可调用)
+void loop_prof_request_dump(void);
+
+// 启动低优先级汇总任务
+void loop_prof_start(void);
+
+#define PROF_MARK(t)            uint32_t t = loop_prof_now()
+#define PROF_LAP(p, span, t)    loop_prof_lap((p), (span), &(t))
+#define PROF_PERIOD(p)          loop_prof_period((p))
+
+#else
+
+#define loop_prof_register(name, period)    ((loop_prof_t *)0)
+#define loop_prof_add_span(p, name)         (0)
+#define loop_prof_set_clock(clock, cpu)     ((void)0)
+#define loop_prof_poll()                    ((void)0)
+#define loop_prof_dump()                    ((void)0)
+#define loop_prof_request_dump()            ((void)0)
+#define loop_prof_start()                   ((void)0)
+
+#define PROF_MARK(t)
+#define PROF_LAP(p, span, t)    ((void)0)
+#define PROF_PERIOD(p)          ((void)0)
+
+#endif // PAM_PROFILE_ENABLE
+
+#endif // LOOP_PROF_H
@@ -0,0 +1,58 @@
+//“最新值”邮箱：一个写者、任意读者，读写均不加互斥锁
+//写者每次 post 覆盖旧值，读者总是拿到最近一次完整写入的值 (基于 seqlock)。
+//用于多速率回路之间交换设定值等只关心最新数据的场合。
+
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "seqlock.h"
+
+typedef struct {
+    seqlock_t lock;
+    uint32_t  version;   ///< 每次 post 加 1，0 表示从未写入
+    size_t    size;
+    void     *data;      ///< 由调用者提供的存储区
+} mailbox_t;
+
+static inline void mailbox_init(mailbox_t *mb, void *storage, size_t size) {
+    seqlock_init(&mb->lock);
+    mb->version = 0;
+    mb->size = size;
+    mb->data = storage;
+}
+
+// 写入新值
+static inline void mailbox_post(mailbox_t *mb, const void *value) {
+    seqlock_write_begin(&mb->lock);
+    memcpy(mb->data, value, mb->size);
+    mb->version++;
+    seqlock_write_end(&mb->lock);
+}
+
+// 读取最新值，返回其版本号 (可与上次比较判断是否为新数据)
+static inline uint32_t mailbox_peek(mailbox_t *mb, void *out) {
+    unsigned s;
+    uint32_t version;
+    do {
+        s = seqlock_read_begin(&mb->lock);
+        memcpy(out, mb->data, mb->size);
+        version = mb->version;
+    } while (seqlock_read_retry(&mb->lock, s));
+    return version;
+}
+
+// 只读取版本号，不拷贝数据 (用于廉价地判断是否有新值)
+static inline uint32_t mailbox_version(mailbox_t *mb) {
+    unsigned s;
+    uint32_t version;
+    do {
+        s = seqlock_read_begin(&mb->lock);
+        version = mb->version;
+    } while (seqlock_read_retry(&mb->lock, s));
+    return version;
+}
+
+#endif // MAILBOX_H
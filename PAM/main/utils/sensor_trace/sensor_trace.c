@@ -0,0 +1,379 @@
+#include "sensor_trace.h"
+
+#if PAM_TRACE_ENABLE
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <stdatomic.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <stdio.h>
+#include <stdlib.h>
+#define TRACE_FILE      "pam_trace.bin"
+#else
+#include "esp_partition.h"
+#endif
+
+static const char *TAG = "TRACE";
+
+#define HDR_BYTES       sizeof(trace_block_hdr_t)
+#define EVENT_MAX       (1 + 10 + 10)           // tag + dt + payload (varint 最长 10 字节)
+#define RING_BYTES      (TRACE_RAM_BLOCKS * TRACE_BLOCK_BYTES)
+
+_Static_assert(TRACE_BLOCK_BYTES - sizeof(trace_block_hdr_t) >= EVENT_MAX, "trace block too small");
+_Static_assert(TRACE_BLOCK_BYTES <= 65535, "block length must fit in u16");
+
+// 差分状态 (编码与解码共用，每块开头重置)
+typedef struct {
+    int64_t  t;
+    uint32_t prev[2][TRACE_MAX_CH];   ///< ANGLE / PRESS 各通道上一读数
+} delta_state_t;
+
+// ---------------- 记录 ----------------
+
+static uint8_t ring[RING_BYTES];
+static portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+static atomic_bool recording;
+
+// 以下由 lock 保护
+static uint32_t cur;                ///< 当前块在环中的下标
+static trace_block_hdr_t hdr;       ///< 当前块的块头 (每个事件后同步写入环中)
+static delta_state_t enc;
+static trace_stats_t stats;
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static void block_begin(uint32_t seq, int64_t t0) {
+    hdr.magic = TRACE_MAGIC;
+    hdr.version = TRACE_VERSION;
+    hdr.len = 0;
+    hdr.seq = seq;
+    hdr.events = 0;
+    hdr.t0_us = t0;
+    memset(&enc, 0, sizeof(enc));
+    enc.t = t0;
+}
+
+// 按当前块的差分状态编码一个事件，返回字节数
+static size_t encode(const trace_event_t *ev, uint8_t *out) {
+    bool flag = ev->type == TRACE_EV_PUMP ? ev->value != 0 : !ev->ok;
+    size_t n = 0;
+
+    out[n++] = (uint8_t)((ev->type << 6) | (flag ? 0x20 : 0) | (ev->ch & 0x1F));
+    n += put_varint(out + n, zigzag(ev->t_us - enc.t));
+    enc.t = ev->t_us;
+
+    if (ev->type == TRACE_EV_MARK) {
+        n += put_varint(out + n, ev->value);
+    } else if (ev->type != TRACE_EV_PUMP && ev->ok) {
+        uint32_t *prev = &enc.prev[ev->type][ev->ch & 0x1F];
+        int64_t d = (int64_t)ev->value - *prev;
+        if (ev->type == TRACE_EV_ANGLE) {
+            d &= 0x0FFF;
+            if (d >= 2048) d -= 4096;
+        }
+        n += put_varint(out + n, zigzag(d));
+        *prev = ev->value;
+    }
+    return n;
+}
+
+void trace_record_start(void) {
+    portENTER_CRITICAL_SAFE(&lock);
+    memset(ring, 0, sizeof(ring));
+    memset(&stats, 0, sizeof(stats));
+    cur = 0;
+    hdr.magic = 0;      // 第一个事件时开始第一块
+    portEXIT_CRITICAL_SAFE(&lock);
+    atomic_store(&recording, true);
+    ESP_LOGI(TAG, "Recording (%u blocks x %u bytes)", (unsigned)TRACE_RAM_BLOCKS, (unsigned)TRACE_BLOCK_BYTES);
+}
+
+void trace_stop(void) {
+    atomic_store(&recording, false);
+}
+
+bool trace_recording(void) {
+    return atomic_load_explicit(&recording, memory_order_relaxed);
+}
+
+void trace_record(const trace_event_t *ev) {
+    if (!atomic_load_explicit(&recording, memory_order_relaxed)) return;
+    uint8_t buf[EVENT_MAX];
+
+    portENTER_CRITICAL_SAFE(&lock);
+    if (hdr.magic != TRACE_MAGIC) {
+        block_begin(0, ev->t_us);
+        stats.blocks = 1;
+    }
+    delta_state_t saved = enc;
+    size_t n = encode(ev, buf);
+    if (HDR_BYTES + hdr.len + n > TRACE_BLOCK_BYTES) {
+        // 当前块已满: 下一块以本事件为时间基准重新编码 (关键帧)
+        enc = saved;
+        cur = (cur + 1) % TRACE_RAM_BLOCKS;
+        if (stats.blocks >= TRACE_RAM_BLOCKS) stats.overwritten++;
+        stats.blocks++;
+        block_begin(hdr.seq + 1, ev->t_us);
+        n = encode(ev, buf);
+    }
+    uint8_t *blk = &ring[cur * TRACE_BLOCK_BYTES];
+    memcpy(blk + HDR_BYTES + hdr.len, buf, n);
+    hdr.len += n;
+    hdr.events++;
+    memcpy(blk, &hdr, HDR_BYTES);
+    stats.events++;
+    stats.bytes += n;
+    portEXIT_CRITICAL_SAFE(&lock);
+}
+
+void trace_get_stats(trace_stats_t *out) {
+    portENTER_CRITICAL_SAFE(&lock);
+    *out = stats;
+    portEXIT_CRITICAL_SAFE(&lock);
+}
+
+const uint8_t *trace_image(size_t *len) {
+    *len = sizeof(ring);
+    return ring;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+static bool part_erased;            ///< 分区已擦除且尚未写入
+
+static const esp_partition_t *trace_partition(void) {
+    const esp_partition_t *part = trace_partition();
+    if (!part) ESP_LOGW(TAG, "No '%s' partition (see partitions.csv)", TRACE_PARTITION_LABEL);
+    return part;
+}
+#endif
+
+esp_err_t trace_partition_erase(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    return ESP_OK;
+#else
+    const esp_partition_t *part = trace_partition();
+    if (!part) return ESP_ERR_NOT_FOUND;
+    // 整个分区擦除: 上一次转存留下的块不能混入本次映像
+    esp_err_t err = esp_partition_erase_range(part, 0, part->size);
+    part_erased = err == ESP_OK;
+    return err;
+#endif
+}
+
+esp_err_t trace_flush(void) {
+    trace_stats_t st;
+    trace_stop();
+    trace_get_stats(&st);
+    size_t len = st.blocks < TRACE_RAM_BLOCKS ? st.blocks * TRACE_BLOCK_BYTES : sizeof(ring);
+
+#if CONFIG_IDF_TARGET_LINUX
+    FILE *f = fopen(TRACE_FILE, "wb");
+    if (!f) return ESP_FAIL;
+    size_t written = fwrite(ring, 1, len, f);
+    fclose(f);
+    if (written != len) return ESP_FAIL;
+#else
+    // 运行中不擦除 (擦除期间 flash 缓存停用，控制任务会停顿而阀门保持打开)，只写入上电时擦好的分区
+    const esp_partition_t *part = trace_partition();
+    if (!part) return ESP_ERR_NOT_FOUND;
+    if (!part_erased) {
+        ESP_LOGE(TAG, "Partition not erased at boot, trace not flushed");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (len > part->size) len = part->size - part->size % TRACE_BLOCK_BYTES;
+    esp_err_t err = esp_partition_write(part, 0, ring, len);
+    part_erased = false;
+    if (err != ESP_OK) return err;
+#endif
+    ESP_LOGI(TAG, "Flushed %lu events in %lu bytes (%lu blocks, %lu overwritten)",
+             (unsigned long)st.events, (unsigned long)len, (unsigned long)st.blocks,
+             (unsigned long)st.overwritten);
+    return ESP_OK;
+}
+
+// ---------------- 回放 ----------------
+
+static struct {
+    const uint8_t *img;
+    uint32_t nblocks;
+    uint32_t blk;               ///< 当前块下标
+    uint32_t left;              ///< 剩余块数 (含当前块)
+    trace_block_hdr_t hdr;      ///< 当前块块头
+    size_t   pos;               ///< 当前块内的解码位置
+    delta_state_t dec;
+    trace_event_t next;         ///< 已解码、尚未交付的事件
+    bool     has_next;
+    bool     active;
+    int64_t  offset_us;
+} rp;
+
+static bool block_valid(uint32_t i, trace_block_hdr_t *h) {
+    memcpy(h, rp.img + (size_t)i * TRACE_BLOCK_BYTES, HDR_BYTES);
+    return h->magic == TRACE_MAGIC && h->version == TRACE_VERSION && HDR_BYTES + h->len <= TRACE_BLOCK_BYTES;
+}
+
+static bool get_varint(const uint8_t *p, size_t end, size_t *pos, uint64_t *v) {
+    *v = 0;
+    for (int shift = 0; *pos < end && shift < 64; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        *v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// 进入下一个有效块 (序号必须与上一块连续，否则视为结束)
+static bool next_block(bool first) {
+    trace_block_hdr_t h;
+    while (rp.left > 0) {
+        if (!first) {
+            rp.blk = (rp.blk + 1) % rp.nblocks;
+            rp.left--;
+            if (rp.left == 0) return false;
+        }
+        if (block_valid(rp.blk, &h) && (first || h.seq == rp.hdr.seq + 1)) {
+            rp.hdr = h;
+            rp.pos = 0;
+            memset(&rp.dec, 0, sizeof(rp.dec));
+            rp.dec.t = h.t0_us;
+            return true;
+        }
+        if (!first) return false;
+        first = false;      // 起始块无效 (不应发生): 放弃
+    }
+    return false;
+}
+
+// 解码下一个事件
+static bool decode(trace_event_t *ev) {
+    while (rp.pos >= rp.hdr.len) {
+        if (!next_block(false)) return false;
+    }
+    const uint8_t *p = rp.img + (size_t)rp.blk * TRACE_BLOCK_BYTES + HDR_BYTES;
+    size_t end = rp.hdr.len;
+    uint64_t v;
+
+    uint8_t tag = p[rp.pos++];
+    ev->type = tag >> 6;
+    ev->ch = tag & 0x1F;
+    bool flag = (tag & 0x20) != 0;
+    if (!get_varint(p, end, &rp.pos, &v)) return false;
+    rp.dec.t += unzigzag(v);
+    ev->t_us = rp.dec.t;
+    ev->ok = true;
+    ev->value = 0;
+
+    if (ev->type == TRACE_EV_MARK) {
+        if (!get_varint(p, end, &rp.pos, &v)) return false;
+        ev->value = (uint32_t)v;
+    } else if (ev->type == TRACE_EV_PUMP) {
+        ev->value = flag ? 1 : 0;
+    } else if (flag) {
+        ev->ok = false;
+    } else {
+        if (!get_varint(p, end, &rp.pos, &v)) return false;
+        uint32_t *prev = &rp.dec.prev[ev->type][ev->ch];
+        *prev = (uint32_t)((int64_t)*prev + unzigzag(v));
+        if (ev->type == TRACE_EV_ANGLE) *prev &= 0x0FFF;
+        ev->value = *prev;
+    }
+    return true;
+}
+
+esp_err_t trace_replay_open(const uint8_t *img, size_t len) {
+    trace_block_hdr_t h;
+    uint32_t oldest = 0, min_seq = UINT32_MAX;
+
+    memset(&rp, 0, sizeof(rp));
+    rp.img = img;
+    rp.nblocks = len / TRACE_BLOCK_BYTES;
+    for (uint32_t i = 0; i < rp.nblocks; i++) {
+        if (block_valid(i, &h) && h.seq < min_seq) {
+            min_seq = h.seq;
+            oldest = i;
+        }
+    }
+    if (min_seq == UINT32_MAX) return ESP_ERR_NOT_FOUND;
+
+    rp.blk = oldest;
+    rp.left = rp.nblocks;
+    next_block(true);
+    rp.has_next = decode(&rp.next);
+    ESP_LOGI(TAG, "Replay: %lu blocks from seq %lu, first event at %lld us",
+             (unsigned long)rp.nblocks, (unsigned long)min_seq, (long long)rp.next.t_us);
+    return rp.has_next ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t trace_replay_load(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    static uint8_t *buf;
+    FILE *f = fopen(TRACE_FILE, "rb");
+    if (!f) return ESP_ERR_NOT_FOUND;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    free(buf);
+    buf = malloc(len > 0 ? (size_t)len : 1);
+    size_t n = buf ? fread(buf, 1, (size_t)len, f) : 0;
+    fclose(f);
+    if (!buf) return ESP_ERR_NO_MEM;
+    return trace_replay_open(buf, n);
+#else
+    static esp_partition_mmap_handle_t handle;
+    const void *ptr;
+    const esp_partition_t *part = trace_partition();
+    if (!part) return ESP_ERR_NOT_FOUND;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA, &ptr, &handle);
+    if (err != ESP_OK) return err;
+    return trace_replay_open(ptr, part->size);
+#endif
+}
+
+void trace_replay_start(int64_t offset_us) {
+    rp.offset_us = offset_us;
+    rp.active = rp.has_next;
+}
+
+int64_t trace_replay_first_us(void) {
+    return rp.next.t_us;
+}
+
+bool trace_replaying(void) {
+    return rp.active;
+}
+
+bool trace_replay_done(void) {
+    return !rp.has_next;
+}
+
+int trace_replay_until(int64_t now_us, trace_sink_t sink) {
+    int n = 0;
+    while (rp.active && rp.has_next && rp.next.t_us + rp.offset_us <= now_us) {
+        trace_event_t ev = rp.next;
+        ev.t_us += rp.offset_us;
+        sink(&ev);
+        n++;
+        rp.has_next = decode(&rp.next);
+    }
+    return n;
+}
+
+#endif // PAM_TRACE_ENABLE
@@ -0,0 +1,143 @@
+//传感器轨迹记录与回放
+//记录: 驱动在最底层 (AS5600 原始读数、气压帧、压力开关边沿) 调用 trace_angle/press/pump，
+//事件经差分编码写入 RAM 环形缓冲，可转存到 flash 分区 (仿真中为 pam_trace.bin)。
+//回放: 按时间把事件交给调用者提供的接收函数，由驱动以与实时采集相同的路径处理
+//(AS5600 展开与滤波、气压快照、气泵去抖)，控制栈本身不区分实时数据与回放数据。
+//
+//缓冲按定长块组织，每块以块头开始并重置差分状态 (关键帧)，环形覆盖最旧的块后其余块仍可独立解码。
+//块格式 (小端): 块头 trace_block_hdr_t，之后为事件流，每个事件:
+//  tag(u8) = type[7:6] | flag[5] | ch[4:0]
+//  dt      = zigzag varint，相对块内上一个事件的时间 (µs，块内第一个事件相对块头 t0_us)
+//  payload = ANGLE: zigzag varint，相对同通道上一读数的增量 (回绕到 ±2048)
+//            PRESS: zigzag varint，相对同通道上一读数的增量 (Pa)
+//            MARK:  varint，用户值
+//            PUMP 与 flag = 1 (读取超时) 的 ANGLE/PRESS 没有 payload；PUMP 的 flag 为开关电平 (1 = 低压)，
+//            通道 0 为边沿，通道 1 为开始记录时的电平
+//典型事件 3~4 字节；块内第一次出现的通道以 0 为基准，相当于绝对值。
+
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "hardware_config.h"
+
+#define TRACE_MAGIC         0x544D4150u     // "PAMT"
+#define TRACE_VERSION       1
+#define TRACE_MAX_CH        32              // tag 中通道号 5 位
+#define TRACE_PUMP_EDGE     0               // PUMP 事件通道: 0 = 开关边沿，1 = 记录开始时的电平
+#define TRACE_PUMP_LEVEL    1
+
+typedef enum {
+    TRACE_EV_ANGLE = 0,     ///< AS5600 原始读数 (12 位)
+    TRACE_EV_PRESS,         ///< 气压帧 (Pa)
+    TRACE_EV_PUMP,          ///< 压力开关边沿 (含触点抖动)
+    TRACE_EV_MARK,          ///< 用户标记 (命令、校验值等)
+} trace_ev_type_t;
+
+typedef struct {
+    int64_t  t_us;          ///< 采样时刻 (驱动使用的时间戳)
+    uint32_t value;         ///< ANGLE: 原始读数；PRESS: Pa；PUMP: 1 = 低压；MARK: 用户值
+    uint8_t  type;          ///< trace_ev_type_t
+    uint8_t  ch;            ///< 通道 (MUX 通道；MARK 为用户编号)
+    bool     ok;            ///< ANGLE/PRESS: false = 读取超时，value 无效
+} trace_event_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t len;           ///< 块内事件流字节数
+    uint32_t seq;           ///< 块序号 (连续递增，回放按此确定最旧的块)
+    uint32_t events;
+    int64_t  t0_us;         ///< 差分时间基准 (块内第一个事件的时刻)
+} trace_block_hdr_t;
+
+typedef struct {
+    uint32_t events;        ///< 已记录的事件数
+    uint32_t bytes;         ///< 已写入的事件流字节数
+    uint32_t blocks;        ///< 已使用的块数 (含被覆盖的)
+    uint32_t overwritten;   ///< 被覆盖的最旧块数 (>0 时回放不是从记录开始)
+} trace_stats_t;
+
+// 事件接收函数 (回放)
+typedef void (*trace_sink_t)(const trace_event_t *ev);
+
+#if PAM_TRACE_ENABLE
+
+// 清空缓冲并开始记录 (之前的内容丢弃)
+void trace_record_start(void);
+
+// 停止记录 (缓冲内容保留，可转存或回放)
+void trace_stop(void);
+
+bool trace_recording(void);
+
+// 记录一个事件 (任意任务或 ISR，未在记录时立即返回)
+void trace_record(const trace_event_t *ev);
+
+void trace_get_stats(trace_stats_t *out);
+
+// RAM 缓冲的原始映像 (按块存放，长度 TRACE_RAM_BLOCKS * TRACE_BLOCK_BYTES)，应在停止记录后读取
+const uint8_t *trace_image(size_t *len);
+
+// 擦除转存分区 (64 KB 约 0.5 s，期间 flash 缓存停用、任务停顿)。须在控制任务启动、阀门动作之前调用；
+// 仿真中无操作
+esp_err_t trace_partition_erase(void);
+
+// 停止记录并转存: 目标上写入 TRACE_PARTITION_LABEL 数据分区 (须已由 trace_partition_erase 擦除，
+// 转存时只写不擦)，仿真中写入 pam_trace.bin
+esp_err_t trace_flush(void);
+
+// 打开一个映像准备回放 (块可为任意环形顺序，无效块跳过)
+// 返回 ESP_ERR_NOT_FOUND: 映像中没有有效块
+esp_err_t trace_replay_open(const uint8_t *img, size_t len);
+
+// 打开 trace_flush 转存的轨迹 (目标上映射 flash 分区，仿真中读入 pam_trace.bin)
+esp_err_t trace_replay_load(void);
+
+// 开始回放: 事件时间戳加上 offset_us 后交给接收函数 (目标上取 当前时刻 - trace_replay_first_us())
+void trace_replay_start(int64_t offset_us);
+
+// 第一个事件的时刻 (映像中的时间)
+int64_t trace_replay_first_us(void);
+
+bool trace_replaying(void);
+
+// 回放结束 (全部事件已交付)
+bool trace_replay_done(void);
+
+// 把时刻 <= now_us (已加偏移) 的全部事件按记录顺序交给 sink，返回交付数
+int trace_replay_until(int64_t now_us, trace_sink_t sink);
+
+#else
+
+static inline void trace_record(const trace_event_t *ev) { (void)ev; }
+static inline bool trace_recording(void) { return false; }
+static inline bool trace_replaying(void) { return false; }
+
+#endif // PAM_TRACE_ENABLE
+
+// 驱动使用的记录入口
+static inline void trace_angle(int ch, uint16_t raw, bool ok, int64_t t_us) {
+    trace_event_t ev = { t_us, raw, TRACE_EV_ANGLE, (uint8_t)ch, ok };
+    trace_record(&ev);
+}
+
+static inline void trace_press(int ch, uint32_t pa, bool ok, int64_t t_us) {
+    trace_event_t ev = { t_us, pa, TRACE_EV_PRESS, (uint8_t)ch, ok };
+    trace_record(&ev);
+}
+
+static inline void trace_pump(bool low, bool edge, int64_t t_us) {
+    trace_event_t ev = { t_us, low ? 1u : 0u, TRACE_EV_PUMP, edge ? TRACE_PUMP_EDGE : TRACE_PUMP_LEVEL, true };
+    trace_record(&ev);
+}
+
+static inline void trace_mark(uint8_t id, uint32_t value, int64_t t_us) {
+    trace_event_t ev = { t_us, value, TRACE_EV_MARK, id, true };
+    trace_record(&ev);
+}
+
+#endif // SENSOR_TRACE_H
@@ -0,0 +1,54 @@
+//顺序锁 (seqlock)：单写多读的“最新值”发布原语
+//读端无锁、不阻塞，发现写入交错时重试；写端在临界区内完成，
+//保证同核读端不会在写到一半时抢占写端而自旋。
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct {
+    atomic_uint  seq;    ///< 偶数 = 稳定，奇数 = 正在写
+    portMUX_TYPE wlock;  ///< 仅写端使用
+} seqlock_t;
+
+#define SEQLOCK_INIT { 0, portMUX_INITIALIZER_UNLOCKED }
+
+static inline void seqlock_init(seqlock_t *sl) {
+    atomic_init(&sl->seq, 0);
+    portMUX_INITIALIZE(&sl->wlock);
+}
+
+// 写端：begin/end 之间只做内存拷贝，不要调用任何可能阻塞的函数
+static inline void seqlock_write_begin(seqlock_t *sl) {
+    portENTER_CRITICAL(&sl->wlock);
+    unsigned s = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+    atomic_store_explicit(&sl->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seqlock_write_end(seqlock_t *sl) {
+    unsigned s = atomic_load_explicit(&sl->seq, memory_order_relaxed);
+    atomic_store_explicit(&sl->seq, s + 1, memory_order_release);
+    portEXIT_CRITICAL(&sl->wlock);
+}
+
+// 读端：典型用法
+//   unsigned s;
+//   do { s = seqlock_read_begin(&sl); copy = data; } while (seqlock_read_retry(&sl, s));
+static inline unsigned seqlock_read_begin(seqlock_t *sl) {
+    unsigned s;
+    while ((s = atomic_load_explicit(&sl->seq, memory_order_acquire)) & 1u) {
+        // 写端在另一核的临界区内，最多等待一次拷贝的时间
+    }
+    return s;
+}
+
+static inline bool seqlock_read_retry(seqlock_t *sl, unsigned start) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&sl->seq, memory_order_relaxed) != start;
+}
+
+#endif // SEQLOCK_H
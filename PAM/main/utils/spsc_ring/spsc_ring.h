@@ -0,0 +1,70 @@
+//单生产者/单消费者无锁环形缓冲区
+//生产者只写 head，消费者只写 tail，二者可在不同核上并发运行，无需互斥锁。
+//元素按值拷贝，容量必须是 2 的幂。
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+typedef struct {
+    atomic_uint head;       ///< 下一个写入位置 (生产者)
+    atomic_uint tail;       ///< 下一个读取位置 (消费者)
+    uint32_t    mask;       ///< 容量 - 1
+    size_t      elem_size;
+    uint8_t    *buf;        ///< 由调用者提供，大小 = 容量 * elem_size
+
+    uint32_t    drops;      ///< 队列满丢弃次数 (生产者维护)
+    uint32_t    max_depth;  ///< 历史最大深度 (生产者维护)
+} spsc_ring_t;
+
+// capacity 必须是 2 的幂
+static inline void spsc_ring_init(spsc_ring_t *r, void *storage, uint32_t capacity, size_t elem_size) {
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->mask = capacity - 1;
+    r->elem_size = elem_size;
+    r->buf = (uint8_t *)storage;
+    r->drops = 0;
+    r->max_depth = 0;
+}
+
+// 当前深度 (任一端均可调用，结果为近似值)
+static inline uint32_t spsc_ring_depth(spsc_ring_t *r) {
+    return atomic_load_explicit(&r->head, memory_order_acquire) -
+           atomic_load_explicit(&r->tail, memory_order_acquire);
+}
+
+// 生产者：写入一个元素，队列满时返回 false
+static inline bool spsc_ring_push(spsc_ring_t *r, const void *elem) {
+    unsigned head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    uint32_t depth = head - tail;
+
+    if (depth > r->mask) {
+        r->drops++;
+        return false;
+    }
+    memcpy(r->buf + (head & r->mask) * r->elem_size, elem, r->elem_size);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+
+    if (depth + 1 > r->max_depth) r->max_depth = depth + 1;
+    return true;
+}
+
+// 消费者：取出一个元素，队列空时返回 false
+static inline bool spsc_ring_pop(spsc_ring_t *r, void *elem) {
+    unsigned tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (head == tail) return false;
+    memcpy(elem, r->buf + (tail & r->mask) * r->elem_size, r->elem_size);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+#endif // SPSC_RING_H
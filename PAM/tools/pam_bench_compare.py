@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""PAM 微基准结果对比
+
+读取微基准输出的 JSON Lines (可直接是串口日志或 linux 目标的标准输出，非 JSON 行被忽略)，
+按内核并排列出各次构建的 ns/op (有周期计数器时另列 cycles/op)，以第一个文件为基准给出比值。
+输出格式见 main/bench/bench.h。
+
+    python pam_bench_compare.py base.log o3.log
+    python pam_bench_compare.py esp32s3.log esp32c3.log --cycles
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """返回 (构建信息, {(name, arg): 结果})"""
+    build, results = {}, {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            start = line.find("{")
+            if start < 0:
+                continue
+            try:
+                rec = json.loads(line[start:])
+            except ValueError:
+                continue
+            if rec.get("type") == "build":
+                build = rec
+            elif rec.get("type") == "result":
+                results[(rec["name"], rec.get("arg"))] = rec
+    return build, results
+
+
+def label(path, build):
+    parts = [build.get("tag") or path, build.get("target", "?"), build.get("opt", "?")]
+    if build.get("fixed_point"):
+        parts.append("q16")
+    return "/".join(str(p) for p in parts)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("files", nargs="+", help="微基准输出 (第一个为基准)")
+    ap.add_argument("--cycles", action="store_true", help="对比 cycles/op 而不是 ns/op")
+    args = ap.parse_args()
+
+    runs = [(path,) + load(path) for path in args.files]
+    key_field = "cycles_per_op" if args.cycles else "ns_per_op"
+    sd_field = "cycles_sd" if args.cycles else "ns_sd"
+
+    # 内核按第一次出现的顺序
+    keys = []
+    for _, _, results in runs:
+        for k in results:
+            if k not in keys:
+                keys.append(k)
+
+    names = ["%s[%s]" % (n, a) if a is not None else n for n, a in keys]
+    width = max([len(n) for n in names] + [6])
+    header = "%-*s" % (width, "kernel")
+    for path, build, _ in runs:
+        header += "  %22s" % label(path, build)[:22]
+    print(header)
+
+    for name, k in zip(names, keys):
+        row = "%-*s" % (width, name)
+        base = runs[0][2].get(k, {}).get(key_field)
+        for i, (_, _, results) in enumerate(runs):
+            r = results.get(k)
+            v = r.get(key_field) if r else None
+            if v is None:
+                row += "  %22s" % "-"
+                continue
+            cell = "%.1f±%.1f" % (v, r.get(sd_field) or 0.0)
+            if i > 0 and base:
+                cell += " x%.2f" % (v / base)
+            row += "  %22s" % cell
+        print(row)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""PAM 二进制遥测解码
+
+读取 COBS 分帧的遥测流 (串口或文件)，输出 CSV (安装 pandas + pyarrow 时可输出 Parquet)。
+帧格式见 main/app/telemetry/telemetry.h。
+
+    python pam_telemetry_decode.py pam_telem.bin -o run.csv
+    python pam_telemetry_decode.py /dev/ttyACM0 -o run.parquet --duration 30
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+TELEM_VERSION = 1
+
+# 与 telem_signal_t 顺序一致
+SIGNALS = [
+    "angle", "angle_sp", "angle_vel",
+    "press_sp_a", "press_sp_b", "press_a", "press_b",
+    "duty_a_in", "duty_a_out", "duty_b_in", "duty_b_out",
+    "pid_p", "pid_i", "pid_d",
+]
+
+HEADER = struct.Struct("<BHIH")
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS frame")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_frame(frame):
+    ver, seq, t_us, mask = HEADER.unpack_from(frame)
+    if ver != TELEM_VERSION:
+        raise ValueError("unsupported version %d" % ver)
+    idx = [i for i in range(len(SIGNALS)) if mask & (1 << i)]
+    values = struct.unpack_from("<%df" % len(idx), frame, HEADER.size)
+    row = {"seq": seq, "t_us": t_us}
+    row.update({SIGNALS[i]: v for i, v in zip(idx, values)})
+    return row
+
+
+def read_chunks(source, duration):
+    """按块产出原始字节，source 为文件路径或串口设备"""
+    if source.startswith("/dev/") or source.upper().startswith("COM"):
+        import serial  # pyserial，仅串口模式需要
+        port = serial.Serial(source, timeout=0.1)
+        t_end = time.monotonic() + duration if duration else None
+        try:
+            while t_end is None or time.monotonic() < t_end:
+                chunk = port.read(4096)
+                if chunk:
+                    yield chunk
+        except KeyboardInterrupt:
+            pass
+        finally:
+            port.close()
+    else:
+        with open(source, "rb") as f:
+            while True:
+                chunk = f.read(65536)
+                if not chunk:
+                    break
+                yield chunk
+
+
+def decode_stream(chunks, stats):
+    buf = bytearray()
+    last_seq = None
+    for chunk in chunks:
+        buf += chunk
+        while True:
+            end = buf.find(b"\x00")
+            if end < 0:
+                break
+            raw = bytes(buf[:end])
+            del buf[:end + 1]
+            if not raw:
+                continue
+            try:
+                row = parse_frame(cobs_decode(raw))
+            except (ValueError, struct.error):
+                stats["bad"] += 1
+                continue
+
+            # 序号按记录递增 (抽取跳过的记录也计数)，回绕为 16 位
+            if last_seq is not None:
+                gap = (row["seq"] - last_seq) & 0xFFFF
+                if gap > stats["max_step"]:
+                    stats["gaps"] += 1
+                    stats["lost"] += gap - 1
+            last_seq = row["seq"]
+            stats["frames"] += 1
+            yield row
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="遥测文件或串口设备")
+    ap.add_argument("-o", "--output", default="-", help="输出文件 (.csv / .parquet)，默认标准输出")
+    ap.add_argument("--duration", type=float, default=0, help="串口采集时长 (秒)，0 = 直到 Ctrl-C")
+    ap.add_argument("--max-step", type=int, default=1,
+                    help="相邻帧序号的最大正常间隔 (所有信号都被抽取时为最小抽取系数)")
+    args = ap.parse_args()
+
+    stats = {"frames": 0, "bad": 0, "gaps": 0, "lost": 0, "max_step": args.max_step}
+    rows = decode_stream(read_chunks(args.source, args.duration), stats)
+    columns = ["seq", "t_us"] + SIGNALS
+
+    if args.output.endswith(".parquet"):
+        import pandas as pd
+        pd.DataFrame(list(rows), columns=columns).to_parquet(args.output)
+    else:
+        f = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+        w = csv.DictWriter(f, fieldnames=columns)
+        w.writeheader()
+        for row in rows:
+            w.writerow(row)
+        if f is not sys.stdout:
+            f.close()
+
+    print("frames=%d bad=%d gaps=%d lost~=%d" % (stats["frames"], stats["bad"], stats["gaps"], stats["lost"]),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()